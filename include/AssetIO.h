@@ -17,6 +17,7 @@
 #include "PathManager.h" // must provide getMarkersPath(), getMapsPath()
 #include "imgui.h"
 #include "ImGuiToaster.h"
+#include "ImageThumbnail.h"
 
 namespace AssetIO
 {
@@ -321,6 +322,56 @@ namespace AssetIO
         return true;
     }
 
+    // Bitmap on the clipboard (a screenshot) as PNG bytes; empty when there is none.
+    // Handles the 24/32-bit CF_DIB that Print Screen and the snipping tools put there.
+    inline std::vector<uint8_t> clipboardImagePng()
+    {
+        std::vector<uint8_t> png;
+        if (!IsClipboardFormatAvailable(CF_DIB) || !OpenClipboard(nullptr))
+            return png;
+        HANDLE h = GetClipboardData(CF_DIB);
+        const auto* bih = h ? static_cast<const BITMAPINFOHEADER*>(GlobalLock(h)) : nullptr;
+        if (bih)
+        {
+            const int w = bih->biWidth;
+            const int hgt = bih->biHeight < 0 ? -bih->biHeight : bih->biHeight;
+            const bool bottomUp = bih->biHeight > 0;
+            const int bpp = bih->biBitCount;
+            const bool bitfields = bih->biCompression == BI_BITFIELDS;
+            if (w > 0 && hgt > 0 && (bpp == 24 || bpp == 32) && (bih->biCompression == BI_RGB || bitfields))
+            {
+                const auto* pixels = reinterpret_cast<const uint8_t*>(bih) + bih->biSize +
+                                     (bitfields && bih->biSize == sizeof(BITMAPINFOHEADER) ? 3 * sizeof(DWORD) : 0) +
+                                     bih->biClrUsed * sizeof(RGBQUAD);
+                const size_t stride = ((size_t(w) * bpp + 31) / 32) * 4;
+                std::vector<uint8_t> rgba(size_t(w) * hgt * 4);
+                bool anyAlpha = false;
+                for (int y = 0; y < hgt; ++y)
+                {
+                    const uint8_t* src = pixels + stride * (bottomUp ? hgt - 1 - y : y);
+                    uint8_t* dst = &rgba[size_t(y) * w * 4];
+                    for (int x = 0; x < w; ++x, src += bpp / 8, dst += 4)
+                    {
+                        dst[0] = src[2];
+                        dst[1] = src[1];
+                        dst[2] = src[0];
+                        dst[3] = bpp == 32 ? src[3] : 255;
+                        anyAlpha = anyAlpha || dst[3] != 0;
+                    }
+                }
+                if (!anyAlpha) // most 32-bit screenshots leave alpha at 0
+                {
+                    for (size_t i = 3; i < rgba.size(); i += 4)
+                        rgba[i] = 255;
+                }
+                png = ImageThumbnail::encodePng(rgba.data(), w, hgt);
+            }
+            GlobalUnlock(h);
+        }
+        CloseClipboard();
+        return png;
+    }
+
     // List assets for UI (absolute paths)
     inline std::vector<std::filesystem::path> listAssets(AssetKind kind)
     {
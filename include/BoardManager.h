@@ -2,6 +2,7 @@
 #include <vector>
 #include "Renderer.h"
 #include "Texture.h"
+#include "TextureStreamer.h"
 #include "Shader.h"
 #include "VertexArray.h"
 #include "VertexBuffer.h"
@@ -168,7 +169,7 @@ enum class Tool
 class BoardManager : std::enable_shared_from_this<BoardManager>
 {
 public:
-    BoardManager(flecs::world ecs, std::weak_ptr<NetworkManager> network_manager, std::shared_ptr<IdentityManager> identity_manager, std::shared_ptr<DirectoryWindow> map_directory, std::shared_ptr<DirectoryWindow> marker_directory);
+    BoardManager(flecs::world ecs, std::weak_ptr<NetworkManager> network_manager, std::shared_ptr<IdentityManager> identity_manager, std::shared_ptr<DirectoryWindow> map_directory, std::shared_ptr<DirectoryWindow> marker_directory, bool watchDirectories = true);
     ~BoardManager();
 
     void renderBoard(VertexArray& va, IndexBuffer& ib, Shader& shader, Shader& grid_shader, Renderer& renderer); // Render board elements (map, markers, fog)
@@ -254,15 +255,60 @@ public:
     };
 
     BoardImageData LoadTextureFromMemory(const unsigned char* bytes, size_t sizeBytes);
+    // Network-received images: placeholder texture now, real image once decoded + uploaded (see TextureStreamer)
+    GLuint LoadTextureAsync(std::vector<uint8_t> bytes, TextureStreamer::ReadyFn onReady)
+    {
+        return texture_streamer.requestFromBytes(std::move(bytes), std::move(onReady));
+    }
+    GLuint LoadTextureAsync(std::shared_ptr<const uint8_t> mapped, size_t size, TextureStreamer::ReadyFn onReady)
+    {
+        return texture_streamer.requestFromView(std::move(mapped), size, std::move(onReady));
+    }
+    GLuint LoadTextureAsync(std::shared_ptr<uint8_t> rgba, int width, int height, TextureStreamer::ReadyFn onReady)
+    {
+        return texture_streamer.requestFromPixels(std::move(rgba), width, height, std::move(onReady));
+    }
+    void pumpTextureUploads(double budgetMs)
+    {
+        texture_streamer.pump(budgetMs);
+    }
+    const TextureStreamer& getTextureStreamer() const
+    {
+        return texture_streamer;
+    }
 
     void killIfMouseUp(bool isMouseDown);
     void resnapAllMarkersToNearest(const Grid& grid);
 
+    // Multi-selection (SELECT tool: drag a box, Ctrl+click toggles). Markers of the active board only;
+    // a MOVE drag on a selected marker moves the whole selection, see startGroupDrag.
+    void startBoxSelect(glm::vec2 world_position);
+    void updateBoxSelect(glm::vec2 world_position);
+    void endBoxSelect(glm::vec2 world_position, bool additive);
+    bool isBoxSelecting() const
+    {
+        return is_box_selecting;
+    }
+    void toggleSelected(flecs::entity marker);
+    void clearSelection();
+    bool isSelected(flecs::entity marker) const;
+    bool hasSelection() const
+    {
+        return !selection.empty();
+    }
+    // GM: one MarkerGroupOp for the whole selection
+    void setSelectionVisibility(bool visible);
+    void deleteSelection();
+    void renderSelectionWindow();
+    // draws into the map image; fbo_to_screen scales FBO pixels to the displayed image
+    void renderSelectionOverlay(ImDrawList* draw_list, ImVec2 image_min, ImVec2 fbo_to_screen);
+
     //void replaceOwnerUsernameEverywhere(const std::string& oldUsername,
     //                                    const std::string& newUsername);
     void onUsernameChanged(const std::string& uniqueId, const std::string& newUsername);
 
 private:
+    TextureStreamer texture_streamer;
     bool showEditWindow = false;
     bool showGridSettings = false;
     bool showCameraSettings = false;
@@ -281,6 +327,27 @@ private:
     flecs::entity grid_entity = flecs::entity();
 
     bool is_creating_fog = false;
+
+    std::vector<flecs::entity> selection;
+    bool is_box_selecting = false;
+    glm::vec2 box_start_world{0.0f, 0.0f};
+    glm::vec2 box_end_world{0.0f, 0.0f};
+
+    struct GroupMember
+    {
+        flecs::entity entity;
+        Position start;
+    };
+    std::vector<GroupMember> group_drag; // empty unless a group drag is running
+    std::vector<uint64_t> group_drag_ids;
+    uint64_t group_drag_id = 0;
+    glm::vec2 group_drag_origin{0.0f, 0.0f};
+
+    void pruneSelection();
+    bool startGroupDrag(glm::vec2 world_position);
+    void handleGroupDragging(glm::vec2 world_position);
+    void endGroupDrag();
+
     Tool currentTool; // Active tool for interaction
     Tool previousTool;
 };
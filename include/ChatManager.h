@@ -16,8 +16,9 @@
 #include "Message.h"
 #include "UiTypingGuard.h"
 
-class NetworkManager; // fwd
-class PeerLink;       // fwd
+class NetworkManager;  // fwd
+class PeerLink;        // fwd
+class TextureStreamer; // fwd
 
 // ---- Chat model ----
 struct ChatMessageModel
@@ -31,8 +32,9 @@ struct ChatMessageModel
     Kind kind = Kind::TEXT;
     std::string senderUniqueId; // <— NEW: stable sender id
     std::string username;       // display label
-    std::string content;        // text / url
+    std::string content;        // text / url / image caption
     double ts = 0.0;
+    std::optional<msg::ChatImageRef> image; // attachment, fetched by hash
 };
 
 struct ChatGroupModel
@@ -50,6 +52,7 @@ class ChatManager : public std::enable_shared_from_this<ChatManager>
 {
 public:
     explicit ChatManager(std::weak_ptr<NetworkManager> nm, std::shared_ptr<IdentityManager> identity_manager);
+    ~ChatManager();
 
     // Attach/replace network
     void setNetwork(std::weak_ptr<NetworkManager> nm);
@@ -61,9 +64,13 @@ public:
         return currentTableId_ != 0;
     }
 
-    // Persistence (local file per table)
+    // Persistence (local file per table); a replay sandbox turns saving off
     bool saveCurrent();
     bool loadCurrent();
+    void setPersistent(bool on)
+    {
+        persistent_ = on;
+    }
 
     // Incoming (GameTableManager -> processReceivedMessages)
     void applyReady(const msg::ReadyMessage& m); // handles group create/update/delete & message
@@ -77,6 +84,9 @@ public:
     // UI render
     void render();
 
+    // Files dropped on the main window; the first image is staged if the chat is hovered
+    void onFilesDropped(const std::vector<std::string>& paths);
+
     // Snapshot helpers (unchanged file layout can be separate if you already use them)
     void writeGroupsToSnapshotGT(std::vector<unsigned char>& buf) const;
     void readGroupsFromSnapshotGT(const std::vector<unsigned char>& buf, size_t& off);
@@ -100,6 +110,7 @@ public:
 
 private:
     std::shared_ptr<IdentityManager> identity_manager;
+    bool persistent_ = true;
 
     // === runtime store ===
     std::unordered_map<uint64_t, ChatGroupModel> groups_;
@@ -136,6 +147,27 @@ private:
     // wiring
     std::weak_ptr<NetworkManager> network_;
 
+    // Image attachments. Textures are keyed by content hash, so a picture posted twice (or
+    // quoted in two groups) is decoded once; only a few full-size ones stay on the GPU.
+    struct ChatImageTex
+    {
+        unsigned thumb = 0;
+        ImVec2 thumbSize{0, 0};
+        unsigned full = 0;
+        ImVec2 fullSize{0, 0};
+        bool fullReady = false;
+        double fullRequestedAt = 0.0; // 0 = not asked
+        uint64_t lastUseFrame = 0;
+    };
+    static constexpr size_t kMaxFullTextures = 6;
+    std::unique_ptr<TextureStreamer> textures_;
+    std::unordered_map<std::string, ChatImageTex> imageTex_; // raw digest bytes -> textures
+    std::optional<msg::ChatImageRef> viewerImage_;
+    std::vector<uint8_t> pendingImage_; // staged attachment, sent with the next message
+    std::string pendingImageName_;
+    bool chatWindowHovered_ = false;
+    uint64_t frame_ = 0;
+
     // === helpers ===
     static ChatMessageModel::Kind classifyMessage(const std::string& s);
     static double nowSec();
@@ -145,6 +177,15 @@ private:
     ImU32 getUsernameColor(const std::string& name) const;
     void renderColoredUsername(const std::string& name) const;
     void renderPlainMessage(const std::string& text) const;
+    void renderImageMessage(const ChatMessageModel& m);
+    void renderImageViewer();
+    void requestFullImage(const ChatMessageModel& m);
+    void applyImageReady(const msg::ReadyMessage& m);
+    void evictFullTextures();
+    void releaseUnusedImages();
+    bool attachImageFile(const std::filesystem::path& path);
+    void attachImageBytes(std::vector<uint8_t> bytes, const std::string& name);
+    void sendImageMessage(ChatGroupModel& g, const std::string& caption);
 
     std::filesystem::path chatFilePathFor(uint64_t tableId, const std::string& name) const;
     void ensureGeneral();
@@ -9,6 +9,8 @@
 #include <shared_mutex>
 #include <condition_variable>
 #include "Texture.h"
+#include "GpuTextures.h"
+#include "HeadlessMode.h"
 //#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
@@ -277,7 +279,7 @@ public:
                 if (it != images.end())
                 {
                     if (it->textureID != 0)
-                        glDeleteTextures(1, &it->textureID);
+                        GpuTextures::destroy(it->textureID);
                     images.erase(it);
                 }
                 // else: already gone — ignore
@@ -309,7 +311,8 @@ public:
 
                 // Use your existing loader (returns ImageData with texture + size)
                 ImageData img = LoadTextureFromFile(fullpath.c_str());
-                if (img.textureID != 0)
+                const bool loaded = HeadlessMode::enabled() ? img.size.x > 0.0f : img.textureID != 0;
+                if (loaded)
                 {
                     img.filename = fname; // store filename (not full path) for matching
                     toInsert.emplace_back(std::move(img));
@@ -415,6 +418,17 @@ private:
         //std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
 
         int width, height, nrChannels;
+        if (HeadlessMode::enabled())
+        {
+            // header only, the host never needs the pixels
+            if (!stbi_info(path, &width, &height, &nrChannels))
+            {
+                std::cerr << "Failed to read image info: " << path << std::endl;
+                return ImageData(0, glm::vec2(), "");
+            }
+            return ImageData(0, glm::vec2(width, height), path);
+        }
+
         unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
         stbi_set_flip_vertically_on_load(0); // Flip images vertically if needed
         if (!data)
@@ -423,17 +437,7 @@ private:
             return ImageData(0, glm::vec2(), "");
         }
 
-        GLuint textureID[1];
-        glGenTextures(1, textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID[0]);
-
-        // Set the texture data
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        const GLuint textureID = GpuTextures::create(width, height, data);
 
         stbi_image_free(data);
 
@@ -446,6 +450,6 @@ private:
         // Output the duration in milliseconds
         //std::cout << "Operation for file "<< path <<"took " << duration.count() << " seconds" << std::endl;
 
-        return ImageData(textureID[0], glm::vec2(width, height), path);
+        return ImageData(textureID, glm::vec2(width, height), path);
     }
 };
@@ -2,6 +2,10 @@
 #include "BoardManager.h"
 #include "UiTypingGuard.h"
 #include <vector>
+#include <deque>
+#include <array>
+#include <memory_resource>
+#include <span>
 #include "flecs.h"
 #include "Components.h"
 #include "PathManager.h"
@@ -9,10 +13,28 @@
 #include "ChatManager.h"
 #include "IdentityManager.h"
 
+class ReplaySandbox;
+
+// Per-frame numbers from processReceivedMessages (debug overlay)
+struct InboundStats
+{
+    size_t rawDepth = 0;       // raw DC buffers still waiting for decode
+    size_t backlogDepth = 0;   // decoded messages waiting for apply
+    uint32_t applied = 0;      // this frame
+    uint32_t coalesced = 0;    // superseded moves/grids dropped this frame
+    uint32_t deferredHeavy = 0;
+    uint64_t coalescedTotal = 0;
+    double decodeMs = 0.0;
+    double applyMs = 0.0;
+    double frameMs = 0.0;
+};
+
 class GameTableManager : public std::enable_shared_from_this<GameTableManager>
 {
 public:
-    GameTableManager(flecs::world ecs, std::shared_ptr<DirectoryWindow> map_directory, std::shared_ptr<DirectoryWindow> marker_directory);
+    // replaySandbox: a throwaway instance a capture is replayed into (ReplaySandbox); it never
+    // connects, watches no folders and writes nothing to disk
+    GameTableManager(flecs::world ecs, std::shared_ptr<DirectoryWindow> map_directory, std::shared_ptr<DirectoryWindow> marker_directory, bool replaySandbox = false);
     ~GameTableManager();
 
     void saveGameTable();
@@ -25,11 +47,24 @@ public:
     bool isConnected() const;
 
     void processReceivedMessages();
+    const InboundStats& getInboundStats() const
+    {
+        return inboundStats_;
+    }
+
+    // session replay (perf regression runs) goes into a ReplaySandbox, ticked with this table
+    bool startReplay(const std::filesystem::path& file, bool realtime);
+    void stopReplay();
+    const ReplaySandbox* getReplaySandbox() const
+    {
+        return replay_.get();
+    }
 
     void hostGameTablePopUp();
     void networkCenterPopUp();
     void renderNetworkCenterPlayer();
     void renderNetworkCenterGM();
+    void renderNetworkStats();
     void connectToGameTablePopUp();
     void closeGameTablePopUp();
     void manageGameTablesPopUp();
@@ -239,6 +274,27 @@ private:
 
     flecs::world ecs;
 
+    static constexpr double kTextureUploadBudgetMs = 3.0; // GL upload time per frame for network textures
+    void attachNetworkTexture(flecs::entity e, msg::ReadyMessage& m, bool sizeFromTexture);
+
+    // ---- inbound scheduler ----
+    static constexpr double kInboundBudgetMs = 4.0;     // decode + apply per frame
+    static constexpr double kHeavyMinRemainingMs = 2.0; // don't start a commit/snapshot with less left
+    static constexpr int kMaxHeavyPerFrame = 4;
+    static constexpr size_t kMaxMarkerBatch = 256;  // consecutive CommitMarker for one board, created in one bulk insert
+    static constexpr size_t kMarkersPerHeavy = 64;  // a run is charged one heavy op per this many markers
+    std::deque<msg::ReadyMessage> readyBacklog_;
+    InboundStats inboundStats_;
+    std::unique_ptr<ReplaySandbox> replay_;
+    // per-frame scratch (coalescing maps etc.), released at the top of processReceivedMessages
+    alignas(std::max_align_t) std::array<std::byte, 64 * 1024> frameArenaBuf_;
+    std::pmr::monotonic_buffer_resource frameArena_{frameArenaBuf_.data(), frameArenaBuf_.size()};
+    static bool isHeavyReady(const msg::ReadyMessage& m);
+    size_t coalesceReadyBacklog();
+    void applyReadyMessage(msg::ReadyMessage& m);
+    size_t takeMarkerCommitRun(std::vector<msg::ReadyMessage>& run, size_t maxCount); // from the backlog head
+    void applyMarkerCommits(std::span<msg::ReadyMessage> run);
+
     glm::vec2 current_mouse_pos; // PosiÃ§Ã£o atual do mouse em snake_case
 
     glm::vec2 current_mouse_ndc_pos;   // PosiÃ§Ã£o atual do mouse em snake_case
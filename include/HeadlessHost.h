@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "flecs.h"
+#include "GameTableManager.h"
+#include "DirectoryWindow.h"
+#include "ImGuiToaster.h"
+
+struct HeadlessHostOptions
+{
+    std::filesystem::path gameTable; // .runic file, or a table name under GameTables/
+    ConnectionType mode = ConnectionType::LOCAL;
+    unsigned short port = 7777;
+    std::string password;
+    std::string customHost;
+    std::string username = "GM";
+    bool tryUpnp = false;
+    int autosaveSec = 60; // 0 = off
+    double tickMs = 16.0; // inbound apply cadence, same budget as a 60 fps frame
+    bool capture = false;
+    std::filesystem::path replay;
+    bool replayRealtime = false;
+    bool replayExit = false; // quit once the replay is done (benchmark runs)
+    std::string netsim;      // NetSim spec, e.g. "latency=80,jitter=20,loss=2,seed=7"
+};
+
+// Dedicated host without a window: runs the flecs world, NetworkManager, signaling and
+// ChatManager off a game table file, with autosave and a line-based admin console on stdin.
+// Images never reach GL (see HeadlessMode.h); boards go out as the raw bytes on disk.
+class HeadlessHost
+{
+public:
+    explicit HeadlessHost(HeadlessHostOptions opts);
+    ~HeadlessHost();
+
+    HeadlessHost(const HeadlessHost&) = delete;
+    HeadlessHost& operator=(const HeadlessHost&) = delete;
+
+    bool start();
+    int run(); // until "quit" or requestStop()
+    void requestStop()
+    {
+        stop_.store(true);
+    }
+
+private:
+    std::filesystem::path resolveGameTablePath() const;
+    void waitForDirectories();
+    void tickAutoSave();
+    bool saveNow();
+
+    void readConsole(); // console thread
+    void drainCommands();
+    void execute(const std::string& line);
+    void printStatus();
+    void printPeers();
+    static void printHelp();
+
+    HeadlessHostOptions opts_;
+    flecs::world ecs_;
+    std::shared_ptr<DirectoryWindow> map_directory_;
+    std::shared_ptr<DirectoryWindow> marker_directory_;
+    std::shared_ptr<GameTableManager> game_table_manager_;
+    std::shared_ptr<ImGuiToaster> toaster_;
+    int logSink_ = 0;
+
+    std::atomic<bool> stop_{false};
+    std::thread consoleThread_;
+    std::mutex cmdMtx_;
+    std::deque<std::string> commands_; // console thread -> host loop
+
+    std::chrono::steady_clock::time_point started_;
+    std::chrono::steady_clock::time_point lastSave_;
+};
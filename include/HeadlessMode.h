@@ -0,0 +1,14 @@
+#pragma once
+
+// Set once by the dedicated host (src/headless/HostMain.cpp) before any manager is built.
+// While on, nothing may touch GL: directory images and network images keep textureID 0 and
+// only carry their size; boards are still sent from the image files on disk.
+namespace HeadlessMode
+{
+    inline bool gEnabled = false;
+
+    inline bool enabled()
+    {
+        return gEnabled;
+    }
+} // namespace HeadlessMode
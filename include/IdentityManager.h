@@ -57,7 +57,15 @@ public:
     // IdentityManager.h
     void erasePeer(const std::string& peerId);
 
+    // off for a replay sandbox: everything stays in memory, the files are never written
+    void setPersistent(bool on)
+    {
+        persistent_ = on;
+    }
+
 private:
+    bool persistent_ = true;
+
     // persisted “me”
     std::string myUniqueId_;
     std::string myUsername_;
@@ -88,6 +88,16 @@ public:
         return getExecutableRoot() / "Config";
     }
 
+    static fs::path getCapturesPath()
+    {
+        return getExecutableRoot() / "Captures";
+    }
+
+    static fs::path getImageCachePath()
+    {
+        return getExecutableRoot() / "Cache" / "Images";
+    }
+
     // --- APP/INSTALLATION-LOCAL FOLDERS ---
     //C:\Dev\RunicVTT\external\node\node.exe .\node_modules\localtunnel\bin\client -p 7778 -s runics
     static fs::path getExternalPath()
@@ -145,6 +155,7 @@ public:
         createIfNotExists(getNotesPath());
         createIfNotExists(getConfigPath());
         createIfNotExists(getGameTablesPath());
+        createIfNotExists(getImageCachePath());
     }
 
     //helpers
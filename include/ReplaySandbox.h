@@ -0,0 +1,36 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include "flecs.h"
+
+class DirectoryWindow;
+class GameTableManager;
+class SessionReplayer;
+
+// A capture replayed into its own flecs world with its own GameTableManager, so the replayed
+// boards, markers and chat never land in the table the user has open. The sandbox decodes and
+// applies exactly like a live session (same shards, same frame budget); it just never connects,
+// watches no folders and writes nothing to disk. UI thread only.
+class ReplaySandbox
+{
+public:
+    ReplaySandbox();
+    ~ReplaySandbox();
+
+    ReplaySandbox(const ReplaySandbox&) = delete;
+    ReplaySandbox& operator=(const ReplaySandbox&) = delete;
+
+    // realtime: spaced out like the original session, otherwise as fast as the shards take it
+    bool start(const std::filesystem::path& file, bool realtime);
+    // once per frame, after the live session's processReceivedMessages
+    void tick();
+
+    const SessionReplayer* replayer() const;
+    size_t entityCount() const; // boards, markers and fog the replay created
+
+private:
+    flecs::world ecs_;
+    std::shared_ptr<DirectoryWindow> map_directory_;
+    std::shared_ptr<DirectoryWindow> marker_directory_;
+    std::shared_ptr<GameTableManager> tables_;
+};
@@ -10,6 +10,7 @@
 #include "DebugConsole.h"
 #include "Logger.h"
 #include "ImGuiToaster.h"
+#include "NetSim.h"
 
 namespace DebugActions
 {
@@ -136,6 +137,110 @@ namespace DebugActions
         }
     }
 
+    // ---------- Debug: Inbound Queue Overlay ---------------------------------------
+    // Lines come from whoever registers it (ApplicationHandler -> GameTableManager stats)
+    inline bool gEnableInboundOverlay = false;
+    inline void InboundOverlayChanged(bool on)
+    {
+        Logger::instance().log("main", std::string("Inbound Queue Overlay ") + (on ? "ENABLED" : "DISABLED"));
+    }
+    inline void InboundOverlayTick(const std::function<std::vector<std::string>()>& lines)
+    {
+        if (!lines)
+            return;
+        ImDrawList* dl = ImGui::GetForegroundDrawList();
+        ImVec2 pos = ImVec2(12, 30); // below the FPS overlay
+        for (const auto& l : lines())
+        {
+            dl->AddText(pos, IM_COL32(180, 255, 180, 220), l.c_str());
+            pos.y += ImGui::GetTextLineHeight();
+        }
+    }
+
+    // ---------- Debug: Inbound Session Capture / Replay ---------------------------
+    // Handlers come from whoever registers them (ApplicationHandler -> NetworkManager)
+    inline bool gEnableSessionCapture = false;
+    inline bool gEnableSessionReplay = false;
+    inline bool gReplayOriginalTiming = false; // read when a replay starts
+
+    // ---------- Debug: Network Condition Simulator ---------------------------------
+    // Edits a copy of NetSim's config; Apply (or the toggle) pushes it and reseeds.
+    inline bool gEnableNetSim = false;
+    inline constexpr uint32_t kNetSimZero = 0;
+    inline constexpr uint32_t kNetSimMaxMs = 2000;
+    inline NetSim::Config gNetSimDraft = NetSim::instance().config();
+    inline char gNetSimSpec[256] = "";
+    inline std::string gNetSimError;
+
+    inline void NetSimChanged(bool on)
+    {
+        gNetSimDraft.enabled = on;
+        NetSim::instance().configure(gNetSimDraft);
+        Logger::instance().log("main", std::string("Network Simulator ") + (on ? "ENABLED" : "DISABLED"));
+    }
+
+    inline void NetSimTick()
+    {
+        ImGui::SetNextWindowSize(ImVec2(460, 0), ImGuiCond_FirstUseEver);
+        if (!ImGui::Begin("Network Simulator"))
+        {
+            ImGui::End();
+            return;
+        }
+
+        int seed = static_cast<int>(gNetSimDraft.seed);
+        if (ImGui::InputInt("Seed", &seed))
+            gNetSimDraft.seed = static_cast<uint64_t>(std::max(seed, 0));
+        ImGui::Checkbox("Outbound", &gNetSimDraft.outbound);
+        ImGui::SameLine();
+        ImGui::Checkbox("Inbound", &gNetSimDraft.inbound);
+
+        for (size_t c = 0; c < NetSim::kChannels; ++c)
+        {
+            auto& p = gNetSimDraft.channels[c];
+            if (!ImGui::CollapsingHeader(NetSim::channelName(c)))
+                continue;
+            ImGui::PushID(static_cast<int>(c));
+            ImGui::SliderScalar("Latency ms", ImGuiDataType_U32, &p.latencyMs, &kNetSimZero, &kNetSimMaxMs);
+            ImGui::SliderScalar("Jitter ms", ImGuiDataType_U32, &p.jitterMs, &kNetSimZero, &kNetSimMaxMs);
+            ImGui::InputScalar("Cap kbps (0 = none)", ImGuiDataType_U32, &p.kbps);
+            if (NetSim::reliable(static_cast<msg::dc::Channel>(c)))
+            {
+                ImGui::TextDisabled("reliable: no loss or reordering");
+            }
+            else
+            {
+                ImGui::SliderFloat("Loss %", &p.lossPct, 0.0f, 100.0f, "%.1f");
+                ImGui::SliderFloat("Reorder %", &p.reorderPct, 0.0f, 100.0f, "%.1f");
+            }
+            ImGui::PopID();
+        }
+
+        ImGui::InputText("Spec", gNetSimSpec, sizeof(gNetSimSpec));
+        ImGui::SameLine();
+        if (ImGui::Button("Parse"))
+        {
+            gNetSimError.clear();
+            NetSim::parseSpec(gNetSimSpec, gNetSimDraft, &gNetSimError);
+        }
+        if (!gNetSimError.empty())
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", gNetSimError.c_str());
+
+        if (ImGui::Button("Apply"))
+        {
+            gNetSimDraft.enabled = true;
+            NetSim::instance().configure(gNetSimDraft);
+        }
+
+        const auto st = NetSim::instance().stats();
+        ImGui::Separator();
+        ImGui::Text("delayed %llu | lost %llu | expired %llu | reordered %llu", static_cast<unsigned long long>(st.delayed),
+                    static_cast<unsigned long long>(st.lost), static_cast<unsigned long long>(st.expired),
+                    static_cast<unsigned long long>(st.reordered));
+        ImGui::Text("held %zu messages, %zu bytes", st.pending, st.pendingBytes);
+        ImGui::End();
+    }
+
     // ---------- Registration helpers ----------------------------------------------
     inline void RegisterToasterToggles(std::weak_ptr<ImGuiToaster> toaster_)
     {
@@ -151,6 +256,49 @@ namespace DebugActions
         });
     }
 
+    inline void RegisterInboundOverlayToggle(std::function<std::vector<std::string>()> linesProvider)
+    {
+        DebugConsole::addToggle({
+            "Inbound Queue Overlay",
+            &gEnableInboundOverlay,
+            InboundOverlayChanged,
+            [lines = std::move(linesProvider)]()
+            { InboundOverlayTick(lines); },
+        });
+    }
+
+    inline void RegisterSessionCaptureToggles(std::function<void(bool)> onCapture, std::function<void(bool)> onReplay)
+    {
+        DebugConsole::addToggle({
+            "Capture Inbound Session",
+            &gEnableSessionCapture,
+            [cb = std::move(onCapture)](bool on)
+            {
+                Logger::instance().log("main", std::string("Session Capture ") + (on ? "ENABLED" : "DISABLED"));
+                if (cb)
+                    cb(on);
+            },
+            nullptr,
+        });
+        DebugConsole::addToggle({
+            "Replay Latest Capture",
+            &gEnableSessionReplay,
+            [cb = std::move(onReplay)](bool on)
+            {
+                Logger::instance().log("main", std::string("Session Replay ") + (on ? "ENABLED" : "DISABLED"));
+                if (cb)
+                    cb(on);
+            },
+            nullptr,
+        });
+        DebugConsole::addToggle({
+            "Replay At Original Timing",
+            &gReplayOriginalTiming,
+            nullptr,
+            nullptr,
+        });
+    }
+
     inline void RegisterAllDefaultToggles()
     {
         // Helper shim to avoid direct include dependency in this header:
@@ -170,6 +318,8 @@ namespace DebugActions
         add("FPS Overlay", &gEnableFpsOverlay, FpsOverlayChanged, FpsOverlayTick);
 
         add("Network Ping Log", &gEnablePingLog, PingLogChanged, PingLogTick);
+
+        add("Network Simulator", &gEnableNetSim, NetSimChanged, NetSimTick);
     }
 
 } // namespace DebugActions
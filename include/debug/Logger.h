@@ -10,7 +10,11 @@
 #include <memory>
 #include <ostream>
 #include <chrono>
+#include <ctime>
 #include <cctype>
+#include <cstring>
+#include <iostream>
+#include <optional>
 
 class Logger
 {
@@ -131,6 +135,18 @@ public:
         coutRedirect_.reset();
     }
 
+    // Thread-safe localtime on both CRTs (localtime_s and localtime_r take their arguments swapped)
+    static std::tm localTime(std::time_t t)
+    {
+        std::tm bt{};
+#if defined(_WIN32)
+        localtime_s(&bt, &t);
+#else
+        localtime_r(&t, &bt);
+#endif
+        return bt;
+    }
+
     // Helper to format ts once in UI (called from DebugConsole)
     static std::string formatTs(uint64_t ms)
     {
@@ -138,12 +154,7 @@ public:
         auto tp = time_point<system_clock, milliseconds>(milliseconds(ms));
         auto t = system_clock::to_time_t(tp);
         auto ms_part = (int)(ms % 1000);
-        struct tm bt;
-#if defined(_WIN32)
-        localtime_s(&bt, &t);
-#else
-        localtime_r(&t, &bt);
-#endif
+        const std::tm bt = localTime(t);
         char buf[32];
         std::snprintf(buf, sizeof(buf), "%02d:%02d:%02d.%03d", bt.tm_hour, bt.tm_min, bt.tm_sec, ms_part);
         return std::string(buf);
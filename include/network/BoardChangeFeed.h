@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "flecs.h"
+
+// The one set of flecs observers behind everything that follows board edits (EntityDeltaTracker,
+// BoardVersions, BoardStateHash). Each event reaches the listeners in the order they subscribed.
+// A drag writes Position through a reference; the drag's end calls modified<Moving>(), which
+// arrives here as Moving and stands in for the position. UI thread only.
+class BoardChangeFeed
+{
+public:
+    enum Change : uint8_t
+    {
+        ChangePosition = 1 << 0,
+        ChangeSize = 1 << 1,
+        ChangeVisibility = 1 << 2,
+        ChangeGrid = 1 << 3,
+        ChangeMarker = 1 << 4, // MarkerComponent
+        ChangeBoard = 1 << 5,
+        ChangeMoving = 1 << 6
+    };
+
+    struct Listener
+    {
+        virtual ~Listener() = default;
+        virtual void onSet(flecs::entity e, uint8_t change) = 0;
+        virtual void onIdentified(flecs::entity) {} // got its Identifier (boards/markers/fog get it first)
+        virtual void onParented(flecs::entity) {}   // got a ChildOf pair (markers/fog get it last)
+        virtual void onRemoved(flecs::entity) {}    // losing its Identifier
+    };
+
+    explicit BoardChangeFeed(flecs::world ecs);
+    ~BoardChangeFeed();
+
+    BoardChangeFeed(const BoardChangeFeed&) = delete;
+    BoardChangeFeed& operator=(const BoardChangeFeed&) = delete;
+
+    void subscribe(Listener* l)
+    {
+        listeners_.push_back(l);
+    }
+    void unsubscribe(Listener* l)
+    {
+        listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), l), listeners_.end());
+    }
+
+private:
+    void set(flecs::entity e, uint8_t change);
+
+    flecs::world ecs_;
+    std::vector<flecs::observer> observers_;
+    std::vector<Listener*> listeners_;
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "flecs.h"
+#include "BoardChangeFeed.h"
+
+// GM side: each board carries a version that goes up with every change to the board or its
+// markers/fog. Entities remember the version they were created, last changed and last revealed
+// at, and deletions leave a tombstone. A player that reconnects with the last version it saw
+// (DCType::ResyncRequest) only gets what moved on since, see NetworkManager::sendBoardResync.
+// Fed by the BoardChangeFeed; unlike EntityDeltaTracker this sees remote writes too. UI thread only.
+class BoardVersions : private BoardChangeFeed::Listener
+{
+public:
+    static constexpr size_t kMaxTombstones = 4096; // older deletes force a full snapshot
+
+    BoardVersions(flecs::world ecs, BoardChangeFeed& feed);
+    ~BoardVersions() override;
+
+    BoardVersions(const BoardVersions&) = delete;
+    BoardVersions& operator=(const BoardVersions&) = delete;
+
+    // Versions only compare within one history; a restarted GM starts a new one.
+    uint64_t historyId() const
+    {
+        return historyId_;
+    }
+    uint64_t version(uint64_t boardId) const;
+
+    struct Changes
+    {
+        bool boardChanged = false;
+        std::vector<uint64_t> created;  // markers/fog the peer has never seen
+        std::vector<uint64_t> revealed; // markers made visible since (the peer may only have a stub)
+        std::vector<uint64_t> changed;  // everything else that changed
+        std::vector<std::pair<uint64_t, bool /*fog*/>> deleted;
+    };
+    // False when the peer's version is from another history or older than the kept tombstones.
+    bool since(uint64_t boardId, uint64_t fromHistory, uint64_t fromVersion, Changes& out) const;
+
+private:
+    struct EntityVersion
+    {
+        uint64_t created = 0;
+        uint64_t changed = 0;
+        uint64_t revealed = 0;
+        bool fog = false;
+    };
+    struct Tombstone
+    {
+        uint64_t version = 0;
+        uint64_t id = 0;
+        bool fog = false;
+    };
+    struct BoardLog
+    {
+        uint64_t version = 0;
+        uint64_t floor = 0; // newest version whose tombstone was dropped
+        std::unordered_map<uint64_t, EntityVersion> entities;
+        std::deque<Tombstone> tombstones;
+    };
+    struct Owner
+    {
+        uint64_t boardId = 0;
+        uint64_t id = 0;
+    };
+
+    void onSet(flecs::entity e, uint8_t change) override;
+    void onParented(flecs::entity e) override;
+    void onRemoved(flecs::entity e) override;
+    void bump(flecs::entity e, bool revealed = false);
+
+    flecs::world ecs_;
+    BoardChangeFeed& feed_;
+    std::unordered_map<uint64_t, BoardLog> boards_;
+    std::unordered_map<flecs::entity_t, Owner> owners_; // tracked entities; OnRemove can't rely on ChildOf
+    uint64_t historyId_ = 0;
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Recycled byte vectors for the network path: outbound build*Frame buffers and inbound
+// InboundRaw payloads. acquire() hands out a cleared vector that keeps its old capacity,
+// release() puts it back. Every pooled buffer is one kBlockSize block, so a frame built with
+// push_back fits without regrowing; bigger (image-sized) buffers are not hoarded.
+class BufferPool
+{
+public:
+    static BufferPool& instance()
+    {
+        static BufferPool pool;
+        return pool;
+    }
+
+    std::vector<uint8_t> acquire(size_t reserve = kBlockSize)
+    {
+        acquires_.fetch_add(1, std::memory_order_relaxed);
+        std::vector<uint8_t> v;
+        if (reserve > kBlockSize)
+        {
+            v.reserve(reserve); // counted in release(), like a block that outgrew itself
+            return v;
+        }
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (!free_.empty())
+            {
+                v = std::move(free_.back());
+                free_.pop_back();
+            }
+        }
+        if (v.capacity() < kBlockSize)
+        {
+            heapAllocs_.fetch_add(1, std::memory_order_relaxed);
+            v.reserve(kBlockSize);
+        }
+        return v;
+    }
+
+    void release(std::vector<uint8_t>&& v)
+    {
+        if (v.capacity() > kBlockSize)
+        {
+            // grew past its block (push_back regrowth) or was reserved big: both hit the heap
+            heapAllocs_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (v.capacity() < kBlockSize)
+            return;
+        v.clear();
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (free_.size() < kMaxPooled)
+            free_.push_back(std::move(v));
+    }
+
+    // Call once per frame; rates are refreshed about once a second.
+    // acquires/s is what the old path allocated (one vector per frame/message),
+    // heapAllocs/s is what still reaches the allocator with the pool.
+    void sampleRates()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const double dt = std::chrono::duration<double>(now - lastSample_).count();
+        if (dt < 1.0)
+            return;
+        const uint64_t a = acquires_.load(std::memory_order_relaxed);
+        const uint64_t h = heapAllocs_.load(std::memory_order_relaxed);
+        acquiresPerSec_ = static_cast<double>(a - lastAcquires_) / dt;
+        heapAllocsPerSec_ = static_cast<double>(h - lastHeapAllocs_) / dt;
+        lastAcquires_ = a;
+        lastHeapAllocs_ = h;
+        lastSample_ = now;
+    }
+    double acquiresPerSec() const
+    {
+        return acquiresPerSec_;
+    }
+    double heapAllocsPerSec() const
+    {
+        return heapAllocsPerSec_;
+    }
+    size_t pooled() const
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return free_.size();
+    }
+
+private:
+    BufferPool() = default;
+
+    static constexpr size_t kBlockSize = 16 * 1024; // any control frame, and an 8KB image chunk with its header
+    static constexpr size_t kMaxPooled = 512;       // buffers kept around, 8 MB at most
+
+    mutable std::mutex mtx_;
+    std::vector<std::vector<uint8_t>> free_;
+
+    std::atomic<uint64_t> acquires_{0};
+    std::atomic<uint64_t> heapAllocs_{0};
+
+    // sampled on the UI thread only
+    std::chrono::steady_clock::time_point lastSample_ = std::chrono::steady_clock::now();
+    uint64_t lastAcquires_ = 0;
+    uint64_t lastHeapAllocs_ = 0;
+    double acquiresPerSec_ = 0.0;
+    double heapAllocsPerSec_ = 0.0;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "flecs.h"
+#include "Components.h"
+
+// Column-wise staging for creating many markers or fog at once (board loads, snapshot commits).
+// A chain of .set() moves a fresh entity through one archetype table per component; ecs_bulk_init
+// appends every row straight into the final table and moves the columns in. The ChildOf pair is
+// still added per entity afterwards: BoardVersions and BoardStateHash (through the BoardChangeFeed)
+// start counting an entity when it gets its parent and read its Identifier then, while a bulk
+// insert fires OnAdd before the data lands.
+struct MarkerRows
+{
+    std::vector<Identifier> ids;
+    std::vector<Position> positions;
+    std::vector<Size> sizes;
+    std::vector<TextureComponent> textures;
+    std::vector<Visibility> visibility;
+    std::vector<MarkerComponent> markers;
+    std::vector<Moving> moving;
+
+    void reserve(size_t n);
+    void push(Identifier id, Position pos, Size size, TextureComponent texture, Visibility vis, MarkerComponent marker, Moving mov);
+    size_t size() const
+    {
+        return ids.size();
+    }
+};
+
+struct FogRows
+{
+    std::vector<Identifier> ids;
+    std::vector<Position> positions;
+    std::vector<Size> sizes;
+    std::vector<Visibility> visibility;
+
+    void reserve(size_t n);
+    void push(Identifier id, Position pos, Size size, Visibility vis);
+    size_t size() const
+    {
+        return ids.size();
+    }
+};
+
+namespace EntityBulk
+{
+    // Rows are moved out and left empty. Entities come back in row order, parented to
+    // `parent` when it is valid. UI thread only, not inside a deferred block.
+    std::vector<flecs::entity> spawnMarkers(flecs::world& ecs, MarkerRows& rows, flecs::entity parent);
+    std::vector<flecs::entity> spawnFog(flecs::world& ecs, FogRows& rows, flecs::entity parent);
+} // namespace EntityBulk
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "flecs.h"
+#include "BoardChangeFeed.h"
+
+// Records which replicated fields (msg::DeltaField) of which entities changed since the last
+// take(), from the BoardChangeFeed's Position, Size, Visibility, Grid and MarkerComponent sets.
+// Edits made through get_mut/each have to call entity.modified<T>() to be seen.
+// UI thread only, like every other ECS write.
+class EntityDeltaTracker : private BoardChangeFeed::Listener
+{
+public:
+    EntityDeltaTracker(flecs::world ecs, BoardChangeFeed& feed);
+    ~EntityDeltaTracker() override;
+
+    EntityDeltaTracker(const EntityDeltaTracker&) = delete;
+    EntityDeltaTracker& operator=(const EntityDeltaTracker&) = delete;
+
+    // Writes that came from the network (or are otherwise already replicated) aren't recorded.
+    class Suppress
+    {
+    public:
+        explicit Suppress(EntityDeltaTracker& t) :
+            t_(t)
+        {
+            ++t_.suppress_;
+        }
+        ~Suppress()
+        {
+            --t_.suppress_;
+        }
+        Suppress(const Suppress&) = delete;
+        Suppress& operator=(const Suppress&) = delete;
+
+    private:
+        EntityDeltaTracker& t_;
+    };
+
+    struct Dirty
+    {
+        flecs::entity entity;
+        uint8_t mask = 0;
+    };
+
+    // Dirty entities in first-touched order. Entities that got their Identifier since the last
+    // call are left out: their create message already carries the current state.
+    std::vector<Dirty> take();
+
+    size_t pending() const
+    {
+        return order_.size();
+    }
+
+private:
+    void onSet(flecs::entity e, uint8_t change) override;
+    void onIdentified(flecs::entity e) override;
+    void mark(flecs::entity e, uint8_t field);
+
+    flecs::world ecs_;
+    BoardChangeFeed& feed_;
+    std::unordered_map<flecs::entity_t, uint8_t> dirty_;
+    std::vector<flecs::entity_t> order_;
+    std::unordered_set<flecs::entity_t> born_;
+    int suppress_ = 0;
+};
@@ -0,0 +1,118 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Native network discovery for hosting: interface enumeration, SSDP/IGD gateway lookup and
+// UPnP port mapping over plain sockets (no PowerShell, no upnpc.exe).
+
+namespace netif
+{
+    struct Interface
+    {
+        std::string name;
+        std::string ipv4;
+        bool loopback = false;
+    };
+
+    std::vector<Interface> enumerateIPv4(); // up interfaces with an IPv4 address
+
+    // local address the OS routes `toward` through; no packet is sent. "" when there is no route
+    std::string routeIPv4(const std::string& toward);
+
+    // RFC 1918, loopback and link-local: peers we can reach without STUN
+    bool isPrivateIPv4(const std::string& ip);
+
+    // route to the Internet if there is one, else the first private non-loopback interface
+    std::string primaryIPv4();
+} // namespace netif
+
+namespace igd
+{
+    struct Options
+    {
+        std::string ssdpAddress = "239.255.255.250"; // point at a local responder to test
+        unsigned short ssdpPort = 1900;
+        int timeoutMs = 2000;
+    };
+
+    struct Gateway
+    {
+        std::string host;
+        unsigned short port = 0;
+        std::string controlPath; // WAN*Connection control URL path
+        std::string serviceType; // urn:schemas-upnp-org:service:WANIPConnection:1 (or PPP)
+        std::string localIp;     // our address on the gateway's LAN
+        bool valid() const
+        {
+            return !controlPath.empty();
+        }
+    };
+
+    // blocking, up to about 2 x timeoutMs
+    Gateway discover(const Options& opts);
+
+    bool addPortMapping(const Gateway& gw, const std::string& internalIp, unsigned short internalPort,
+                        unsigned short externalPort, const std::string& protocol, const std::string& description,
+                        unsigned int leaseSec, std::string* error = nullptr, int timeoutMs = 3000);
+    bool deletePortMapping(const Gateway& gw, unsigned short externalPort, const std::string& protocol,
+                           int timeoutMs = 3000);
+    std::string externalIPAddress(const Gateway& gw, int timeoutMs = 3000);
+} // namespace igd
+
+// Looks up the local address, the public address and the IGD gateway concurrently on background
+// threads and caches the answers, so the host popup and the Network Center only ever read them.
+// Workers share the state through a shared_ptr and are detached: a slow HTTP lookup never holds
+// up shutdown.
+class HostDiscovery
+{
+public:
+    enum class State
+    {
+        Idle,
+        Pending,
+        Ready,
+        Failed
+    };
+
+    using ExternalLookup = std::function<std::string()>; // fallback when the gateway can't tell
+    using DoneFn = std::function<void(bool ok, const std::string& detail)>;
+
+    explicit HostDiscovery(igd::Options opts = {}, ExternalLookup externalFallback = {});
+
+    void start();   // idempotent
+    void refresh(); // forget cached answers and look again
+
+    // never block; "" while pending or failed
+    std::string localIPv4() const;
+    std::string externalIPv4() const;
+    State gatewayState() const;
+    std::string gatewayDescription() const; // "192.168.0.1:5000 WANIPConnection:1"
+
+    // waits for discovery on a worker; onDone runs there too
+    void addPortMappingAsync(unsigned short port, const std::string& protocol, const std::string& description, DoneFn onDone);
+    void removePortMappingAsync(unsigned short port, const std::string& protocol, DoneFn onDone = {});
+
+private:
+    struct Shared
+    {
+        mutable std::mutex mtx;
+        std::condition_variable cv;
+        uint64_t generation = 0; // bumped by refresh, stale workers drop their answer
+        std::string localIp;
+        State localState = State::Idle;
+        std::string externalIp;
+        State externalState = State::Idle;
+        igd::Gateway gateway;
+        State gatewayState = State::Idle;
+    };
+
+    static igd::Gateway waitGateway(const std::shared_ptr<Shared>& s, int timeoutMs);
+
+    igd::Options opts_;
+    ExternalLookup externalFallback_;
+    std::shared_ptr<Shared> shared_ = std::make_shared<Shared>();
+};
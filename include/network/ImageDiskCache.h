@@ -0,0 +1,98 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Sha256.h"
+
+// Player side: every image received from the GM is kept on disk as <sha256>.img, so a player
+// rejoining a table it has seen sends the GM its inventory (DCType::CacheInventory) and gets
+// DCType::ImageCachedByHash instead of the chunks. Bounded by bytes, least recently used goes
+// first; recency survives restarts through the files' write times.
+class ImageDiskCache
+{
+public:
+    static constexpr uint64_t kDefaultCapacity = 2ull * 1024 * 1024 * 1024;
+    static constexpr uint64_t kMaxEntryBytes = 256ull * 1024 * 1024;
+    static constexpr uint64_t kMaxPendingBytes = 512ull * 1024 * 1024; // queued writes past this are dropped
+
+    explicit ImageDiskCache(std::filesystem::path dir, uint64_t capacityBytes = kDefaultCapacity);
+    ~ImageDiskCache();
+
+    // Copies the bytes; hashing, writing and eviction happen on the cache's own thread.
+    void store(const uint8_t* data, size_t len);
+    // Same without the copy: `data` (a heap buffer or a mapped spool file) is kept alive until written.
+    void store(std::shared_ptr<const uint8_t> data, size_t len);
+
+    // Empty on a miss, a size mismatch or a file that no longer hashes to its name.
+    std::vector<uint8_t> load(const Sha256::Digest& hash, uint64_t expectedSize);
+    // load() on the cache's thread, ahead of queued writes; `done` runs there too. Dropped unrun
+    // when the cache shuts down first.
+    using LoadDone = std::function<void(std::vector<uint8_t>)>;
+    void loadAsync(const Sha256::Digest& hash, uint64_t expectedSize, LoadDone done);
+
+    // Most recently used first.
+    std::vector<Sha256::Digest> inventory(size_t max) const;
+
+    struct Stats
+    {
+        size_t entries = 0;
+        uint64_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t droppedWrites = 0; // queue was over kMaxPendingBytes
+    };
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        Sha256::Digest hash{};
+        uint64_t size = 0;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    std::filesystem::path pathFor(const std::string& hex) const;
+
+    void scan();
+    void workerLoop();
+    void insertLocked(const std::string& hex, const Sha256::Digest& hash, uint64_t size);
+    void dropLocked(std::string hex); // by value: callers pass lru_.back()
+
+    const std::filesystem::path dir_;
+    const uint64_t capacity_;
+
+    mutable std::mutex mtx_;
+    std::unordered_map<std::string, Entry> entries_; // hex hash -> entry
+    std::list<std::string> lru_;                     // front = most recently used
+    uint64_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t droppedWrites_ = 0;
+
+    std::condition_variable cv_;
+    struct WriteJob
+    {
+        std::shared_ptr<const uint8_t> data;
+        size_t size = 0;
+    };
+    struct LoadJob
+    {
+        Sha256::Digest hash{};
+        uint64_t size = 0;
+        LoadDone done;
+    };
+    std::deque<WriteJob> pending_;
+    uint64_t pendingBytes_ = 0;
+    std::deque<LoadJob> loads_;
+    bool stop_ = false;
+    std::thread worker_;
+};
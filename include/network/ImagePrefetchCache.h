@@ -0,0 +1,208 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Message.h"
+
+// Player side of the board prefetch: encoded images of boards/markers the GM streamed ahead
+// of time (DCType::ImagePrefetchChunk), kept until the GM switches to them and sends
+// DCType::ImageCached instead of the chunks. Bounded by bytes, least recently used goes first;
+// an evicted image just costs a normal transfer (ImageRequest) on the switch.
+class ImagePrefetchCache
+{
+public:
+    using Bytes = std::shared_ptr<const std::vector<uint8_t>>;
+
+    explicit ImagePrefetchCache(uint64_t capacityBytes = kDefaultCapacity) :
+        capacity_(capacityBytes) {}
+
+    // False when the chunk doesn't fit the announced total (or the image is too big to keep).
+    // Partial images count against the byte budget too. Resent or overlapping chunks only count
+    // the bytes they add; the image is done once every byte of it has arrived.
+    bool addChunk(msg::ImageOwnerKind kind, uint64_t id, uint64_t total, uint64_t offset, const uint8_t* data, size_t len)
+    {
+        if (total == 0 || total > capacity_ / 2 || offset > total || len > total - offset)
+            return false;
+        if (len == 0)
+            return true;
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto it = assembling_.find(id);
+        if (it != assembling_.end() && (it->second.total != total || it->second.kind != kind))
+        {
+            dropAssemblyLocked(it);
+            it = assembling_.end();
+        }
+        if (it == assembling_.end())
+        {
+            bytes_ += total; // reserved up front: the buffer is allocated at full size
+            evictLocked(id);
+            if (bytes_ > capacity_)
+            {
+                bytes_ -= total;
+                return false;
+            }
+            assemblyOrder_.push_back(id);
+            it = assembling_.emplace(id, Assembly{}).first;
+            it->second.kind = kind;
+            it->second.total = total;
+            it->second.bytes.resize(static_cast<size_t>(total));
+            it->second.orderPos = std::prev(assemblyOrder_.end());
+        }
+        auto& a = it->second;
+        const uint64_t added = coverLocked(a.ranges, offset, offset + len);
+        if (added == 0)
+            return true; // resent chunk, already counted
+        std::memcpy(a.bytes.data() + offset, data, len);
+        a.received += added;
+        if (a.received < total)
+            return true;
+
+        auto bytes = std::make_shared<const std::vector<uint8_t>>(std::move(a.bytes));
+        dropAssemblyLocked(it);
+        insertLocked(kind, id, std::move(bytes));
+        return true;
+    }
+
+    // An image that was announced as prefetched but had to be transferred anyway (evicted, or
+    // the chunks never all arrived), or a swarm image this player keeps seeding pieces of.
+    // Shares the caller's buffer.
+    void put(msg::ImageOwnerKind kind, uint64_t id, Bytes bytes)
+    {
+        if (!bytes || bytes->empty() || bytes->size() > capacity_ / 2)
+            return;
+        std::lock_guard<std::mutex> lk(mtx_);
+        insertLocked(kind, id, std::move(bytes));
+    }
+
+    // Marks the entry as recently used; null when missing or of another size.
+    Bytes find(msg::ImageOwnerKind kind, uint64_t id, uint64_t expectedSize)
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto it = entries_.find(id);
+        if (it == entries_.end() || it->second.kind != kind || it->second.bytes->size() != expectedSize)
+        {
+            ++misses_;
+            return nullptr;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+        ++hits_;
+        return it->second.bytes;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        entries_.clear();
+        lru_.clear();
+        assembling_.clear();
+        assemblyOrder_.clear();
+        bytes_ = 0;
+    }
+
+    struct Stats
+    {
+        size_t entries = 0;
+        size_t assembling = 0;
+        uint64_t bytes = 0; // finished entries and partial images together
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+    Stats stats() const
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return Stats{entries_.size(), assembling_.size(), bytes_, hits_, misses_};
+    }
+
+    static constexpr uint64_t kDefaultCapacity = 192ull * 1024 * 1024;
+
+private:
+    struct Entry
+    {
+        msg::ImageOwnerKind kind{};
+        Bytes bytes;
+        std::list<uint64_t>::iterator lruPos;
+    };
+    struct Assembly
+    {
+        msg::ImageOwnerKind kind{};
+        std::vector<uint8_t> bytes;
+        uint64_t total = 0; // what bytes_ holds for it, also after the buffer moved on
+        uint64_t received = 0;
+        std::map<uint64_t, uint64_t> ranges; // begin -> end of what arrived, disjoint and merged
+        std::list<uint64_t>::iterator orderPos;
+    };
+
+    // Adds [begin, end) to the ranges, returns how many of its bytes weren't there yet.
+    static uint64_t coverLocked(std::map<uint64_t, uint64_t>& ranges, uint64_t begin, uint64_t end)
+    {
+        uint64_t held = 0;
+        uint64_t lo = begin, hi = end;
+        auto it = ranges.upper_bound(begin);
+        if (it != ranges.begin() && std::prev(it)->second >= begin)
+            --it;
+        // every range met here overlaps or touches [begin, end)
+        for (; it != ranges.end() && it->first <= end; it = ranges.erase(it))
+        {
+            held += std::min(it->second, end) - std::max(it->first, begin);
+            lo = std::min(lo, it->first);
+            hi = std::max(hi, it->second);
+        }
+        ranges.emplace(lo, hi);
+        return (end - begin) - held;
+    }
+
+    void dropAssemblyLocked(std::unordered_map<uint64_t, Assembly>::iterator it)
+    {
+        bytes_ -= it->second.total;
+        assemblyOrder_.erase(it->second.orderPos);
+        assembling_.erase(it);
+    }
+
+    // Least recently used entries go first, then the oldest partial images; `keep` is spared.
+    void evictLocked(uint64_t keep)
+    {
+        while (bytes_ > capacity_ && !lru_.empty() && lru_.back() != keep)
+        {
+            auto victim = entries_.find(lru_.back());
+            bytes_ -= victim->second.bytes->size();
+            entries_.erase(victim);
+            lru_.pop_back();
+        }
+        for (auto o = assemblyOrder_.begin(); bytes_ > capacity_ && o != assemblyOrder_.end();)
+        {
+            const uint64_t victim = *o++;
+            if (victim != keep)
+                dropAssemblyLocked(assembling_.find(victim));
+        }
+    }
+
+    void insertLocked(msg::ImageOwnerKind kind, uint64_t id, Bytes bytes)
+    {
+        if (auto old = entries_.find(id); old != entries_.end())
+        {
+            bytes_ -= old->second.bytes->size();
+            lru_.erase(old->second.lruPos);
+            entries_.erase(old);
+        }
+        bytes_ += bytes->size();
+        lru_.push_front(id);
+        entries_[id] = Entry{kind, std::move(bytes), lru_.begin()};
+        evictLocked(id);
+    }
+
+    const uint64_t capacity_;
+    mutable std::mutex mtx_;
+    std::unordered_map<uint64_t, Entry> entries_;
+    std::list<uint64_t> lru_; // front = most recently used
+    std::unordered_map<uint64_t, Assembly> assembling_;
+    std::list<uint64_t> assemblyOrder_; // front = oldest
+    uint64_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// Backing storage for one in-flight image transfer.
+// Small transfers live in a plain heap buffer; big ones (or when the global budget is
+// exhausted) go to a delete-on-close temp file mapped into memory, so the OS can page
+// it out instead of the player's whole process. Spilled files count against a process-wide
+// disk budget until they are unmapped, including after shareMapped() handed them on.
+class ImageSpool
+{
+public:
+    static constexpr uint64_t kSpillBudget = 2048ull * 1024 * 1024; // all temp files together
+
+    ImageSpool() = default;
+    ~ImageSpool()
+    {
+        reset();
+    }
+
+    ImageSpool(const ImageSpool&) = delete;
+    ImageSpool& operator=(const ImageSpool&) = delete;
+
+    ImageSpool(ImageSpool&& o) noexcept
+    {
+        *this = std::move(o);
+    }
+    ImageSpool& operator=(ImageSpool&& o) noexcept;
+
+    bool allocateInMemory(size_t total);
+    bool allocateOnDisk(size_t total); // false when the temp file fails or the spill budget is spent
+
+    bool write(uint64_t offset, const uint8_t* src, size_t len)
+    {
+        if (offset + len > size_)
+            return false;
+        std::memcpy(data() + offset, src, len);
+        return true;
+    }
+
+    // Heap transfers: hands the vector over (what ReadyMessage::bytes expects).
+    std::vector<uint8_t> takeBytes();
+    // Spilled transfers: the mapped view itself, the file stays mapped until the last owner
+    // lets go; nothing is copied back onto the heap. Leaves this spool empty.
+    std::shared_ptr<const uint8_t> shareMapped();
+
+    void reset();
+
+    uint8_t* data()
+    {
+        return isSpilled() ? view_ : mem_.data();
+    }
+    size_t size() const
+    {
+        return size_;
+    }
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+    bool isSpilled() const
+    {
+        return view_ != nullptr;
+    }
+
+    static uint64_t spilledBytes()
+    {
+        return spilled_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<uint8_t> mem_;
+    intptr_t file_ = -1;       // HANDLE on Windows, fd elsewhere
+    void* mapping_ = nullptr;  // Windows file mapping object
+    uint8_t* view_ = nullptr;
+    size_t size_ = 0;
+    bool onDisk_ = false; // charged against kSpillBudget
+
+    static inline std::atomic<uint64_t> spilled_{0};
+};
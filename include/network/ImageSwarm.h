@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Sha256.h"
+
+// Swarm image distribution: instead of uploading an image to every player, the GM sends each
+// player a manifest (content hash, per-piece hashes, who seeds what) and uploads piece i only to
+// seeders[i % n]. Players fetch the other pieces from each other over their own PeerLinks
+// (DCType::PieceRequest / ImagePiece) and fall back to the GM when a seeder stalls.
+struct ImageManifest
+{
+    using PieceHash = std::array<uint8_t, 16>; // truncated SHA-256
+
+    static constexpr uint32_t kPieceSize = 64 * 1024;
+
+    uint64_t total = 0;
+    uint32_t pieceSize = kPieceSize;
+    Sha256::Digest contentHash{};
+    std::vector<PieceHash> pieceHashes;
+    std::vector<std::string> seeders; // peer ids; piece i goes to seeders[i % seeders.size()]
+
+    uint32_t pieceCount() const
+    {
+        return static_cast<uint32_t>(pieceHashes.size());
+    }
+    uint64_t pieceOffset(uint32_t i) const
+    {
+        return uint64_t(i) * pieceSize;
+    }
+    size_t pieceLen(uint32_t i) const
+    {
+        return static_cast<size_t>(std::min<uint64_t>(pieceSize, total - pieceOffset(i)));
+    }
+    const std::string& seederOf(uint32_t i) const
+    {
+        return seeders[i % seeders.size()];
+    }
+
+    static PieceHash hashPiece(const uint8_t* data, size_t len)
+    {
+        const auto full = Sha256::of(data, len);
+        PieceHash h;
+        std::memcpy(h.data(), full.data(), h.size());
+        return h;
+    }
+
+    static ImageManifest build(const uint8_t* data, size_t size, std::vector<std::string> seeders)
+    {
+        ImageManifest m;
+        m.total = size;
+        m.seeders = std::move(seeders);
+        m.pieceHashes.reserve(static_cast<size_t>((size + m.pieceSize - 1) / m.pieceSize));
+        for (uint64_t off = 0; off < size; off += m.pieceSize)
+        {
+            const size_t len = static_cast<size_t>(std::min<uint64_t>(m.pieceSize, size - off));
+            m.pieceHashes.push_back(hashPiece(data + off, len));
+        }
+        m.contentHash = Sha256::of(data, size);
+        return m;
+    }
+};
+
+// Receiver side of one swarmed image, kept on its PendingImage.
+struct SwarmRx
+{
+    ImageManifest manifest;
+    std::string gmPeerId;  // sent the manifest; serves whatever the seeders don't
+    std::vector<bool> have;
+    uint32_t haveCount = 0;
+    bool verified = false; // every piece in and the content hash matched
+    uint64_t lastProgressMs = 0;
+    uint64_t lastFallbackMs = 0;
+    std::unordered_map<uint32_t, std::vector<std::string>> waiters; // piece -> peers that asked before we had it
+
+    bool complete() const
+    {
+        return haveCount == manifest.pieceCount();
+    }
+};
+
+// Swarm counters shown in the Network Center.
+struct SwarmStats
+{
+    uint64_t piecesSeeded = 0;   // GM: pieces uploaded once to their seeder
+    uint64_t piecesServed = 0;   // pieces sent in answer to a PieceRequest
+    uint64_t piecesFromPeers = 0; // player: verified pieces that didn't come from the GM
+    uint64_t badPieces = 0;      // failed the manifest hash, dropped
+    uint64_t fallbacks = 0;      // stalls re-requested from the GM
+};
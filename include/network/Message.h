@@ -3,8 +3,10 @@
 #include <string>
 #include <string_view>
 #include <cstdint>
+#include <memory>
 #include "nlohmann/json.hpp"
 #include "Components.h"
+#include "Sha256.h"
 
 // If you use nlohmann::json in this TU, include it once anywhere before using helpers.
 // #include <nlohmann/json.hpp>
@@ -26,6 +28,10 @@ enum class ConnectionType
 
 namespace msg
 {
+    // interned peer id, see PeerRegistry
+    using PeerHandle = uint32_t;
+    inline constexpr PeerHandle kNoPeer = 0;
+    inline constexpr PeerHandle kSelfPeer = 1;
 
     enum class DCType : uint8_t
     {
@@ -39,6 +45,8 @@ namespace msg
         //Operations
         MarkerMove = 150,
         MarkerMoveState = 151,
+        MarkerMoveAck = 152, // GM -> dragging player: last op it took (or refused) and where the marker is
+        MarkerGroupOp = 153, // one op over a selection of markers (see GroupOp)
         MarkerCreate = 1,
         MarkerUpdate = 2, //Position and/or Visibility
         MarkerDelete = 3,
@@ -52,11 +60,44 @@ namespace msg
 
         UserNameUpdate = 105, // Game channel: broadcast username changes
 
+        // board prefetch (GM streams non-active boards while idle)
+        ImagePrefetchChunk = 106, // GM -> player: image bytes to keep for later
+        ImageCached = 107,        // GM -> player: use the prefetched copy instead of chunks
+        ImageRequest = 108,       // player -> GM: prefetched copy is gone, send the chunks
+
+        EntityDelta = 109, // changed fields of one entity (see DeltaField); several per message
+
+        // swarm image distribution (see ImageSwarm.h)
+        ImageManifest = 110, // GM -> player: hashes and seeders, in place of the chunks
+        ImagePiece = 111,    // any -> player: one verified-size piece of a swarmed image
+        PieceRequest = 112,  // player -> seeder/GM: pieces I still need
+
+        // player disk cache (see ImageDiskCache.h)
+        CacheInventory = 113,    // player -> GM: content hashes it keeps on disk
+        ImageCachedByHash = 114, // GM -> player: load this image from disk instead of the chunks
+
+        // versioned resync (see BoardVersions.h)
+        StateVersion = 115,  // GM -> player: the active board's version everything so far adds up to
+        ResyncRequest = 116, // player -> GM on reconnect: the last StateVersion it saw
+
+        // board hash checks (see BoardStateHash.h)
+        StateHash = 117,       // GM -> player: root and bucket hashes of the active board
+        StateHashLeaves = 118, // player -> GM: its entity hashes for the buckets that differ
+
+        // interest management (see NetworkManager::getPeerIdsViewing)
+        BoardView = 119,   // any -> all: the board I have active now (0 = none)
+        BoardSwitch = 120, // GM -> player: show this board you already hold; its catch-up follows
+
         // chat ops (binary)
         ChatGroupCreate = 200,
         ChatGroupUpdate = 201,
         ChatGroupDelete = 202,
-        ChatMessage = 203
+        ChatMessage = 203,
+
+        // chat image attachments, binary on the chat_media channel (see NetworkManager::postChatImage)
+        ChatImageThumb = 204,   // author -> group: small JPEG preview, sent right after the ChatMessage
+        ChatImageRequest = 205, // reader -> author/GM: send me the full image from this offset
+        ChatImageChunk = 206    // author/GM -> reader: a piece of the full image
     };
     inline std::string DCtypeString(DCType type)
     {
@@ -126,9 +167,69 @@ namespace msg
             case msg::DCType::MarkerMoveState:
                 type_str = "MarkerMoveState";
                 break;
+            case msg::DCType::MarkerMoveAck:
+                type_str = "MarkerMoveAck";
+                break;
+            case msg::DCType::MarkerGroupOp:
+                type_str = "MarkerGroupOp";
+                break;
             case msg::DCType::UserNameUpdate:
                 type_str = "UserNameUpdate";
                 break;
+            case msg::DCType::ImagePrefetchChunk:
+                type_str = "ImagePrefetchChunk";
+                break;
+            case msg::DCType::ImageCached:
+                type_str = "ImageCached";
+                break;
+            case msg::DCType::ImageRequest:
+                type_str = "ImageRequest";
+                break;
+            case msg::DCType::EntityDelta:
+                type_str = "EntityDelta";
+                break;
+            case msg::DCType::ImageManifest:
+                type_str = "ImageManifest";
+                break;
+            case msg::DCType::ImagePiece:
+                type_str = "ImagePiece";
+                break;
+            case msg::DCType::PieceRequest:
+                type_str = "PieceRequest";
+                break;
+            case msg::DCType::CacheInventory:
+                type_str = "CacheInventory";
+                break;
+            case msg::DCType::ImageCachedByHash:
+                type_str = "ImageCachedByHash";
+                break;
+            case msg::DCType::StateVersion:
+                type_str = "StateVersion";
+                break;
+            case msg::DCType::ResyncRequest:
+                type_str = "ResyncRequest";
+                break;
+            case msg::DCType::StateHash:
+                type_str = "StateHash";
+                break;
+            case msg::DCType::StateHashLeaves:
+                type_str = "StateHashLeaves";
+                break;
+            case msg::DCType::BoardView:
+                type_str = "BoardView";
+                break;
+            case msg::DCType::BoardSwitch:
+                type_str = "BoardSwitch";
+                break;
+            case msg::DCType::ChatImageThumb:
+                type_str = "ChatImageThumb";
+                break;
+            case msg::DCType::ChatImageRequest:
+                type_str = "ChatImageRequest";
+                break;
+            case msg::DCType::ChatImageChunk:
+                type_str = "ChatImageChunk";
+                break;
             default:
                 type_str = "UnkownType";
                 break;
@@ -142,6 +243,23 @@ namespace msg
         Marker = 1
     };
 
+    // EntityDelta: [boardId][entityId][DeltaEntity][mask] then the masked fields in bit order
+    enum class DeltaEntity : uint8_t
+    {
+        Board = 0,
+        Marker = 1,
+        Fog = 2
+    };
+
+    enum DeltaField : uint8_t
+    {
+        DeltaPosition = 1 << 0,
+        DeltaSize = 1 << 1,
+        DeltaVisibility = 1 << 2,
+        DeltaGrid = 1 << 3,
+        DeltaMarkerComponent = 1 << 4
+    };
+
     struct MarkerMeta
     {
         uint64_t markerId = 0;
@@ -162,11 +280,45 @@ namespace msg
         Size size{};
     };
 
+    // A chat attachment is named by its content; the same picture posted twice is one transfer
+    inline constexpr uint64_t kChatImageMaxBytes = 32ull * 1024 * 1024;
+    inline constexpr uint32_t kChatImageMaxSide = 8192; // a small file can still decode to gigabytes of RGBA
+    struct ChatImageRef
+    {
+        Sha256::Digest hash{};
+        uint64_t size = 0;
+        uint16_t width = 0;
+        uint16_t height = 0;
+    };
+
+    // RGBA8 pixels decoded off the UI thread (freed through the stb deleter)
+    struct DecodedImage
+    {
+        int width = 0;
+        int height = 0;
+        std::shared_ptr<uint8_t> rgba;
+    };
+
+    // MarkerGroupOp: [boardId][op][groupId][epoch][seq][count][ids...] then by op
+    //   Move:       Position, offset of every member since the drag began (marker_move channel)
+    //   MoveEnd:    one Position per id, final resting place; closes the group's epoch
+    //   Visibility: Visibility for all members
+    //   Delete:     nothing
+    enum class GroupOp : uint8_t
+    {
+        Move = 0,
+        MoveEnd = 1,
+        Visibility = 2,
+        Delete = 3
+    };
+    inline constexpr uint32_t kMaxGroupMarkers = 1024;
+
     // Single ready container with tag + optionals (only 1 engaged)
     struct ReadyMessage
     {
         DCType kind;
-        std::string fromPeerId; // optional: who sent it (fill in DC callback if you have it)
+        PeerHandle fromPeer = kNoPeer; // who sent it
+        std::string fromPeerId;        // resolved transport id, only filled for chat/UserNameUpdate
 
         std::optional<uint64_t> tableId;
         std::optional<uint64_t> boardId;
@@ -179,13 +331,18 @@ namespace msg
 
         std::optional<std::string> name;
         std::optional<std::vector<uint8_t>> bytes;
+        std::shared_ptr<const uint8_t> mapped; // a spilled image: the temp file's view, decoded in place
+        size_t mappedSize = 0;
         std::optional<BoardMeta> boardMeta;
         std::optional<MarkerMeta> markerMeta;
+        std::optional<DecodedImage> decoded; // set when the image was decoded while streaming
+        std::optional<uint64_t> lastByteMs;  // steady clock ms when the last image chunk landed
 
         std::optional<uint64_t> threadId;
         std::optional<uint64_t> ts;
         std::optional<std::string> text;                   // chat text
         std::optional<std::set<std::string>> participants; // thread participants
+        std::optional<ChatImageRef> chatImage;             // attachment (ChatMessage/ChatImageThumb/ChatImageChunk)
 
         std::optional<Moving> mov;
         std::optional<MarkerComponent> markerComp;
@@ -194,6 +351,11 @@ namespace msg
 
         std::optional<uint32_t> dragEpoch;
         std::optional<uint32_t> seq;
+        std::optional<bool> accepted; // MarkerMoveAck
+        std::optional<GroupOp> groupOp; // MarkerGroupOp
+        std::optional<uint64_t> groupId;
+        std::optional<std::vector<uint64_t>> ids;
+        std::optional<std::vector<Position>> positions;
         std::optional<Role> senderRole;
 
         std::optional<std::string> userUniqueId;
@@ -216,10 +378,24 @@ namespace msg
         std::string label;
     };
 
+    namespace dc
+    {
+        // resolved once per DataChannel in PeerLink, the drain switches on it
+        enum class Channel : uint8_t
+        {
+            Game,
+            Chat,
+            Notes,
+            MarkerMove,
+            ChatMedia,
+            Unknown
+        };
+    } // namespace dc
+
     struct InboundRaw
     {
-        std::string fromPeer;
-        std::string label;
+        PeerHandle fromPeer = kNoPeer;
+        dc::Channel channel = dc::Channel::Unknown;
         std::vector<uint8_t> bytes;
     };
 
@@ -298,8 +474,24 @@ namespace msg
             inline constexpr std::string Chat = "chat";
             inline constexpr std::string Notes = "notes";
             inline constexpr std::string MarkerMove = "marker_move";
+            inline constexpr std::string ChatMedia = "chat_media"; // attachments, so chat text never waits on them
         } // namespace name
 
+        inline Channel channelFromLabel(std::string_view label)
+        {
+            if (label == name::Game)
+                return Channel::Game;
+            if (label == name::Chat)
+                return Channel::Chat;
+            if (label == name::Notes)
+                return Channel::Notes;
+            if (label == name::MarkerMove)
+                return Channel::MarkerMove;
+            if (label == name::ChatMedia)
+                return Channel::ChatMedia;
+            return Channel::Unknown;
+        }
+
     } // namespace dc
 
     // --- DCType <-> string (chat only) ---
@@ -355,6 +547,7 @@ namespace msg
         inline constexpr std::string_view Ts = "ts";              // u64
         inline constexpr std::string_view Username = "username";  // string
         inline constexpr std::string_view Text = "text";          // string
+        inline constexpr std::string_view Image = "image";        // {hash hex, size, w, h}, optional
     } // namespace chatkey
 
     // ========== JSON helpers (nlohmann::json) ==========
@@ -414,6 +607,32 @@ namespace msg
             {std::string(chatkey::Text), text}};
     }
 
+    inline Json chatImageToJson(const ChatImageRef& r)
+    {
+        return Json{{"hash", Sha256::toHex(r.hash)}, {"size", r.size}, {"w", r.width}, {"h", r.height}};
+    }
+
+    inline bool chatImageFromJson(const Json& j, ChatImageRef& out)
+    {
+        if (!j.is_object() || !j.contains("hash") || !j["hash"].is_string())
+            return false;
+        if (!Sha256::fromHex(j["hash"].get<std::string>(), out.hash))
+            return false;
+        out.size = j.value("size", uint64_t(0));
+        out.width = j.value("w", uint16_t(0));
+        out.height = j.value("h", uint16_t(0));
+        return out.size > 0;
+    }
+
+    inline Json makeChatImageMessage(uint64_t tableId, uint64_t groupId,
+                                     uint64_t ts, const std::string& username,
+                                     const std::string& caption, const ChatImageRef& image)
+    {
+        auto j = makeChatMessage(tableId, groupId, ts, username, caption);
+        j[std::string(chatkey::Image)] = chatImageToJson(image);
+        return j;
+    }
+
     inline Json makeOffer(const std::string& from, const std::string& to,
                           const std::string& sdp, const std::string& username,
                           const std::string& uniqueId,
@@ -31,6 +31,12 @@ public:
         return value;
     }
 
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
     bool try_pop(T& value)
     {
         std::unique_lock<std::mutex> lock(mutex_);
@@ -0,0 +1,161 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Message.h"
+
+// Network condition simulator between PeerLink and libdatachannel, for testing on a LAN or
+// loopback. Off by default; while off a send or receive costs one atomic load. Each channel gets
+// its own latency, jitter, bandwidth cap, loss and reordering, applied per (peer, channel,
+// direction) lane. Reliable channels (game, chat, notes, chat_media) keep their semantics: never
+// lost, never reordered, so jitter turns into head-of-line blocking. marker_move is unordered
+// with a 500 ms packet lifetime (PeerLink::createChannels): it may lose and reorder, and whatever
+// would arrive later than the lifetime is abandoned, like SCTP would. Each lane draws from its own
+// RNG seeded from (seed, lane), so the same seed and the same traffic on a lane give the same
+// decisions there however the other lanes interleave. Replayed captures don't go through it.
+class NetSim
+{
+public:
+    static constexpr size_t kChannels = static_cast<size_t>(msg::dc::Channel::Unknown);
+    static constexpr std::chrono::milliseconds kMarkerMoveLifetime{500};
+
+    struct Profile
+    {
+        uint32_t latencyMs = 0; // one way, per direction the sim applies to
+        uint32_t jitterMs = 0;  // +/- around latencyMs
+        uint32_t kbps = 0;      // 0 = no cap
+        float lossPct = 0.0f;   // unreliable channels only
+        float reorderPct = 0.0f;
+    };
+
+    struct Config
+    {
+        bool enabled = false;
+        bool outbound = true;
+        bool inbound = true;
+        uint64_t seed = 1;
+        std::array<Profile, kChannels> channels{};
+    };
+
+    struct Stats
+    {
+        uint64_t delayed = 0;
+        uint64_t lost = 0;
+        uint64_t expired = 0; // past the marker_move lifetime
+        uint64_t reordered = 0;
+        size_t pending = 0;
+        size_t pendingBytes = 0;
+    };
+
+    enum class Direction : uint8_t
+    {
+        Out,
+        In
+    };
+
+    using Deliver = std::function<void()>;
+
+    static NetSim& instance()
+    {
+        static NetSim sim;
+        return sim;
+    }
+
+    ~NetSim();
+    NetSim(const NetSim&) = delete;
+    NetSim& operator=(const NetSim&) = delete;
+
+    // Replaces the settings and reseeds. Lanes with queued messages drain in order when turned off.
+    void configure(const Config& cfg);
+    Config config() const;
+    void setEnabled(bool on);
+
+    bool engaged() const
+    {
+        return engaged_.load(std::memory_order_acquire);
+    }
+
+    // False: not simulated, the caller delivers now. True: the sim owns it and runs deliver on its
+    // own thread once due, or never if it was lost.
+    bool submit(msg::PeerHandle peer, msg::dc::Channel channel, Direction dir, size_t bytes, Deliver deliver);
+
+    // Outbound bytes held for that channel, added to PeerLink::bufferedAmount so senders that
+    // pace themselves on it see the simulated bottleneck.
+    size_t queuedBytes(msg::PeerHandle peer, msg::dc::Channel channel) const;
+    Stats stats() const;
+
+    // "latency=80,jitter=20,kbps=2000,loss=2,reorder=5,seed=42,dir=both"; a key may be scoped to one
+    // channel ("marker_move.loss=10"), otherwise it sets every channel. "off" turns it off.
+    static bool parseSpec(std::string_view spec, Config& inout, std::string* error = nullptr);
+    static std::string describe(const Config& cfg);
+    static const char* channelName(size_t channel);
+
+    static bool reliable(msg::dc::Channel channel)
+    {
+        return channel != msg::dc::Channel::MarkerMove;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    NetSim() = default;
+
+    struct Lane
+    {
+        Clock::time_point wireFree{}; // when the capped link finishes what it already took
+        Clock::time_point lastDue{};  // reliable lanes never deliver before this
+        size_t pending = 0;
+        size_t pendingBytes = 0;
+    };
+
+    struct Pending
+    {
+        Clock::time_point due;
+        uint64_t seq = 0; // FIFO among equal due times
+        uint64_t lane = 0;
+        size_t bytes = 0;
+        Deliver deliver;
+    };
+
+    struct Later
+    {
+        bool operator()(const Pending& a, const Pending& b) const
+        {
+            return a.due != b.due ? a.due > b.due : a.seq > b.seq;
+        }
+    };
+
+    static uint64_t laneKey(msg::PeerHandle peer, msg::dc::Channel channel, Direction dir)
+    {
+        return (uint64_t(peer) << 16) | (uint64_t(channel) << 1) | uint64_t(dir);
+    }
+
+    static double uniform(std::mt19937_64& rng, double lo, double hi);
+    std::mt19937_64& rngFor(uint64_t lane); // caller holds mtx_
+    void refreshEngaged();                // caller holds mtx_
+    void run();                           // worker
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::thread worker_;
+    bool stop_ = false;
+
+    Config cfg_;
+    std::unordered_map<uint64_t, Lane> lanes_;
+    std::unordered_map<uint64_t, std::mt19937_64> rngs_; // per lane; outlive the drained lanes, reset by configure
+    std::priority_queue<Pending, std::vector<Pending>, Later> queue_;
+    uint64_t seq_ = 0;
+    Stats stats_;
+    std::atomic<bool> engaged_{false};
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
 #include <memory>
 #include "PeerLink.h"
 #include "flecs.h"
@@ -11,6 +13,9 @@
 #include <rtc/peerconnection.hpp>
 #include <nlohmann/json.hpp>
 #include <future>
+#include <deque>
+#include <condition_variable>
+#include <thread>
 #include <iostream>
 #include "MessageQueue.h"
 #include "Components.h"
@@ -20,18 +25,48 @@
 #include "PathManager.h"
 #include "Logger.h"
 #include "IdentityManager.h"
+#include "ImageSpool.h"
+#include "StreamingImageDecoder.h"
+#include "PeerRegistry.h"
+#include "PeerTable.h"
+#include "SessionCapture.h"
+#include "ImagePrefetchCache.h"
+#include "EntityDeltaTracker.h"
+#include "ImageSwarm.h"
+#include "ImageDiskCache.h"
+#include "BoardVersions.h"
+#include "BoardStateHash.h"
+#include "BoardChangeFeed.h"
 
 struct DragState
 {
     uint32_t epoch{0};
     bool closed{true};
     uint32_t lastSeq{0};
-    std::string ownerPeerId;
+    msg::PeerHandle ownerPeer{msg::kNoPeer};
     bool locallyDragging{false};
     uint32_t locallyProposedEpoch{0};
     uint32_t localSeq{0};
     uint64_t lastTxMs{0};
     uint64_t epochOpenedMs{0};
+    uint64_t lastRxMs{0}; // last op received for it
+
+    // player-side prediction: our ops the GM hasn't acked yet, with the position each one sent.
+    // The marker keeps following the mouse; an ack only shifts it by what the GM changed.
+    std::deque<std::pair<uint32_t /*seq*/, Position>> unacked;
+    uint32_t ackedSeq{0};
+    bool yielded{false}; // the GM refused our drag; still take the winner's ops for this epoch
+};
+
+// A selection dragged as one: members don't open drags of their own, the group's epoch covers them
+struct GroupDragState
+{
+    uint32_t epoch{0};
+    bool closed{true};
+    uint32_t lastSeq{0};
+    msg::PeerHandle ownerPeer{msg::kNoPeer};
+    uint32_t localSeq{0};
+    std::unordered_map<uint64_t /*markerId*/, Position> base; // receiver: where each member was when the drag reached us
 };
 
 // Forward declare
@@ -39,6 +74,7 @@ class SignalingServer;
 class SignalingClient;
 class BoardManager;
 class GameTableManager;
+class HostDiscovery;
 
 struct PendingImage
 {
@@ -53,20 +89,45 @@ struct PendingImage
 
     uint64_t total = 0;
     uint64_t received = 0;
-    std::vector<uint8_t> buf;
+    ImageSpool buf; // heap or mmapped temp file, see NetworkManager::reserveImageRx
+    uint64_t contiguous = 0; // in-order prefix written so far (what the decoder may read)
+    uint64_t lastByteMs = 0;
+    std::unique_ptr<StreamingImageDecoder> decoder; // declared after buf: joins before buf goes away
+    std::unique_ptr<SwarmRx> swarm;                 // set when the GM sent a manifest instead of chunks
 
     bool commitRequested = false;
+    bool fromDiskCache = false; // filled from ImageDiskCache, don't store it again
+    bool prefetched = false;    // announced with ImageCached but missed: goes back into the prefetch cache
 
     bool isComplete() const
     {
-        return total == received && total > 0;
+        return total == received && total > 0 && (!swarm || swarm->verified);
     }
 };
 
+// Receiver-side image transfer counters (shown in Network Center)
+struct ImageRxStats
+{
+    size_t inFlight = 0;       // PendingImage entries
+    uint64_t memBytes = 0;     // heap-backed in-flight bytes
+    uint64_t spillBytes = 0;   // mmapped temp file in-flight bytes
+    uint64_t peakMemBytes = 0; // high-water of memBytes
+    uint64_t spilledCount = 0; // transfers that went to disk
+    uint64_t refusedCount = 0; // transfers over the hard limit (or failed alloc)
+
+    // last byte received -> texture created
+    uint64_t streamedCount = 0; // decoded while chunks were arriving
+    uint64_t readyCount = 0;
+    uint64_t lastReadyMs = 0;
+    uint64_t maxReadyMs = 0;
+    uint64_t sumReadyMs = 0;
+};
+
 class NetworkManager : public std::enable_shared_from_this<NetworkManager>
 {
 public:
-    NetworkManager(flecs::world ecs, std::shared_ptr<IdentityManager> identity_manager);
+    // replaySandbox: never hosts or connects, only replays captures into its own world (ReplaySandbox)
+    NetworkManager(flecs::world ecs, std::shared_ptr<IdentityManager> identity_manager, bool replaySandbox = false);
 
     void setup(std::weak_ptr<BoardManager> board_manager, std::weak_ptr<GameTableManager> gametable_manager);
 
@@ -86,9 +147,13 @@ public:
     void disallowPort(unsigned short port);
 
     // Utility methods
-    std::string getNetworkInfo(ConnectionType type); // Get network info (IP and port) (server utility)
+    std::string getNetworkInfo(ConnectionType type); // Connection string for that route; "" while its address is still being looked up
     std::string getLocalIPAddress();                 // Get local IP address (server utility)
     std::string getExternalIPAddress();              // Get external IP address (server utility)
+    std::shared_ptr<HostDiscovery> getHostDiscovery() const
+    {
+        return discovery_;
+    }
     std::string getLocalTunnelURL();                 // Get Local Tunnel URL
 
     void parseConnectionString(std::string connection_string, std::string& server, unsigned short& port, std::string& password);
@@ -115,14 +180,37 @@ public:
         return rtcConfig;
     }
 
+    // LAN fast path: links skip STUN and bind ICE to the interface facing the table.
+    // Set when hosting in LOCAL mode or joining a private/loopback address.
+    void setLanMode(bool on, std::string bindAddress = {})
+    {
+        std::lock_guard<std::mutex> lk(lanMtx_);
+        lanMode_ = on;
+        lanBindAddress_ = on ? std::move(bindAddress) : std::string{};
+    }
+    bool isLanMode() const
+    {
+        std::lock_guard<std::mutex> lk(lanMtx_);
+        return lanMode_;
+    }
+    std::string getLanBindAddress() const
+    {
+        std::lock_guard<std::mutex> lk(lanMtx_);
+        return lanBindAddress_;
+    }
+    uint64_t signalingAuthMs() const; // connect -> auth ok, 0 until authed
+    void logConnectPhases(const std::string& peerId, const PeerLink& link);
+    void markPeerBootstrapped(msg::PeerHandle from); // player side, first board from the GM
+
     bool connectToPeer(const std::string& connectionString);
     bool disconectFromPeers();
     bool removePeer(std::string peerId);
     bool clearPeers() const
     {
-        for (auto [id, peer] : peers)
+        for (auto& [id, peer] : peers.snapshot())
         {
-            peer->close();
+            if (peer)
+                peer->close();
         }
         return peers.empty();
     }
@@ -152,12 +240,19 @@ public:
     }
     void setMyPeerId(std::string v)
     {
+        peerRegistry_.setSelfPeerId(v);
         myPeerId_ = std::move(v);
     }
 
-    const std::unordered_map<std::string, std::shared_ptr<PeerLink>>& getPeers() const
+    PeerRegistry& peerRegistry()
+    {
+        return peerRegistry_;
+    }
+
+    // immutable version of the table, iterate it directly (for (auto& [id, link] : getPeers()))
+    PeerTable::Snapshot getPeers() const
     {
-        return peers;
+        return peers.snapshot();
     }
     std::shared_ptr<SignalingServer> getSignalingServer() const
     {
@@ -169,19 +264,41 @@ public:
         return inboundGame_.try_pop(out);
     }
 
-    bool tryPopRawMessage(msg::InboundRaw& out)
+    // libdatachannel threads: hands a received message to its peer's decode shard
+    void enqueueInbound(msg::InboundRaw&& r);
+
+    void drainEvents();
+    // UI thread, once per frame: commits whose streaming decode finished meanwhile
+    void pollStreamingDecodes();
+    size_t inboundRawDepth() const; // queued on all decode shards
+    size_t decodeShardCount() const
     {
-        return inboundRaw_.try_pop(out);
+        return shards_.size();
     }
+    std::vector<uint64_t> decodeShardCounts() const; // messages decoded per shard so far
+    std::vector<double> decodeShardBusyMs() const;   // time each shard spent decoding so far
 
-    void drainEvents();
-    void drainInboundRaw(int maxPerTick);
+    // ---- session capture / replay (perf regression runs) ----
+    bool startCapture(const std::filesystem::path& file);
+    void stopCapture();
+    const SessionRecorder& getRecorder() const
+    {
+        return recorder_;
+    }
+    // feeds a capture through the decode shards into the ready queue, like live peers would;
+    // sandbox instances only, a live session replays through GameTableManager::startReplay
+    bool startReplay(const std::filesystem::path& file, bool realtime);
+    void stopReplay();
+    const SessionReplayer* getReplayer() const
+    {
+        return replayer_.get();
+    }
 
-    void decodeRawChatBuffer(const std::string& fromPeer, const std::vector<uint8_t>& b);
-    void decodeRawNotesBuffer(const std::string& fromPeer, const std::vector<uint8_t>& b);
+    void decodeRawChatBuffer(msg::PeerHandle fromPeer, const std::vector<uint8_t>& b);
+    void decodeRawNotesBuffer(msg::PeerHandle fromPeer, const std::vector<uint8_t>& b);
 
-    void startRawDrainWorker();
-    void stopRawDrainWorker();
+    void startDecodeShards();
+    void stopDecodeShards();
 
     void onPeerChannelOpen(const std::string& peerId, const std::string& label);
     void bootstrapPeerIfReady(const std::string& peerId);
@@ -190,10 +307,8 @@ public:
     void broadcastBoard(const flecs::entity& board);
     void broadcastFog(uint64_t boardId, const flecs::entity& fog);
 
-    void broadcastFogUpdate(uint64_t boardId, const flecs::entity& fog);
     void broadcastFogDelete(uint64_t boardId, const flecs::entity& fog);
 
-    void sendFogUpdate(uint64_t boardId, const flecs::entity& fog, const std::vector<std::string>& toPeerIds);
     void sendFogDelete(uint64_t boardId, const flecs::entity& fog, const std::vector<std::string>& toPeerIds);
 
     void sendGameTo(const std::string& peerId, const std::vector<unsigned char>& bytes);
@@ -217,7 +332,6 @@ public:
     }
 
     MessageQueue<msg::NetEvent> events_;
-    MessageQueue<msg::InboundRaw> inboundRaw_;
     std::vector<std::string> getConnectedPeerIds() const;
     std::vector<std::string> getConnectedUsernames() const;
 
@@ -231,7 +345,7 @@ public:
         return gmPeerId_;
     }
 
-    void decodeRawGameBuffer(const std::string& fromPeer, const std::vector<uint8_t>& b);
+    void decodeRawGameBuffer(msg::PeerHandle fromPeer, const std::vector<uint8_t>& b);
 
     void sendMarkerDelete(uint64_t boardId, const flecs::entity& marker, const std::vector<std::string>& toPeerIds);
     void broadcastMarkerDelete(uint64_t boardId, const flecs::entity& marker);
@@ -240,9 +354,10 @@ public:
     //PUBLIC MARKER STUFF--------------------------------------------------------------------------------
 
     //END STABLE
-    void decodeRawMarkerMoveBuffer(const std::string& fromPeer, const std::vector<uint8_t>& b);
+    void decodeRawMarkerMoveBuffer(msg::PeerHandle fromPeer, const std::vector<uint8_t>& b);
 
     void markDraggingLocal(uint64_t markerId, bool dragging);
+    void releaseDragsOf(msg::PeerHandle peer);
     bool isMarkerBeingDragged(uint64_t markerId) const;
     bool amIDragging(uint64_t markerId) const;
     void forceCloseDrag(uint64_t markerId);
@@ -253,16 +368,78 @@ public:
     void broadcastMarkerMoveState(uint64_t boardId, const flecs::entity& marker);
     void sendMarkerMoveState(uint64_t boardId, const flecs::entity& marker, const std::vector<std::string>& toPeerIds);
 
-    void broadcastMarkerUpdate(uint64_t boardId, const flecs::entity& marker);
-    void sendMarkerUpdate(uint64_t boardId, const flecs::entity& marker, const std::vector<std::string>& toPeerIds);
-
     bool shouldApplyMarkerMove(const msg::ReadyMessage& m);           // DCType::MarkerMove
     bool shouldApplyMarkerMoveStateStart(const msg::ReadyMessage& m); // DCType::MarkerMoveState + mov.isDragging==true
     bool shouldApplyMarkerMoveStateFinal(const msg::ReadyMessage& m); // DCType::MarkerMoveState + mov.isDragging==false
 
-    // send/broadcast
-    void broadcastGridUpdate(uint64_t boardId, const flecs::entity& board);
-    void sendGridUpdate(uint64_t boardId, const flecs::entity& board, const std::vector<std::string>& toPeerIds);
+    // GM: answer a player's MarkerMove/MarkerMoveState after the gate ran (applied = gate result)
+    void ackMarkerMove(const msg::ReadyMessage& m, const flecs::entity& marker, bool applied);
+    // player: drop acked ops and replay the rest on the GM's position; nullopt = nothing to change
+    std::optional<Position> reconcileMarkerMove(const msg::ReadyMessage& m, const Position& current);
+
+    // Multi-marker ops, one MarkerGroupOp frame per selection (see msg::GroupOp). A group drag
+    // isn't predicted or acked: MoveEnd carries every member's final position and the state
+    // hash check mends whatever a lost frame leaves behind.
+    uint64_t beginGroupDrag(const std::vector<uint64_t>& markerIds); // opens a new epoch, returns the group id
+    void broadcastGroupMove(uint64_t boardId, uint64_t groupId, const std::vector<uint64_t>& markerIds, const Position& offset);
+    void broadcastGroupMoveEnd(uint64_t boardId, uint64_t groupId, const std::vector<flecs::entity>& markers);
+    void broadcastGroupVisibility(uint64_t boardId, const std::vector<flecs::entity>& markers, bool visible);
+    void broadcastGroupDelete(uint64_t boardId, const std::vector<flecs::entity>& markers);
+    // deleted markers: their drag state and any group drag that held them
+    void forgetMarkerDrags(const std::vector<uint64_t>& markerIds);
+
+    bool shouldApplyGroupMove(const msg::ReadyMessage& m); // GroupOp::Move / MoveEnd
+    // false when the member is held by a drag of someone else (or ours)
+    bool groupMayMove(const msg::ReadyMessage& m, uint64_t markerId) const;
+    Position groupMoveTarget(const msg::ReadyMessage& m, uint64_t markerId, const Position& current);
+
+    // Size/Visibility/Position/Grid/MarkerComponent edits are picked up by the delta tracker
+    // (set<T>() or get_mut + modified<T>()) and sent once per frame as EntityDelta records.
+    void flushEntityDeltas();
+    EntityDeltaTracker& entityDeltas()
+    {
+        return *deltaTracker_;
+    }
+    // GM: tells bootstrapped players the active board's version (throttled), right after the flush
+    void publishStateVersion();
+    // Keeps the board hash current; the GM also sends its root/buckets to players (throttled)
+    void pollStateHash();
+    // player: compare the GM's StateHash with ours, ask for buckets that stay different
+    void checkStateHash(const msg::ReadyMessage& m);
+    // GM: resend what differs in the leaves a player reported (StateHashLeaves)
+    void repairStateHash(const msg::ReadyMessage& m);
+    struct StateHashStats
+    {
+        uint64_t checks = 0;
+        uint64_t mismatches = 0; // bucket lists sent (player) / received (GM)
+        uint64_t repaired = 0;   // entities resent (GM)
+        uint64_t lastRefreshUs = 0; // BoardStateHash::refresh in pollStateHash
+        uint64_t maxRefreshUs = 0;
+    };
+    StateHashStats getStateHashStats() const
+    {
+        return stateHashStats_;
+    }
+
+    // Interest management. Every peer tells the others which board it has active (BoardView) and
+    // board-scoped updates only go to the peers looking at that board, plus the GM, which keeps
+    // them all. The GM notes the version a player stopped following a board at; coming back
+    // (BoardSwitch, or its own BoardView) the player gets a resync delta, not the whole board.
+    // UI thread.
+    void announceBoardView();
+    void onPeerBoardView(const msg::ReadyMessage& m);
+    // connected peers that get live updates for boardId (unknown views count as looking)
+    std::vector<std::string> getPeerIdsViewing(uint64_t boardId) const;
+    struct InterestStats
+    {
+        uint64_t skippedSends = 0; // peer-sends left out because the peer looks elsewhere
+        uint64_t switches = 0;     // BoardSwitch sent in place of a whole board (GM)
+        uint64_t catchUps = 0;     // resync deltas sent on a peer's return (GM)
+    };
+    InterestStats getInterestStats() const
+    {
+        return interestStats_;
+    }
 
     //PUBLIC END MARKER STUFF----------------------------------------------------------------------------
 
@@ -285,12 +462,24 @@ public:
     bool broadcastChatJson(const msg::Json& j);
     bool sendChatJsonTo(const std::string& peerId, const msg::Json& j);
     bool sendChatJsonTo(const std::set<std::string>& peers, const msg::Json& j);
+
+    // ---- chat image attachments ----
+    // UI thread. Hashing, the thumbnail and the sends run on the chat media worker; our own post
+    // comes back through the inbound queue as a ChatMessage + ChatImageThumb from kSelfPeer.
+    void postChatImage(uint64_t tableId, uint64_t groupId, const std::set<std::string>& toPeerIds, bool broadcast,
+                       const std::string& username, const std::string& caption, uint64_t ts, std::vector<uint8_t> bytes);
+    // UI thread. From the disk cache, else asked of fromPeerId (the GM when that peer is gone);
+    // lands as a ChatImageChunk ReadyMessage holding the whole verified image.
+    void requestChatImage(const msg::ChatImageRef& ref, const std::string& fromPeerId);
     std::shared_ptr<IdentityManager> getIdentityManager()
     {
         return identity_manager;
     }
 
     std::unordered_map<uint64_t /*markerId*/, DragState> drag_;
+    std::unordered_map<uint64_t /*groupId*/, GroupDragState> groupDrag_; // open drags only, erased at MoveEnd
+    uint32_t groupEpoch_ = 0;                                             // ours, across every group
+    std::unordered_map<msg::PeerHandle, uint32_t> groupEpochEnded_;       // per sender: newest ended group epoch
     // NetworkManager.h
     std::string debugIdentitySnapshot() const;
     void clearDragState(uint64_t markerId);
@@ -299,15 +488,81 @@ public:
     void setCustomHost(const std::string& h) { customHost_ = h; }
     const std::string& getCustomHost() const { return customHost_; }
 
+    ImageRxStats getImageRxStats() const
+    {
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        ImageRxStats s = rxStats_;
+        s.inFlight = imagesRx_.size();
+        return s;
+    }
+    // ---- board prefetch ----
+    // GM marks boards (file names under the table's Boards/) that players should get first
+    void setBoardUpcoming(const std::string& boardFile, bool upcoming);
+    bool isBoardUpcoming(const std::string& boardFile) const;
+    ImagePrefetchCache::Stats getPrefetchCacheStats() const
+    {
+        return prefetchCache_.stats();
+    }
+    ImageDiskCache::Stats getDiskCacheStats() const
+    {
+        return diskCache_ ? diskCache_->stats() : ImageDiskCache::Stats{};
+    }
+    // Hidden markers reach players as image-less stubs; with this on, their art is still
+    // prefetched in the background (faster reveal, but a player could dig it out of traffic)
+    void setPrefetchHiddenArt(bool on)
+    {
+        prefetchHiddenArt_.store(on);
+    }
+    bool prefetchHiddenArt() const
+    {
+        return prefetchHiddenArt_.load();
+    }
+    // ---- swarm image distribution ----
+    // Big images going to several players are seeded once and relayed between players.
+    void setSwarmImages(bool on)
+    {
+        swarmImages_.store(on);
+    }
+    bool swarmImages() const
+    {
+        return swarmImages_.load();
+    }
+    SwarmStats getSwarmStats() const
+    {
+        std::lock_guard<std::mutex> lk(swarmMtx_);
+        return swarmStats_;
+    }
+    void pollSwarmTransfers(); // UI thread, once per frame: stall fallback and seed expiry
+    size_t prefetchQueueDepth() const
+    {
+        std::lock_guard<std::mutex> lk(prefetchMtx_);
+        return prefetchJobs_.size();
+    }
+
+    void recordImageReady(uint64_t lastByteMs, bool streamed)
+    {
+        const uint64_t ms = nowMs() - lastByteMs;
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        rxStats_.readyCount++;
+        rxStats_.lastReadyMs = ms;
+        rxStats_.maxReadyMs = std::max(rxStats_.maxReadyMs, ms);
+        rxStats_.sumReadyMs += ms;
+        if (streamed)
+            rxStats_.streamedCount++;
+    }
+
 private:
     std::string customHost_; // empty = unset
-    // build
-    std::vector<unsigned char> buildGridUpdateFrame(uint64_t boardId, const Grid& grid);
     // handle
     void handleGridUpdate(const std::vector<uint8_t>& b, size_t& off);
+    void handleEntityDelta(const std::vector<uint8_t>& b, size_t& off);
+    // false when the entity isn't replicated or nothing in the mask applies to it
+    bool appendEntityDelta(std::vector<unsigned char>& out, const flecs::entity& e, uint8_t mask,
+                           const std::vector<std::string>& toPeerIds);
+    static constexpr size_t kDeltaFrameMax = 64 * 1024; // split a flush past this
 
     //MARKER STUFF--------------------------------------------------------------------------------
-    std::string decodingFromPeer_;
+    static thread_local msg::PeerHandle decodingFrom_; // sender of the buffer this shard worker is decoding
     uint32_t sendMoveMinPeriodMs_{50}; // pacing target (~20Hz)
     uint32_t getSendMoveMinPeriodMs() const
     {
@@ -318,16 +573,27 @@ private:
     void handleMarkerMove(const std::vector<uint8_t>& b, size_t& off);
     void handleMarkerUpdate(const std::vector<uint8_t>& b, size_t& off);
     void handleMarkerMoveState(const std::vector<uint8_t>& b, size_t& off);
+    void handleMarkerMoveAck(const std::vector<uint8_t>& b, size_t& off);
+    void handleMarkerGroupOp(const std::vector<uint8_t>& b, size_t& off);
 
     // ---- MARKER UPDATE/DELETE ----
     std::vector<unsigned char> buildMarkerMoveFrame(uint64_t boardId, const flecs::entity& marker, uint32_t seq);
     std::vector<unsigned char> buildMarkerMoveStateFrame(uint64_t boardId, const flecs::entity& marker);
-    std::vector<unsigned char> buildMarkerUpdateFrame(uint64_t boardId, const flecs::entity& marker);
-
-    static bool tieBreakWins(const std::string& challengerPeerId, const std::string& currentOwnerPeerId) //NEEDS REVISITING
-    {
-        return challengerPeerId < currentOwnerPeerId;
-    }
+    std::vector<unsigned char> buildMarkerGroupFrame(uint64_t boardId, msg::GroupOp op, uint64_t groupId, uint32_t epoch,
+                                                     uint32_t seq, const std::vector<uint64_t>& markerIds);
+    // GM: a marker just made visible goes out in full to the peers that only have its stub
+    void sendRevealedMarker(uint64_t boardId, const flecs::entity& marker, const std::vector<std::string>& toPeerIds);
+    void forgetWithheldMarkers(const std::vector<uint64_t>& ids); // marker delete paths
+
+    static constexpr size_t kMaxUnackedMoves = 128; // ~4s of moves at 30Hz; older ones can't be replayed
+    void recordPredictedMove(DragState& s, uint32_t seq, const flecs::entity& marker);
+    std::vector<unsigned char> buildMarkerMoveAckFrame(uint64_t boardId, uint64_t markerId, uint32_t epoch,
+                                                       uint32_t seq, bool accepted, const Position& pos);
+
+    // by the unique id bound to the handle; peer ids go through peerRegistry_.find first
+    bool isGmPeer(msg::PeerHandle h) const;
+    static uint64_t groupIdOf(std::vector<uint64_t> markerIds);
+    bool tieBreakWins(msg::PeerHandle challenger, msg::PeerHandle currentOwner) const;
 
     //STABLE
     void handleMarkerDelete(const std::vector<uint8_t>& b, size_t& off);
@@ -337,12 +603,237 @@ private:
     void handleMarkerMeta(const std::vector<uint8_t>& b, size_t& off);
     //END MARKER STUFF----------------------------------------------------------------------------
 
+    // image transfer state below is shared by all decode shards (and polled from the UI thread)
+    mutable std::mutex imagesMtx_;
     std::unordered_map<uint64_t, PendingImage> imagesRx_;
-    MessageQueue<msg::ReadyMessage> inboundGame_;
-    // optional background raw-drain worker
-    std::atomic<bool> rawWorkerRunning_{false};
-    std::atomic<bool> rawWorkerStop_{false};
-    std::thread rawWorker_;
+    // ---- inbound image budget ----
+    static constexpr uint64_t kRxMemBudget = 256ull * 1024 * 1024;      // all heap-backed transfers together
+    static constexpr uint64_t kRxSpillThreshold = 64ull * 1024 * 1024;  // a single transfer above this goes to disk
+    static constexpr uint64_t kRxHardLimit = 1024ull * 1024 * 1024;     // announced totals above this are refused
+    std::unordered_set<uint64_t> imagesRefused_; // ids whose chunks/commit we drop
+    ImageRxStats rxStats_;
+    // finished images for the prefetch/disk caches, handed over once imagesMtx_ is released
+    struct KeptImage
+    {
+        msg::ImageOwnerKind kind{};
+        uint64_t id = 0;
+        ImagePrefetchCache::Bytes prefetch; // heap image announced as prefetched, or seeded by swarm
+        std::shared_ptr<const uint8_t> data; // for the disk cache, null when it is skipped
+        size_t size = 0;
+    };
+    std::vector<KeptImage> keptImages_; // guarded by imagesMtx_
+    void keepFinishedImages();          // without imagesMtx_ held
+    bool reserveImageRx(PendingImage& p, uint64_t total);
+    void releaseImageRx(PendingImage& p);
+    // ---- streaming decode ----
+    static constexpr uint64_t kStreamDecodeMinBytes = 512 * 1024; // small images decode fast enough on commit
+    static constexpr size_t kMaxStreamDecoders = 2;              // one thread each, keep it bounded
+    void feedStreamingDecode(PendingImage& p);
+    MessageQueue<msg::ReadyMessage> inboundGame_; // decode shards -> GameTableManager
+    // ---- board prefetch ----
+    // After bootstrap the GM streams the table's other boards (and their markers) to each player
+    // on one low-priority worker: a chunk only goes out while no foreground image is being sent
+    // and the player's game channel is nearly drained. Whoever holds an image (prefetched or
+    // received before) gets ImageCached on a board switch instead of the chunks.
+    struct PrefetchJob
+    {
+        std::string peerId;
+        std::filesystem::path boardFile; // prefetch: board file to stream
+        uint64_t skipBoardId = 0;        // prefetch: the board the peer already got
+        msg::ImageOwnerKind kind{};      // resend / single image: which one
+        uint64_t id = 0;
+        uint64_t boardId = 0;
+        std::string imagePath; // single image (hidden marker art), prefetch queue only
+        std::shared_ptr<const std::vector<unsigned char>> bytes; // resend queue: already read, skip the file
+        bool checkDisk = false; // resend queue: hash, then ImageCachedByHash if the player has it on disk
+    };
+    struct PrefetchSent
+    {
+        msg::ImageOwnerKind kind{};
+        uint64_t size = 0;
+        std::string path;
+    };
+    static constexpr size_t kPrefetchMaxBuffered = 256 * 1024; // game DC backlog under which prefetch may send
+    mutable std::mutex prefetchMtx_;
+    std::condition_variable prefetchCv_;
+    std::deque<PrefetchJob> prefetchJobs_;
+    std::deque<PrefetchJob> resendJobs_; // served before any prefetch chunk
+    std::unordered_map<std::string, std::unordered_map<uint64_t, PrefetchSent>> prefetchSent_; // peer -> image id
+    std::unordered_set<std::string> upcomingBoards_;
+    std::unordered_map<std::string, std::unordered_set<uint64_t>> withheldMarkers_; // peer -> hidden markers sent as stubs
+    std::atomic<bool> prefetchHiddenArt_{false};
+    std::atomic<int> foregroundImageSends_{0};
+    std::atomic<bool> prefetchStop_{false};
+    std::thread prefetchWorker_;
+    ImagePrefetchCache prefetchCache_; // player side
+    void schedulePrefetch(const std::string& peerId, const std::vector<std::string>& boardFiles, bool front);
+    std::vector<std::string> prefetchBoardOrder(); // UI thread: the table's board files, upcoming first
+    void ensurePrefetchWorker();
+    void stopPrefetchWorker();
+    void prefetchLoop();
+    void prefetchBoardFile(const PrefetchJob& job);
+    bool prefetchImage(const std::string& peerId, msg::ImageOwnerKind kind, uint64_t id, const std::string& path);
+    bool waitPrefetchIdle(const std::string& peerId);
+    void serviceResends();
+    void resendImage(const PrefetchJob& job);
+    bool heldByPeer(const std::string& peerId, uint64_t id, uint64_t size, const std::string& path);
+    void rememberHeld(const std::vector<std::string>& peerIds, msg::ImageOwnerKind kind, uint64_t id, uint64_t size, const std::string& path);
+    void sendImageOrCached(msg::ImageOwnerKind kind, uint64_t id, uint64_t boardId, std::shared_ptr<const std::vector<unsigned char>> img, const std::string& path, const std::vector<std::string>& toPeerIds);
+    static std::string resolveImagePath(msg::ImageOwnerKind kind, const std::string& image_path);
+    std::vector<uint8_t> buildImagePrefetchChunkFrame(msg::ImageOwnerKind kind, uint64_t id, uint64_t total, uint64_t offset, const uint8_t* data, size_t len);
+    std::vector<uint8_t> buildImageCachedFrame(msg::ImageOwnerKind kind, uint64_t id);
+    std::vector<uint8_t> buildImageRequestFrame(msg::ImageOwnerKind kind, uint64_t boardId, uint64_t id);
+    void handleImagePrefetchChunk(const std::vector<uint8_t>& b, size_t& off);
+
+    // ---- chat image attachments ----
+    static constexpr int kChatThumbSide = 192;
+    static constexpr size_t kChatMediaChunk = 16 * 1024;
+    static constexpr size_t kChatMediaMaxBuffered = 256 * 1024; // per link: a thumbnail never waits behind more
+    static constexpr size_t kChatMediaHeldMax = 8;               // recent full images kept in memory to serve
+    struct ChatMediaJob
+    {
+        enum class Kind : uint8_t
+        {
+            Post,
+            Fetch,
+            Serve
+        };
+        Kind kind = Kind::Post;
+        std::string peerId; // Fetch: who to ask, Serve: who asked
+        msg::ChatImageRef ref;
+        uint64_t offset = 0; // Serve
+        uint64_t tableId = 0, groupId = 0, ts = 0;
+        std::set<std::string> toPeerIds;
+        bool broadcast = false;
+        std::string username, caption;
+        std::shared_ptr<const std::vector<uint8_t>> bytes; // Post
+    };
+    struct ChatMediaRx
+    {
+        uint64_t total = 0;
+        uint64_t received = 0; // chunks come in order on the channel
+        std::vector<uint8_t> buf;
+    };
+    std::mutex chatMediaMtx_;
+    std::condition_variable chatMediaCv_;
+    std::deque<ChatMediaJob> chatMediaJobs_;
+    std::unordered_map<std::string, ChatMediaRx> chatMediaRx_; // hash -> image we asked for
+    std::deque<std::pair<std::string, std::shared_ptr<const std::vector<uint8_t>>>> chatMediaHeld_; // worker only
+    bool chatMediaStop_ = false;
+    std::thread chatMediaWorker_;
+    void queueChatMediaJob(ChatMediaJob job);
+    void stopChatMediaWorker();
+    void chatMediaLoop();
+    void runChatMediaPost(const ChatMediaJob& job);
+    void runChatMediaFetch(const ChatMediaJob& job);
+    std::shared_ptr<const std::vector<uint8_t>> chatMediaBytes(const msg::ChatImageRef& ref);
+    void holdChatMedia(const msg::ChatImageRef& ref, std::shared_ptr<const std::vector<uint8_t>> bytes);
+    void decodeRawChatMediaBuffer(msg::PeerHandle fromPeer, const std::vector<uint8_t>& b);
+    void handleChatImageThumb(const std::vector<uint8_t>& b, size_t& off);
+    void handleChatImageRequest(const std::vector<uint8_t>& b, size_t& off);
+    void handleChatImageChunk(const std::vector<uint8_t>& b, size_t& off);
+    void handleImageCached(const std::vector<uint8_t>& b, size_t& off);
+    void handleImageRequest(const std::vector<uint8_t>& b, size_t& off);
+    // ---- disk image cache ----
+    // Players send the GM the content hashes in their ImageDiskCache when the game channel
+    // opens; the GM holds the bootstrap until that inventory lands (or kCacheInventoryWaitMs
+    // passes) and answers images the player already has with ImageCachedByHash.
+    static constexpr size_t kCacheInventoryMax = 2048; // 64KB of hashes, most recent first
+    static constexpr uint64_t kCacheInventoryWaitMs = 500;
+    struct HashMemo
+    {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        Sha256::Digest hash{};
+    };
+    std::unique_ptr<ImageDiskCache> diskCache_; // player side: made on the first connectToPeer, kept until shutdown
+    std::unordered_map<std::string, std::unordered_set<std::string>> diskHeld_; // GM: peer -> raw hashes it has on disk (prefetchMtx_)
+    std::unordered_map<std::string, uint64_t> inventoryWaitSince_;            // GM: peer -> first bootstrap attempt (prefetchMtx_)
+    std::mutex hashMemoMtx_;
+    std::unordered_map<std::string, HashMemo> hashMemo_; // GM: image path -> content hash
+    std::optional<Sha256::Digest> memoizedContentHash(const std::string& path, uint64_t size);
+    Sha256::Digest contentHashOf(const std::string& path, const std::vector<unsigned char>& img);
+    bool cacheInventoryReady(const std::string& peerId);
+    void sendCacheInventory(const std::string& peerId);
+    std::vector<uint8_t> buildImageCachedByHashFrame(msg::ImageOwnerKind kind, uint64_t id, const Sha256::Digest& hash);
+    void handleCacheInventory(const std::vector<uint8_t>& b, size_t& off);
+    void handleImageCachedByHash(const std::vector<uint8_t>& b, size_t& off);
+    void fillFromDiskCache(msg::ImageOwnerKind kind, uint64_t id, uint64_t boardId, const std::string& sender, std::vector<uint8_t> bytes);
+    // ---- swarm image distribution ----
+    // GM side keeps the bytes of swarmed images for a while: stalled players fall back to it,
+    // and after the hold they are re-read from the path on demand. The buffer is the one the
+    // board or marker send read, shared rather than copied.
+    struct SwarmSeed
+    {
+        msg::ImageOwnerKind kind{};
+        uint64_t total = 0;
+        std::string path;
+        std::shared_ptr<const std::vector<unsigned char>> bytes;
+        uint64_t lastUseMs = 0;
+        std::unordered_set<std::string> recipients; // got the manifest; nobody else is served pieces
+    };
+    static constexpr uint64_t kSwarmMinBytes = 1024 * 1024;         // smaller images aren't worth a manifest
+    static constexpr uint64_t kSwarmMaxBytes = 256ull * 1024 * 1024; // keeps the manifest in one message
+    static constexpr uint64_t kSwarmStallMs = 4000;                 // no new piece for this long: ask the GM
+    static constexpr uint64_t kSwarmSeedHoldMs = 120000;
+    mutable std::mutex swarmMtx_;
+    std::unordered_map<uint64_t, SwarmSeed> swarmSeeds_; // image id -> GM copy
+    // Hashing a manifest and pacing out the pieces runs on swarmWorker_, not the UI thread. The
+    // commit may reach a player before the manifest; the transfer finalizes once the pieces land.
+    struct SwarmSend
+    {
+        msg::ImageOwnerKind kind{};
+        uint64_t id = 0;
+        std::shared_ptr<const std::vector<unsigned char>> bytes;
+        std::vector<std::string> toPeerIds;
+    };
+    std::condition_variable swarmCv_;
+    std::deque<SwarmSend> swarmSends_; // guarded by swarmMtx_
+    std::atomic<bool> swarmStop_{false};
+    std::thread swarmWorker_;
+    // player side, guarded by imagesMtx_: requests that arrived before our own manifest
+    std::unordered_map<uint64_t, std::vector<std::pair<std::string, std::vector<uint32_t>>>> earlyPieceRequests_;
+    static constexpr size_t kMaxEarlyPieceRequests = 64;
+    // player side, guarded by imagesMtx_: the manifest's seeders per image, the only peers we serve
+    // its pieces to (the GM lists every recipient as a seeder)
+    std::unordered_map<uint64_t, std::unordered_set<std::string>> swarmPeers_;
+    static constexpr size_t kMaxSwarmPeers = 256;
+    SwarmStats swarmStats_;
+    std::atomic<bool> swarmImages_{true};
+    bool shouldSwarm(uint64_t size, const std::vector<std::string>& toPeerIds) const;
+    void sendImageSwarm(msg::ImageOwnerKind kind, uint64_t id, std::shared_ptr<const std::vector<unsigned char>> img, const std::string& path, const std::vector<std::string>& toPeerIds);
+    void stopSwarmWorker();
+    void swarmLoop();
+    void runSwarmSend(const SwarmSend& job);
+    std::shared_ptr<const std::vector<unsigned char>> swarmSeedBytes(msg::ImageOwnerKind kind, uint64_t id, uint64_t total);
+    std::vector<uint8_t> buildImageManifestFrame(msg::ImageOwnerKind kind, uint64_t id, const ImageManifest& m);
+    std::vector<uint8_t> buildImagePieceFrame(msg::ImageOwnerKind kind, uint64_t id, uint32_t index, const uint8_t* data, size_t len);
+    std::vector<uint8_t> buildPieceRequestFrame(msg::ImageOwnerKind kind, uint64_t id, uint64_t total, const std::vector<uint32_t>& indices);
+    void handleImageManifest(const std::vector<uint8_t>& b, size_t& off);
+    void handleImagePiece(const std::vector<uint8_t>& b, size_t& off);
+    void handlePieceRequest(const std::vector<uint8_t>& b, size_t& off);
+    // ---- inbound decode shards ----
+    // A peer always maps to the same shard (handle % count), so its messages decode in order;
+    // different peers decode in parallel.
+    struct DecodeShard
+    {
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<msg::InboundRaw> q;
+        std::atomic<uint64_t> decoded{0};
+        std::atomic<uint64_t> busyUs{0}; // time spent decoding, for comparing shards under load
+        std::thread worker;
+    };
+    static constexpr unsigned kMaxDecodeShards = 4;
+    std::vector<std::unique_ptr<DecodeShard>> shards_; // fixed once started
+    std::atomic<bool> shardsStop_{false};
+    void decodeShardLoop(DecodeShard& shard);
+    void routeInbound(msg::InboundRaw&& r);
+    // ---- capture / replay ----
+    static constexpr size_t kReplayMaxQueued = 4096; // fast replay waits for the shards past this
+    SessionRecorder recorder_;
+    std::unique_ptr<SessionReplayer> replayer_;
+    void decodeInbound(const msg::InboundRaw& r);
     // NetworkManager.h
     std::shared_ptr<IdentityManager> identity_manager;
     std::shared_ptr<ImGuiToaster> toaster_;
@@ -374,7 +865,6 @@ private:
     std::vector<uint8_t> buildCommitBoardFrame(uint64_t boardId);
 
     // ---- FOG UPDATE/DELETE ----
-    std::vector<unsigned char> buildFogUpdateFrame(uint64_t boardId, const flecs::entity& fog);
     std::vector<unsigned char> buildFogDeleteFrame(uint64_t boardId, uint64_t fogId);
 
     // Helpers used by reconnectPeer (thin wrappers around what you already have)
@@ -384,18 +874,77 @@ private:
 
     std::string myPeerId_;
     std::string gmPeerId_;
+    PeerRegistry peerRegistry_;
 
     flecs::world ecs;
+    std::unique_ptr<BoardChangeFeed> changeFeed_; // declared first: outlives its listeners below
+    std::unique_ptr<EntityDeltaTracker> deltaTracker_;
+
+    // ---- versioned resync ----
+    struct SeenState
+    {
+        uint64_t historyId = 0;
+        uint64_t boardId = 0;
+        uint64_t version = 0;
+    };
+    static constexpr uint64_t kStateVersionPeriodMs = 250;
+    std::unique_ptr<BoardVersions> boardVersions_; // GM side
+    std::mutex seenStateMtx_;
+    SeenState seenState_;                                    // player: last StateVersion from the GM
+    std::unordered_map<std::string, SeenState> resyncFrom_; // GM: peer -> version it reconnected with (prefetchMtx_)
+    SeenState lastVersionSent_;
+    uint64_t lastVersionSentMs_ = 0;
+    std::vector<uint8_t> buildStateVersionFrame(msg::DCType type, const SeenState& s);
+    void sendResyncRequest(const std::string& peerId);
+    bool sendBoardResync(const flecs::entity& board, const std::string& peerId, const SeenState& from);
+    void handleStateVersion(const std::vector<uint8_t>& b, size_t& off);
+    void handleResyncRequest(const std::vector<uint8_t>& b, size_t& off);
+
+    // ---- interest management ----
+    struct HeldBoard
+    {
+        flecs::entity_t entity = 0; // the board entity that was sent; a reloaded board goes out whole
+        uint64_t leftAt = 0;        // version when the peer stopped looking at it (0 = still looking)
+    };
+    struct PeerView
+    {
+        bool known = false; // false: never said, gets everything
+        uint64_t boardId = 0;
+        uint64_t pendingSwitch = 0;                      // GM: BoardSwitch sent, waiting for its BoardView
+        std::unordered_map<uint64_t, HeldBoard> held; // GM: boards the peer holds
+    };
+    std::unordered_map<std::string, PeerView> peerViews_;
+    mutable InterestStats interestStats_;
+    std::vector<unsigned char> buildBoardViewFrame(msg::DCType type, uint64_t boardId);
+    void sendBoardView(const std::string& peerId);
+    bool switchToHeldBoard(const flecs::entity& board, const std::string& peerId);
+    void handleBoardView(msg::DCType type, const std::vector<uint8_t>& b, size_t& off); // BoardView / BoardSwitch
+
+    // ---- board hash checks ----
+    static constexpr uint64_t kStateHashPeriodMs = 2000;
+    static constexpr size_t kMaxRepairBuckets = 16; // per StateHashLeaves, the rest waits for the next round
+    static constexpr uint64_t kDragQuietMs = 5000;  // a remote drag silent this long no longer holds checks back
+    std::unique_ptr<BoardStateHash> stateHash_;
+    uint64_t lastStateHashMs_ = 0;
+    uint64_t suspectBoard_ = 0;
+    uint64_t suspectBuckets_ = 0; // player: buckets that differed last check (bit per bucket)
+    StateHashStats stateHashStats_;
+    void handleStateHash(const std::vector<uint8_t>& b, size_t& off);
+    void handleStateHashLeaves(const std::vector<uint8_t>& b, size_t& off);
     unsigned int port = 8080;
     char network_password[124] = "\0";
-    std::string external_ip_address = "";
-    std::string local_ip_address = "";
-    Role peer_role;
+    std::shared_ptr<HostDiscovery> discovery_;
+    unsigned short upnpMappedPort_ = 0; // removed again in closeServer
+    std::atomic<Role> peer_role; // written on the UI thread, read by the decode shards too
+    const bool replaySandbox_;
 
     rtc::Configuration rtcConfig;
+    mutable std::mutex lanMtx_;
+    bool lanMode_ = false;
+    std::string lanBindAddress_;
     std::shared_ptr<SignalingServer> signalingServer;
     std::shared_ptr<SignalingClient> signalingClient;
-    std::unordered_map<std::string, std::shared_ptr<PeerLink>> peers;
+    PeerTable peers; // copy-on-write: readers iterate snapshots, connect/disconnect publish new versions
     std::weak_ptr<BoardManager> board_manager;
     std::weak_ptr<GameTableManager> gametable_manager;
 
@@ -15,6 +15,7 @@
 #include <Windows.h>
 
 #include <winhttp.h>
+#include <Psapi.h>
 
 #include <mutex>
 #include <condition_variable>
@@ -22,6 +23,7 @@
 #include <cstdlib> // for _putenv_s
 
 #include "Logger.h"
+#include "HostDiscovery.h"
 #include "rtc/peerconnection.hpp" 
 
 class NetworkUtilities
@@ -81,6 +83,17 @@ public:
         }
     }
 
+    // Current / peak working set of this process, in bytes
+    static bool getProcessMemory(size_t& rssBytes, size_t& peakRssBytes)
+    {
+        PROCESS_MEMORY_COUNTERS pmc{};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+            return false;
+        rssBytes = pmc.WorkingSetSize;
+        peakRssBytes = pmc.PeakWorkingSetSize;
+        return true;
+    }
+
     static std::string runCommand(const std::string& cmd)
     {
         std::array<char, 128> buffer;
@@ -155,51 +168,19 @@ public:
         return result;
     }
 
-    static std::string getLocalIPv4Address()
+    // RFC 1918, loopback and link-local: peers we can reach without STUN
+    static bool isPrivateIPv4(const std::string& ip)
     {
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
-        {
-            throw std::runtime_error("WSAStartup failed");
-        }
-
-        // Create a UDP socket (does not actually send packets)
-        SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-        if (sock == INVALID_SOCKET)
-        {
-            WSACleanup();
-            throw std::runtime_error("socket creation failed");
-        }
-
-        sockaddr_in remote{};
-        remote.sin_family = AF_INET;
-        remote.sin_port = htons(53);                     // DNS port
-        inet_pton(AF_INET, "8.8.8.8", &remote.sin_addr); // Google DNS
-
-        // Connect sets the default route for this socket
-        if (connect(sock, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) != 0)
-        {
-            closesocket(sock);
-            WSACleanup();
-            throw std::runtime_error("connect failed");
-        }
-
-        sockaddr_in local{};
-        int len = sizeof(local);
-        if (getsockname(sock, reinterpret_cast<sockaddr*>(&local), &len) != 0)
-        {
-            closesocket(sock);
-            WSACleanup();
-            throw std::runtime_error("getsockname failed");
-        }
-
-        char ipStr[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &local.sin_addr, ipStr, sizeof(ipStr));
-
-        closesocket(sock);
-        WSACleanup();
+        return netif::isPrivateIPv4(ip);
+    }
 
-        return std::string(ipStr);
+    // local address of the interface the OS would route `toward` through (default: Internet)
+    static std::string getLocalIPv4Address(const char* toward = "8.8.8.8")
+    {
+        auto ip = netif::routeIPv4(toward);
+        if (ip.empty())
+            throw std::runtime_error(std::string("no route toward ") + toward);
+        return ip;
     }
 
     // helper: normalize URL for libdatachannel
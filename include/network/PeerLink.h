@@ -1,7 +1,12 @@
 #pragma once
 #include <rtc/rtc.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <mutex>
 #include <string>
+#include "Message.h"
 
 class NetworkManager; // forward declare
 
@@ -11,6 +16,29 @@ public:
     PeerLink(const std::string& id, std::weak_ptr<NetworkManager> parent);
     PeerLink();
 
+    // Connection setup phases, stamped once as ms since the link was created (0 = not reached)
+    enum class Phase : uint8_t
+    {
+        LocalSdp,     // our offer/answer created
+        Gathered,     // local ICE gathering complete
+        RemoteSdp,    // their offer/answer applied
+        IceConnected, // PC connected
+        DcOpen,       // Game channel open
+        Bootstrap,    // GM: snapshot sent, player: first board committed
+        Count
+    };
+    static const char* phaseName(Phase p);
+    void markPhase(Phase p);
+    uint64_t phaseMs(Phase p) const
+    {
+        return phaseMs_[static_cast<size_t>(p)].load(std::memory_order_relaxed);
+    }
+    bool lanMode() const
+    {
+        return lanMode_;
+    }
+    std::string phaseSummary() const; // "sdp 12 | gather 3 | ... ms"
+
     void close();
 
     void createChannels(); // creates Intent, State, Snapshot, Chat (as offerer)
@@ -29,6 +57,7 @@ public:
     bool sendChat(const std::vector<uint8_t>& bytes);
     bool sendNote(const std::vector<uint8_t>& bytes);
     bool sendMarkerMove(const std::vector<uint8_t>& bytes);
+    bool sendChatMedia(const std::vector<uint8_t>& bytes);
     void sendChatJson(const std::string& jsonText);
 
     void setDisplayName(std::string n);
@@ -38,6 +67,7 @@ public:
     void attachMarkerMoveChannelHandlers(const std::shared_ptr<rtc::DataChannel>& ch, const std::string& label);
 
     bool isDataChannelOpen() const;
+    size_t bufferedAmount(const std::string& label) const; // bytes queued on that channel (NetSim included), 0 if none
     rtc::PeerConnection::State pcState() const; // optional
     const char* pcStateString() const;
     bool isClosedOrFailed() const;
@@ -55,6 +85,7 @@ public:
     //static constexpr size_t kMaxBufferedBytes = 5 /*MB*/ * 1024 * 1024; //(tune as you like)
     void setOpen(std::string label, bool open)
     {
+        std::lock_guard<std::mutex> lk(dcsMtx_);
         dcOpen_[label] = open;
     }
 
@@ -76,12 +107,21 @@ public:
     {
         return pc;
     }
+    msg::PeerHandle handle() const
+    {
+        return handle_;
+    }
 
 private:
+    void setChannel(const std::string& label, std::shared_ptr<rtc::DataChannel> ch);
+    std::shared_ptr<rtc::DataChannel> channel(const std::string& label) const;
+
     std::string peerId;
+    msg::PeerHandle handle_ = msg::kNoPeer; // interned peerId, tags everything this link receives
     std::string displayName_;
     std::shared_ptr<rtc::PeerConnection> pc;
     //std::shared_ptr<rtc::DataChannel> dc;
+    mutable std::mutex dcsMtx_; // dcs_ and dcOpen_
     std::unordered_map<std::string, std::shared_ptr<rtc::DataChannel>> dcs_;
     std::atomic<bool> closing_{false};
     std::weak_ptr<NetworkManager> network_manager;
@@ -96,6 +136,10 @@ private:
     bool bootstrapSent_ = false;
     std::unordered_map<std::string, bool> dcOpen_;
 
+    bool lanMode_ = false;
+    std::chrono::steady_clock::time_point createdAt_ = std::chrono::steady_clock::now();
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Phase::Count)> phaseMs_{};
+
     //// internal handler dispatch (called from each dc->onMessage)
     //void onIntentMessage(const std::vector<uint8_t>& bytes);
     //void onStateMessage(const std::vector<uint8_t>& bytes);
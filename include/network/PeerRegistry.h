@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Message.h"
+
+// Interns transport peer ids into small integer handles (msg::PeerHandle) so the inbound
+// dispatch path (InboundRaw -> ReadyMessage -> drag ownership/coalescing) never carries or
+// hashes strings. A handle keeps meaning the same peer id for the whole session, even after
+// the peer disconnected, so queued messages and DragState may hold on to it.
+// Handle 0 is msg::kNoPeer, handle 1 is msg::kSelfPeer (this client, whatever its peer id is now).
+class PeerRegistry
+{
+public:
+    PeerRegistry()
+    {
+        entries_.resize(2); // kNoPeer, kSelfPeer
+    }
+
+    // existing handle for peerId, or a new one
+    msg::PeerHandle intern(const std::string& peerId)
+    {
+        {
+            std::shared_lock<std::shared_mutex> lk(mtx_);
+            if (auto it = byPeerId_.find(peerId); it != byPeerId_.end())
+                return it->second;
+        }
+        std::unique_lock<std::shared_mutex> lk(mtx_);
+        if (auto it = byPeerId_.find(peerId); it != byPeerId_.end())
+            return it->second;
+        const auto h = static_cast<msg::PeerHandle>(entries_.size());
+        entries_.push_back(Entry{peerId, {}});
+        byPeerId_.emplace(peerId, h);
+        return h;
+    }
+
+    // msg::kNoPeer when the id was never interned
+    msg::PeerHandle find(const std::string& peerId) const
+    {
+        std::shared_lock<std::shared_mutex> lk(mtx_);
+        auto it = byPeerId_.find(peerId);
+        return it == byPeerId_.end() ? msg::kNoPeer : it->second;
+    }
+
+    // kSelfPeer resolves to the id set through setSelfPeerId
+    std::string peerId(msg::PeerHandle h) const
+    {
+        std::shared_lock<std::shared_mutex> lk(mtx_);
+        return h < entries_.size() ? entries_[h].peerId : std::string{};
+    }
+
+    std::string uniqueId(msg::PeerHandle h) const
+    {
+        std::shared_lock<std::shared_mutex> lk(mtx_);
+        return h < entries_.size() ? entries_[h].uniqueId : std::string{};
+    }
+
+    void setUniqueId(msg::PeerHandle h, const std::string& uniqueId)
+    {
+        std::unique_lock<std::shared_mutex> lk(mtx_);
+        if (h != msg::kNoPeer && h < entries_.size())
+            entries_[h].uniqueId = uniqueId;
+    }
+
+    void setSelfPeerId(const std::string& peerId)
+    {
+        std::unique_lock<std::shared_mutex> lk(mtx_);
+        entries_[msg::kSelfPeer].peerId = peerId;
+    }
+
+    size_t size() const
+    {
+        std::shared_lock<std::shared_mutex> lk(mtx_);
+        return entries_.size() - 2;
+    }
+
+private:
+    struct Entry
+    {
+        std::string peerId;
+        std::string uniqueId; // filled once the peer announced it (UserNameUpdate)
+    };
+
+    mutable std::shared_mutex mtx_;
+    std::vector<Entry> entries_; // indexed by handle, never shrinks
+    std::unordered_map<std::string, msg::PeerHandle> byPeerId_;
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class PeerLink;
+
+// Copy-on-write peer table. Readers (broadcasts on the UI thread, lookups, PeerLink callbacks
+// on libdatachannel threads) take the current immutable version and iterate it without touching
+// the writer mutex; connects/disconnects copy the map, change the copy and publish it.
+// A table holds a handful of players, so one map copy per membership change is nothing.
+class PeerTable
+{
+public:
+    using Map = std::unordered_map<std::string, std::shared_ptr<PeerLink>>;
+
+    // Keeps one published version alive; safe to iterate while the table keeps changing.
+    class Snapshot
+    {
+    public:
+        explicit Snapshot(std::shared_ptr<const Map> map) :
+            map_(std::move(map)) {}
+
+        Map::const_iterator begin() const
+        {
+            return map_->begin();
+        }
+        Map::const_iterator end() const
+        {
+            return map_->end();
+        }
+        Map::const_iterator find(const std::string& peerId) const
+        {
+            return map_->find(peerId);
+        }
+        size_t size() const
+        {
+            return map_->size();
+        }
+        bool empty() const
+        {
+            return map_->empty();
+        }
+
+    private:
+        std::shared_ptr<const Map> map_;
+    };
+
+    PeerTable() :
+        current_(std::make_shared<const Map>()) {}
+
+    PeerTable(const PeerTable&) = delete;
+    PeerTable& operator=(const PeerTable&) = delete;
+
+    Snapshot snapshot() const
+    {
+        return Snapshot(current_.load(std::memory_order_acquire));
+    }
+
+    std::shared_ptr<PeerLink> find(const std::string& peerId) const
+    {
+        auto snap = current_.load(std::memory_order_acquire);
+        auto it = snap->find(peerId);
+        return it == snap->end() ? nullptr : it->second;
+    }
+
+    bool empty() const
+    {
+        return current_.load(std::memory_order_acquire)->empty();
+    }
+    size_t size() const
+    {
+        return current_.load(std::memory_order_acquire)->size();
+    }
+    uint64_t version() const
+    {
+        return version_.load(std::memory_order_relaxed);
+    }
+
+    // ---- writers (serialized) ----
+
+    // existing link for peerId, or make() inserted as a new version
+    template <class Make>
+    std::shared_ptr<PeerLink> findOrInsert(const std::string& peerId, Make&& make)
+    {
+        std::lock_guard<std::mutex> lk(writeMtx_);
+        auto cur = current_.load(std::memory_order_acquire);
+        if (auto it = cur->find(peerId); it != cur->end())
+            return it->second;
+        auto link = make();
+        auto next = std::make_shared<Map>(*cur);
+        next->emplace(peerId, link);
+        publish(std::move(next));
+        return link;
+    }
+
+    // false if peerId was not in the table; `removed` gets the link so the caller can close it
+    bool erase(const std::string& peerId, std::shared_ptr<PeerLink>& removed)
+    {
+        std::lock_guard<std::mutex> lk(writeMtx_);
+        auto cur = current_.load(std::memory_order_acquire);
+        auto it = cur->find(peerId);
+        if (it == cur->end())
+            return false;
+        removed = it->second;
+        auto next = std::make_shared<Map>(*cur);
+        next->erase(peerId);
+        publish(std::move(next));
+        return true;
+    }
+
+    // removes every entry pred(peerId, link) accepts, in one new version
+    template <class Pred>
+    std::vector<std::pair<std::string, std::shared_ptr<PeerLink>>> eraseIf(Pred&& pred)
+    {
+        std::vector<std::pair<std::string, std::shared_ptr<PeerLink>>> removed;
+        std::lock_guard<std::mutex> lk(writeMtx_);
+        auto cur = current_.load(std::memory_order_acquire);
+        for (const auto& [pid, link] : *cur)
+            if (pred(pid, link))
+                removed.emplace_back(pid, link);
+        if (removed.empty())
+            return removed;
+        auto next = std::make_shared<Map>(*cur);
+        for (const auto& [pid, link] : removed)
+            next->erase(pid);
+        publish(std::move(next));
+        return removed;
+    }
+
+    // empties the table, returns what was in it
+    Map takeAll()
+    {
+        std::lock_guard<std::mutex> lk(writeMtx_);
+        Map old = *current_.load(std::memory_order_acquire);
+        publish(std::make_shared<Map>());
+        return old;
+    }
+
+private:
+    void publish(std::shared_ptr<Map> next)
+    {
+        current_.store(std::shared_ptr<const Map>(std::move(next)), std::memory_order_release);
+        version_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::mutex writeMtx_;
+    std::atomic<std::shared_ptr<const Map>> current_;
+    std::atomic<uint64_t> version_{0};
+};
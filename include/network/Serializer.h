@@ -5,7 +5,9 @@
 #include <glm/glm.hpp>
 #include <iostream>
 #include <cstring>      // For memcpy
+#include <algorithm>
 #include "Components.h" // Include your components header
+#include "EntityBulk.h"
 
 class Serializer
 {
@@ -64,6 +66,10 @@ public:
     static void serializeMarkerEntity(std::vector<unsigned char>& buffer, const flecs::entity entity, flecs::world& ecs);
     static flecs::entity deserializeMarkerEntity(const std::vector<unsigned char>& buffer, size_t& offset, flecs::world& ecs);
 
+    // Read one marker/fog record into bulk staging rows (see EntityBulk.h)
+    static void deserializeMarkerRow(const std::vector<unsigned char>& buffer, size_t& offset, MarkerRows& rows);
+    static void deserializeFogRow(const std::vector<unsigned char>& buffer, size_t& offset, FogRows& rows);
+
     static void serializeFogEntity(std::vector<unsigned char>& buffer, const flecs::entity entity, flecs::world& ecs);
     static flecs::entity deserializeFogEntity(const std::vector<unsigned char>& buffer, size_t& offset, flecs::world& ecs);
 
@@ -72,6 +78,21 @@ public:
 
     static void serializeBoardEntity(std::vector<unsigned char>& buffer, const flecs::entity entity, flecs::world& ecs);
     static flecs::entity deserializeBoardEntity(const std::vector<unsigned char>& buffer, size_t& offset, flecs::world& ecs);
+
+    // Image paths of a saved board, read without creating entities (safe off the UI thread)
+    struct MarkerImageRef
+    {
+        uint64_t markerId = 0;
+        std::string imagePath;
+        bool visible = true;
+    };
+    struct BoardImageRefs
+    {
+        uint64_t boardId = 0;
+        std::string boardImage;
+        std::vector<MarkerImageRef> markerImages;
+    };
+    static BoardImageRefs scanBoardImages(const std::vector<unsigned char>& buffer, size_t& offset);
 };
 
 // Serialize and Deserialize MarkerEntity
@@ -94,9 +115,8 @@ inline void Serializer::serializeMarkerEntity(std::vector<unsigned char>& buffer
     serializeMarkerComponent(buffer, marker_component);
 }
 
-inline flecs::entity Serializer::deserializeMarkerEntity(const std::vector<unsigned char>& buffer, size_t& offset, flecs::world& ecs)
+inline void Serializer::deserializeMarkerRow(const std::vector<unsigned char>& buffer, size_t& offset, MarkerRows& rows)
 {
-
     uint64_t marker_id = Serializer::deserializeUInt64(buffer, offset);
     auto position = deserializePosition(buffer, offset);
     auto size = deserializeSize(buffer, offset);
@@ -104,16 +124,15 @@ inline flecs::entity Serializer::deserializeMarkerEntity(const std::vector<unsig
     auto visibility = deserializeVisibility(buffer, offset);
     auto texture = deserializeTextureComponent(buffer, offset);
     auto marker_component = deserializeMarkerComponent(buffer, offset);
-    auto marker = ecs.entity()
-                      .set<Identifier>({marker_id})
-                      .set<Position>(position)
-                      .set<Size>(size)
-                      .set<Moving>(moving)
-                      .set<Visibility>(visibility)
-                      .set<MarkerComponent>(marker_component)
-                      .set<TextureComponent>({0, texture.image_path, texture.size});
+    rows.push(Identifier{marker_id}, position, size, TextureComponent{0, std::move(texture.image_path), texture.size},
+              visibility, std::move(marker_component), moving);
+}
 
-    return marker;
+inline flecs::entity Serializer::deserializeMarkerEntity(const std::vector<unsigned char>& buffer, size_t& offset, flecs::world& ecs)
+{
+    MarkerRows rows;
+    deserializeMarkerRow(buffer, offset, rows);
+    return EntityBulk::spawnMarkers(ecs, rows, flecs::entity()).front();
 }
 
 // Serialize and Deserialize FogEntity
@@ -130,21 +149,20 @@ inline void Serializer::serializeFogEntity(std::vector<unsigned char>& buffer, c
     serializeVisibility(buffer, visibility);
 }
 
-inline flecs::entity Serializer::deserializeFogEntity(const std::vector<unsigned char>& buffer, size_t& offset, flecs::world& ecs)
+inline void Serializer::deserializeFogRow(const std::vector<unsigned char>& buffer, size_t& offset, FogRows& rows)
 {
-
     uint64_t fog_id = Serializer::deserializeUInt64(buffer, offset);
     auto position = deserializePosition(buffer, offset);
     auto size = deserializeSize(buffer, offset);
     auto visibility = deserializeVisibility(buffer, offset);
+    rows.push(Identifier{fog_id}, position, size, visibility);
+}
 
-    auto fog = ecs.entity()
-                   .set<Identifier>({fog_id})
-                   .set<Position>(position)
-                   .set<Size>(size)
-                   .set<Visibility>(visibility);
-
-    return fog;
+inline flecs::entity Serializer::deserializeFogEntity(const std::vector<unsigned char>& buffer, size_t& offset, flecs::world& ecs)
+{
+    FogRows rows;
+    deserializeFogRow(buffer, offset, rows);
+    return EntityBulk::spawnFog(ecs, rows, flecs::entity()).front();
 }
 
 inline void Serializer::serializeGameTableEntity(std::vector<unsigned char>& buffer, const flecs::entity entity, flecs::world& ecs)
@@ -259,27 +277,50 @@ inline flecs::entity Serializer::deserializeBoardEntity(const std::vector<unsign
                         .set<TextureComponent>({0, texture.image_path, texture.size})
                         .set<Size>(size);
 
-    // Deserialize markers
+    // Markers and fog are read into rows first and created in one bulk insert each
     int markerCount = Serializer::deserializeInt(buffer, offset);
+    MarkerRows markers;
+    markers.reserve(static_cast<size_t>(std::max(markerCount, 0)));
     for (int i = 0; i < markerCount; ++i)
-    {
-        auto marker = deserializeMarkerEntity(buffer, offset, ecs);
-        marker.add<MarkerComponent>();
-        marker.add(flecs::ChildOf, newBoard);
-    }
+        deserializeMarkerRow(buffer, offset, markers);
+    EntityBulk::spawnMarkers(ecs, markers, newBoard);
 
-    // Deserialize fog entities
     int fogCount = Serializer::deserializeInt(buffer, offset);
+    FogRows fog;
+    fog.reserve(static_cast<size_t>(std::max(fogCount, 0)));
     for (int i = 0; i < fogCount; ++i)
-    {
-        auto fog = deserializeFogEntity(buffer, offset, ecs);
-        fog.add<FogOfWar>();
-        fog.add(flecs::ChildOf, newBoard);
-    }
+        deserializeFogRow(buffer, offset, fog);
+    EntityBulk::spawnFog(ecs, fog, newBoard);
 
     return newBoard;
 }
 
+inline Serializer::BoardImageRefs Serializer::scanBoardImages(const std::vector<unsigned char>& buffer, size_t& offset)
+{
+    BoardImageRefs refs;
+    refs.boardId = Serializer::deserializeUInt64(buffer, offset);
+    (void)Serializer::deserializeBoard(buffer, offset);
+    (void)Serializer::deserializePanning(buffer, offset);
+    (void)Serializer::deserializeGrid(buffer, offset);
+    refs.boardImage = Serializer::deserializeTextureComponent(buffer, offset).image_path;
+    (void)Serializer::deserializeSize(buffer, offset);
+
+    // same layout as deserializeMarkerEntity
+    int markerCount = Serializer::deserializeInt(buffer, offset);
+    for (int i = 0; i < markerCount; ++i)
+    {
+        uint64_t marker_id = Serializer::deserializeUInt64(buffer, offset);
+        (void)deserializePosition(buffer, offset);
+        (void)deserializeSize(buffer, offset);
+        (void)deserializeMoving(buffer, offset);
+        auto visibility = deserializeVisibility(buffer, offset);
+        auto texture = deserializeTextureComponent(buffer, offset);
+        (void)deserializeMarkerComponent(buffer, offset);
+        refs.markerImages.push_back(MarkerImageRef{marker_id, texture.image_path, visibility.isVisible});
+    }
+    return refs;
+}
+
 // Implementation
 inline void Serializer::serializeMarkerComponent(std::vector<unsigned char>& b, const MarkerComponent* marker_component)
 {
@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "Message.h"
+#include "PeerRegistry.h"
+
+// Inbound session capture, taken where PeerLink::onMessage hands a message to NetworkManager.
+// File layout (little endian):
+//   "RVTCAP01"
+//   [kind:u8=Peer][handle:u32][len:u16][peerId]                        once per sender
+//   [kind:u8=Message][tUs:u64][handle:u32][channel:u8][len:u32][bytes]  tUs since capture start
+namespace capture
+{
+    inline constexpr char kMagic[8] = {'R', 'V', 'T', 'C', 'A', 'P', '0', '1'};
+    // libdatachannel's default max message size (PeerLink doesn't raise it): no recorded frame is
+    // larger, so a longer record means a corrupt file
+    inline constexpr uint32_t kMaxMessageBytes = 256 * 1024;
+
+    enum class RecordKind : uint8_t
+    {
+        Peer = 1,
+        Message = 2
+    };
+} // namespace capture
+
+class SessionRecorder
+{
+public:
+    ~SessionRecorder()
+    {
+        stop();
+    }
+
+    bool start(const std::filesystem::path& file);
+    void stop();
+    bool isRecording() const
+    {
+        return recording_.load(std::memory_order_acquire);
+    }
+
+    // any thread
+    void record(const msg::InboundRaw& r, const PeerRegistry& peers);
+
+    uint64_t messages() const
+    {
+        return messages_.load(std::memory_order_relaxed);
+    }
+    uint64_t bytes() const
+    {
+        return bytes_.load(std::memory_order_relaxed);
+    }
+    std::filesystem::path path() const
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        return path_;
+    }
+
+private:
+    mutable std::mutex mtx_;
+    std::ofstream out_;
+    std::filesystem::path path_;
+    std::chrono::steady_clock::time_point t0_;
+    std::unordered_set<msg::PeerHandle> introduced_;
+    std::atomic<bool> recording_{false};
+    std::atomic<uint64_t> messages_{0};
+    std::atomic<uint64_t> bytes_{0};
+};
+
+// Streams a capture file back into a sink on its own thread, either as fast as the sink
+// takes it or spaced out like the original session.
+class SessionReplayer
+{
+public:
+    using Sink = std::function<void(const std::string& peerId, msg::dc::Channel channel, std::vector<uint8_t>&& bytes)>;
+
+    SessionReplayer(std::filesystem::path file, bool realtime, Sink sink);
+    ~SessionReplayer(); // stops + joins
+
+    SessionReplayer(const SessionReplayer&) = delete;
+    SessionReplayer& operator=(const SessionReplayer&) = delete;
+
+    bool done() const
+    {
+        return done_.load(std::memory_order_acquire);
+    }
+    bool failed() const
+    {
+        return failed_.load(std::memory_order_acquire);
+    }
+    uint64_t fed() const
+    {
+        return fed_.load(std::memory_order_relaxed);
+    }
+    double progress() const; // 0..1 of the file
+    double elapsedMs() const;
+
+private:
+    void run();
+
+    std::filesystem::path file_;
+    bool realtime_;
+    Sink sink_;
+
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> done_{false};
+    std::atomic<bool> failed_{false};
+    std::atomic<uint64_t> fed_{0};
+    std::atomic<uint64_t> readBytes_{0};
+    std::atomic<double> elapsedMs_{0.0};
+    uint64_t fileBytes_ = 0;
+    std::chrono::steady_clock::time_point started_;
+    std::thread worker_;
+};
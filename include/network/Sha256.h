@@ -0,0 +1,57 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <openssl/evp.h>
+
+// SHA-256 through OpenSSL's libcrypto (already linked for libdatachannel), used to verify image
+// pieces relayed between players and to name the disk cache's files.
+struct Sha256
+{
+    using Digest = std::array<uint8_t, 32>;
+
+    static Digest of(const uint8_t* data, size_t len)
+    {
+        Digest d{};
+        EVP_Digest(data, len, d.data(), nullptr, EVP_sha256(), nullptr);
+        return d;
+    }
+
+    // Lowercase hex, as sent in chat image refs and used for the disk cache's file names.
+    static std::string toHex(const Digest& d)
+    {
+        static const char* digits = "0123456789abcdef";
+        std::string s;
+        s.reserve(d.size() * 2);
+        for (uint8_t c : d)
+        {
+            s.push_back(digits[c >> 4]);
+            s.push_back(digits[c & 0xF]);
+        }
+        return s;
+    }
+
+    static bool fromHex(std::string_view s, Digest& out)
+    {
+        if (s.size() != out.size() * 2)
+            return false;
+        auto nibble = [](char c) -> int
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            return -1;
+        };
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            const int hi = nibble(s[i * 2]), lo = nibble(s[i * 2 + 1]);
+            if (hi < 0 || lo < 0)
+                return false;
+            out[i] = static_cast<uint8_t>((hi << 4) | lo);
+        }
+        return true;
+    }
+};
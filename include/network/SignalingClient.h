@@ -2,6 +2,9 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include "rtc/rtc.hpp"
 
 class NetworkManager;
@@ -16,7 +19,16 @@ public:
     void onMessage(const std::string& msg);
     void close();
 
+    // ws open -> AuthResponse ok of the current connection, 0 until authed
+    uint64_t authMs() const
+    {
+        return authMs_.load(std::memory_order_relaxed);
+    }
+
 private:
+    std::chrono::steady_clock::time_point connectStartedAt_;
+    std::atomic<uint64_t> authMs_{0};
+
     std::shared_ptr<rtc::WebSocket> ws;
     std::weak_ptr<NetworkManager> network_manager;
 };
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "Message.h"
+
+// Decodes one incoming image on its own thread while the chunks are still arriving.
+// handleImageChunk writes into the PendingImage spool and calls feed() with the contiguous
+// byte count; stb pulls through read callbacks and blocks until more bytes land.
+// JPEG decodes scanline by scanline as data comes in; PNG at least gathers/parses IDAT on the
+// worker. Anything else (or a failed decode) falls back to the TextureStreamer decode pool on commit.
+class StreamingImageDecoder
+{
+public:
+    // `data` must stay valid (and not move) until this object is destroyed
+    StreamingImageDecoder(const uint8_t* data, size_t total);
+    ~StreamingImageDecoder(); // aborts + joins
+
+    StreamingImageDecoder(const StreamingImageDecoder&) = delete;
+    StreamingImageDecoder& operator=(const StreamingImageDecoder&) = delete;
+
+    static bool canStream(const uint8_t* head, size_t n);
+
+    void feed(size_t available);
+    bool done() const
+    {
+        return done_.load(std::memory_order_acquire);
+    }
+    bool succeeded() const
+    {
+        return done() && decoded_.rgba != nullptr;
+    }
+    msg::DecodedImage take()
+    {
+        return std::move(decoded_);
+    }
+
+private:
+    static int readCb(void* user, char* out, int size);
+    static void skipCb(void* user, int n);
+    static int eofCb(void* user);
+    void run();
+
+    const uint8_t* data_;
+    size_t total_;
+    size_t pos_ = 0; // worker-side read cursor
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    size_t available_ = 0;
+    bool abort_ = false;
+
+    std::atomic<bool> done_{false};
+    msg::DecodedImage decoded_;
+    std::thread worker_;
+};
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+// The few texture calls the shared managers make (DirectoryWindow, BoardManager, TextureStreamer).
+// The desktop build links the GL version (GpuTexturesGL.cpp); RunicVTTHost links a stand-in
+// (headless/GpuTexturesNull.cpp) that hands out ids without a context, so the core library needs
+// no GLEW or opengl32. Ids are GLuint values. GL thread only.
+namespace GpuTextures
+{
+    // RGBA8, linear filtering, clamped. `rgba` may be null to only allocate the storage.
+    unsigned int create(int width, int height, const uint8_t* rgba);
+    // Replaces the storage of an existing texture with width x height, contents undefined.
+    void allocate(unsigned int tex, int width, int height);
+    // Tightly packed RGBA8 rows [y, y + rows).
+    void uploadRows(unsigned int tex, int y, int width, int rows, const uint8_t* rgba);
+    void destroy(unsigned int tex);
+} // namespace GpuTextures
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU-only helpers for chat attachments (no GL): a small JPEG preview of an encoded image, and
+// PNG encoding for bitmaps that arrive without a file (a pasted screenshot). Any thread.
+class ImageThumbnail
+{
+public:
+    struct Result
+    {
+        int width = 0; // of the source image
+        int height = 0;
+        std::vector<uint8_t> jpeg;
+    };
+
+    // False when stb can't decode the bytes.
+    static bool make(const uint8_t* data, size_t len, int maxSide, Result& out);
+
+    // Empty on failure.
+    static std::vector<uint8_t> encodePng(const uint8_t* rgba, int width, int height);
+};
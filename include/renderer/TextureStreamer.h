@@ -0,0 +1,103 @@
+#pragma once
+#include <GL/glew.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "glm/glm.hpp"
+
+// Off-thread decode + time-budgeted GL upload for textures that arrive over the network.
+// request*() hands back a 1x1 placeholder texture right away; the same texture id gets the
+// real image once a decode worker produced the RGBA and pump() (GL thread, once per frame)
+// streamed it in with glTexSubImage2D bands until the frame budget ran out. onReady runs on the
+// GL thread either way; with ok == false the decode failed and the placeholder is all there is.
+class TextureStreamer
+{
+public:
+    using ReadyFn = std::function<void(GLuint tex, glm::vec2 size, bool ok)>;
+
+    explicit TextureStreamer(size_t workers = 2);
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // encoded image bytes (png/jpg/...), decoded on a worker
+    GLuint requestFromBytes(std::vector<uint8_t> bytes, ReadyFn onReady);
+    // encoded bytes owned elsewhere (a mapped spool file); `data` keeps them alive until decoded
+    GLuint requestFromView(std::shared_ptr<const uint8_t> data, size_t size, ReadyFn onReady);
+    // already decoded RGBA8, goes straight to the upload stage
+    GLuint requestFromPixels(std::shared_ptr<uint8_t> rgba, int width, int height, ReadyFn onReady);
+
+    // GL thread only
+    void pump(double budgetMs);
+    // Drops whatever is still pending for a texture from request*() and deletes it; its onReady
+    // never runs. GL thread only. Use this rather than glDeleteTextures on a streamed texture.
+    void release(GLuint tex);
+
+    size_t pendingDecodes() const;
+    size_t pendingUploads() const
+    {
+        return uploads_.size();
+    }
+    double lastPumpMs() const
+    {
+        return lastPumpMs_;
+    }
+    double maxPumpMs() const
+    {
+        return maxPumpMs_;
+    }
+
+private:
+    struct DecodeJob
+    {
+        GLuint tex = 0;
+        uint64_t gen = 0;
+        std::shared_ptr<const uint8_t> data;
+        size_t size = 0;
+        ReadyFn onReady;
+    };
+
+    struct UploadJob
+    {
+        GLuint tex = 0;
+        uint64_t gen = 0;
+        int width = 0;
+        int height = 0;
+        std::shared_ptr<uint8_t> rgba;
+        ReadyFn onReady;
+        int nextRow = 0;
+        bool storageAllocated = false;
+        bool failed = false; // decode failed, only onReady is left to run
+    };
+
+    GLuint createPlaceholder(uint64_t& gen);
+    bool current(const UploadJob& job) const;
+    void workerLoop();
+    bool uploadSome(UploadJob& job, double deadlineMs);
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<DecodeJob> decodeQ_;
+    std::deque<UploadJob> decoded_; // workers -> GL thread
+    size_t decoding_ = 0;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+
+    // GL thread only. A texture id freed and handed out again gets a new generation, so work
+    // queued for the old owner can't land in it.
+    std::deque<UploadJob> uploads_;
+    std::unordered_map<GLuint, uint64_t> live_; // texture -> generation of its pending request
+    uint64_t nextGen_ = 0;
+    double lastPumpMs_ = 0.0;
+    double maxPumpMs_ = 0.0;
+
+    static constexpr int kBandBytes = 1024 * 1024; // ~1 MB per glTexSubImage2D call
+};
@@ -7,6 +7,8 @@
 #include "FirewallUtils.h"
 #include "AssetIO.h"
 #include <chrono>
+#include <ctime>
+#include <filesystem>
 #include <string>
 
 ApplicationHandler::ApplicationHandler(GLFWwindow* window, std::shared_ptr<DirectoryWindow> map_directory, std::shared_ptr<DirectoryWindow> marker_directory) :
@@ -45,6 +47,57 @@ ApplicationHandler::ApplicationHandler(GLFWwindow* window, std::shared_ptr<Direc
     //ecs.component<ToolComponent>();
     DebugActions::RegisterToasterToggles(toaster_);
     DebugActions::RegisterAllDefaultToggles();
+    DebugActions::RegisterInboundOverlayToggle(
+        [gtm = std::weak_ptr<GameTableManager>(game_table_manager)]() -> std::vector<std::string>
+        {
+            auto g = gtm.lock();
+            if (!g)
+                return {};
+            const auto& st = g->getInboundStats();
+            char l0[128], l1[128], l2[128];
+            snprintf(l0, sizeof(l0), "Inbound: raw %zu | backlog %zu", st.rawDepth, st.backlogDepth);
+            snprintf(l1, sizeof(l1), "decode %.2f ms | apply %.2f ms | total %.2f ms", st.decodeMs, st.applyMs, st.frameMs);
+            snprintf(l2, sizeof(l2), "applied %u | coalesced %u (%llu) | deferred heavy %u", st.applied, st.coalesced,
+                     static_cast<unsigned long long>(st.coalescedTotal), st.deferredHeavy);
+            return {l0, l1, l2};
+        });
+    DebugActions::RegisterSessionCaptureToggles(
+        [nm = std::weak_ptr<NetworkManager>(game_table_manager->network_manager)](bool on)
+        {
+            auto n = nm.lock();
+            if (!n)
+                return;
+            if (!on)
+            {
+                n->stopCapture();
+                return;
+            }
+            char name[64];
+            const std::time_t t = std::time(nullptr);
+            const std::tm bt = Logger::localTime(t);
+            std::strftime(name, sizeof(name), "session-%Y%m%d-%H%M%S.rvtcap", &bt);
+            n->startCapture(PathManager::getCapturesPath() / name);
+        },
+        [gtm = std::weak_ptr<GameTableManager>(game_table_manager)](bool on)
+        {
+            auto g = gtm.lock();
+            if (!g)
+                return;
+            if (!on)
+            {
+                g->stopReplay();
+                return;
+            }
+            // newest capture into a sandbox world, as fast as the decode shards take it unless
+            // "Replay At Original Timing" is on
+            std::filesystem::path latest;
+            std::error_code ec;
+            for (auto& e : std::filesystem::directory_iterator(PathManager::getCapturesPath(), ec))
+                if (e.path().extension() == ".rvtcap" && (latest.empty() || e.last_write_time() > std::filesystem::last_write_time(latest)))
+                    latest = e.path();
+            if (latest.empty() || !g->startReplay(latest, DebugActions::gReplayOriginalTiming))
+                Logger::instance().log("main", Logger::Level::Warn, "Session Replay: no capture found");
+        });
 }
 
 ApplicationHandler::~ApplicationHandler()
@@ -251,6 +304,13 @@ int ApplicationHandler::run()
     glfwSwapInterval(1);
 
     glfwSetWindowUserPointer(window, &game_table_manager);
+    // files dropped from Explorer: images go to the chat input when the chat window is under the cursor
+    glfwSetDropCallback(window, [](GLFWwindow* w, int count, const char** paths)
+                        {
+                            auto* gtm = static_cast<std::shared_ptr<GameTableManager>*>(glfwGetWindowUserPointer(w));
+                            if (!gtm || !*gtm || !(*gtm)->chat_manager)
+                                return;
+                            (*gtm)->chat_manager->onFilesDropped(std::vector<std::string>(paths, paths + count)); });
     int minWidth = 1280; // AJUSTAR TAMANHOS, VERIFICAR TAMANHO MINIMO QUE NÃ‚O QUEBRA O LAYOUT
     int minHeight = 960;
     glfwSetWindowSizeLimits(window, minWidth, minHeight, GLFW_DONT_CARE, GLFW_DONT_CARE);
@@ -475,6 +535,11 @@ void ApplicationHandler::renderActiveGametable()
                 ImVec2 displayed_image_size = ImGui::GetItemRectSize();
                 ;
                 ImVec2 image_min_screen_pos = ImGui::GetItemRectMin();
+                if (map_fbo->width > 0 && map_fbo->height > 0)
+                {
+                    const ImVec2 fbo_to_screen(displayed_image_size.x / map_fbo->width, displayed_image_size.y / map_fbo->height);
+                    game_table_manager->board_manager->renderSelectionOverlay(ImGui::GetWindowDrawList(), image_min_screen_pos, fbo_to_screen);
+                }
 
                 ImVec2 toolbar_cursor_pos_in_parent = ImVec2(image_min_screen_pos.x - window_pos.x,
                                                              image_min_screen_pos.y - window_pos.y);
@@ -9,6 +9,7 @@
 #include "VertexArray.h"
 #include "VertexBufferLayout.h"
 #include "Texture.h"
+#include "GpuTextures.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -25,6 +26,7 @@
 #include "NetworkManager.h"
 #include "Logger.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>    // getenv
 #include <functional> // std::hash
@@ -32,9 +34,11 @@
 #include <thread>
 #include <unordered_map>
 
-BoardManager::BoardManager(flecs::world ecs, std::weak_ptr<NetworkManager> network_manager, std::shared_ptr<IdentityManager> identity_manager, std::shared_ptr<DirectoryWindow> map_directory, std::shared_ptr<DirectoryWindow> marker_directory) :
+BoardManager::BoardManager(flecs::world ecs, std::weak_ptr<NetworkManager> network_manager, std::shared_ptr<IdentityManager> identity_manager, std::shared_ptr<DirectoryWindow> map_directory, std::shared_ptr<DirectoryWindow> marker_directory, bool watchDirectories) :
     ecs(ecs), camera(), identity_manager(identity_manager), currentTool(Tool::MOVE), mouse_start_screen_pos({0, 0}), mouse_start_world_pos({0, 0}), mouse_current_world_pos({0, 0}), marker_directory(marker_directory), map_directory(map_directory), network_manager(network_manager)
 {
+    if (!watchDirectories)
+        return; // a replay sandbox: the live session already watches the folders
 
     std::filesystem::path map_path = std::filesystem::path(map_directory->directoryPath);
     std::filesystem::path base_path = map_path.parent_path();
@@ -57,7 +61,11 @@ bool BoardManager::isBoardActive()
 
 void BoardManager::closeBoard()
 {
+    endGroupDrag();
+    clearSelection();
     active_board = flecs::entity();
+    if (auto nm = network_manager.lock())
+        nm->announceBoardView();
 }
 
 flecs::entity BoardManager::createBoard(std::string board_name, std::string map_image_path, GLuint texture_id, glm::vec2 size)
@@ -75,11 +83,12 @@ flecs::entity BoardManager::createBoard(std::string board_name, std::string map_
 
 void BoardManager::setActiveBoard(flecs::entity board_entity)
 {
+    endGroupDrag();
+    clearSelection();
     active_board = board_entity;
-    auto nm = network_manager.lock();
-    if (!nm)
-        if (nm->getPeerRole() == Role::GAMEMASTER)
-            nm->broadcastBoard(active_board);
+    // callers that mean to show it to the players broadcast the board themselves
+    if (auto nm = network_manager.lock())
+        nm->announceBoardView();
 }
 /*
 void BoardManager::renderToolbar(const ImVec2& window_position)
@@ -404,140 +413,6 @@ glm::vec2 BoardManager::computeMarkerDrawSize_ARFit(const TextureComponent& tex,
     return texPx * s; // scaled to fit inside the box, AR preserved
 }
 
-void BoardManager::renderBoard(VertexArray& va, IndexBuffer& ib, Shader& shader, Shader& grid_shader, Renderer& renderer)
-{
-    auto nm = network_manager.lock();
-    if (!nm)
-        throw std::exception("[BoardManager] Network Manager expired!!");
-
-    const TextureComponent* texture = active_board.get<TextureComponent>();
-    if (texture->textureID != 0)
-    {
-        const Board* board = active_board.get<Board>();
-        const Grid* grid = active_board.get<Grid>();
-        const Size* size = active_board.get<Size>();
-
-        glm::mat4 viewMatrix = camera.getViewMatrix(); // ObtÃ©m a matriz de visualizaÃ§Ã£o da cÃ¢mera (pan/zoom)
-        glm::mat4 projection = camera.getProjectionMatrix();
-        glm::mat4 board_model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f));
-        board_model = glm::scale(board_model, glm::vec3(size->width, size->height, 1.0f));
-
-        shader.Bind();
-        shader.SetUniformMat4f("projection", projection);
-        shader.SetUniformMat4f("view", viewMatrix);
-        shader.SetUniformMat4f("model", board_model);
-        shader.SetUniform1f("u_Alpha", 1.0f);
-        shader.SetUniform1i("u_UseTexture", 1);
-        shader.SetUniform1i("u_Texture", 0);
-        shader.Unbind();
-
-        GLCall(glActiveTexture(GL_TEXTURE0));
-        GLCall(glBindTexture(GL_TEXTURE_2D, texture->textureID));
-
-        renderer.Draw(va, ib, shader);
-
-        if (grid)
-        {
-            if (grid->visible)
-            {
-                grid_shader.Bind();
-                grid_shader.SetUniformMat4f("projection", projection);
-                grid_shader.SetUniformMat4f("view", viewMatrix);
-                grid_shader.SetUniformMat4f("model", board_model); // Grid model is the same as the board
-                grid_shader.SetUniform1i("grid_type", grid->is_hex ? 1 : 0);
-                grid_shader.SetUniform1f("cell_size", grid->cell_size);
-                grid_shader.SetUniform2f("grid_offset", grid->offset.x, grid->offset.y);
-                grid_shader.SetUniform1f("opacity", grid->opacity);
-                grid_shader.Unbind();
-
-                renderer.Draw(va, ib, grid_shader);
-            }
-        }
-
-        ecs.defer_begin(); // Start deferring modifications
-        active_board.children([&](flecs::entity child)
-                              {
-            if (child.has<MarkerComponent>()) {
-                const TextureComponent* texture_marker = child.get<TextureComponent>();
-                if (texture_marker->textureID != 0) {
-                    const Position* position_marker = child.get<Position>();
-                    const Visibility* visibility_marker = child.get<Visibility>();
-                    const Size* size_marker = child.get<Size>();
-
-                    glm::mat4 marker_model = glm::translate(glm::mat4(1.0f), glm::vec3(position_marker->x, position_marker->y, 0.0f));
-                    marker_model = glm::scale(marker_model, glm::vec3(size_marker->width, size_marker->height, 1.0f));
-
-                    //glm::mat4 mvp = projection * viewMatrix * marker_model; //Calculate Screen Position(Can use method to standize it, but alter to return the MVP
-                    float alpha = 1.0f;
-                    if (!visibility_marker->isVisible) {
-                        if (nm->getPeerRole() == Role::GAMEMASTER)
-                        {
-                            alpha = 0.5f;
-                        }
-                        else {
-                            alpha = 0.0f;
-                        }
-                    }
-
-                    shader.Bind();
-                    shader.SetUniformMat4f("projection", projection);
-                    shader.SetUniformMat4f("view", viewMatrix);
-                    shader.SetUniformMat4f("model", marker_model);
-                    shader.SetUniform1f("u_Alpha", alpha);
-                    shader.SetUniform1i("u_Texture", 0);
-                    shader.SetUniform1i("u_UseTexture", 1);
-                    shader.Unbind();
-
-                    GLCall(glActiveTexture(GL_TEXTURE0));
-                    GLCall(glBindTexture(GL_TEXTURE_2D, texture_marker->textureID));
-
-                    renderer.Draw(va, ib, shader);
-                }
-            }
-
-            if (child.has<FogOfWar>()) {
-                const Position* position_marker = child.get<Position>();
-                const Visibility* visibility_marker = child.get<Visibility>();
-                const TextureComponent* texture_marker = child.get<TextureComponent>();
-                const Size* size_marker = child.get<Size>();
-
-                glm::mat4 fog_model = glm::translate(glm::mat4(1.0f), glm::vec3(position_marker->x, position_marker->y, 0.0f));
-                fog_model = glm::scale(fog_model, glm::vec3(size_marker->width, size_marker->height, 1.0f));
-
-                float alpha = 1.0f;
-              
-                if (!visibility_marker->isVisible) {
-                    if (nm->getPeerRole() == Role::GAMEMASTER) {
-                        alpha = 0.3f;
-                    }
-                    else
-                    {
-                        alpha = 0.0f;
-                    }
-                }
-                else
-                {
-                    if (nm->getPeerRole() == Role::GAMEMASTER)
-                    {
-                        alpha = 0.6f;
-                    }
-                }
-
-                shader.Bind();
-                shader.SetUniformMat4f("projection", projection);
-                shader.SetUniformMat4f("view", viewMatrix);
-                shader.SetUniformMat4f("model", fog_model);
-                shader.SetUniform1f("u_Alpha", alpha);
-                shader.SetUniform1i("u_UseTexture", 0);
-                shader.Unbind();
-
-                renderer.Draw(va, ib, shader);
-
-            } });
-        ecs.defer_end();
-    }
-}
-
 flecs::entity BoardManager::createMarker(const std::string& imageFilePath, GLuint textureId, glm::vec2 position, glm::vec2 size)
 {
     auto nm = network_manager.lock();
@@ -788,6 +663,8 @@ void BoardManager::killIfMouseUp(bool isMouseDown)
         active_board.set<Panning>({false});
 
     auto nm = network_manager.lock();
+    endGroupDrag();
+    is_box_selecting = false;
 
     // If some marker still locally dragging (UI glitch), force-end it now
     ecs.defer_begin();
@@ -802,6 +679,7 @@ void BoardManager::killIfMouseUp(bool isMouseDown)
             return; // skip markers dragged by others
 
         moving.isDragging = false;
+        entity.modified<Moving>(); // the change feed picks up the Position the drag wrote
 
         const auto bid = active_board.get<Identifier>()->id;
 
@@ -839,8 +717,6 @@ void BoardManager::resnapAllMarkersToNearest(const Grid& grid)
     if (grid.cell_size <= 0.0f)
         return;
 
-    auto nm = network_manager.lock();
-
     ecs.defer_begin();
     active_board.children([&](flecs::entity e)
                           {
@@ -856,12 +732,7 @@ void BoardManager::resnapAllMarkersToNearest(const Grid& grid)
         if (glm::any(glm::epsilonNotEqual(p, goal, glm::vec2(1e-4f)))) {
             pos->x = goal.x;
             pos->y = goal.y;
-
-            // If you're broadcasting grid-driven corrections:
-            if (nm && e.has<Identifier>()) {
-                const auto bid = active_board.get<Identifier>()->id;
-                nm->broadcastMarkerUpdate(bid, e); // or your existing "final pos" message
-            }
+            e.modified<Position>(); // sent as a delta next frame
         } });
     ecs.defer_end();
 }
@@ -945,6 +816,14 @@ void BoardManager::startMouseDrag(glm::vec2 mousePos, bool draggingMap)
 
         const auto mid = ent.get<Identifier>()->id;
 
+        // a selected marker takes the rest of the selection along
+        if (selection.size() > 1 && isSelected(ent))
+        {
+            if (!isDraggingMarker())
+                startGroupDrag(mousePos);
+            return;
+        }
+
         // Do NOT start if someone else is already dragging this marker.
         if (nm->isMarkerBeingDragged(mid) && !nm->amIDragging(mid))
             return;
@@ -982,6 +861,8 @@ void BoardManager::endMouseDrag()
     if (!nm)
         throw std::exception("[BoardManager] Network Manager expired!!");
 
+    endGroupDrag(); // releases its members before the single-drag pass below
+
     const Grid* grid = active_board.get<Grid>();
     const bool canSnap = (grid && grid->snap_to_grid && grid->cell_size > 0.0f);
 
@@ -1003,6 +884,7 @@ void BoardManager::endMouseDrag()
         }
 
         moving.isDragging = false;
+        entity.modified<Moving>(); // the change feed picks up the Position the drag wrote
   
         const auto bid = active_board.get<Identifier>()->id;
 
@@ -1020,6 +902,12 @@ void BoardManager::handleMarkerDragging(glm::vec2 world_position)
     if (!nm)
         throw std::exception("[BoardManager] Network Manager expired!!");
 
+    if (!group_drag.empty())
+    {
+        handleGroupDragging(world_position);
+        return;
+    }
+
     ecs.defer_begin();
     ecs.each([&](flecs::entity entity, const MarkerComponent& marker, Moving& moving, Position& position)
              {
@@ -1076,6 +964,9 @@ bool BoardManager::isDraggingMarker(bool local_drag_only /*= true*/)
     if (!nm)
         return false;
 
+    if (!group_drag.empty())
+        return true;
+
     bool any = false;
 
     ecs.defer_begin();
@@ -1099,6 +990,296 @@ bool BoardManager::isDraggingMarker(bool local_drag_only /*= true*/)
     return any;
 }
 
+// ---- multi-selection ------------------------------------------------------------------------------------------
+
+void BoardManager::startBoxSelect(glm::vec2 world_position)
+{
+    is_box_selecting = true;
+    box_start_world = world_position;
+    box_end_world = world_position;
+}
+
+void BoardManager::updateBoxSelect(glm::vec2 world_position)
+{
+    if (is_box_selecting)
+        box_end_world = world_position;
+}
+
+void BoardManager::endBoxSelect(glm::vec2 world_position, bool additive)
+{
+    if (!is_box_selecting)
+        return;
+    is_box_selecting = false;
+    box_end_world = world_position;
+
+    if (!additive)
+        selection.clear();
+    if (!active_board.is_valid())
+        return;
+
+    auto nm = network_manager.lock();
+    const bool isGm = nm && nm->getPeerRole() == Role::GAMEMASTER;
+    const glm::vec2 lo = glm::min(box_start_world, box_end_world);
+    const glm::vec2 hi = glm::max(box_start_world, box_end_world);
+
+    // a marker is in when its center is
+    ecs.defer_begin();
+    ecs.each([&](flecs::entity e, const MarkerComponent&, const Position& pos, const Visibility& vis)
+             {
+        if (!e.has(flecs::ChildOf, active_board))
+            return;
+        if (!isGm && !vis.isVisible)
+            return;
+        if (pos.x < lo.x || pos.x > hi.x || pos.y < lo.y || pos.y > hi.y)
+            return;
+        if (!isSelected(e))
+            selection.push_back(e); });
+    ecs.defer_end();
+}
+
+void BoardManager::toggleSelected(flecs::entity marker)
+{
+    if (!marker.is_valid() || !marker.has<MarkerComponent>())
+        return;
+    auto it = std::find(selection.begin(), selection.end(), marker);
+    if (it != selection.end())
+        selection.erase(it);
+    else
+        selection.push_back(marker);
+}
+
+void BoardManager::clearSelection()
+{
+    selection.clear();
+    is_box_selecting = false;
+}
+
+bool BoardManager::isSelected(flecs::entity marker) const
+{
+    return std::find(selection.begin(), selection.end(), marker) != selection.end();
+}
+
+void BoardManager::pruneSelection()
+{
+    selection.erase(std::remove_if(selection.begin(), selection.end(), [this](const flecs::entity& e)
+                                   { return !e.is_alive() || !e.has(flecs::ChildOf, active_board); }),
+                    selection.end());
+}
+
+void BoardManager::setSelectionVisibility(bool visible)
+{
+    pruneSelection();
+    auto nm = network_manager.lock();
+    if (!nm || selection.empty() || !active_board.has<Identifier>())
+        return;
+
+    {
+        // goes out below as one MarkerGroupOp, not as a delta per marker
+        EntityDeltaTracker::Suppress quiet(nm->entityDeltas());
+        for (auto& e : selection)
+            e.set<Visibility>(Visibility{visible});
+    }
+    nm->broadcastGroupVisibility(active_board.get<Identifier>()->id, selection, visible);
+}
+
+void BoardManager::deleteSelection()
+{
+    pruneSelection();
+    auto nm = network_manager.lock();
+    if (!nm || selection.empty() || !active_board.has<Identifier>())
+        return;
+
+    nm->broadcastGroupDelete(active_board.get<Identifier>()->id, selection);
+    for (auto& e : selection)
+    {
+        if (e == edit_window_entity)
+        {
+            showEditWindow = false;
+            edit_window_entity = flecs::entity();
+        }
+        e.destruct();
+    }
+    selection.clear();
+}
+
+bool BoardManager::startGroupDrag(glm::vec2 world_position)
+{
+    auto nm = network_manager.lock();
+    if (!nm || !active_board.has<Identifier>())
+        return false;
+    pruneSelection();
+
+    group_drag.clear();
+    group_drag_ids.clear();
+    for (auto& e : selection)
+    {
+        if (!e.has<Identifier>() || !e.has<Position>() || !e.has<Moving>())
+            continue;
+        const auto mid = e.get<Identifier>()->id;
+        if (nm->isMarkerBeingDragged(mid) && !nm->amIDragging(mid))
+            continue;
+        if (!canMoveMarker(e.get<MarkerComponent>(), e))
+            continue;
+        group_drag.push_back(GroupMember{e, *e.get<Position>()});
+        group_drag_ids.push_back(mid);
+    }
+    if (group_drag.empty())
+        return false;
+
+    group_drag_id = nm->beginGroupDrag(group_drag_ids);
+    group_drag_origin = world_position;
+    mouse_start_world_pos = world_position;
+    for (auto& m : group_drag)
+        m.entity.set<Moving>(Moving{true});
+    return true;
+}
+
+void BoardManager::handleGroupDragging(glm::vec2 world_position)
+{
+    auto nm = network_manager.lock();
+    if (!nm || !active_board.has<Identifier>())
+        return;
+
+    // every member keeps its offset to the others; the wire only carries the shared offset
+    const glm::vec2 offset = world_position - group_drag_origin;
+    for (auto& m : group_drag)
+    {
+        if (!m.entity.is_alive())
+            continue;
+        if (auto* pos = m.entity.get_mut<Position>())
+        {
+            pos->x = m.start.x + offset.x;
+            pos->y = m.start.y + offset.y;
+        }
+    }
+    mouse_start_world_pos = world_position;
+
+    if (shouldSendMarkerMove(group_drag_id))
+        nm->broadcastGroupMove(active_board.get<Identifier>()->id, group_drag_id, group_drag_ids, Position{offset.x, offset.y});
+}
+
+void BoardManager::endGroupDrag()
+{
+    if (group_drag.empty())
+        return;
+
+    const Grid* grid = active_board.is_valid() ? active_board.get<Grid>() : nullptr;
+    const bool canSnap = (grid && grid->snap_to_grid && grid->cell_size > 0.0f);
+
+    std::vector<flecs::entity> members;
+    members.reserve(group_drag.size());
+    for (auto& m : group_drag)
+    {
+        if (!m.entity.is_alive())
+            continue;
+        auto* pos = m.entity.get_mut<Position>();
+        if (pos && canSnap)
+        {
+            glm::vec2 snapped = snapToSquareCenter(glm::vec2(pos->x, pos->y), grid->offset, grid->cell_size);
+            pos->x = snapped.x;
+            pos->y = snapped.y;
+        }
+        if (auto* mv = m.entity.get_mut<Moving>())
+        {
+            mv->isDragging = false;
+            m.entity.modified<Moving>(); // the change feed picks up the Position the drag wrote
+        }
+        members.push_back(m.entity);
+    }
+
+    auto nm = network_manager.lock();
+    if (nm && active_board.has<Identifier>())
+        nm->broadcastGroupMoveEnd(active_board.get<Identifier>()->id, group_drag_id, members);
+
+    group_drag.clear();
+    group_drag_ids.clear();
+    group_drag_id = 0;
+}
+
+void BoardManager::renderSelectionWindow()
+{
+    pruneSelection();
+    if (selection.empty())
+        return;
+
+    auto nm = network_manager.lock();
+    const bool isGm = nm && nm->getPeerRole() == Role::GAMEMASTER;
+
+    ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.2f, 0.3f, 0.4f, 1.0f));
+    ImGui::Begin("Selection", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoCollapse);
+    ImGui::Text("%d markers selected", static_cast<int>(selection.size()));
+
+    if (isGm)
+    {
+        if (ImGui::Button("Show"))
+            setSelectionVisibility(true);
+        ImGui::SameLine();
+        if (ImGui::Button("Hide"))
+            setSelectionVisibility(false);
+        ImGui::SameLine();
+        if (ImGui::Button("Delete"))
+            ImGui::OpenPopup("Confirm Group Delete");
+
+        if (ImGui::BeginPopupModal("Confirm Group Delete", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+        {
+            ImGui::Text("Delete %d markers?", static_cast<int>(selection.size()));
+            ImGui::Separator();
+            if (ImGui::Button("Yes", ImVec2(120, 0)))
+            {
+                deleteSelection();
+                ImGui::CloseCurrentPopup();
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("No", ImVec2(120, 0)))
+                ImGui::CloseCurrentPopup();
+            ImGui::EndPopup();
+        }
+    }
+
+    ImGui::Separator();
+    ImGui::TextDisabled("Move tool: drag a selected marker to move them all");
+    if (ImGui::Button("Clear"))
+        clearSelection();
+
+    ImGui::End();
+    ImGui::PopStyleColor();
+}
+
+void BoardManager::renderSelectionOverlay(ImDrawList* draw_list, ImVec2 image_min, ImVec2 fbo_to_screen)
+{
+    if (!draw_list || !active_board.is_valid())
+        return;
+
+    auto toScreen = [&](glm::vec2 world)
+    {
+        const glm::vec2 fbo = camera.worldToScreenPosition(world);
+        return ImVec2(image_min.x + fbo.x * fbo_to_screen.x, image_min.y + fbo.y * fbo_to_screen.y);
+    };
+    const ImU32 accent = IM_COL32(90, 200, 255, 255);
+
+    if (is_box_selecting)
+    {
+        const ImVec2 a = toScreen(box_start_world);
+        const ImVec2 b = toScreen(box_end_world);
+        const ImVec2 lo(std::min(a.x, b.x), std::min(a.y, b.y));
+        const ImVec2 hi(std::max(a.x, b.x), std::max(a.y, b.y));
+        draw_list->AddRectFilled(lo, hi, IM_COL32(90, 200, 255, 40));
+        draw_list->AddRect(lo, hi, accent);
+    }
+
+    pruneSelection();
+    for (const auto& e : selection)
+    {
+        const auto* pos = e.get<Position>();
+        const auto* siz = e.get<Size>();
+        if (!pos || !siz)
+            continue;
+        const ImVec2 a = toScreen(glm::vec2(pos->x - siz->width * 0.5f, pos->y - siz->height * 0.5f));
+        const ImVec2 b = toScreen(glm::vec2(pos->x + siz->width * 0.5f, pos->y + siz->height * 0.5f));
+        draw_list->AddRect(ImVec2(std::min(a.x, b.x), std::min(a.y, b.y)), ImVec2(std::max(a.x, b.x), std::max(a.y, b.y)), accent, 0.0f, 0, 2.0f);
+    }
+}
+
 glm::vec2 BoardManager::getMouseStartPosition() const
 {
     return mouse_start_world_pos;
@@ -1357,14 +1538,7 @@ void BoardManager::renderEditWindow()
             {
                 size->width = size->width * 1.1;
                 size->height = size->height * 1.1; // Adjust height proportionally to the width
-                if (edit_window_entity.has<MarkerComponent>())
-                {
-                    nm->broadcastMarkerUpdate(boardEnt.get<Identifier>()->id, edit_window_entity);
-                }
-                else if (edit_window_entity.has<FogOfWar>())
-                {
-                    nm->broadcastFogUpdate(boardEnt.get<Identifier>()->id, edit_window_entity);
-                }
+                edit_window_entity.modified<Size>();
             }
         }
         ImGui::SameLine();
@@ -1374,14 +1548,7 @@ void BoardManager::renderEditWindow()
             {
                 size->width = size->width * 0.90;
                 size->height = size->height * 0.90; // Adjust height proportionally to the width
-                if (edit_window_entity.has<MarkerComponent>())
-                {
-                    nm->broadcastMarkerUpdate(boardEnt.get<Identifier>()->id, edit_window_entity);
-                }
-                else if (edit_window_entity.has<FogOfWar>())
-                {
-                    nm->broadcastFogUpdate(boardEnt.get<Identifier>()->id, edit_window_entity);
-                }
+                edit_window_entity.modified<Size>();
             }
         }
 
@@ -1393,14 +1560,7 @@ void BoardManager::renderEditWindow()
             if (nm && boardEnt.is_valid())
             {
                 visibility->isVisible = vis_temp;
-                if (edit_window_entity.has<MarkerComponent>())
-                {
-                    nm->broadcastMarkerUpdate(boardEnt.get<Identifier>()->id, edit_window_entity);
-                }
-                else if (edit_window_entity.has<FogOfWar>())
-                {
-                    nm->broadcastFogUpdate(boardEnt.get<Identifier>()->id, edit_window_entity);
-                }
+                edit_window_entity.modified<Visibility>();
             }
         }
 
@@ -1569,13 +1729,7 @@ void BoardManager::renderEditWindow()
                         nm->clearDragState(mid); // small helper: drag_.erase(mid)
                 }
 
-                // Broadcast the change now
-                if (nm)
-                {
-                    auto boardEnt = getActiveBoard();
-                    if (boardEnt.is_valid())
-                        nm->broadcastMarkerUpdate(boardEnt.get<Identifier>()->id, edit_window_entity);
-                }
+                edit_window_entity.modified<MarkerComponent>();
             }
         }
 
@@ -1600,12 +1754,8 @@ void BoardManager::renderEditWindow()
         bool flagsChanged = false;
         flagsChanged |= ImGui::Checkbox("Allow all players to move", &mc->allowAllPlayersMove);
         flagsChanged |= ImGui::Checkbox("Locked (players cannot move)", &mc->locked);
-        if (flagsChanged && nm)
-        {
-            auto boardEnt = getActiveBoard();
-            if (boardEnt.is_valid())
-                nm->broadcastMarkerUpdate(boardEnt.get<Identifier>()->id, edit_window_entity);
-        }
+        if (flagsChanged)
+            edit_window_entity.modified<MarkerComponent>();
     }
 
     ImGui::End();
@@ -1745,11 +1895,7 @@ void BoardManager::renderGridWindow()
             {
                 resnapAllMarkersToNearest(*grid);
             }
-            if (auto nm = network_manager.lock())
-            {
-                if (active_board.has<Identifier>())
-                    nm->broadcastGridUpdate(active_board.get<Identifier>()->id, active_board);
-            }
+            active_board.modified<Grid>();
         }
     }
     else
@@ -1793,18 +1939,7 @@ BoardImageData BoardManager::LoadTextureFromMemory(const uint8_t* bytes, size_t
         return BoardImageData{};
     }
 
-    GLuint tex = 0;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
-
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height,
-                 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
+    const GLuint tex = GpuTextures::create(width, height, data);
     stbi_image_free(data);
     return BoardImageData(tex, glm::vec2(width, height), /*path*/ "");
 }
@@ -1,4 +1,5 @@
 #include "ChatManager.h"
+#include "TextureStreamer.h"
 #include "NetworkManager.h"
 #include "PeerLink.h"
 #include "Serializer.h"
@@ -10,7 +11,11 @@
 #include <random>
 #include <cstdint>
 #include <unordered_map>
+#include <unordered_set>
 #include "PathManager.h"
+#include "HeadlessMode.h"
+#include "DirectoryWindow.h"
+#include "AssetIO.h"
 
 // ====== small utils ======
 double ChatManager::nowSec()
@@ -38,7 +43,13 @@ ChatMessageModel::Kind ChatManager::classifyMessage(const std::string& s)
 
 // ====== ctor/bind ======
 ChatManager::ChatManager(std::weak_ptr<NetworkManager> nm, std::shared_ptr<IdentityManager> identity_manager) :
-    network_(std::move(nm)), identity_manager(identity_manager) {}
+    network_(std::move(nm)), identity_manager(identity_manager)
+{
+    if (!HeadlessMode::enabled())
+        textures_ = std::make_unique<TextureStreamer>(1);
+}
+ChatManager::~ChatManager() = default;
+
 void ChatManager::setNetwork(std::weak_ptr<NetworkManager> nm)
 {
     network_ = std::move(nm);
@@ -56,6 +67,7 @@ void ChatManager::setActiveGameTable(uint64_t tableId, const std::string& gameTa
     ensureGeneral();
 
     loadCurrent(); // will merge/overwrite groups_ from disk
+    releaseUnusedImages();
 
     activeGroupId_ = generalGroupId_;
     focusInput_ = true;
@@ -85,7 +97,7 @@ std::filesystem::path ChatManager::chatFilePathFor(uint64_t tableId, const std::
 bool ChatManager::saveLog(std::vector<uint8_t>& buf) const
 {
     Serializer::serializeString(buf, "RUNIC-CHAT-GROUPS");
-    Serializer::serializeInt(buf, 2); // <— version 2
+    Serializer::serializeInt(buf, 3); // v3: image attachments
 
     Serializer::serializeInt(buf, (int)groups_.size());
     for (auto& [id, g] : groups_)
@@ -106,6 +118,14 @@ bool ChatManager::saveLog(std::vector<uint8_t>& buf) const
             Serializer::serializeString(buf, m.username);
             Serializer::serializeString(buf, m.content);
             Serializer::serializeUInt64(buf, (uint64_t)m.ts);
+            Serializer::serializeUInt8(buf, m.image ? 1 : 0); // <— NEW in v3
+            if (m.image)
+            {
+                buf.insert(buf.end(), m.image->hash.begin(), m.image->hash.end());
+                Serializer::serializeUInt64(buf, m.image->size);
+                Serializer::serializeUInt32(buf, m.image->width);
+                Serializer::serializeUInt32(buf, m.image->height);
+            }
         }
         Serializer::serializeInt(buf, (int)g.unread);
     }
@@ -155,6 +175,18 @@ bool ChatManager::loadLog(const std::vector<uint8_t>& buf)
             msg.username = Serializer::deserializeString(buf, off);
             msg.content = Serializer::deserializeString(buf, off);
             msg.ts = (double)Serializer::deserializeUInt64(buf, off);
+            if (version >= 3 && Serializer::deserializeUInt8(buf, off) != 0)
+            {
+                msg::ChatImageRef ref;
+                if (off + ref.hash.size() > buf.size())
+                    return false;
+                std::copy(buf.begin() + off, buf.begin() + off + ref.hash.size(), ref.hash.begin());
+                off += ref.hash.size();
+                ref.size = Serializer::deserializeUInt64(buf, off);
+                ref.width = (uint16_t)Serializer::deserializeUInt32(buf, off);
+                ref.height = (uint16_t)Serializer::deserializeUInt32(buf, off);
+                msg.image = ref;
+            }
             g.messages.push_back(std::move(msg));
         }
 
@@ -170,7 +202,7 @@ bool ChatManager::loadLog(const std::vector<uint8_t>& buf)
 
 bool ChatManager::saveCurrent()
 {
-    if (!hasCurrent())
+    if (!persistent_ || !hasCurrent())
         return false;
     try
     {
@@ -331,6 +363,7 @@ void ChatManager::applyReady(const msg::ReadyMessage& m)
                     groups_.erase(*m.threadId);
                     if (activeGroupId_ == *m.threadId)
                         activeGroupId_ = generalGroupId_;
+                    releaseUnusedImages();
                 }
             }
             break;
@@ -344,16 +377,20 @@ void ChatManager::applyReady(const msg::ReadyMessage& m)
                 return;
 
             // map sender to uniqueId if possible (if ReadyMessage.userPeerId later carries it, use that)
-            std::string senderUid =
-                identity_manager ? identity_manager->uniqueForPeer(m.fromPeerId).value_or("Player") : std::string{};
+            std::string senderUid;
+            if (m.fromPeer == msg::kSelfPeer) // our own image post, echoed once its thumbnail is out
+                senderUid = identity_manager ? identity_manager->myUniqueId() : std::string{};
+            else
+                senderUid = identity_manager ? identity_manager->uniqueForPeer(m.fromPeerId).value_or("Player") : std::string{};
 
             // inline append to include senderUniqueId
             ChatMessageModel msg;
-            msg.kind = classifyMessage(*m.text);
+            msg.kind = m.chatImage ? ChatMessageModel::Kind::IMAGE : classifyMessage(*m.text);
             msg.senderUniqueId = senderUid;
             msg.username = *m.name;
             msg.content = *m.text;
             msg.ts = (double)*m.ts;
+            msg.image = m.chatImage;
 
             auto* g = getGroup(*m.threadId);
             if (!g)
@@ -372,6 +409,11 @@ void ChatManager::applyReady(const msg::ReadyMessage& m)
             break;
         }
 
+        case K::ChatImageThumb:
+        case K::ChatImageChunk:
+            applyImageReady(m);
+            break;
+
         default:
             break;
     }
@@ -603,11 +645,15 @@ const float fullW = ImGui::GetContentRegionAvail().x;
 */
 void ChatManager::render()
 {
+    ++frame_;
+    if (textures_)
+        textures_->pump(2.0); // chat pictures never take more than a sliver of the frame
     if (!hasCurrent())
         return;
 
     ImGui::Begin("ChatWindow");
     chatWindowFocused_ = ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows | ImGuiFocusedFlags_RootWindow);
+    chatWindowHovered_ = ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows | ImGuiHoveredFlags_RootWindow);
 
     const float leftWmin = 170.0f;
 
@@ -632,6 +678,8 @@ void ChatManager::render()
     ImGui::EndChild();
 
     ImGui::End();
+
+    renderImageViewer();
 }
 
 ImVec4 ChatManager::HSVtoRGB(float h, float s, float v)
@@ -722,6 +770,266 @@ void ChatManager::renderPlainMessage(const std::string& text) const
     ImGui::TextWrapped("%s", text.c_str());
 }
 
+// ====== image attachments ======
+void ChatManager::renderImageMessage(const ChatMessageModel& m)
+{
+    const auto& ref = *m.image;
+    if (!m.content.empty())
+        renderPlainMessage(m.content);
+    else
+        ImGui::TextDisabled("(image)");
+
+    const std::string key(ref.hash.begin(), ref.hash.end());
+    auto it = imageTex_.find(key);
+    const ChatImageTex* t = it == imageTex_.end() ? nullptr : &it->second;
+
+    ImGui::PushID(&m);
+    bool open = false;
+    if (t && t->thumb != 0 && t->thumbSize.x > 0.0f)
+    {
+        open = ImGui::ImageButton("##thumb", (void*)(intptr_t)t->thumb, t->thumbSize);
+    }
+    else
+    {
+        // no thumbnail (log from an older session, or it hasn't arrived yet)
+        char label[96];
+        std::snprintf(label, sizeof(label), "Image %ux%u, %.1f MB", (unsigned)ref.width, (unsigned)ref.height,
+                      ref.size / (1024.0 * 1024.0));
+        open = ImGui::Button(label);
+    }
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Click to open");
+    ImGui::PopID();
+
+    if (open)
+    {
+        viewerImage_ = ref;
+        requestFullImage(m);
+    }
+}
+
+void ChatManager::requestFullImage(const ChatMessageModel& m)
+{
+    if (!textures_ || !m.image)
+        return;
+    const std::string key(m.image->hash.begin(), m.image->hash.end());
+    auto& t = imageTex_[key];
+    t.lastUseFrame = frame_;
+
+    const double now = ImGui::GetTime();
+    if (t.full != 0 || (t.fullRequestedAt > 0.0 && now - t.fullRequestedAt < 15.0))
+        return; // decoded, or still on its way
+    auto nm = network_.lock();
+    if (!nm)
+        return;
+
+    // the author has it for sure; NetworkManager falls back to the GM when they left
+    std::string from;
+    if (identity_manager && !m.senderUniqueId.empty())
+        from = identity_manager->peerForUnique(m.senderUniqueId).value_or(std::string{});
+    t.fullRequestedAt = now;
+    nm->requestChatImage(*m.image, from);
+}
+
+void ChatManager::applyImageReady(const msg::ReadyMessage& m)
+{
+    if (!textures_ || !m.chatImage || !m.bytes || m.bytes->empty())
+        return;
+    if (m.chatImage->width > msg::kChatImageMaxSide || m.chatImage->height > msg::kChatImageMaxSide)
+        return;
+    const std::string key(m.chatImage->hash.begin(), m.chatImage->hash.end());
+    auto& t = imageTex_[key];
+
+    if (m.kind == msg::DCType::ChatImageThumb)
+    {
+        if (t.thumb != 0)
+            return; // same picture posted again
+        t.thumb = textures_->requestFromBytes(*m.bytes, [this, key](GLuint tex, glm::vec2 size, bool ok)
+                                              {
+                                                  auto it = imageTex_.find(key);
+                                                  if (it == imageTex_.end() || it->second.thumb != tex)
+                                                      return;
+                                                  if (ok)
+                                                  {
+                                                      it->second.thumbSize = ImVec2(size.x, size.y);
+                                                      return;
+                                                  }
+                                                  // undecodable: drop it so the next copy of the thumbnail can try again
+                                                  textures_->release(tex);
+                                                  it->second.thumb = 0; });
+        return;
+    }
+
+    if (t.full != 0)
+        return;
+    t.lastUseFrame = frame_;
+    t.full = textures_->requestFromBytes(*m.bytes, [this, key](GLuint tex, glm::vec2 size, bool ok)
+                                         {
+                                             auto it = imageTex_.find(key);
+                                             if (it == imageTex_.end() || it->second.full != tex)
+                                                 return;
+                                             // the declared size can lie; the decoded one can't
+                                             if (!ok || size.x > msg::kChatImageMaxSide || size.y > msg::kChatImageMaxSide)
+                                             {
+                                                 textures_->release(tex);
+                                                 it->second.full = 0;
+                                                 it->second.fullRequestedAt = 0.0; // let the next click ask again
+                                                 return;
+                                             }
+                                             it->second.fullSize = ImVec2(size.x, size.y);
+                                             it->second.fullReady = true;
+                                             evictFullTextures(); });
+}
+
+// Keeps at most kMaxFullTextures decoded full-size images, least recently shown go first.
+// Thumbnails are small and stay.
+void ChatManager::evictFullTextures()
+{
+    size_t ready = 0;
+    for (auto& [key, t] : imageTex_)
+        ready += t.fullReady ? 1 : 0;
+
+    while (ready > kMaxFullTextures)
+    {
+        ChatImageTex* oldest = nullptr;
+        for (auto& [key, t] : imageTex_)
+        {
+            if (t.fullReady && (!oldest || t.lastUseFrame < oldest->lastUseFrame))
+                oldest = &t;
+        }
+        if (!oldest)
+            break;
+        textures_->release(oldest->full);
+        oldest->full = 0;
+        oldest->fullSize = ImVec2(0, 0);
+        oldest->fullReady = false;
+        oldest->fullRequestedAt = 0.0;
+        --ready;
+    }
+}
+
+// Frees the textures of pictures no message refers to any more (deleted or left groups, a table
+// switch). The open viewer keeps its picture.
+void ChatManager::releaseUnusedImages()
+{
+    if (!textures_ || imageTex_.empty())
+        return;
+    std::unordered_set<std::string> used;
+    for (auto& [id, g] : groups_)
+    {
+        for (auto& m : g.messages)
+        {
+            if (m.image)
+                used.emplace(m.image->hash.begin(), m.image->hash.end());
+        }
+    }
+    if (viewerImage_)
+        used.emplace(viewerImage_->hash.begin(), viewerImage_->hash.end());
+
+    for (auto it = imageTex_.begin(); it != imageTex_.end();)
+    {
+        if (used.count(it->first))
+        {
+            ++it;
+            continue;
+        }
+        if (it->second.thumb != 0)
+            textures_->release(it->second.thumb);
+        if (it->second.full != 0)
+            textures_->release(it->second.full);
+        it = imageTex_.erase(it);
+    }
+}
+
+void ChatManager::renderImageViewer()
+{
+    if (!viewerImage_)
+        return;
+    const auto ref = *viewerImage_;
+    const std::string key(ref.hash.begin(), ref.hash.end());
+
+    bool open = true;
+    ImGui::SetNextWindowSize(ImVec2(720, 540), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Chat Image", &open))
+    {
+        auto it = imageTex_.find(key);
+        if (it != imageTex_.end())
+            it->second.lastUseFrame = frame_;
+        if (it != imageTex_.end() && it->second.fullReady)
+        {
+            const auto& t = it->second;
+            const ImVec2 avail = ImGui::GetContentRegionAvail();
+            const float scale = std::max(0.01f, std::min({1.0f, avail.x / t.fullSize.x, avail.y / t.fullSize.y}));
+            ImGui::Image((void*)(intptr_t)t.full, ImVec2(t.fullSize.x * scale, t.fullSize.y * scale));
+        }
+        else
+        {
+            ImGui::TextDisabled("Loading %ux%u image (%.1f MB)...", (unsigned)ref.width, (unsigned)ref.height,
+                                ref.size / (1024.0 * 1024.0));
+        }
+    }
+    ImGui::End();
+    if (!open)
+        viewerImage_.reset();
+}
+
+bool ChatManager::attachImageFile(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec || size == 0)
+        return false;
+    if (size > msg::kChatImageMaxBytes)
+    {
+        Logger::instance().log("chat", Logger::Level::Warn, "Image too large to attach: " + path.string());
+        return false;
+    }
+    std::ifstream is(path, std::ios::binary);
+    std::vector<uint8_t> bytes((size_t)size);
+    if (!is.read((char*)bytes.data(), (std::streamsize)bytes.size()))
+        return false;
+    attachImageBytes(std::move(bytes), path.filename().string());
+    return true;
+}
+
+void ChatManager::attachImageBytes(std::vector<uint8_t> bytes, const std::string& name)
+{
+    pendingImage_ = std::move(bytes);
+    pendingImageName_ = name;
+    focusInput_ = true;
+}
+
+// The input text becomes the caption. The message itself is echoed back by NetworkManager once
+// the thumbnail is made (off the UI thread), so nothing is appended here.
+void ChatManager::sendImageMessage(ChatGroupModel& g, const std::string& caption)
+{
+    auto nm = network_.lock();
+    if (!nm || !hasCurrent())
+        return;
+    auto uname = nm->getMyUsername();
+    if (uname.empty())
+        uname = "me";
+
+    const bool general = g.id == generalGroupId_;
+    const auto targets = general ? std::set<std::string>{} : resolvePeerIdsForParticipants(g.participants);
+    nm->postChatImage(currentTableId_, g.id, targets, general, uname, caption, (uint64_t)nowSec(), std::move(pendingImage_));
+    pendingImage_.clear();
+    pendingImageName_.clear();
+}
+
+void ChatManager::onFilesDropped(const std::vector<std::string>& paths)
+{
+    if (!hasCurrent() || !chatWindowHovered_)
+        return;
+    for (auto& p : paths)
+    {
+        // GLFW hands out UTF-8
+        if (classifyMessage(p) == ChatMessageModel::Kind::IMAGE &&
+            attachImageFile(std::filesystem::path(reinterpret_cast<const char8_t*>(p.c_str()))))
+            return;
+    }
+}
+
 void ChatManager::tryHandleSlashCommand(uint64_t threadId, const std::string& input)
 {
     // /roll NdM(+K)  e.g., /roll 4d6+2  or /roll 1d20-5
@@ -912,7 +1220,7 @@ void ChatManager::renderLeftPanel(float /*width*/)
 void ChatManager::renderRightPanel(float /*leftW*/)
 {
     auto* g = getGroup(activeGroupId_);
-    const float footerRowH = ImGui::GetFrameHeightWithSpacing() * 2.0f;
+    const float footerRowH = ImGui::GetFrameHeightWithSpacing() * (pendingImage_.empty() ? 2.0f : 3.0f);
 
     ImVec2 avail = ImGui::GetContentRegionAvail();
     ImGui::BeginChild("Messages", ImVec2(0, avail.y - footerRowH), true, ImGuiWindowFlags_AlwaysVerticalScrollbar);
@@ -934,7 +1242,10 @@ void ChatManager::renderRightPanel(float /*leftW*/)
             // but simplest is to just call TextWrapped now:
             // ensure we start from current cursor X (SameLine set it)
             ImGui::PushTextWrapPos(0);
-            renderPlainMessage(m.content);
+            if (m.image)
+                renderImageMessage(m);
+            else
+                renderPlainMessage(m.content);
             ImGui::PopTextWrapPos();
         }
         if (followScroll_)
@@ -950,6 +1261,17 @@ void ChatManager::renderRightPanel(float /*leftW*/)
     // Footer input
     ImGui::BeginChild("Footer", ImVec2(0, 0), false, ImGuiWindowFlags_AlwaysAutoResize);
 
+    if (!pendingImage_.empty())
+    {
+        ImGui::TextDisabled("Image: %s (%.1f KB)", pendingImageName_.c_str(), pendingImage_.size() / 1024.0);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Remove"))
+        {
+            pendingImage_.clear();
+            pendingImageName_.clear();
+        }
+    }
+
     if (focusInput_)
     {
         ImGui::SetKeyboardFocusHere();
@@ -960,7 +1282,7 @@ void ChatManager::renderRightPanel(float /*leftW*/)
     if (ImGui::InputText("##chat_input", input_.data(), (int)input_.size(), flags))
     {
         std::string text(input_.data());
-        if (!text.empty() && g)
+        if ((!text.empty() || !pendingImage_.empty()) && g)
         {
             const uint64_t ts = (uint64_t)nowSec();
             auto nm = network_.lock();
@@ -968,7 +1290,11 @@ void ChatManager::renderRightPanel(float /*leftW*/)
             if (uname.empty())
                 uname = "me";
 
-            if (!text.empty() && text[0] == '/')
+            if (!pendingImage_.empty())
+            {
+                sendImageMessage(*g, text);
+            }
+            else if (text[0] == '/')
             {
                 tryHandleSlashCommand(activeGroupId_, text);
             }
@@ -985,11 +1311,36 @@ void ChatManager::renderRightPanel(float /*leftW*/)
         }
     }
     UiTypingGuard::TrackThisInput();
+    // Ctrl+V with a bitmap on the clipboard (screenshots) stages it instead of pasting text
+    if (ImGui::IsItemActive() && ImGui::GetIO().KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_V, false))
+    {
+        auto png = AssetIO::clipboardImagePng();
+        if (!png.empty())
+            attachImageBytes(std::move(png), "clipboard.png");
+    }
+    if (ImGui::BeginDragDropTarget())
+    {
+        if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("MARKER_IMAGE"))
+        {
+            const DirectoryWindow::ImageData* asset = (const DirectoryWindow::ImageData*)payload->Data;
+            if (!attachImageFile(PathManager::getMarkersPath() / asset->filename))
+                attachImageFile(PathManager::getMapsPath() / asset->filename);
+        }
+        ImGui::EndDragDropTarget();
+    }
     ImGui::SameLine();
     if (ImGui::Button("Send") && g)
     {
         std::string text(input_.data());
-        if (!text.empty())
+        if (!pendingImage_.empty())
+        {
+            sendImageMessage(*g, text);
+
+            input_.fill('\0');
+            followScroll_ = true;
+            markGroupRead(g->id);
+        }
+        else if (!text.empty())
         {
             const uint64_t ts = (uint64_t)nowSec();
             auto nm = network_.lock();
@@ -1017,6 +1368,12 @@ void ChatManager::renderRightPanel(float /*leftW*/)
     {
         openDicePopup_ = true;
     }
+    ImGui::SameLine();
+    if (ImGui::Button("Attach Image"))
+    {
+        if (auto path = AssetIO::pickImageFileWin32())
+            attachImageFile(*path);
+    }
     if (openDicePopup_)
     {
         openDicePopup_ = false;
@@ -1500,6 +1857,7 @@ void ChatManager::renderDeleteGroupPopup()
                 if (activeGroupId_ == id)
                     activeGroupId_ = generalGroupId_;
                 it = groups_.erase(it);
+                releaseUnusedImages();
 
                 ImGui::PopID();
                 continue; // skip ++it
@@ -1520,6 +1878,7 @@ void ChatManager::renderDeleteGroupPopup()
                     if (activeGroupId_ == id)
                         activeGroupId_ = generalGroupId_;
                     it = groups_.erase(it);
+                    releaseUnusedImages();
                     ImGui::PopID();
                     continue; // skip ++it
                 }
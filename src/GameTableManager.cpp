@@ -1,14 +1,30 @@
 #include "GameTableManager.h"
 #include "imgui_internal.h"
 #include "Serializer.h"
+#include "EntityBulk.h"
 #include "SignalingServer.h"
+#include "NetworkUtilities.h"
+#include "BufferPool.h"
+#include "HeadlessMode.h"
 #include "UPnPManager.h"
+#include "HostDiscovery.h"
 #include "Logger.h"
+#include "ReplaySandbox.h"
 #include "random"
+#include <algorithm>
 
-GameTableManager::GameTableManager(flecs::world ecs, std::shared_ptr<DirectoryWindow> map_directory, std::shared_ptr<DirectoryWindow> marker_directory) :
-    ecs(ecs), identity_manager(std::make_shared<IdentityManager>()), network_manager(std::make_shared<NetworkManager>(ecs, identity_manager)), map_directory(map_directory), board_manager(std::make_shared<BoardManager>(ecs, network_manager, identity_manager, map_directory, marker_directory))
+GameTableManager::GameTableManager(flecs::world ecs, std::shared_ptr<DirectoryWindow> map_directory, std::shared_ptr<DirectoryWindow> marker_directory, bool replaySandbox) :
+    ecs(ecs), identity_manager(std::make_shared<IdentityManager>()), network_manager(std::make_shared<NetworkManager>(ecs, identity_manager, replaySandbox)), map_directory(map_directory), board_manager(std::make_shared<BoardManager>(ecs, network_manager, identity_manager, map_directory, marker_directory, !replaySandbox))
 {
+    if (replaySandbox)
+    {
+        identity_manager->setPersistent(false);
+        identity_manager->setMyIdentity("replay", "Replay");
+        chat_manager = std::make_shared<ChatManager>(network_manager, identity_manager);
+        chat_manager->setPersistent(false);
+        return;
+    }
+
     identity_manager->loadMyIdentityFromFile();
     identity_manager->loadAddressBookFromFile();
     if (identity_manager->myUniqueId().empty())
@@ -33,6 +49,21 @@ void GameTableManager::setup()
 
 GameTableManager::~GameTableManager()
 {
+    replay_.reset(); // before the live world, it shares nothing with it but the frame
+}
+
+bool GameTableManager::startReplay(const std::filesystem::path& file, bool realtime)
+{
+    replay_ = std::make_unique<ReplaySandbox>();
+    if (replay_->start(file, realtime))
+        return true;
+    replay_.reset();
+    return false;
+}
+
+void GameTableManager::stopReplay()
+{
+    replay_.reset();
 }
 
 void GameTableManager::saveGameTable()
@@ -108,8 +139,6 @@ bool GameTableManager::isConnected() const
 
 void GameTableManager::processReceivedMessages()
 {
-    constexpr int kMaxPerFrame = 32; // avoid long stalls
-
     /* static uint64_t last = 0;
     uint64_t t = nowMs();
     if (t - last >= 30000)
@@ -118,342 +147,785 @@ void GameTableManager::processReceivedMessages()
         last = t;
     }*/
 
-    network_manager->drainInboundRaw(kMaxPerFrame);
+    using clock = std::chrono::steady_clock;
+    auto msSince = [](clock::time_point t0)
+    { return std::chrono::duration<double, std::milli>(clock::now() - t0).count(); };
+
+    const auto frameStart = clock::now();
+    frameArena_.release(); // last frame's scratch
+    BufferPool::instance().sampleRates();
+
+    // last frame's local edits go out before anything remote lands; remote writes aren't echoed
+    network_manager->flushEntityDeltas();
+    network_manager->publishStateVersion();
+    network_manager->pollStateHash();
+    EntityDeltaTracker::Suppress remote(network_manager->entityDeltas());
+    auto& st = inboundStats_;
+    st.applied = 0;
+    st.coalesced = 0;
+    st.deferredHeavy = 0;
+
+    // 1) raw -> ready happens on the NetworkManager decode shards; here only finalize
+    //    streamed images and handle link events
+    network_manager->pollStreamingDecodes();
+    network_manager->pollSwarmTransfers();
     network_manager->drainEvents();
-    int processed = 0;
+    st.decodeMs = msSince(frameStart);
+
+    // 2) pull everything that's ready (cheap moves) and drop superseded state
     msg::ReadyMessage m;
-    while (processed < kMaxPerFrame && network_manager->tryPopReadyMessage(m))
+    while (network_manager->tryPopReadyMessage(m))
+        readyBacklog_.push_back(std::move(m));
+    st.coalesced = coalesceReadyBacklog();
+    st.coalescedTotal += st.coalesced;
+
+    // 3) apply in order until the frame budget is spent; heavy ops only start with enough
+    //    budget left, otherwise they stay at the head for the next frame. The head entry always
+    //    goes: when steps 1-2 alone eat the budget every frame nothing would ever be applied.
+    const auto applyStart = clock::now();
+    int heavy = 0;
+    bool progressed = false;
+    while (!readyBacklog_.empty())
+    {
+        const double spent = msSince(frameStart);
+        if (progressed && spent >= kInboundBudgetMs)
+            break;
+        auto& next = readyBacklog_.front();
+        if (progressed && isHeavyReady(next) && (heavy >= kMaxHeavyPerFrame || kInboundBudgetMs - spent < kHeavyMinRemainingMs))
+        {
+            st.deferredHeavy++;
+            break;
+        }
+        if (isHeavyReady(next))
+            ++heavy;
+        progressed = true;
+
+        // a snapshot's markers for one board go in as one bulk create, sized to the heavy slots
+        // left this frame (its first slot was counted above)
+        if (next.kind == msg::DCType::CommitMarker)
+        {
+            const size_t slots = static_cast<size_t>(std::max(1, kMaxHeavyPerFrame - heavy + 1));
+            std::vector<msg::ReadyMessage> run;
+            const size_t taken = takeMarkerCommitRun(run, std::min(kMaxMarkerBatch, slots * kMarkersPerHeavy));
+            heavy += static_cast<int>((taken - 1) / kMarkersPerHeavy);
+            st.applied += static_cast<uint32_t>(taken);
+            applyMarkerCommits(run);
+            continue;
+        }
+
+        m = std::move(next);
+        readyBacklog_.pop_front();
+        applyReadyMessage(m);
+        st.applied++;
+    }
+    st.applyMs = msSince(applyStart);
+
+    board_manager->pumpTextureUploads(kTextureUploadBudgetMs);
+
+    st.rawDepth = network_manager->inboundRawDepth();
+    st.backlogDepth = readyBacklog_.size();
+    st.frameMs = msSince(frameStart);
+
+    if (replay_)
+        replay_->tick();
+}
+
+bool GameTableManager::isHeavyReady(const msg::ReadyMessage& m)
+{
+    return m.kind == msg::DCType::CommitBoard || m.kind == msg::DCType::CommitMarker ||
+           m.kind == msg::DCType::Snapshot_GameTable;
+}
+
+// Drops MarkerMove/GridUpdate entries that another queued entry already supersedes.
+// Moves are keyed by (marker, sender) and the highest (epoch, seq) survives (MarkerMove is
+// unordered, queue position says nothing); group moves likewise per group; grids keep the last
+// one per board. Anything else touching the same marker/group/board is a barrier so drag
+// start/end and creates keep their order.
+size_t GameTableManager::coalesceReadyBacklog()
+{
+    if (readyBacklog_.size() < 2)
+        return 0;
+
+    // scratch lives in the frame arena
+    std::pmr::vector<bool> drop(readyBacklog_.size(), false, &frameArena_);
+    std::pmr::unordered_map<uint64_t, std::pmr::unordered_map<msg::PeerHandle, size_t>> moveKept(&frameArena_); // marker -> peer -> idx
+    std::pmr::unordered_map<uint64_t, size_t> gridKept(&frameArena_);                                            // board -> idx
+    std::pmr::unordered_map<uint64_t, size_t> groupKept(&frameArena_);                                           // group -> idx
+
+    auto moveKey = [](const msg::ReadyMessage& r)
+    { return std::make_pair(r.dragEpoch.value_or(0), r.seq.value_or(0)); };
+
+    for (size_t i = readyBacklog_.size(); i-- > 0;)
     {
-        Logger::instance().log("localtunnel", Logger::Level::Info, msg::DCtypeString(m.kind) + "RECEIVED ON PROCESS!!!");
-        switch (m.kind)
+        const auto& r = readyBacklog_[i];
+        if (r.kind == msg::DCType::MarkerMove && r.markerId)
         {
-            case msg::DCType::Snapshot_GameTable:
+            auto& perPeer = moveKept[*r.markerId];
+            auto it = perPeer.find(r.fromPeer);
+            if (it == perPeer.end())
             {
-                if (!m.tableId || !m.name)
-                    break;
-                active_game_table = ecs.entity("GameTable")
-                                        .set(GameTable{*m.name})
-                                        .set(Identifier{*m.tableId});
-                game_table_name = *m.name;
-                chat_manager->setActiveGameTable(*m.tableId, *m.name);
-                Logger::instance().log("localtunnel", Logger::Level::Info, "GameTable Created!!");
+                perPeer.emplace(r.fromPeer, i);
+            }
+            else if (moveKey(r) > moveKey(readyBacklog_[it->second]))
+            {
+                drop[it->second] = true;
+                it->second = i;
+            }
+            else
+            {
+                drop[i] = true;
+            }
+            continue;
+        }
+        // a group move carries the offset since the drag began, so only the newest one counts
+        if (r.kind == msg::DCType::MarkerGroupOp && r.groupId && r.groupOp == msg::GroupOp::Move)
+        {
+            auto it = groupKept.find(*r.groupId);
+            if (it == groupKept.end())
+            {
+                groupKept.emplace(*r.groupId, i);
+            }
+            else if (moveKey(r) > moveKey(readyBacklog_[it->second]))
+            {
+                drop[it->second] = true;
+                it->second = i;
+            }
+            else
+            {
+                drop[i] = true;
+            }
+            continue;
+        }
+        if (r.kind == msg::DCType::GridUpdate && r.boardId)
+        {
+            if (gridKept.count(*r.boardId))
+                drop[i] = true;
+            else
+                gridKept.emplace(*r.boardId, i);
+            continue;
+        }
+
+        // barriers
+        if (r.markerId)
+            moveKept.erase(*r.markerId);
+        if (r.groupId)
+            groupKept.erase(*r.groupId);
+        if (r.boardId && (r.kind == msg::DCType::CommitBoard || r.kind == msg::DCType::Snapshot_Board))
+            gridKept.erase(*r.boardId);
+    }
+
+    // compact in place
+    size_t w = 0;
+    for (size_t i = 0; i < readyBacklog_.size(); ++i)
+    {
+        if (drop[i])
+            continue;
+        if (w != i)
+            readyBacklog_[w] = std::move(readyBacklog_[i]);
+        ++w;
+    }
+    const size_t dropped = readyBacklog_.size() - w;
+    readyBacklog_.erase(readyBacklog_.begin() + w, readyBacklog_.end());
+    return dropped;
+}
 
+void GameTableManager::applyReadyMessage(msg::ReadyMessage& m)
+{
+    Logger::instance().log("localtunnel", Logger::Level::Info, msg::DCtypeString(m.kind) + "RECEIVED ON PROCESS!!!");
+    switch (m.kind)
+    {
+        case msg::DCType::Snapshot_GameTable:
+        {
+            if (!m.tableId || !m.name)
                 break;
-            }
+            active_game_table = ecs.entity("GameTable")
+                                    .set(GameTable{*m.name})
+                                    .set(Identifier{*m.tableId});
+            game_table_name = *m.name;
+            chat_manager->setActiveGameTable(*m.tableId, *m.name);
+            Logger::instance().log("localtunnel", Logger::Level::Info, "GameTable Created!!");
+
+            break;
+        }
 
-            case msg::DCType::CommitBoard:
-            {
-                if (!m.boardId || !m.boardMeta)
-                    break;
-                GLuint tex = 0;
-                glm::vec2 texSize{0, 0};
-                if (m.bytes && !m.bytes->empty())
-                {
-                    auto image = board_manager->LoadTextureFromMemory(m.bytes->data(),
-                                                                      m.bytes->size());
-                    tex = image.textureID;
-                    texSize = image.size;
-                    Logger::instance().log("localtunnel", Logger::Level::Info, "Board Texture Created: " + std::to_string(tex));
-                }
+        case msg::DCType::CommitBoard:
+        {
+            if (!m.boardId || !m.boardMeta)
+                break;
+            const auto& bm = *m.boardMeta;
+            glm::vec2 texSize{bm.size.width, bm.size.height}; // placeholder until the upload lands
+            auto board = ecs.entity()
+                             .set(Identifier{bm.boardId})
+                             .set(Board{bm.boardName})
+                             .set(Panning{false})
+                             .set(Grid{bm.grid})
+                             .set(TextureComponent{0, "", texSize})
+                             .set(Size{texSize.x, texSize.y});
+            attachNetworkTexture(board, m, /*sizeFromTexture*/ true);
+
+            board_manager->setActiveBoard(board);
+            Logger::instance().log("localtunnel", Logger::Level::Info, "Board Created!!");
+
+            network_manager->markPeerBootstrapped(m.fromPeer); // the board closes the GM's bootstrap
+            break;
+        }
+
+        case msg::DCType::CommitMarker:
+        {
+            applyMarkerCommits({&m, 1});
+            break;
+        }
 
-                const auto& bm = *m.boardMeta;
-                auto board = ecs.entity()
-                                 .set(Identifier{bm.boardId})
-                                 .set(Board{bm.boardName})
-                                 .set(Panning{false})
-                                 .set(Grid{bm.grid})
-                                 .set(TextureComponent{tex, "", texSize})
-                                 .set(Size{texSize.x, texSize.y});
-
-                board_manager->setActiveBoard(board);
-                Logger::instance().log("localtunnel", Logger::Level::Info, "Board Created!!");
+        case msg::DCType::FogCreate:
+        {
+            if (!m.boardId || !m.fogId || !m.pos || !m.size || !m.vis)
+                break;
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
                 break;
-            }
 
-            case msg::DCType::CommitMarker:
-            {
-                if (!m.boardId || !m.markerMeta)
-                    break;
-                auto boardEnt = board_manager->findBoardById(*m.boardId);
-                if (!boardEnt.is_valid())
-                    break;
+            auto fog = ecs.entity()
+                           .set(Identifier{*m.fogId})
+                           .set(Position{m.pos->x, m.pos->y})
+                           .set(Size{m.size->width, m.size->height})
+                           .set(Visibility{*m.vis});
 
-                GLuint tex = 0;
-                glm::vec2 texSize{m.markerMeta->size.width, m.markerMeta->size.height};
-                Logger::instance().log("localtunnel", Logger::Level::Info, "Marker Texture Byte Size: " + std::to_string(m.bytes->size()));
-                if (m.bytes && !m.bytes->empty())
-                {
-                    auto image = board_manager->LoadTextureFromMemory(m.bytes->data(),
-                                                                      m.bytes->size());
-                    tex = image.textureID;
-                    texSize = image.size;
-                    Logger::instance().log("localtunnel", Logger::Level::Info, "Marker Texture Created: " + std::to_string(tex));
-                }
-                const auto& mm = *m.markerMeta;
-                flecs::entity marker = ecs.entity()
-                                           .set(Identifier{mm.markerId})
-                                           .set(Position{mm.pos.x, mm.pos.y}) //World Position
-                                           .set(Size{mm.size.width, mm.size.height})
-                                           .set(TextureComponent{tex, "", texSize})
-                                           .set(Visibility{mm.vis})
-                                           .set(MarkerComponent{"", "", false, false})
-                                           .set(Moving{mm.mov});
-                marker.add(flecs::ChildOf, boardEnt);
-                Logger::instance().log("localtunnel", Logger::Level::Info, "Marker Created");
+            fog.add<FogOfWar>();
+            fog.add(flecs::ChildOf, boardEnt);
+            Logger::instance().log("localtunnel", Logger::Level::Info, "Fog Created");
+            break;
+        }
+
+        case msg::DCType::FogUpdate:
+        {
+            if (!m.boardId || !m.fogId)
+                break;
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
                 break;
-            }
 
-            case msg::DCType::FogCreate:
-            {
-                if (!m.boardId || !m.fogId || !m.pos || !m.size || !m.vis)
-                    break;
-                auto boardEnt = board_manager->findBoardById(*m.boardId);
-                if (!boardEnt.is_valid())
-                    break;
+            flecs::entity fogEnt;
+            boardEnt.children([&](flecs::entity child)
+                              {
+                if (child.has<FogOfWar>()) {
+                    auto id = child.get<Identifier>()->id;
+                    if (id == *m.fogId) fogEnt = child;
+                    } });
+            if (!fogEnt.is_valid())
+                break;
 
-                auto fog = ecs.entity()
-                               .set(Identifier{*m.fogId})
-                               .set(Position{m.pos->x, m.pos->y})
-                               .set(Size{m.size->width, m.size->height})
-                               .set(Visibility{*m.vis});
+            if (m.pos)
+                fogEnt.set<Position>(*m.pos);
+            if (m.size)
+                fogEnt.set<Size>(*m.size);
+            if (m.vis)
+                fogEnt.set<Visibility>(*m.vis);
+            if (m.mov)
+                fogEnt.set<Moving>(*m.mov); // if used
+            break;
+        }
 
-                fog.add<FogOfWar>();
-                fog.add(flecs::ChildOf, boardEnt);
-                Logger::instance().log("localtunnel", Logger::Level::Info, "Fog Created");
+        case msg::DCType::FogDelete:
+        {
+            if (!m.boardId || !m.fogId)
+                break;
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
                 break;
-            }
 
-            case msg::DCType::FogUpdate:
-            {
-                if (!m.boardId || !m.fogId)
-                    break;
-                auto boardEnt = board_manager->findBoardById(*m.boardId);
-                if (!boardEnt.is_valid())
-                    break;
+            flecs::entity fogEnt;
+            boardEnt.children([&](flecs::entity child)
+                              {
+                if (child.has<FogOfWar>()) {
+                    auto id = child.get<Identifier>()->id;
+                    if (id == *m.fogId) fogEnt = child;
+                } });
+            if (fogEnt.is_valid())
+                fogEnt.destruct();
+            break;
+        }
 
-                flecs::entity fogEnt;
-                boardEnt.children([&](flecs::entity child)
-                                  {
-                    if (child.has<FogOfWar>()) {
-                        auto id = child.get<Identifier>()->id;
-                        if (id == *m.fogId) fogEnt = child;
-                        } });
-                if (!fogEnt.is_valid())
-                    break;
+        case msg::DCType::MarkerMove:
+        {
+            if (!m.boardId || !m.markerId || !m.pos)
+                break;
 
-                if (m.pos)
-                    fogEnt.set<Position>(*m.pos);
-                if (m.size)
-                    fogEnt.set<Size>(*m.size);
-                if (m.vis)
-                    fogEnt.set<Visibility>(*m.vis);
-                if (m.mov)
-                    fogEnt.set<Moving>(*m.mov); // if used
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
                 break;
-            }
 
-            case msg::DCType::FogDelete:
-            {
-                if (!m.boardId || !m.fogId)
-                    break;
-                auto boardEnt = board_manager->findBoardById(*m.boardId);
-                if (!boardEnt.is_valid())
-                    break;
+            auto markerEnt = findMarkerInBoard(boardEnt, *m.markerId);
+            if (!markerEnt.is_valid())
+                break;
 
-                flecs::entity fogEnt;
-                boardEnt.children([&](flecs::entity child)
-                                  {
-                    if (child.has<FogOfWar>()) {
-                        auto id = child.get<Identifier>()->id;
-                        if (id == *m.fogId) fogEnt = child;
-                    } });
-                if (fogEnt.is_valid())
-                    fogEnt.destruct();
+            // Epoch/seq gate; apply streaming position, keep Moving true during drag
+            const bool apply = network_manager->shouldApplyMarkerMove(m);
+            if (apply)
+                markerEnt.set<Position>(*m.pos);
+            network_manager->ackMarkerMove(m, markerEnt, apply); // GM only
+            break;
+        }
+
+        case msg::DCType::MarkerGroupOp:
+        {
+            if (!m.boardId || !m.groupOp || !m.ids)
                 break;
-            }
 
-            case msg::DCType::MarkerMove:
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
+                break;
+
+            // one pass over the board rather than a lookup per member
+            std::pmr::unordered_map<uint64_t, flecs::entity> members(&frameArena_);
+            members.reserve(m.ids->size());
+            for (auto id : *m.ids)
+                members.emplace(id, flecs::entity());
+            boardEnt.children([&](flecs::entity child)
+                              {
+                if (!child.has<MarkerComponent>() || !child.has<Identifier>())
+                    return;
+                if (auto it = members.find(child.get<Identifier>()->id); it != members.end())
+                    it->second = child; });
+
+            const auto op = *m.groupOp;
+            if (op == msg::GroupOp::Move || op == msg::GroupOp::MoveEnd)
             {
-                // Epoch/seq gate (no side effects)
-                if (!network_manager->shouldApplyMarkerMove(m))
+                if (!network_manager->shouldApplyGroupMove(m))
                     break;
+                for (size_t i = 0; i < m.ids->size(); ++i)
+                {
+                    const uint64_t id = (*m.ids)[i];
+                    auto e = members[id];
+                    if (!e.is_valid() || !network_manager->groupMayMove(m, id))
+                        continue;
+                    if (op == msg::GroupOp::Move && m.pos && e.has<Position>())
+                    {
+                        e.set<Position>(network_manager->groupMoveTarget(m, id, *e.get<Position>()));
+                        if (const auto* mv = e.get<Moving>(); !mv || !mv->isDragging)
+                            e.set<Moving>(Moving{true});
+                    }
+                    else if (op == msg::GroupOp::MoveEnd)
+                    {
+                        if (m.positions && i < m.positions->size())
+                            e.set<Position>((*m.positions)[i]);
+                        e.set<Moving>(Moving{false});
+                    }
+                }
+            }
+            else if (op == msg::GroupOp::Visibility && m.vis)
+            {
+                for (auto& [id, e] : members)
+                {
+                    if (e.is_valid())
+                        e.set<Visibility>(*m.vis);
+                }
+            }
+            else if (op == msg::GroupOp::Delete)
+            {
+                for (auto& [id, e] : members)
+                {
+                    if (e.is_valid())
+                        e.destruct();
+                }
+                network_manager->forgetMarkerDrags(*m.ids);
+            }
+            break;
+        }
 
-                if (!m.boardId || !m.markerId || !m.pos)
-                    break;
+        case msg::DCType::MarkerMoveAck:
+        {
+            if (!m.boardId || !m.markerId)
+                break;
 
-                auto boardEnt = board_manager->findBoardById(*m.boardId);
-                if (!boardEnt.is_valid())
-                    break;
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
+                break;
 
-                auto markerEnt = findMarkerInBoard(boardEnt, *m.markerId);
-                if (!markerEnt.is_valid())
-                    break;
+            auto markerEnt = findMarkerInBoard(boardEnt, *m.markerId);
+            if (!markerEnt.is_valid() || !markerEnt.has<Position>())
+                break;
 
-                // Apply streaming position; keep Moving true during drag
-                markerEnt.set<Position>(*m.pos);
-                //markerEnt.set<Moving>(Moving{true});
+            // our own moves were applied when made; only move it if the GM saw it differently
+            auto corrected = network_manager->reconcileMarkerMove(m, *markerEnt.get<Position>());
+            if (!corrected)
                 break;
-            }
+            markerEnt.set<Position>(*corrected);
+            if (m.accepted && !*m.accepted)
+                markerEnt.set<Moving>(Moving{false}); // drag refused: hand the marker back
+            break;
+        }
 
-            case msg::DCType::MarkerMoveState:
-            {
-                if (!m.boardId || !m.markerId)
-                    break;
+        case msg::DCType::StateHash:
+            network_manager->checkStateHash(m); // player
+            break;
 
-                auto boardEnt = board_manager->findBoardById(*m.boardId);
-                if (!boardEnt.is_valid())
-                    break;
+        case msg::DCType::StateHashLeaves:
+            network_manager->repairStateHash(m); // GM
+            break;
 
-                auto markerEnt = findMarkerInBoard(boardEnt, *m.markerId);
-                if (!markerEnt.is_valid())
-                    break;
+        case msg::DCType::BoardView:
+            network_manager->onPeerBoardView(m);
+            break;
 
-                // Start of drag
-                if (m.mov && m.mov->isDragging)
-                {
-                    if (!network_manager->shouldApplyMarkerMoveStateStart(m))
-                        break;
+        case msg::DCType::BoardSwitch:
+        {
+            if (!m.boardId || network_manager->getPeerRole() != Role::PLAYER)
+                break;
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (boardEnt.is_valid())
+                board_manager->setActiveBoard(boardEnt); // its BoardView brings the catch-up
+            else
+                network_manager->announceBoardView(); // not held after all: the GM sends it whole
+            break;
+        }
+
+        case msg::DCType::MarkerMoveState:
+        {
+            if (!m.boardId || !m.markerId)
+                break;
+
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
+                break;
+
+            auto markerEnt = findMarkerInBoard(boardEnt, *m.markerId);
+            if (!markerEnt.is_valid())
+                break;
 
-                    // optional visual sync (safe; local drags are already set locally)
+            // Start of drag
+            if (m.mov && m.mov->isDragging)
+            {
+                const bool apply = network_manager->shouldApplyMarkerMoveStateStart(m);
+                // optional visual sync (safe; local drags are already set locally)
+                if (apply)
                     markerEnt.set<Moving>(Moving{true});
-                }
-                else // End of drag (final)
+                network_manager->ackMarkerMove(m, markerEnt, apply);
+            }
+            else // End of drag (final)
+            {
+                const bool apply = network_manager->shouldApplyMarkerMoveStateFinal(m);
+                if (apply)
                 {
-                    if (!network_manager->shouldApplyMarkerMoveStateFinal(m))
-                        break;
-
                     if (m.pos)
                         markerEnt.set<Position>(*m.pos);
                     markerEnt.set<Moving>(Moving{false}); // ensure drag ends
                 }
-                break;
+                network_manager->ackMarkerMove(m, markerEnt, apply);
             }
+            break;
+        }
 
-            case msg::DCType::MarkerUpdate:
+        case msg::DCType::MarkerUpdate:
+        {
+            if (!m.boardId || !m.markerId)
+                break;
+
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
+                break;
+
+            auto markerEnt = findMarkerInBoard(boardEnt, *m.markerId);
+            if (!markerEnt.is_valid())
+                break;
+
+            // Apply only non-movement attributes
+            if (m.size)
+                markerEnt.set<Size>(*m.size);
+            if (m.vis)
+                markerEnt.set<Visibility>(*m.vis);
+            if (m.markerComp)
             {
-                if (!m.boardId || !m.markerId)
-                    break;
+                std::string oldOwnerUid = markerEnt.get<MarkerComponent>()->ownerUniqueId;
+                if (oldOwnerUid != m.markerComp->ownerUniqueId)
+                    network_manager->drag_.erase(*m.markerId);
+                markerEnt.set<MarkerComponent>(*m.markerComp);
+            }
 
-                auto boardEnt = board_manager->findBoardById(*m.boardId);
-                if (!boardEnt.is_valid())
-                    break;
+            break;
+        }
 
+        case msg::DCType::EntityDelta:
+        {
+            if (!m.boardId)
+                break;
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
+                break;
+
+            if (m.markerId)
+            {
                 auto markerEnt = findMarkerInBoard(boardEnt, *m.markerId);
                 if (!markerEnt.is_valid())
                     break;
-
-                // Apply only non-movement attributes
+                if (m.pos && !network_manager->amIDragging(*m.markerId))
+                    markerEnt.set<Position>(*m.pos);
                 if (m.size)
                     markerEnt.set<Size>(*m.size);
                 if (m.vis)
                     markerEnt.set<Visibility>(*m.vis);
                 if (m.markerComp)
                 {
-                    std::string oldOwnerUid = markerEnt.get<MarkerComponent>()->ownerUniqueId;
-                    if (oldOwnerUid != m.markerComp->ownerUniqueId)
+                    if (markerEnt.get<MarkerComponent>()->ownerUniqueId != m.markerComp->ownerUniqueId)
                         network_manager->drag_.erase(*m.markerId);
                     markerEnt.set<MarkerComponent>(*m.markerComp);
                 }
-
-                break;
             }
-
-            case msg::DCType::MarkerDelete:
+            else if (m.fogId)
             {
-                if (!m.boardId || !m.markerId)
-                    break;
-                auto boardEnt = board_manager->findBoardById(*m.boardId);
-                if (!boardEnt.is_valid())
-                    break;
-
-                flecs::entity markerEnt;
+                flecs::entity fogEnt;
                 boardEnt.children([&](flecs::entity child)
                                   {
-                    if (child.has<MarkerComponent>()) {
-                        auto id = child.get<Identifier>()->id;
-                        if (id == *m.markerId) markerEnt = child;
-                    } });
-                if (markerEnt.is_valid())
-                    markerEnt.destruct();
-                break;
+                    if (child.has<FogOfWar>() && child.get<Identifier>()->id == *m.fogId)
+                        fogEnt = child; });
+                if (!fogEnt.is_valid())
+                    break;
+                if (m.pos)
+                    fogEnt.set<Position>(*m.pos);
+                if (m.size)
+                    fogEnt.set<Size>(*m.size);
+                if (m.vis)
+                    fogEnt.set<Visibility>(*m.vis);
             }
-
-            // GameTableManager.cpp — inside processReceivedMessages() switch:
-            case msg::DCType::UserNameUpdate:
+            else if (m.grid)
             {
-                if (!m.tableId || !m.userUniqueId || !m.name || !m.text)
-                    break;
-                if (*m.tableId != chat_manager->currentTableId_)
-                    break;
-
-                const std::string uniqueId = *m.userUniqueId; // now uniqueId
-                const std::string fromPeerId = m.fromPeerId;
-                const std::string newU = *m.name;
-
-                // 1) record in address book
-                network_manager->upsertPeerIdentityWithUnique(/*peerId=*/m.fromPeerId, /*uniqueId=*/uniqueId, /*username=*/newU);
-                identity_manager->setUsernameForUnique(uniqueId, newU);
-                board_manager->onUsernameChanged(uniqueId, newU);
-                chat_manager->replaceUsernameForUnique(uniqueId, newU);
-
-                break;
+                boardEnt.set<Grid>(*m.grid);
             }
+            break;
+        }
 
-            case msg::DCType::ChatGroupCreate:
-            {
-                chat_manager->applyReady(m);
+        case msg::DCType::MarkerDelete:
+        {
+            if (!m.boardId || !m.markerId)
                 break;
-            }
-            case msg::DCType::ChatGroupUpdate:
-            {
-                chat_manager->applyReady(m);
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
                 break;
-            }
-            case msg::DCType::ChatGroupDelete:
-            {
-                chat_manager->applyReady(m);
+
+            flecs::entity markerEnt;
+            boardEnt.children([&](flecs::entity child)
+                              {
+                if (child.has<MarkerComponent>()) {
+                    auto id = child.get<Identifier>()->id;
+                    if (id == *m.markerId) markerEnt = child;
+                } });
+            if (markerEnt.is_valid())
+                markerEnt.destruct();
+            break;
+        }
+
+        // GameTableManager.cpp — inside processReceivedMessages() switch:
+        case msg::DCType::UserNameUpdate:
+        {
+            if (!m.tableId || !m.userUniqueId || !m.name || !m.text)
                 break;
-            }
-            case msg::DCType::ChatMessage:
-            {
-                chat_manager->applyReady(m);
+            if (*m.tableId != chat_manager->currentTableId_)
                 break;
-            }
 
-            case msg::DCType::GridUpdate:
-            {
-                if (!m.boardId || !m.grid)
-                    break;
+            const std::string uniqueId = *m.userUniqueId; // now uniqueId
+            const std::string fromPeerId = m.fromPeerId;
+            const std::string newU = *m.name;
 
-                auto boardEnt = board_manager->findBoardById(*m.boardId);
-                if (!boardEnt.is_valid())
-                    break;
+            // 1) record in address book
+            network_manager->upsertPeerIdentityWithUnique(/*peerId=*/m.fromPeerId, /*uniqueId=*/uniqueId, /*username=*/newU);
+            identity_manager->setUsernameForUnique(uniqueId, newU);
+            board_manager->onUsernameChanged(uniqueId, newU);
+            chat_manager->replaceUsernameForUnique(uniqueId, newU);
 
-                boardEnt.set<Grid>(*m.grid);
-                break;
-            }
+            break;
+        }
 
-            case msg::DCType::NoteCreate:
-            {
+        case msg::DCType::ChatGroupCreate:
+        {
+            chat_manager->applyReady(m);
+            break;
+        }
+        case msg::DCType::ChatGroupUpdate:
+        {
+            chat_manager->applyReady(m);
+            break;
+        }
+        case msg::DCType::ChatGroupDelete:
+        {
+            chat_manager->applyReady(m);
+            break;
+        }
+        case msg::DCType::ChatMessage:
+        {
+            chat_manager->applyReady(m);
+            break;
+        }
+        case msg::DCType::ChatImageThumb:
+        case msg::DCType::ChatImageChunk:
+        {
+            chat_manager->applyReady(m);
+            break;
+        }
+
+        case msg::DCType::GridUpdate:
+        {
+            if (!m.boardId || !m.grid)
                 break;
-            }
 
-            case msg::DCType::NoteUpdate:
-            {
+            auto boardEnt = board_manager->findBoardById(*m.boardId);
+            if (!boardEnt.is_valid())
                 break;
-            }
 
-            case msg::DCType::NoteDelete:
+            boardEnt.set<Grid>(*m.grid);
+            break;
+        }
+
+        case msg::DCType::NoteCreate:
+        {
+            break;
+        }
+
+        case msg::DCType::NoteUpdate:
+        {
+            break;
+        }
+
+        case msg::DCType::NoteDelete:
+        {
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+// Kicks off decode/upload for a committed image. The entity renders a placeholder until the
+// upload finishes, then gets the real texture size (and Size, for boards).
+// Moves the CommitMarker run at the backlog head (same board, up to maxCount) into run.
+size_t GameTableManager::takeMarkerCommitRun(std::vector<msg::ReadyMessage>& run, size_t maxCount)
+{
+    const auto boardId = readyBacklog_.front().boardId;
+    while (!readyBacklog_.empty() && run.size() < maxCount)
+    {
+        auto& head = readyBacklog_.front();
+        if (head.kind != msg::DCType::CommitMarker || head.boardId != boardId)
+            break;
+        run.push_back(std::move(head));
+        readyBacklog_.pop_front();
+    }
+    return run.size();
+}
+
+// New markers of the run are created with one bulk insert; a revealed stub comes back as a full
+// marker and is updated in place. The board's markers are looked up once for the whole run.
+void GameTableManager::applyMarkerCommits(std::span<msg::ReadyMessage> run)
+{
+    if (run.empty() || !run.front().boardId)
+        return;
+    auto boardEnt = board_manager->findBoardById(*run.front().boardId);
+    if (!boardEnt.is_valid())
+        return;
+
+    std::unordered_map<uint64_t, flecs::entity> existing;
+    boardEnt.children([&](flecs::entity child)
+                      {
+        if (child.has<MarkerComponent>())
+            if (auto id = child.get<Identifier>())
+                existing.emplace(id->id, child); });
+
+    MarkerRows rows;
+    rows.reserve(run.size());
+    std::vector<msg::ReadyMessage*> created; // row -> its message, for the texture
+    std::unordered_map<uint64_t, size_t> rowOf;
+    for (auto& m : run)
+    {
+        if (!m.markerMeta)
+            continue;
+        const auto& mm = *m.markerMeta;
+        if (auto it = existing.find(mm.markerId); it != existing.end())
+        {
+            it->second.set(Position{mm.pos.x, mm.pos.y})
+                .set(Size{mm.size.width, mm.size.height})
+                .set(Visibility{mm.vis})
+                .set(Moving{mm.mov});
+            attachNetworkTexture(it->second, m, /*sizeFromTexture*/ false);
+            continue;
+        }
+        if (auto it = rowOf.find(mm.markerId); it != rowOf.end())
+        {
+            // sent twice in one run: the later one wins
+            const size_t r = it->second;
+            rows.positions[r] = Position{mm.pos.x, mm.pos.y};
+            rows.sizes[r] = Size{mm.size.width, mm.size.height};
+            rows.textures[r].size = glm::vec2{mm.size.width, mm.size.height};
+            rows.visibility[r] = Visibility{mm.vis};
+            rows.moving[r] = Moving{mm.mov};
+            created[r] = &m;
+            continue;
+        }
+        rowOf.emplace(mm.markerId, rows.size());
+        rows.push(Identifier{mm.markerId}, Position{mm.pos.x, mm.pos.y}, //World Position
+                  Size{mm.size.width, mm.size.height}, TextureComponent{0, "", glm::vec2{mm.size.width, mm.size.height}},
+                  Visibility{mm.vis}, MarkerComponent{"", "", false, false}, Moving{mm.mov});
+        created.push_back(&m);
+    }
+
+    auto markers = EntityBulk::spawnMarkers(ecs, rows, boardEnt);
+    for (size_t r = 0; r < markers.size(); ++r)
+        attachNetworkTexture(markers[r], *created[r], /*sizeFromTexture*/ false);
+    if (!markers.empty())
+        Logger::instance().log("localtunnel", Logger::Level::Info, "Markers Created: " + std::to_string(markers.size()));
+}
+
+void GameTableManager::attachNetworkTexture(flecs::entity e, msg::ReadyMessage& m, bool sizeFromTexture)
+{
+    const bool streamed = m.decoded.has_value();
+    auto lastByteMs = m.lastByteMs;
+    auto nm = network_manager;
+    auto onReady = [e, nm, lastByteMs, streamed, sizeFromTexture](GLuint tex, glm::vec2 size, bool ok) mutable
+    {
+        if (!ok)
+        {
+            // the gray placeholder stays so the marker can still be seen, picked and deleted
+            Logger::instance().log("localtunnel", Logger::Level::Warn, "Texture for entity " + std::to_string(e.id()) + " failed to decode");
+            return;
+        }
+        if (e.is_alive())
+        {
+            if (auto texture = e.get_mut<TextureComponent>())
             {
-                break;
+                texture->textureID = tex;
+                texture->size = size;
             }
-
-            default:
-                break;
+            if (sizeFromTexture)
+                e.set(Size{size.x, size.y});
         }
+        if (lastByteMs)
+            nm->recordImageReady(*lastByteMs, streamed);
+    };
 
-        ++processed;
+    if (HeadlessMode::enabled())
+    {
+        // no GL on the dedicated host: keep the size, never upload
+        glm::vec2 size{0.0f, 0.0f};
+        int w = 0, h = 0, comp = 0;
+        if (m.decoded)
+            size = glm::vec2(m.decoded->width, m.decoded->height);
+        else if (m.bytes && !m.bytes->empty() && stbi_info_from_memory(m.bytes->data(), static_cast<int>(m.bytes->size()), &w, &h, &comp))
+            size = glm::vec2(w, h);
+        else if (m.mapped && stbi_info_from_memory(m.mapped.get(), static_cast<int>(m.mappedSize), &w, &h, &comp))
+            size = glm::vec2(w, h);
+        onReady(0, size, true);
+        return;
     }
+
+    GLuint tex = 0;
+    if (m.decoded)
+        tex = board_manager->LoadTextureAsync(m.decoded->rgba, m.decoded->width, m.decoded->height, std::move(onReady));
+    else if (m.bytes && !m.bytes->empty())
+        tex = board_manager->LoadTextureAsync(std::move(*m.bytes), std::move(onReady));
+    else if (m.mapped)
+        tex = board_manager->LoadTextureAsync(std::move(m.mapped), m.mappedSize, std::move(onReady));
+    else
+        return;
+
+    if (auto texture = e.get_mut<TextureComponent>())
+        texture->textureID = tex;
 }
 
 void GameTableManager::setCameraFboDimensions(glm::vec2 fbo_dimensions)
@@ -499,10 +971,19 @@ void GameTableManager::handleMouseButtonInputs()
         if (board_manager->getCurrentTool() == Tool::SELECT)
         {
             auto entity = board_manager->getEntityAtMousePosition(current_mouse_world_pos);
-            if (entity.is_valid())
+            if (entity.is_valid() && entity.has<MarkerComponent>() && ImGui::GetIO().KeyCtrl)
+            {
+                board_manager->toggleSelected(entity);
+            }
+            else if (entity.is_valid())
             {
+                board_manager->clearSelection();
                 board_manager->setShowEditWindow(true, entity);
             }
+            else
+            {
+                board_manager->startBoxSelect(current_mouse_world_pos);
+            }
         }
     }
 
@@ -518,6 +999,10 @@ void GameTableManager::handleMouseButtonInputs()
             board_manager->handleFogCreation(current_mouse_world_pos); // Use world_pos
             board_manager->endMouseDrag();
         }
+        if (board_manager->isBoxSelecting())
+        {
+            board_manager->endBoxSelect(current_mouse_world_pos, ImGui::GetIO().KeyCtrl);
+        }
     }
 
     board_manager->killIfMouseUp(ImGui::IsMouseDown(ImGuiMouseButton_Left));
@@ -537,6 +1022,11 @@ void GameTableManager::handleCursorInputs()
     {
         board_manager->panBoard(current_mouse_fbo_pos);
     }
+
+    if (board_manager->isBoxSelecting())
+    {
+        board_manager->updateBoxSelect(current_mouse_world_pos);
+    }
 }
 
 void GameTableManager::handleScrollInputs()
@@ -797,6 +1287,14 @@ void GameTableManager::loadBoardPopUp()
                 loaded = true;
                 ImGui::CloseCurrentPopup();
             }
+            if (network_manager->isHosting())
+            {
+                // players get upcoming boards streamed first, so the switch is instant
+                ImGui::SameLine();
+                bool upcoming = network_manager->isBoardUpcoming(board);
+                if (ImGui::Checkbox(("Upcoming##" + board).c_str(), &upcoming))
+                    network_manager->setBoardUpcoming(board, upcoming);
+            }
         }
 
         UI_TransientLine("board-loaded", loaded, ImVec4(0.4f, 1.f, 0.4f, 1.f), "Board Loaded!", 1.5f);
@@ -975,10 +1473,39 @@ void GameTableManager::renderNetworkCenterGM()
     ImGui::TextUnformatted(local_ip.c_str());
     ImGui::TextUnformatted("External IP:");
     ImGui::SameLine();
-    ImGui::TextUnformatted(external_ip.c_str());
+    ImGui::TextUnformatted(external_ip.empty() ? "(looking up...)" : external_ip.c_str());
     ImGui::TextUnformatted("Port:");
     ImGui::SameLine();
     ImGui::Text("%u", port);
+    if (auto discovery = network_manager->getHostDiscovery())
+    {
+        ImGui::TextUnformatted("UPnP gateway:");
+        ImGui::SameLine();
+        switch (discovery->gatewayState())
+        {
+            case HostDiscovery::State::Ready:
+                ImGui::TextUnformatted(discovery->gatewayDescription().c_str());
+                break;
+            case HostDiscovery::State::Failed:
+                ImGui::TextDisabled("none found");
+                break;
+            default:
+                ImGui::TextDisabled("(looking up...)");
+                break;
+        }
+    }
+
+    bool prefetchHidden = network_manager->prefetchHiddenArt();
+    if (ImGui::Checkbox("Prefetch hidden marker art", &prefetchHidden))
+        network_manager->setPrefetchHiddenArt(prefetchHidden);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Reveals are instant, but players could find hidden art in their traffic.");
+
+    bool swarm = network_manager->swarmImages();
+    if (ImGui::Checkbox("Share image uploads between players", &swarm))
+        network_manager->setSwarmImages(swarm);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Big images are uploaded once and players pass the pieces on to each other.");
 
     ImGui::Separator();
 
@@ -987,6 +1514,11 @@ void GameTableManager::renderNetworkCenterGM()
     {
         ImGui::TextUnformatted(label);
         ImGui::SameLine();
+        if (value.empty())
+        {
+            ImGui::TextDisabled("(looking up...)");
+            return;
+        }
         ImGui::TextUnformatted(value.c_str());
         ImGui::SameLine();
         UI_CopyButtonWithToast(btnId, value, toastId, 1.5f);
@@ -1107,6 +1639,8 @@ void GameTableManager::renderNetworkCenterGM()
         ImGui::EndTable();
     }
 
+    renderNetworkStats();
+
     // ---------- Controls ----------
     ImGui::Separator();
     if (ImGui::Button("Disconnect All"))
@@ -1136,6 +1670,90 @@ void GameTableManager::renderNetworkCenterGM()
     }
 }
 
+void GameTableManager::renderNetworkStats()
+{
+    ImGui::Separator();
+    if (!ImGui::CollapsingHeader("Network Stats"))
+        return;
+
+    auto mb = [](uint64_t bytes)
+    { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+
+    size_t rss = 0, peakRss = 0;
+    if (NetworkUtilities::getProcessMemory(rss, peakRss))
+        ImGui::Text("Process RSS: %.1f MB (peak %.1f MB)", mb(rss), mb(peakRss));
+
+    const auto rx = network_manager->getImageRxStats();
+    ImGui::Text("Images in flight: %zu", rx.inFlight);
+    ImGui::Text("In-flight memory: %.1f MB (peak %.1f MB)", mb(rx.memBytes), mb(rx.peakMemBytes));
+    ImGui::Text("Spilled to disk: %.1f MB (%llu transfers), temp files %.1f / %.0f MB", mb(rx.spillBytes),
+                static_cast<unsigned long long>(rx.spilledCount), mb(ImageSpool::spilledBytes()), mb(ImageSpool::kSpillBudget));
+    ImGui::Text("Refused transfers: %llu", static_cast<unsigned long long>(rx.refusedCount));
+    const auto pf = network_manager->getPrefetchCacheStats();
+    ImGui::Text("Prefetched images: %zu (+%zu partial), %.1f MB (%llu hits, %llu misses), %zu boards queued", pf.entries, pf.assembling, mb(pf.bytes),
+                static_cast<unsigned long long>(pf.hits), static_cast<unsigned long long>(pf.misses),
+                network_manager->prefetchQueueDepth());
+    const auto dc = network_manager->getDiskCacheStats();
+    ImGui::Text("Disk image cache: %zu images, %.1f MB (%llu hits, %llu misses, %llu writes dropped)", dc.entries, mb(dc.bytes),
+                static_cast<unsigned long long>(dc.hits), static_cast<unsigned long long>(dc.misses),
+                static_cast<unsigned long long>(dc.droppedWrites));
+    const auto sh = network_manager->getStateHashStats();
+    ImGui::Text("Board hash: %llu checks, %llu mismatches, %llu entities repaired, refresh %llu us (max %llu us)",
+                static_cast<unsigned long long>(sh.checks), static_cast<unsigned long long>(sh.mismatches),
+                static_cast<unsigned long long>(sh.repaired), static_cast<unsigned long long>(sh.lastRefreshUs),
+                static_cast<unsigned long long>(sh.maxRefreshUs));
+    const auto ist = network_manager->getInterestStats();
+    ImGui::Text("Interest: %llu sends skipped (peer on another board), %llu board switches, %llu catch-ups",
+                static_cast<unsigned long long>(ist.skippedSends), static_cast<unsigned long long>(ist.switches),
+                static_cast<unsigned long long>(ist.catchUps));
+    const auto sw = network_manager->getSwarmStats();
+    ImGui::Text("Swarm pieces: %llu seeded, %llu served, %llu from peers, %llu bad, %llu fallbacks",
+                static_cast<unsigned long long>(sw.piecesSeeded), static_cast<unsigned long long>(sw.piecesServed),
+                static_cast<unsigned long long>(sw.piecesFromPeers), static_cast<unsigned long long>(sw.badPieces),
+                static_cast<unsigned long long>(sw.fallbacks));
+    auto& pool = BufferPool::instance();
+    ImGui::Text("Net buffers: %.0f frames/s, %.0f heap allocs/s (%zu pooled)",
+                pool.acquiresPerSec(), pool.heapAllocsPerSec(), pool.pooled());
+    {
+        // a fast session replay loads every shard; even busy times mean the peers spread out
+        std::string perShard;
+        const auto counts = network_manager->decodeShardCounts();
+        const auto busy = network_manager->decodeShardBusyMs();
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            char buf[48];
+            snprintf(buf, sizeof(buf), "%llu in %.0f ms", static_cast<unsigned long long>(counts[i]), i < busy.size() ? busy[i] : 0.0);
+            perShard += (perShard.empty() ? "" : " / ") + std::string(buf);
+        }
+        ImGui::Text("Decode shards: %zu, %zu queued (decoded %s)", network_manager->decodeShardCount(),
+                    network_manager->inboundRawDepth(), perShard.c_str());
+    }
+    if (const auto& rec = network_manager->getRecorder(); rec.isRecording())
+        ImGui::Text("Capturing: %llu messages, %.1f MB", static_cast<unsigned long long>(rec.messages()), mb(rec.bytes()));
+    if (const auto* rp = replay_ ? replay_->replayer() : nullptr)
+        ImGui::Text("Replay (sandbox): %llu messages, %.0f%% in %.0f ms%s, %zu entities", static_cast<unsigned long long>(rp->fed()),
+                    rp->progress() * 100.0, rp->elapsedMs(), rp->done() ? (rp->failed() ? " (failed)" : " (done)") : "",
+                    replay_->entityCount());
+    ImGui::Text("Signaling auth: %llu ms%s", static_cast<unsigned long long>(network_manager->signalingAuthMs()),
+                network_manager->isLanMode() ? " (LAN mode, no STUN)" : "");
+    for (const auto& [pid, link] : network_manager->getPeers())
+        if (link)
+            ImGui::Text("  %s setup: %s", network_manager->displayNameForPeer(pid).c_str(), link->phaseSummary().c_str());
+
+    const auto& ts = board_manager->getTextureStreamer();
+    ImGui::Text("Textures: %zu decoding, %zu uploading (upload %.2f ms/frame, max %.2f ms)",
+                ts.pendingDecodes(), ts.pendingUploads(), ts.lastPumpMs(), ts.maxPumpMs());
+    if (rx.readyCount > 0)
+    {
+        ImGui::Text("Last byte -> texture visible: last %llu ms, avg %llu ms, max %llu ms",
+                    static_cast<unsigned long long>(rx.lastReadyMs),
+                    static_cast<unsigned long long>(rx.sumReadyMs / rx.readyCount),
+                    static_cast<unsigned long long>(rx.maxReadyMs));
+        ImGui::Text("Streamed decodes: %llu / %llu", static_cast<unsigned long long>(rx.streamedCount),
+                    static_cast<unsigned long long>(rx.readyCount));
+    }
+}
+
 void GameTableManager::renderNetworkCenterPlayer()
 {
     // Username
@@ -1185,6 +1803,8 @@ void GameTableManager::renderNetworkCenterPlayer()
 
         ImGui::EndTable();
     }
+    renderNetworkStats();
+
     // At end of renderNetworkCenterPlayer()
     if (ImGui::Button("Disconnect"))
     {
@@ -1991,28 +2611,3 @@ void GameTableManager::aboutPopUp()
         ImGui::EndPopup();
     }
 }
-
-void GameTableManager::render(VertexArray& va, IndexBuffer& ib, Shader& shader, Shader& grid_shader, Renderer& renderer)
-{
-    if (isGameTableActive())
-    {
-        chat_manager->render();
-    }
-    if (board_manager->isBoardActive())
-    {
-        if (board_manager->isEditWindowOpen())
-        {
-            board_manager->renderEditWindow();
-        }
-        else
-        {
-            board_manager->setShowEditWindow(false);
-        }
-
-        if (network_manager->getPeerRole() == Role::GAMEMASTER)
-        {
-            board_manager->marker_directory->renderDirectory();
-        }
-        board_manager->renderBoard(va, ib, shader, grid_shader, renderer);
-    }
-}
@@ -35,7 +35,7 @@ bool IdentityManager::loadMyIdentityFromFile()
 
 bool IdentityManager::saveMyIdentityToFile() const
 {
-    return writeMeFile();
+    return persistent_ && writeMeFile();
 }
 
 void IdentityManager::setMyIdentity(const std::string& uniqueId, const std::string& username)
@@ -68,7 +68,7 @@ bool IdentityManager::loadAddressBookFromFile()
 
 bool IdentityManager::saveAddressBookToFile() const
 {
-    return writeBookFile();
+    return persistent_ && writeBookFile();
 }
 //
 //void IdentityManager::bindPeer(const std::string& peerId,
@@ -0,0 +1,55 @@
+#include "ReplaySandbox.h"
+#include "GameTableManager.h"
+#include "PathManager.h"
+
+ReplaySandbox::ReplaySandbox()
+{
+    // same registrations as ApplicationHandler
+    ecs_.component<Position>();
+    ecs_.component<Size>();
+    ecs_.component<Visibility>();
+    ecs_.component<Moving>();
+    ecs_.component<TextureComponent>();
+    ecs_.component<Panning>();
+    ecs_.component<Grid>();
+    ecs_.component<Board>();
+    ecs_.component<MarkerComponent>();
+    ecs_.component<FogOfWar>();
+    ecs_.component<GameTable>();
+    ecs_.component<Notes>();
+    ecs_.component<Identifier>();
+    ecs_.component<NoteComponent>();
+
+    // never monitored, the sandbox only needs somewhere for BoardManager to point at
+    map_directory_ = std::make_shared<DirectoryWindow>(PathManager::getMapsPath().string(), "ReplayMaps", DirectoryKind::MAP);
+    marker_directory_ = std::make_shared<DirectoryWindow>(PathManager::getMarkersPath().string(), "ReplayMarkers", DirectoryKind::MARKER);
+    tables_ = std::make_shared<GameTableManager>(ecs_, map_directory_, marker_directory_, /*replaySandbox*/ true);
+    tables_->setup();
+}
+
+ReplaySandbox::~ReplaySandbox()
+{
+    // the replayer feeds the shards from its own thread; stop it before the world goes
+    if (tables_ && tables_->network_manager)
+        tables_->network_manager->stopReplay();
+}
+
+bool ReplaySandbox::start(const std::filesystem::path& file, bool realtime)
+{
+    return tables_->network_manager->startReplay(file, realtime);
+}
+
+void ReplaySandbox::tick()
+{
+    tables_->processReceivedMessages();
+}
+
+const SessionReplayer* ReplaySandbox::replayer() const
+{
+    return tables_->network_manager->getReplayer();
+}
+
+size_t ReplaySandbox::entityCount() const
+{
+    return static_cast<size_t>(ecs_.count<Identifier>());
+}
@@ -0,0 +1,20 @@
+#include "GpuTextures.h"
+#include <atomic>
+
+// No context on the host: ids stay unique so TextureStreamer's bookkeeping keyed on them still
+// holds, nothing is ever drawn with them.
+namespace
+{
+    std::atomic<unsigned int> nextId{0};
+}
+
+unsigned int GpuTextures::create(int, int, const uint8_t*)
+{
+    return ++nextId;
+}
+
+void GpuTextures::allocate(unsigned int, int, int) {}
+
+void GpuTextures::uploadRows(unsigned int, int, int, int, const uint8_t*) {}
+
+void GpuTextures::destroy(unsigned int) {}
@@ -0,0 +1,392 @@
+#include "HeadlessHost.h"
+#include "HeadlessMode.h"
+#include "PathManager.h"
+#include "Logger.h"
+#include "NetSim.h"
+#include "ReplaySandbox.h"
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    std::mutex gPrintMtx;
+
+    const char* levelTag(Logger::Level lvl)
+    {
+        switch (lvl)
+        {
+            case Logger::Level::Trace:
+                return "TRACE";
+            case Logger::Level::Debug:
+                return "DEBUG";
+            case Logger::Level::Info:
+                return "INFO";
+            case Logger::Level::Warn:
+                return "WARN";
+            case Logger::Level::Error:
+                return "ERROR";
+            case Logger::Level::Success:
+                return "OK";
+        }
+        return "?";
+    }
+
+    std::filesystem::path captureFile()
+    {
+        char name[64];
+        const std::time_t t = std::time(nullptr);
+        const std::tm bt = Logger::localTime(t);
+        std::strftime(name, sizeof(name), "session-%Y%m%d-%H%M%S.rvtcap", &bt);
+        return PathManager::getCapturesPath() / name;
+    }
+
+    void println(const std::string& line)
+    {
+        std::lock_guard<std::mutex> lk(gPrintMtx);
+        std::cout << line << std::endl;
+    }
+} // namespace
+
+HeadlessHost::HeadlessHost(HeadlessHostOptions opts) :
+    opts_(std::move(opts))
+{
+    HeadlessMode::gEnabled = true; // before any DirectoryWindow/BoardManager loads an image
+
+    logSink_ = Logger::instance().addSink([](const std::string& channel, const Logger::LogEntry& e)
+                                          { println(std::string("[") + levelTag(e.level) + "][" + channel + "] " + e.text); });
+
+    map_directory_ = std::make_shared<DirectoryWindow>(PathManager::getMapsPath().string(), "MapsDiretory", DirectoryKind::MAP);
+    marker_directory_ = std::make_shared<DirectoryWindow>(PathManager::getMarkersPath().string(), "MarkersDirectory", DirectoryKind::MARKER);
+    game_table_manager_ = std::make_shared<GameTableManager>(ecs_, map_directory_, marker_directory_);
+
+    ImGuiToaster::Config cfg;
+    toaster_ = std::make_shared<ImGuiToaster>(cfg);
+    game_table_manager_->setup();
+    game_table_manager_->setToaster(toaster_);
+
+    // same registrations as ApplicationHandler
+    ecs_.component<Position>();
+    ecs_.component<Size>();
+    ecs_.component<Visibility>();
+    ecs_.component<Moving>();
+    ecs_.component<TextureComponent>();
+    ecs_.component<Panning>();
+    ecs_.component<Grid>();
+    ecs_.component<Board>();
+    ecs_.component<MarkerComponent>();
+    ecs_.component<FogOfWar>();
+    ecs_.component<GameTable>();
+    ecs_.component<Notes>();
+    ecs_.component<Identifier>();
+    ecs_.component<NoteComponent>();
+}
+
+HeadlessHost::~HeadlessHost()
+{
+    stop_.store(true);
+    if (game_table_manager_ && game_table_manager_->network_manager)
+    {
+        game_table_manager_->stopReplay();
+        game_table_manager_->network_manager->stopCapture();
+        game_table_manager_->network_manager->closeServer();
+    }
+    map_directory_->stopMonitoring();
+    marker_directory_->stopMonitoring();
+    Logger::instance().removeSink(logSink_);
+}
+
+std::filesystem::path HeadlessHost::resolveGameTablePath() const
+{
+    namespace fs = std::filesystem;
+    if (opts_.gameTable.extension() == ".runic" && fs::exists(opts_.gameTable))
+        return opts_.gameTable;
+    // table name, as listed under Documents/RunicVTT/GameTables
+    const std::string name = opts_.gameTable.stem().string();
+    return PathManager::getGameTablesPath() / name / (name + ".runic");
+}
+
+// The directory monitors queue their first scan from their own threads; the desktop app
+// picks it up in its frame loop before anyone can load a table, the host has to wait for it.
+void HeadlessHost::waitForDirectories()
+{
+    using namespace std::chrono_literals;
+    for (int i = 0; i < 10; ++i)
+    {
+        std::this_thread::sleep_for(100ms);
+        map_directory_->applyPendingAssetChanges();
+        marker_directory_->applyPendingAssetChanges();
+    }
+}
+
+bool HeadlessHost::start()
+{
+    auto nm = game_table_manager_->network_manager;
+
+    if (!opts_.gameTable.empty())
+    {
+        waitForDirectories();
+        const auto file = resolveGameTablePath();
+        game_table_manager_->game_table_name = file.stem().string();
+        game_table_manager_->loadGameTable(file);
+        if (!game_table_manager_->getActiveGameTableEntity().is_valid())
+        {
+            Logger::instance().log("main", Logger::Level::Error, "Host: cannot load game table " + file.string());
+            return false;
+        }
+        Logger::instance().log("main", Logger::Level::Success, "Host: loaded game table '" + game_table_manager_->game_table_name + "'");
+
+        auto identity = game_table_manager_->identity_manager;
+        identity->setMyIdentity(identity->myUniqueId(), opts_.username);
+        nm->setNetworkPassword(opts_.password.c_str());
+        nm->setCustomHost(opts_.customHost);
+        nm->startServer(opts_.mode, opts_.port, opts_.tryUpnp);
+        const auto info = nm->getNetworkInfo(opts_.mode);
+        Logger::instance().log("main", Logger::Level::Success,
+                               "Host: serving on " + (info.empty() ? "port " + std::to_string(nm->getPort()) + " (address still being looked up)" : info));
+    }
+
+    // before any traffic, so a seeded replay sees the same decisions every run
+    if (!opts_.netsim.empty())
+    {
+        NetSim::Config cfg;
+        std::string error;
+        if (!NetSim::parseSpec(opts_.netsim, cfg, &error))
+        {
+            Logger::instance().log("main", Logger::Level::Error, "Host: bad --netsim: " + error);
+            return false;
+        }
+        NetSim::instance().configure(cfg);
+    }
+
+    if (opts_.capture)
+        nm->startCapture(captureFile());
+    if (!opts_.replay.empty() && !game_table_manager_->startReplay(opts_.replay, opts_.replayRealtime))
+    {
+        Logger::instance().log("main", Logger::Level::Error, "Host: cannot replay " + opts_.replay.string());
+        return false;
+    }
+
+    started_ = std::chrono::steady_clock::now();
+    lastSave_ = started_;
+    return true;
+}
+
+int HeadlessHost::run()
+{
+    using clock = std::chrono::steady_clock;
+    const auto tick = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double, std::milli>(opts_.tickMs));
+
+    // getline can't be interrupted; the thread dies with the process
+    consoleThread_ = std::thread([this]()
+                                 { readConsole(); });
+    consoleThread_.detach();
+    printHelp();
+
+    auto nm = game_table_manager_->network_manager;
+    bool replayReported = false;
+    auto next = clock::now();
+    while (!stop_.load())
+    {
+        map_directory_->applyPendingAssetChanges();
+        marker_directory_->applyPendingAssetChanges();
+        game_table_manager_->processReceivedMessages();
+        drainCommands();
+        tickAutoSave();
+
+        const auto* sandbox = game_table_manager_->getReplaySandbox();
+        if (const auto* rp = sandbox ? sandbox->replayer() : nullptr; rp && rp->done() && !replayReported)
+        {
+            replayReported = true;
+            char line[160];
+            snprintf(line, sizeof(line), "Replay %s: %llu messages in %.0f ms", rp->failed() ? "failed" : "done",
+                     static_cast<unsigned long long>(rp->fed()), rp->elapsedMs());
+            println(line);
+            if (opts_.replayExit)
+                stop_.store(true);
+        }
+        else if (!rp)
+        {
+            replayReported = false;
+        }
+
+        next += tick;
+        const auto now = clock::now();
+        if (next < now)
+            next = now; // fell behind, don't try to catch up
+        else
+            std::this_thread::sleep_until(next);
+    }
+
+    if (opts_.autosaveSec > 0)
+        saveNow();
+    return 0;
+}
+
+void HeadlessHost::tickAutoSave()
+{
+    if (opts_.autosaveSec <= 0)
+        return;
+    const auto now = std::chrono::steady_clock::now();
+    if (now - lastSave_ < std::chrono::seconds(opts_.autosaveSec))
+        return;
+    lastSave_ = now;
+    saveNow();
+}
+
+// Same two steps as ApplicationHandler::TickAutoSave: the game table file, then the active board.
+bool HeadlessHost::saveNow()
+{
+    auto gametable_entity = game_table_manager_->getActiveGameTableEntity();
+    if (!gametable_entity.is_valid())
+        return false;
+    try
+    {
+        game_table_manager_->saveGameTable();
+        auto board_dir_path = PathManager::getBoardsPath(gametable_entity.get<GameTable>()->gameTableName);
+        game_table_manager_->board_manager->saveActiveBoard(board_dir_path);
+    }
+    catch (const std::exception& e)
+    {
+        Logger::instance().log("main", Logger::Level::Error, std::string("Autosave failed: ") + e.what());
+        return false;
+    }
+    Logger::instance().log("main", Logger::Level::Info, "Autosave complete: GameTable & Board");
+    return true;
+}
+
+void HeadlessHost::readConsole()
+{
+    std::string line;
+    while (!stop_.load() && std::getline(std::cin, line))
+    {
+        if (line.empty())
+            continue;
+        std::lock_guard<std::mutex> lk(cmdMtx_);
+        commands_.push_back(std::move(line));
+    }
+}
+
+// Commands run on the host loop thread, like UI actions in the desktop app.
+void HeadlessHost::drainCommands()
+{
+    std::deque<std::string> cmds;
+    {
+        std::lock_guard<std::mutex> lk(cmdMtx_);
+        cmds.swap(commands_);
+    }
+    for (auto& c : cmds)
+        execute(c);
+}
+
+void HeadlessHost::execute(const std::string& line)
+{
+    std::istringstream in(line);
+    std::string cmd, arg;
+    in >> cmd;
+    auto nm = game_table_manager_->network_manager;
+
+    if (cmd == "help")
+        printHelp();
+    else if (cmd == "status")
+        printStatus();
+    else if (cmd == "peers")
+        printPeers();
+    else if (cmd == "kick")
+    {
+        in >> arg;
+        println(nm->removePeer(arg) ? "Kicked " + arg : "No such peer: " + arg);
+    }
+    else if (cmd == "save")
+        println(saveNow() ? "Saved" : "Nothing to save");
+    else if (cmd == "capture")
+    {
+        in >> arg;
+        if (arg == "stop")
+            nm->stopCapture();
+        else
+        {
+            nm->startCapture(captureFile());
+        }
+    }
+    else if (cmd == "replay")
+    {
+        in >> arg;
+        std::string mode;
+        in >> mode;
+        if (arg == "stop")
+            game_table_manager_->stopReplay();
+        else if (!game_table_manager_->startReplay(arg, mode == "realtime"))
+            println("Cannot replay " + arg);
+    }
+    else if (cmd == "netsim")
+    {
+        std::string spec;
+        std::getline(in, spec);
+        auto cfg = NetSim::instance().config();
+        std::string error;
+        if (spec.find_first_not_of(' ') == std::string::npos)
+            println("NetSim: " + NetSim::describe(cfg));
+        else if (!NetSim::parseSpec(spec, cfg, &error))
+            println("NetSim: " + error);
+        else
+            NetSim::instance().configure(cfg);
+    }
+    else if (cmd == "quit" || cmd == "exit")
+        stop_.store(true);
+    else
+        println("Unknown command: " + cmd + " (try help)");
+}
+
+void HeadlessHost::printStatus()
+{
+    auto nm = game_table_manager_->network_manager;
+    const auto up = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - started_).count();
+    const auto& st = game_table_manager_->getInboundStats();
+    const auto rx = nm->getImageRxStats();
+
+    std::ostringstream out;
+    out << "Table: " << (game_table_manager_->getActiveGameTableEntity().is_valid() ? game_table_manager_->game_table_name : "(none)")
+        << " | up " << up << " s | hosting " << (nm->isHosting() ? "yes" : "no") << " | peers " << nm->getPeers().size() << "\n";
+    out << "Inbound: raw " << st.rawDepth << " | backlog " << st.backlogDepth << " | shards " << nm->decodeShardCount()
+        << " | last apply " << st.applyMs << " ms\n";
+    out << "Images in flight: " << rx.inFlight << " | mem " << rx.memBytes << " B | spill " << rx.spillBytes << " B";
+    if (const auto& rec = nm->getRecorder(); rec.isRecording())
+        out << "\nCapturing: " << rec.messages() << " messages to " << rec.path().string();
+    if (const auto* sandbox = game_table_manager_->getReplaySandbox(); sandbox && sandbox->replayer())
+    {
+        const auto* rp = sandbox->replayer();
+        out << "\nReplay (sandbox): " << rp->fed() << " messages, " << static_cast<int>(rp->progress() * 100.0) << "%"
+            << (rp->done() ? (rp->failed() ? " (failed)" : " (done)") : "") << ", " << sandbox->entityCount() << " entities";
+    }
+    if (NetSim::instance().config().enabled)
+    {
+        const auto sim = NetSim::instance().stats();
+        out << "\nNetSim: delayed " << sim.delayed << " | lost " << sim.lost << " | expired " << sim.expired << " | held "
+            << sim.pending << " (" << sim.pendingBytes << " B)";
+    }
+    println(out.str());
+}
+
+void HeadlessHost::printPeers()
+{
+    auto nm = game_table_manager_->network_manager;
+    auto peers = nm->getPeers();
+    if (peers.empty())
+    {
+        println("No peers");
+        return;
+    }
+    for (const auto& [pid, link] : peers)
+    {
+        if (!link)
+            continue;
+        println(pid + "  " + nm->displayNameForPeer(pid) + "  pc=" + link->pcStateString() +
+                (link->isDataChannelOpen() ? "  dc=open" : "  dc=closed") + "  setup: " + link->phaseSummary());
+    }
+}
+
+void HeadlessHost::printHelp()
+{
+    println("Commands: status | peers | kick <peerId> | save | capture [stop] | replay <file> [realtime] | replay stop | netsim [spec|off] | quit");
+}
@@ -0,0 +1,148 @@
+#include "HeadlessHost.h"
+#include "PathManager.h"
+#include "Logger.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// RunicVTTHost: dedicated table host without a window.
+//   RunicVTTHost --table <name|file.runic> [--port 7777] [--mode local|external|localtunnel|custom]
+//                [--password <pw>] [--custom-host <ip>] [--username <name>] [--upnp]
+//                [--autosave-sec 60] [--capture] [--replay <file.rvtcap> [--realtime] [--exit-after-replay]]
+//                [--netsim "latency=80,jitter=20,loss=2,seed=7"]
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "Usage: RunicVTTHost --table <name|file.runic> [--port N] [--mode local|external|localtunnel|custom]\n"
+                     "                    [--password PW] [--custom-host IP] [--username NAME] [--upnp]\n"
+                     "                    [--autosave-sec N] [--capture]\n"
+                     "                    [--replay FILE [--realtime] [--exit-after-replay]]\n"
+                     "                    [--netsim SPEC]\n";
+    }
+
+    bool parseMode(const std::string& s, ConnectionType& out)
+    {
+        if (s == "local")
+            out = ConnectionType::LOCAL;
+        else if (s == "external")
+            out = ConnectionType::EXTERNAL;
+        else if (s == "localtunnel")
+            out = ConnectionType::LOCALTUNNEL;
+        else if (s == "custom")
+            out = ConnectionType::CUSTOM;
+        else
+            return false;
+        return true;
+    }
+
+    bool parseArgs(int argc, char** argv, HeadlessHostOptions& o)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string a = argv[i];
+            auto value = [&]() -> const char*
+            {
+                return i + 1 < argc ? argv[++i] : nullptr;
+            };
+
+            if (a == "--table")
+            {
+                const char* v = value();
+                if (!v)
+                    return false;
+                o.gameTable = v;
+            }
+            else if (a == "--port")
+            {
+                const char* v = value();
+                if (!v)
+                    return false;
+                o.port = static_cast<unsigned short>(std::atoi(v));
+            }
+            else if (a == "--mode")
+            {
+                const char* v = value();
+                if (!v || !parseMode(v, o.mode))
+                    return false;
+            }
+            else if (a == "--password")
+            {
+                const char* v = value();
+                if (!v)
+                    return false;
+                o.password = v;
+            }
+            else if (a == "--custom-host")
+            {
+                const char* v = value();
+                if (!v)
+                    return false;
+                o.customHost = v;
+            }
+            else if (a == "--username")
+            {
+                const char* v = value();
+                if (!v)
+                    return false;
+                o.username = v;
+            }
+            else if (a == "--autosave-sec")
+            {
+                const char* v = value();
+                if (!v)
+                    return false;
+                o.autosaveSec = std::atoi(v);
+            }
+            else if (a == "--replay")
+            {
+                const char* v = value();
+                if (!v)
+                    return false;
+                o.replay = v;
+            }
+            else if (a == "--netsim")
+            {
+                const char* v = value();
+                if (!v)
+                    return false;
+                o.netsim = v;
+            }
+            else if (a == "--upnp")
+                o.tryUpnp = true;
+            else if (a == "--capture")
+                o.capture = true;
+            else if (a == "--realtime")
+                o.replayRealtime = true;
+            else if (a == "--exit-after-replay")
+                o.replayExit = true;
+            else
+                return false;
+        }
+        // hosting needs a table; a bare replay run (CI benchmark) doesn't
+        return !o.gameTable.empty() || !o.replay.empty();
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    HeadlessHostOptions opts;
+    if (!parseArgs(argc, argv, opts))
+    {
+        printUsage();
+        return 2;
+    }
+
+    Logger::instance().setChannelCapacity(4000);
+    PathManager::ensureDirectories();
+
+    // localtunnel mode spawns node, same as the desktop app
+    auto nodeModules = (PathManager::getExternalPath() / "node" / "node_modules").string();
+    _putenv_s("NODE_PATH", nodeModules.c_str());
+
+    HeadlessHost host(std::move(opts));
+    if (!host.start())
+        return 1;
+    return host.run();
+}
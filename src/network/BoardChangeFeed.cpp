@@ -0,0 +1,75 @@
+#include "BoardChangeFeed.h"
+#include "Components.h"
+
+BoardChangeFeed::BoardChangeFeed(flecs::world ecs) :
+    ecs_(ecs)
+{
+    observers_.push_back(ecs_.observer<Position>()
+                             .event(flecs::OnSet)
+                             .each([this](flecs::entity e, Position&)
+                                   { set(e, ChangePosition); }));
+    observers_.push_back(ecs_.observer<Size>()
+                             .event(flecs::OnSet)
+                             .each([this](flecs::entity e, Size&)
+                                   { set(e, ChangeSize); }));
+    observers_.push_back(ecs_.observer<Visibility>()
+                             .event(flecs::OnSet)
+                             .each([this](flecs::entity e, Visibility&)
+                                   { set(e, ChangeVisibility); }));
+    observers_.push_back(ecs_.observer<Grid>()
+                             .event(flecs::OnSet)
+                             .each([this](flecs::entity e, Grid&)
+                                   { set(e, ChangeGrid); }));
+    observers_.push_back(ecs_.observer<MarkerComponent>()
+                             .event(flecs::OnSet)
+                             .each([this](flecs::entity e, MarkerComponent&)
+                                   { set(e, ChangeMarker); }));
+    observers_.push_back(ecs_.observer<Board>()
+                             .event(flecs::OnSet)
+                             .each([this](flecs::entity e, Board&)
+                                   { set(e, ChangeBoard); }));
+    observers_.push_back(ecs_.observer<Moving>()
+                             .event(flecs::OnSet)
+                             .each([this](flecs::entity e, Moving&)
+                                   { set(e, ChangeMoving); }));
+
+    observers_.push_back(ecs_.observer()
+                             .with<Identifier>()
+                             .event(flecs::OnAdd)
+                             .each([this](flecs::entity e)
+                                   {
+                                       for (auto* l : listeners_)
+                                           l->onIdentified(e);
+                                   }));
+    observers_.push_back(ecs_.observer()
+                             .with(flecs::ChildOf, flecs::Wildcard)
+                             .event(flecs::OnAdd)
+                             .each([this](flecs::entity e)
+                                   {
+                                       for (auto* l : listeners_)
+                                           l->onParented(e);
+                                   }));
+    observers_.push_back(ecs_.observer()
+                             .with<Identifier>()
+                             .event(flecs::OnRemove)
+                             .each([this](flecs::entity e)
+                                   {
+                                       for (auto* l : listeners_)
+                                           l->onRemoved(e);
+                                   }));
+}
+
+BoardChangeFeed::~BoardChangeFeed()
+{
+    for (auto& o : observers_)
+    {
+        if (o.is_alive())
+            o.destruct();
+    }
+}
+
+void BoardChangeFeed::set(flecs::entity e, uint8_t change)
+{
+    for (auto* l : listeners_)
+        l->onSet(e, change);
+}
@@ -0,0 +1,176 @@
+#include "BoardStateHash.h"
+#include <cstring>
+#include "Components.h"
+
+namespace
+{
+    uint64_t bitsOf(float f)
+    {
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        return u;
+    }
+} // namespace
+
+BoardStateHash::BoardStateHash(flecs::world ecs, BoardChangeFeed& feed) :
+    ecs_(ecs), feed_(feed)
+{
+    feed_.subscribe(this);
+}
+
+BoardStateHash::~BoardStateHash()
+{
+    feed_.unsubscribe(this);
+}
+
+// splitmix64 finalizer
+uint64_t BoardStateHash::mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+bool BoardStateHash::kindOf(flecs::entity e, Kind& out)
+{
+    if (e.has<Board>())
+        out = Kind::Board;
+    else if (e.has<MarkerComponent>())
+        out = Kind::Marker;
+    else if (e.has<FogOfWar>())
+        out = Kind::Fog;
+    else
+        return false;
+    return true;
+}
+
+uint64_t BoardStateHash::leafHash(flecs::entity e, uint64_t id, Kind kind)
+{
+    uint64_t h = mix(id ^ (uint64_t(kind) << 56));
+    auto feed = [&h](uint64_t v)
+    { h = mix(h ^ v); };
+
+    if (kind == Kind::Board)
+    {
+        // the board's Size is the local texture's, only the grid is shared
+        if (const auto* g = e.get<Grid>())
+        {
+            feed(bitsOf(g->offset.x) | (bitsOf(g->offset.y) << 32));
+            feed(bitsOf(g->cell_size) | (bitsOf(g->opacity) << 32));
+            feed(uint64_t(g->is_hex) | (uint64_t(g->snap_to_grid) << 1) | (uint64_t(g->visible) << 2));
+        }
+        return h;
+    }
+
+    const auto* mv = e.get<Moving>();
+    const auto* pos = e.get<Position>();
+    if (pos && !(mv && mv->isDragging))
+        feed(bitsOf(pos->x) | (bitsOf(pos->y) << 32));
+    if (const auto* siz = e.get<Size>())
+        feed(bitsOf(siz->width) | (bitsOf(siz->height) << 32));
+    if (const auto* vis = e.get<Visibility>())
+        feed(vis->isVisible ? 1 : 2);
+    return h;
+}
+
+void BoardStateHash::rehash(flecs::entity e)
+{
+    Kind kind;
+    if (!e.has<Identifier>() || !kindOf(e, kind))
+    {
+        drop(e.id());
+        return;
+    }
+    const uint64_t id = e.get<Identifier>()->id;
+    const uint64_t h = leafHash(e, id, kind);
+
+    auto [it, fresh] = leaves_.try_emplace(e.id());
+    auto& leaf = it->second;
+    if (!fresh)
+        buckets_[bucketOf(leaf.id)] -= leaf.hash;
+    leaf = Leaf{id, kind, h};
+    buckets_[bucketOf(id)] += h;
+    byId_[id] = e.id();
+}
+
+void BoardStateHash::drop(flecs::entity_t e)
+{
+    auto it = leaves_.find(e);
+    if (it == leaves_.end())
+        return;
+    buckets_[bucketOf(it->second.id)] -= it->second.hash;
+    byId_.erase(it->second.id);
+    leaves_.erase(it);
+}
+
+void BoardStateHash::clear()
+{
+    leaves_.clear();
+    byId_.clear();
+    dirty_.clear();
+    buckets_.fill(0);
+    root_ = 0;
+    board_ = 0;
+    boardId_ = 0;
+}
+
+void BoardStateHash::rebuild(flecs::entity board)
+{
+    clear();
+    board_ = board.id();
+    boardId_ = board.get<Identifier>()->id;
+    rehash(board);
+    board.children([this](flecs::entity child)
+                   { rehash(child); });
+}
+
+void BoardStateHash::refresh(flecs::entity board)
+{
+    if (!board.is_valid() || !board.has<Identifier>())
+    {
+        clear();
+        return;
+    }
+    if (board.id() != board_ || board.get<Identifier>()->id != boardId_)
+    {
+        rebuild(board);
+    }
+    else
+    {
+        for (auto eid : dirty_)
+        {
+            flecs::entity e(ecs_, eid);
+            if (e.is_alive() && (eid == board_ || e.has(flecs::ChildOf, board)))
+                rehash(e);
+            else
+                drop(eid);
+        }
+        dirty_.clear();
+    }
+
+    uint64_t r = mix(boardId_);
+    for (auto b : buckets_)
+        r = mix(r ^ b);
+    root_ = r;
+}
+
+std::vector<BoardStateHash::Leaf> BoardStateHash::leaves(uint8_t bucket) const
+{
+    std::vector<Leaf> out;
+    for (const auto& [e, leaf] : leaves_)
+    {
+        if (bucketOf(leaf.id) == bucket)
+            out.push_back(leaf);
+    }
+    return out;
+}
+
+flecs::entity BoardStateHash::entityOf(uint64_t id) const
+{
+    auto it = byId_.find(id);
+    if (it == byId_.end())
+        return flecs::entity();
+    flecs::entity e(ecs_, it->second);
+    return e.is_alive() ? e : flecs::entity();
+}
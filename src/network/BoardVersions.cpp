@@ -0,0 +1,139 @@
+#include "BoardVersions.h"
+#include <random>
+#include "Components.h"
+
+BoardVersions::BoardVersions(flecs::world ecs, BoardChangeFeed& feed) :
+    ecs_(ecs), feed_(feed)
+{
+    std::random_device rd;
+    historyId_ = (uint64_t(rd()) << 32) | rd();
+    feed_.subscribe(this);
+}
+
+BoardVersions::~BoardVersions()
+{
+    feed_.unsubscribe(this);
+}
+
+void BoardVersions::onSet(flecs::entity e, uint8_t change)
+{
+    if (change == BoardChangeFeed::ChangeVisibility)
+    {
+        const auto* v = e.get<Visibility>();
+        bump(e, v && v->isVisible);
+    }
+    else if (change == BoardChangeFeed::ChangeMoving)
+    {
+        // a drag's end: the Position it wrote along the way only counts now
+        const auto* mv = e.get<Moving>();
+        if (mv && !mv->isDragging)
+            bump(e);
+    }
+    else
+    {
+        bump(e);
+    }
+}
+
+// markers and fog get their parent last, that's when they start counting
+void BoardVersions::onParented(flecs::entity e)
+{
+    bump(e);
+}
+
+uint64_t BoardVersions::version(uint64_t boardId) const
+{
+    auto it = boards_.find(boardId);
+    return it == boards_.end() ? 0 : it->second.version;
+}
+
+void BoardVersions::bump(flecs::entity e, bool revealed)
+{
+    if (!e.is_alive() || !e.has<Identifier>())
+        return;
+
+    flecs::entity board;
+    if (e.has<Board>())
+        board = e;
+    else if (e.has<MarkerComponent>() || e.has<FogOfWar>())
+        board = e.parent();
+    if (!board.is_valid() || !board.has<Identifier>())
+        return;
+
+    const uint64_t boardId = board.get<Identifier>()->id;
+    const uint64_t id = e.get<Identifier>()->id;
+    auto& log = boards_[boardId];
+    const uint64_t v = ++log.version;
+    owners_[e.id()] = Owner{boardId, id};
+
+    auto [it, fresh] = log.entities.try_emplace(id);
+    if (fresh)
+    {
+        it->second.created = v;
+        it->second.fog = e.has<FogOfWar>();
+    }
+    it->second.changed = v;
+    if (revealed)
+        it->second.revealed = v;
+}
+
+void BoardVersions::onRemoved(flecs::entity e)
+{
+    auto it = owners_.find(e.id());
+    if (it == owners_.end())
+        return;
+    const Owner o = it->second;
+    owners_.erase(it);
+
+    auto b = boards_.find(o.boardId);
+    if (b == boards_.end())
+        return;
+    if (o.id == o.boardId)
+    {
+        boards_.erase(b); // a peer asking for a deleted board gets the full snapshot
+        return;
+    }
+
+    auto& log = b->second;
+    bool fog = false;
+    if (auto ent = log.entities.find(o.id); ent != log.entities.end())
+    {
+        fog = ent->second.fog;
+        log.entities.erase(ent);
+    }
+    log.tombstones.push_back(Tombstone{++log.version, o.id, fog});
+    while (log.tombstones.size() > kMaxTombstones)
+    {
+        log.floor = log.tombstones.front().version;
+        log.tombstones.pop_front();
+    }
+}
+
+bool BoardVersions::since(uint64_t boardId, uint64_t fromHistory, uint64_t fromVersion, Changes& out) const
+{
+    if (fromHistory != historyId_)
+        return false;
+    auto b = boards_.find(boardId);
+    if (b == boards_.end())
+        return false;
+    const auto& log = b->second;
+    if (fromVersion > log.version || fromVersion < log.floor)
+        return false;
+
+    for (const auto& [id, ev] : log.entities)
+    {
+        if (ev.changed <= fromVersion)
+            continue;
+        if (id == boardId)
+            out.boardChanged = true;
+        else if (ev.created > fromVersion)
+            out.created.push_back(id);
+        else if (ev.revealed > fromVersion)
+            out.revealed.push_back(id);
+        else
+            out.changed.push_back(id);
+    }
+    for (auto t = log.tombstones.rbegin(); t != log.tombstones.rend() && t->version > fromVersion; ++t)
+        out.deleted.emplace_back(t->id, t->fog);
+    return true;
+}
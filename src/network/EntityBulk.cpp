@@ -0,0 +1,110 @@
+#include "EntityBulk.h"
+#include <initializer_list>
+#include <utility>
+
+namespace
+{
+    struct Column
+    {
+        ecs_id_t id;
+        void* data; // nullptr for tags
+    };
+
+    std::vector<flecs::entity> spawn(flecs::world& ecs, size_t count, std::initializer_list<Column> columns, flecs::entity parent)
+    {
+        std::vector<flecs::entity> out;
+        if (count == 0)
+            return out;
+
+        ecs_bulk_desc_t desc{};
+        void* data[FLECS_ID_DESC_MAX] = {};
+        size_t i = 0;
+        for (const auto& c : columns)
+        {
+            desc.ids[i] = c.id;
+            data[i] = c.data;
+            ++i;
+        }
+        desc.count = static_cast<int32_t>(count);
+        desc.data = data;
+
+        // copied right away: the returned ids live in world storage that later calls may reuse
+        const ecs_entity_t* ids = ecs_bulk_init(ecs, &desc);
+        out.reserve(count);
+        for (size_t r = 0; r < count; ++r)
+            out.emplace_back(ecs, ids[r]);
+
+        if (parent.is_valid())
+        {
+            for (auto& e : out)
+                e.add(flecs::ChildOf, parent);
+        }
+        return out;
+    }
+} // namespace
+
+void MarkerRows::reserve(size_t n)
+{
+    ids.reserve(n);
+    positions.reserve(n);
+    sizes.reserve(n);
+    textures.reserve(n);
+    visibility.reserve(n);
+    markers.reserve(n);
+    moving.reserve(n);
+}
+
+void MarkerRows::push(Identifier id, Position pos, Size size, TextureComponent texture, Visibility vis, MarkerComponent marker, Moving mov)
+{
+    ids.push_back(id);
+    positions.push_back(pos);
+    sizes.push_back(size);
+    textures.push_back(std::move(texture));
+    visibility.push_back(vis);
+    markers.push_back(std::move(marker));
+    moving.push_back(mov);
+}
+
+void FogRows::reserve(size_t n)
+{
+    ids.reserve(n);
+    positions.reserve(n);
+    sizes.reserve(n);
+    visibility.reserve(n);
+}
+
+void FogRows::push(Identifier id, Position pos, Size size, Visibility vis)
+{
+    ids.push_back(id);
+    positions.push_back(pos);
+    sizes.push_back(size);
+    visibility.push_back(vis);
+}
+
+std::vector<flecs::entity> EntityBulk::spawnMarkers(flecs::world& ecs, MarkerRows& rows, flecs::entity parent)
+{
+    auto out = spawn(ecs, rows.size(),
+                     {{ecs.id<Identifier>(), rows.ids.data()},
+                      {ecs.id<Position>(), rows.positions.data()},
+                      {ecs.id<Size>(), rows.sizes.data()},
+                      {ecs.id<TextureComponent>(), rows.textures.data()},
+                      {ecs.id<Visibility>(), rows.visibility.data()},
+                      {ecs.id<MarkerComponent>(), rows.markers.data()},
+                      {ecs.id<Moving>(), rows.moving.data()}},
+                     parent);
+    rows = MarkerRows{}; // the strings were moved out
+    return out;
+}
+
+std::vector<flecs::entity> EntityBulk::spawnFog(flecs::world& ecs, FogRows& rows, flecs::entity parent)
+{
+    auto out = spawn(ecs, rows.size(),
+                     {{ecs.id<Identifier>(), rows.ids.data()},
+                      {ecs.id<Position>(), rows.positions.data()},
+                      {ecs.id<Size>(), rows.sizes.data()},
+                      {ecs.id<Visibility>(), rows.visibility.data()},
+                      {ecs.id<FogOfWar>(), nullptr}},
+                     parent);
+    rows = FogRows{};
+    return out;
+}
@@ -0,0 +1,73 @@
+#include "EntityDeltaTracker.h"
+#include "Components.h"
+#include "Message.h"
+
+EntityDeltaTracker::EntityDeltaTracker(flecs::world ecs, BoardChangeFeed& feed) :
+    ecs_(ecs), feed_(feed)
+{
+    feed_.subscribe(this);
+}
+
+EntityDeltaTracker::~EntityDeltaTracker()
+{
+    feed_.unsubscribe(this);
+}
+
+void EntityDeltaTracker::onSet(flecs::entity e, uint8_t change)
+{
+    switch (change)
+    {
+    case BoardChangeFeed::ChangePosition:
+        mark(e, msg::DeltaPosition);
+        break;
+    case BoardChangeFeed::ChangeSize:
+        mark(e, msg::DeltaSize);
+        break;
+    case BoardChangeFeed::ChangeVisibility:
+        mark(e, msg::DeltaVisibility);
+        break;
+    case BoardChangeFeed::ChangeGrid:
+        mark(e, msg::DeltaGrid);
+        break;
+    case BoardChangeFeed::ChangeMarker:
+        mark(e, msg::DeltaMarkerComponent);
+        break;
+    default:
+        break; // Board and Moving aren't replicated as deltas
+    }
+}
+
+// new boards/markers/fog always get their Identifier first
+void EntityDeltaTracker::onIdentified(flecs::entity e)
+{
+    born_.insert(e.id());
+}
+
+void EntityDeltaTracker::mark(flecs::entity e, uint8_t field)
+{
+    if (suppress_ > 0)
+        return;
+    auto [it, inserted] = dirty_.try_emplace(e.id(), uint8_t{0});
+    if (inserted)
+        order_.push_back(e.id());
+    it->second |= field;
+}
+
+std::vector<EntityDeltaTracker::Dirty> EntityDeltaTracker::take()
+{
+    std::vector<Dirty> out;
+    out.reserve(order_.size());
+    for (auto id : order_)
+    {
+        if (born_.count(id))
+            continue;
+        flecs::entity e(ecs_, id);
+        if (!e.is_alive())
+            continue;
+        out.push_back(Dirty{e, dirty_[id]});
+    }
+    dirty_.clear();
+    order_.clear();
+    born_.clear();
+    return out;
+}
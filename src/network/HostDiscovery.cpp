@@ -0,0 +1,698 @@
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#include <iphlpapi.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "HostDiscovery.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+#ifdef _WIN32
+    using socket_t = SOCKET;
+    constexpr socket_t kBadSocket = INVALID_SOCKET;
+    void closeSocket(socket_t s)
+    {
+        closesocket(s);
+    }
+    // WSAStartup is refcounted, one per operation is fine
+    struct NetInit
+    {
+        NetInit()
+        {
+            WSADATA d;
+            ok = WSAStartup(MAKEWORD(2, 2), &d) == 0;
+        }
+        ~NetInit()
+        {
+            if (ok)
+                WSACleanup();
+        }
+        bool ok = false;
+    };
+#else
+    using socket_t = int;
+    constexpr socket_t kBadSocket = -1;
+    void closeSocket(socket_t s)
+    {
+        ::close(s);
+    }
+    struct NetInit
+    {
+        bool ok = true;
+    };
+#endif
+
+    struct SocketGuard
+    {
+        socket_t s = kBadSocket;
+        ~SocketGuard()
+        {
+            if (s != kBadSocket)
+                closeSocket(s);
+        }
+    };
+
+    void setRecvTimeout(socket_t s, int ms)
+    {
+#ifdef _WIN32
+        DWORD tv = static_cast<DWORD>(ms);
+        setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+#else
+        timeval tv{ms / 1000, (ms % 1000) * 1000};
+        setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+#endif
+    }
+
+    bool setNonBlocking(socket_t s, bool on)
+    {
+#ifdef _WIN32
+        u_long mode = on ? 1 : 0;
+        return ioctlsocket(s, FIONBIO, &mode) == 0;
+#else
+        int flags = fcntl(s, F_GETFL, 0);
+        return fcntl(s, F_SETFL, on ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) == 0;
+#endif
+    }
+
+    // a dead LOCATION host must not stall the worker for the OS connect timeout
+    bool connectWithTimeout(socket_t s, const sockaddr_in& addr, int timeoutMs)
+    {
+        setNonBlocking(s, true);
+        int rc = ::connect(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+        if (rc != 0)
+        {
+            fd_set wr, ex;
+            FD_ZERO(&wr);
+            FD_ZERO(&ex);
+            FD_SET(s, &wr);
+            FD_SET(s, &ex);
+            timeval tv{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+            if (select(static_cast<int>(s) + 1, nullptr, &wr, &ex, &tv) <= 0 || FD_ISSET(s, &ex))
+                return false;
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&err), &len);
+            if (err != 0)
+                return false;
+        }
+        setNonBlocking(s, false);
+        return true;
+    }
+
+    bool resolveIPv4(const std::string& host, unsigned short port, sockaddr_in& out)
+    {
+        out = {};
+        out.sin_family = AF_INET;
+        out.sin_port = htons(port);
+        if (inet_pton(AF_INET, host.c_str(), &out.sin_addr) == 1)
+            return true;
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        addrinfo* res = nullptr;
+        if (getaddrinfo(host.c_str(), nullptr, &hints, &res) != 0 || !res)
+            return false;
+        out.sin_addr = reinterpret_cast<sockaddr_in*>(res->ai_addr)->sin_addr;
+        freeaddrinfo(res);
+        return true;
+    }
+
+    std::string lower(std::string s)
+    {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        return s;
+    }
+
+    std::string trim(const std::string& s)
+    {
+        const auto b = s.find_first_not_of(" \t\r\n");
+        if (b == std::string::npos)
+            return {};
+        return s.substr(b, s.find_last_not_of(" \t\r\n") - b + 1);
+    }
+
+    // value of `name:` in an HTTP/SSDP header block, case-insensitive
+    std::string headerValue(const std::string& head, const std::string& name)
+    {
+        const std::string lh = lower(head);
+        const std::string key = "\n" + lower(name) + ":";
+        auto pos = lh.find(key);
+        if (pos == std::string::npos)
+            return {};
+        pos += key.size();
+        return trim(head.substr(pos, head.find('\n', pos) - pos));
+    }
+
+    // text of the first <tag>...</tag> (ignores namespace prefixes on the tag)
+    std::string xmlValue(const std::string& xml, const std::string& tag, size_t from = 0)
+    {
+        const std::string lx = lower(xml);
+        const std::string lt = lower(tag);
+        size_t pos = from;
+        while ((pos = lx.find(lt + ">", pos)) != std::string::npos)
+        {
+            const size_t open = lx.rfind('<', pos);
+            if (open != std::string::npos && lx[open + 1] != '/' && lx.find(' ', open) >= pos)
+            {
+                const size_t start = pos + lt.size() + 1;
+                const size_t end = lx.find('<', start);
+                return end == std::string::npos ? std::string{} : trim(xml.substr(start, end - start));
+            }
+            pos += lt.size();
+        }
+        return {};
+    }
+
+    struct Url
+    {
+        std::string host;
+        unsigned short port = 80;
+        std::string path = "/";
+    };
+
+    bool parseUrl(const std::string& url, Url& out)
+    {
+        const std::string scheme = "http://";
+        if (lower(url.substr(0, scheme.size())) != scheme)
+            return false;
+        std::string rest = url.substr(scheme.size());
+        const auto slash = rest.find('/');
+        std::string hostPort = rest.substr(0, slash);
+        out.path = slash == std::string::npos ? "/" : rest.substr(slash);
+        if (auto colon = hostPort.find(':'); colon != std::string::npos)
+        {
+            out.port = static_cast<unsigned short>(std::atoi(hostPort.c_str() + colon + 1));
+            hostPort.resize(colon);
+        }
+        out.host = hostPort;
+        return !out.host.empty();
+    }
+
+    std::string dechunk(const std::string& body)
+    {
+        std::string out;
+        size_t pos = 0;
+        while (pos < body.size())
+        {
+            const size_t eol = body.find("\r\n", pos);
+            if (eol == std::string::npos)
+                break;
+            const size_t n = std::strtoul(body.substr(pos, eol - pos).c_str(), nullptr, 16);
+            if (n == 0)
+                break;
+            out.append(body, eol + 2, n);
+            pos = eol + 2 + n + 2;
+        }
+        return out;
+    }
+
+    struct HttpResponse
+    {
+        int status = 0;
+        std::string body;
+    };
+
+    // HTTP/1.1 with Connection: close, enough for IGD descriptions and SOAP
+    HttpResponse httpRequest(const Url& url, const std::string& method, const std::string& extraHeaders,
+                             const std::string& body, int timeoutMs)
+    {
+        HttpResponse r;
+        sockaddr_in addr;
+        if (!resolveIPv4(url.host, url.port, addr))
+            return r;
+        SocketGuard sock{::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)};
+        if (sock.s == kBadSocket || !connectWithTimeout(sock.s, addr, timeoutMs))
+            return r;
+        setRecvTimeout(sock.s, timeoutMs);
+
+        std::string req = method + " " + url.path + " HTTP/1.1\r\n"
+                                                    "Host: " +
+                          url.host + ":" + std::to_string(url.port) + "\r\n" + "Connection: close\r\n" + extraHeaders;
+        if (!body.empty() || method == "POST")
+            req += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        req += "\r\n" + body;
+        if (::send(sock.s, req.data(), static_cast<int>(req.size()), 0) != static_cast<int>(req.size()))
+            return r;
+
+        std::string raw;
+        char buf[4096];
+        for (;;)
+        {
+            const int n = ::recv(sock.s, buf, sizeof(buf), 0);
+            if (n <= 0)
+                break;
+            raw.append(buf, n);
+            if (raw.size() > (1u << 20))
+                break; // no IGD answer is this big
+        }
+
+        const auto split = raw.find("\r\n\r\n");
+        if (split == std::string::npos || raw.compare(0, 5, "HTTP/") != 0)
+            return r;
+        const std::string head = raw.substr(0, split);
+        const auto sp = head.find(' ');
+        r.status = sp == std::string::npos ? 0 : std::atoi(head.c_str() + sp + 1);
+        r.body = raw.substr(split + 4);
+        if (lower(headerValue(head, "Transfer-Encoding")) == "chunked")
+            r.body = dechunk(r.body);
+        return r;
+    }
+
+    std::string soapEnvelope(const std::string& serviceType, const std::string& action, const std::string& args)
+    {
+        return "<?xml version=\"1.0\"?>"
+               "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" "
+               "s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\"><s:Body>"
+               "<u:" +
+               action + " xmlns:u=\"" + serviceType + "\">" + args + "</u:" + action + "></s:Body></s:Envelope>";
+    }
+
+    HttpResponse soapCall(const igd::Gateway& gw, const std::string& action, const std::string& args, int timeoutMs)
+    {
+        Url url{gw.host, gw.port, gw.controlPath};
+        const std::string headers = "Content-Type: text/xml; charset=\"utf-8\"\r\n"
+                                    "SOAPAction: \"" +
+                                    gw.serviceType + "#" + action + "\"\r\n";
+        return httpRequest(url, "POST", headers, soapEnvelope(gw.serviceType, action, args), timeoutMs);
+    }
+
+    // WANIPConnection/WANPPPConnection control URL out of a device description
+    bool findWanService(const std::string& xml, const Url& location, igd::Gateway& gw)
+    {
+        size_t pos = 0;
+        const std::string lx = lower(xml);
+        while ((pos = lx.find("<service>", pos)) != std::string::npos)
+        {
+            const size_t end = lx.find("</service>", pos);
+            const std::string block = xml.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+            pos += 9;
+            const std::string type = xmlValue(block, "serviceType");
+            if (type.find("WANIPConnection") == std::string::npos && type.find("WANPPPConnection") == std::string::npos)
+                continue;
+            std::string control = xmlValue(block, "controlURL");
+            if (control.empty())
+                continue;
+
+            Url base = location;
+            if (const auto urlBase = xmlValue(xml, "URLBase"); !urlBase.empty())
+                parseUrl(urlBase, base);
+            Url abs;
+            if (parseUrl(control, abs))
+                base = abs;
+            else
+                base.path = control.front() == '/' ? control : "/" + control;
+
+            gw.host = base.host;
+            gw.port = base.port;
+            gw.controlPath = base.path;
+            gw.serviceType = type;
+            return true;
+        }
+        return false;
+    }
+} // namespace
+
+// ---- netif ----
+
+std::vector<netif::Interface> netif::enumerateIPv4()
+{
+    std::vector<Interface> out;
+#ifdef _WIN32
+    ULONG size = 16 * 1024;
+    std::vector<unsigned char> buf(size);
+    auto* addrs = reinterpret_cast<IP_ADAPTER_ADDRESSES*>(buf.data());
+    const ULONG flags = GAA_FLAG_SKIP_ANYCAST | GAA_FLAG_SKIP_MULTICAST | GAA_FLAG_SKIP_DNS_SERVER;
+    ULONG rc = GetAdaptersAddresses(AF_INET, flags, nullptr, addrs, &size);
+    if (rc == ERROR_BUFFER_OVERFLOW)
+    {
+        buf.resize(size);
+        addrs = reinterpret_cast<IP_ADAPTER_ADDRESSES*>(buf.data());
+        rc = GetAdaptersAddresses(AF_INET, flags, nullptr, addrs, &size);
+    }
+    if (rc != NO_ERROR)
+        return out;
+    for (auto* a = addrs; a; a = a->Next)
+    {
+        if (a->OperStatus != IfOperStatusUp)
+            continue;
+        for (auto* u = a->FirstUnicastAddress; u; u = u->Next)
+        {
+            if (u->Address.lpSockaddr->sa_family != AF_INET)
+                continue;
+            char ip[INET_ADDRSTRLEN] = {};
+            inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in*>(u->Address.lpSockaddr)->sin_addr, ip, sizeof(ip));
+            out.push_back(Interface{a->AdapterName, ip, a->IfType == IF_TYPE_SOFTWARE_LOOPBACK});
+        }
+    }
+#else
+    ifaddrs* list = nullptr;
+    if (getifaddrs(&list) != 0)
+        return out;
+    for (auto* a = list; a; a = a->ifa_next)
+    {
+        if (!a->ifa_addr || a->ifa_addr->sa_family != AF_INET || !(a->ifa_flags & IFF_UP))
+            continue;
+        char ip[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in*>(a->ifa_addr)->sin_addr, ip, sizeof(ip));
+        out.push_back(Interface{a->ifa_name, ip, (a->ifa_flags & IFF_LOOPBACK) != 0});
+    }
+    freeifaddrs(list);
+#endif
+    return out;
+}
+
+std::string netif::routeIPv4(const std::string& toward)
+{
+    NetInit net;
+    sockaddr_in remote;
+    if (!net.ok || !resolveIPv4(toward, 53, remote))
+        return {};
+    SocketGuard sock{::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)};
+    if (sock.s == kBadSocket || ::connect(sock.s, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) != 0)
+        return {};
+    sockaddr_in local{};
+    socklen_t len = sizeof(local);
+    if (getsockname(sock.s, reinterpret_cast<sockaddr*>(&local), &len) != 0)
+        return {};
+    char ip[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &local.sin_addr, ip, sizeof(ip));
+    return ip;
+}
+
+bool netif::isPrivateIPv4(const std::string& ip)
+{
+    in_addr a{};
+    if (inet_pton(AF_INET, ip.c_str(), &a) != 1)
+        return false;
+    const uint32_t h = ntohl(a.s_addr);
+    return (h >> 24) == 10 || (h >> 24) == 127 || (h >> 20) == 0xAC1 /*172.16/12*/ ||
+           (h >> 16) == 0xC0A8 /*192.168/16*/ || (h >> 16) == 0xA9FE /*169.254/16*/;
+}
+
+std::string netif::primaryIPv4()
+{
+    if (auto ip = routeIPv4("8.8.8.8"); !ip.empty() && ip != "0.0.0.0")
+        return ip;
+    // offline LAN: no default route, take the first private interface
+    std::string fallback;
+    for (const auto& i : enumerateIPv4())
+    {
+        if (i.loopback || i.ipv4.rfind("169.254.", 0) == 0)
+            continue;
+        if (isPrivateIPv4(i.ipv4))
+            return i.ipv4;
+        if (fallback.empty())
+            fallback = i.ipv4;
+    }
+    return fallback;
+}
+
+// ---- igd ----
+
+igd::Gateway igd::discover(const Options& opts)
+{
+    Gateway gw;
+    NetInit net;
+    sockaddr_in dst;
+    if (!net.ok || !resolveIPv4(opts.ssdpAddress, opts.ssdpPort, dst))
+        return gw;
+
+    SocketGuard sock{::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)};
+    if (sock.s == kBadSocket)
+        return gw;
+    setRecvTimeout(sock.s, 250);
+
+    const char* targets[] = {"urn:schemas-upnp-org:device:InternetGatewayDevice:1",
+                             "urn:schemas-upnp-org:service:WANIPConnection:1",
+                             "urn:schemas-upnp-org:service:WANPPPConnection:1"};
+    for (const char* st : targets)
+    {
+        const std::string req = "M-SEARCH * HTTP/1.1\r\n"
+                                "HOST: " +
+                                opts.ssdpAddress + ":" + std::to_string(opts.ssdpPort) +
+                                "\r\n"
+                                "MAN: \"ssdp:discover\"\r\n"
+                                "MX: 2\r\n"
+                                "ST: " +
+                                st + "\r\n\r\n";
+        ::sendto(sock.s, req.data(), static_cast<int>(req.size()), 0, reinterpret_cast<const sockaddr*>(&dst), sizeof(dst));
+    }
+
+    // every responder's LOCATION, first answers first
+    std::vector<std::string> locations;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(opts.timeoutMs);
+    char buf[2048];
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        const int n = ::recvfrom(sock.s, buf, sizeof(buf) - 1, 0, nullptr, nullptr);
+        if (n <= 0)
+        {
+            if (!locations.empty())
+                break; // quiet after answers: done
+            continue;
+        }
+        const std::string resp(buf, n);
+        const std::string loc = headerValue("\n" + resp, "LOCATION");
+        if (!loc.empty() && std::find(locations.begin(), locations.end(), loc) == locations.end())
+            locations.push_back(loc);
+    }
+
+    for (const auto& loc : locations)
+    {
+        Url url;
+        if (!parseUrl(loc, url))
+            continue;
+        const auto desc = httpRequest(url, "GET", "", "", opts.timeoutMs);
+        if (desc.status != 200 || !findWanService(desc.body, url, gw))
+            continue;
+        gw.localIp = netif::routeIPv4(gw.host);
+        Logger::instance().log("localtunnel", Logger::Level::Info,
+                               "IGD: " + gw.host + ":" + std::to_string(gw.port) + gw.controlPath + " (" + gw.serviceType + ")");
+        return gw;
+    }
+    return Gateway{};
+}
+
+bool igd::addPortMapping(const Gateway& gw, const std::string& internalIp, unsigned short internalPort,
+                         unsigned short externalPort, const std::string& protocol, const std::string& description,
+                         unsigned int leaseSec, std::string* error, int timeoutMs)
+{
+    if (!gw.valid())
+    {
+        if (error)
+            *error = "no gateway";
+        return false;
+    }
+    NetInit net;
+    const std::string args = "<NewRemoteHost></NewRemoteHost>"
+                             "<NewExternalPort>" +
+                             std::to_string(externalPort) + "</NewExternalPort><NewProtocol>" + protocol +
+                             "</NewProtocol><NewInternalPort>" + std::to_string(internalPort) +
+                             "</NewInternalPort><NewInternalClient>" + internalIp +
+                             "</NewInternalClient><NewEnabled>1</NewEnabled><NewPortMappingDescription>" + description +
+                             "</NewPortMappingDescription><NewLeaseDuration>" + std::to_string(leaseSec) +
+                             "</NewLeaseDuration>";
+    const auto r = soapCall(gw, "AddPortMapping", args, timeoutMs);
+    if (r.status == 200)
+        return true;
+    if (error)
+    {
+        const auto desc = xmlValue(r.body, "errorDescription");
+        *error = r.status == 0 ? "gateway did not answer" : "HTTP " + std::to_string(r.status) + (desc.empty() ? "" : " " + desc);
+    }
+    return false;
+}
+
+bool igd::deletePortMapping(const Gateway& gw, unsigned short externalPort, const std::string& protocol, int timeoutMs)
+{
+    if (!gw.valid())
+        return false;
+    NetInit net;
+    const std::string args = "<NewRemoteHost></NewRemoteHost><NewExternalPort>" + std::to_string(externalPort) +
+                             "</NewExternalPort><NewProtocol>" + protocol + "</NewProtocol>";
+    return soapCall(gw, "DeletePortMapping", args, timeoutMs).status == 200;
+}
+
+std::string igd::externalIPAddress(const Gateway& gw, int timeoutMs)
+{
+    if (!gw.valid())
+        return {};
+    NetInit net;
+    const auto r = soapCall(gw, "GetExternalIPAddress", "", timeoutMs);
+    if (r.status != 200)
+        return {};
+    const auto ip = xmlValue(r.body, "NewExternalIPAddress");
+    in_addr a{};
+    return inet_pton(AF_INET, ip.c_str(), &a) == 1 ? ip : std::string{};
+}
+
+// ---- HostDiscovery ----
+
+HostDiscovery::HostDiscovery(igd::Options opts, ExternalLookup externalFallback) :
+    opts_(std::move(opts)), externalFallback_(std::move(externalFallback))
+{
+}
+
+void HostDiscovery::start()
+{
+    uint64_t gen;
+    {
+        std::lock_guard<std::mutex> lk(shared_->mtx);
+        if (shared_->gatewayState != State::Idle)
+            return;
+        shared_->localState = shared_->externalState = shared_->gatewayState = State::Pending;
+        gen = shared_->generation;
+    }
+
+    auto s = shared_;
+    std::thread([s, gen]()
+                {
+        const auto ip = netif::primaryIPv4();
+        std::lock_guard<std::mutex> lk(s->mtx);
+        if (s->generation != gen)
+            return;
+        s->localIp = ip;
+        s->localState = ip.empty() ? State::Failed : State::Ready;
+        s->cv.notify_all(); })
+        .detach();
+
+    // gateway first; its own answer for the public address, the HTTP fallback otherwise
+    std::thread([s, gen, opts = opts_, fallback = externalFallback_]()
+                {
+        const auto gw = igd::discover(opts);
+        {
+            std::lock_guard<std::mutex> lk(s->mtx);
+            if (s->generation != gen)
+                return;
+            s->gateway = gw;
+            s->gatewayState = gw.valid() ? State::Ready : State::Failed;
+            if (gw.valid() && !gw.localIp.empty())
+            {
+                // the interface facing the gateway is the one port mappings must point at
+                s->localIp = gw.localIp;
+                s->localState = State::Ready;
+            }
+            s->cv.notify_all();
+        }
+        if (!gw.valid())
+            Logger::instance().log("localtunnel", Logger::Level::Warn, "IGD: no UPnP gateway answered");
+
+        std::string ext = igd::externalIPAddress(gw);
+        if (ext.empty() && fallback)
+        {
+            try
+            {
+                ext = trim(fallback());
+            }
+            catch (...)
+            {
+            }
+        }
+        std::lock_guard<std::mutex> lk(s->mtx);
+        if (s->generation != gen)
+            return;
+        s->externalIp = ext;
+        s->externalState = ext.empty() ? State::Failed : State::Ready;
+        s->cv.notify_all(); })
+        .detach();
+}
+
+void HostDiscovery::refresh()
+{
+    {
+        std::lock_guard<std::mutex> lk(shared_->mtx);
+        ++shared_->generation;
+        shared_->localIp.clear();
+        shared_->externalIp.clear();
+        shared_->gateway = {};
+        shared_->localState = shared_->externalState = shared_->gatewayState = State::Idle;
+    }
+    start();
+}
+
+std::string HostDiscovery::localIPv4() const
+{
+    std::lock_guard<std::mutex> lk(shared_->mtx);
+    return shared_->localIp;
+}
+
+std::string HostDiscovery::externalIPv4() const
+{
+    std::lock_guard<std::mutex> lk(shared_->mtx);
+    return shared_->externalIp;
+}
+
+HostDiscovery::State HostDiscovery::gatewayState() const
+{
+    std::lock_guard<std::mutex> lk(shared_->mtx);
+    return shared_->gatewayState;
+}
+
+std::string HostDiscovery::gatewayDescription() const
+{
+    std::lock_guard<std::mutex> lk(shared_->mtx);
+    const auto& gw = shared_->gateway;
+    if (!gw.valid())
+        return {};
+    const auto colon = gw.serviceType.rfind(':', gw.serviceType.size() - 3);
+    return gw.host + ":" + std::to_string(gw.port) + " " +
+           (colon == std::string::npos ? gw.serviceType : gw.serviceType.substr(colon + 1));
+}
+
+igd::Gateway HostDiscovery::waitGateway(const std::shared_ptr<Shared>& s, int timeoutMs)
+{
+    std::unique_lock<std::mutex> lk(s->mtx);
+    s->cv.wait_for(lk, std::chrono::milliseconds(timeoutMs), [&]()
+                   { return s->gatewayState == State::Ready || s->gatewayState == State::Failed; });
+    return s->gateway;
+}
+
+void HostDiscovery::addPortMappingAsync(unsigned short port, const std::string& protocol, const std::string& description, DoneFn onDone)
+{
+    start();
+    std::thread([s = shared_, timeout = opts_.timeoutMs * 3, port, protocol, description, onDone = std::move(onDone)]()
+                {
+        const auto gw = waitGateway(s, timeout);
+        std::string err;
+        bool ok = false;
+        if (!gw.valid())
+            err = "no UPnP gateway found";
+        else
+            ok = igd::addPortMapping(gw, gw.localIp, port, port, protocol, description, 0, &err);
+        Logger::instance().log("localtunnel", ok ? Logger::Level::Success : Logger::Level::Warn,
+                               "UPnP " + protocol + " " + std::to_string(port) + (ok ? " mapped" : " not mapped: " + err));
+        if (onDone)
+            onDone(ok, ok ? gw.localIp : err); })
+        .detach();
+}
+
+void HostDiscovery::removePortMappingAsync(unsigned short port, const std::string& protocol, DoneFn onDone)
+{
+    std::thread([s = shared_, port, protocol, onDone = std::move(onDone)]()
+                {
+        igd::Gateway gw;
+        {
+            std::lock_guard<std::mutex> lk(s->mtx);
+            gw = s->gateway;
+        }
+        const bool ok = igd::deletePortMapping(gw, port, protocol);
+        if (onDone)
+            onDone(ok, {}); })
+        .detach();
+}
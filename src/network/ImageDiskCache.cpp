@@ -0,0 +1,264 @@
+#include "ImageDiskCache.h"
+#include <algorithm>
+#include <fstream>
+#include "Logger.h"
+
+namespace fs = std::filesystem;
+
+ImageDiskCache::ImageDiskCache(fs::path dir, uint64_t capacityBytes) :
+    dir_(std::move(dir)), capacity_(capacityBytes)
+{
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    scan();
+    worker_ = std::thread([this]()
+                          { workerLoop(); });
+}
+
+ImageDiskCache::~ImageDiskCache()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+fs::path ImageDiskCache::pathFor(const std::string& hex) const
+{
+    return dir_ / (hex + ".img");
+}
+
+// Startup: rebuild the index from the folder, newest write time first.
+void ImageDiskCache::scan()
+{
+    struct Found
+    {
+        std::string hex;
+        Sha256::Digest hash;
+        uint64_t size;
+        fs::file_time_type when;
+    };
+    std::vector<Found> found;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir_, ec), end; !ec && it != end; it.increment(ec))
+    {
+        const auto& p = it->path();
+        if (p.extension() == ".tmp")
+        {
+            std::error_code rm;
+            fs::remove(p, rm); // interrupted write
+            continue;
+        }
+        Found f;
+        f.hex = p.stem().string();
+        if (p.extension() != ".img" || !Sha256::fromHex(f.hex, f.hash))
+            continue;
+        std::error_code fe;
+        f.size = fs::file_size(p, fe);
+        f.when = fs::last_write_time(p, fe);
+        if (!fe)
+            found.push_back(std::move(f));
+    }
+    std::sort(found.begin(), found.end(), [](const Found& a, const Found& b)
+              { return a.when > b.when; });
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    for (auto& f : found)
+    {
+        lru_.push_back(f.hex);
+        entries_[f.hex] = Entry{f.hash, f.size, std::prev(lru_.end())};
+        bytes_ += f.size;
+    }
+    while (bytes_ > capacity_ && !lru_.empty())
+        dropLocked(lru_.back());
+
+    Logger::instance().log("localtunnel", Logger::Level::Info,
+                           "Image disk cache: " + std::to_string(entries_.size()) + " images, " +
+                               std::to_string(bytes_ / (1024 * 1024)) + " MB");
+}
+
+void ImageDiskCache::store(const uint8_t* data, size_t len)
+{
+    if (len == 0 || len > kMaxEntryBytes)
+        return;
+    auto copy = std::make_shared<const std::vector<uint8_t>>(data, data + len);
+    store(std::shared_ptr<const uint8_t>(copy, copy->data()), len);
+}
+
+void ImageDiskCache::store(std::shared_ptr<const uint8_t> data, size_t len)
+{
+    if (!data || len == 0 || len > kMaxEntryBytes)
+        return;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (stop_)
+            return;
+        if (pendingBytes_ + len > kMaxPendingBytes)
+        {
+            // the disk can't keep up: the image is still in use, it just won't survive a restart
+            ++droppedWrites_;
+            return;
+        }
+        pendingBytes_ += len;
+        pending_.push_back(WriteJob{std::move(data), len});
+    }
+    cv_.notify_one();
+}
+
+void ImageDiskCache::loadAsync(const Sha256::Digest& hash, uint64_t expectedSize, LoadDone done)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (stop_)
+            return;
+        loads_.push_back(LoadJob{hash, expectedSize, std::move(done)});
+    }
+    cv_.notify_one();
+}
+
+// Loads first: someone is waiting on them, a write only matters next session.
+void ImageDiskCache::workerLoop()
+{
+    for (;;)
+    {
+        WriteJob job;
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            cv_.wait(lk, [&]()
+                     { return stop_ || !pending_.empty() || !loads_.empty(); });
+            if (stop_)
+                return;
+            if (!loads_.empty())
+            {
+                LoadJob load = std::move(loads_.front());
+                loads_.pop_front();
+                lk.unlock();
+                load.done(this->load(load.hash, load.size));
+                continue;
+            }
+            job = std::move(pending_.front());
+            pending_.pop_front();
+            pendingBytes_ -= job.size;
+        }
+
+        const auto hash = Sha256::of(job.data.get(), job.size);
+        const auto hex = Sha256::toHex(hash);
+        const auto path = pathFor(hex);
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (auto it = entries_.find(hex); it != entries_.end())
+            {
+                lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+                std::error_code ec;
+                fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+                continue;
+            }
+        }
+
+        // write aside and rename, so a crash never leaves a truncated .img behind
+        auto tmp = path;
+        tmp.replace_extension(".tmp");
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(job.data.get()), static_cast<std::streamsize>(job.size));
+            if (!out)
+            {
+                Logger::instance().log("localtunnel", Logger::Level::Warn, "Image disk cache: write failed " + tmp.string());
+                out.close();
+                std::error_code ec;
+                fs::remove(tmp, ec);
+                continue;
+            }
+        }
+        std::error_code ec;
+        fs::rename(tmp, path, ec);
+        if (ec)
+        {
+            fs::remove(tmp, ec);
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lk(mtx_);
+        insertLocked(hex, hash, job.size);
+    }
+}
+
+std::vector<uint8_t> ImageDiskCache::load(const Sha256::Digest& hash, uint64_t expectedSize)
+{
+    const auto hex = Sha256::toHex(hash);
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto it = entries_.find(hex);
+        if (it == entries_.end() || it->second.size != expectedSize)
+        {
+            ++misses_;
+            return {};
+        }
+    }
+
+    const auto path = pathFor(hex);
+    std::vector<uint8_t> bytes(static_cast<size_t>(expectedSize));
+    {
+        std::ifstream in(path, std::ios::binary);
+        in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!in || Sha256::of(bytes.data(), bytes.size()) != hash)
+            bytes.clear();
+    }
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (bytes.empty())
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Warn, "Image disk cache: dropping unreadable " + hex);
+        dropLocked(hex);
+        ++misses_;
+        return {};
+    }
+    if (auto it = entries_.find(hex); it != entries_.end())
+        lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    ++hits_;
+    return bytes;
+}
+
+std::vector<Sha256::Digest> ImageDiskCache::inventory(size_t max) const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    std::vector<Sha256::Digest> out;
+    out.reserve(std::min(max, lru_.size()));
+    for (auto it = lru_.begin(); it != lru_.end() && out.size() < max; ++it)
+        out.push_back(entries_.at(*it).hash);
+    return out;
+}
+
+ImageDiskCache::Stats ImageDiskCache::stats() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return Stats{entries_.size(), bytes_, hits_, misses_, droppedWrites_};
+}
+
+// Caller holds mtx_.
+void ImageDiskCache::insertLocked(const std::string& hex, const Sha256::Digest& hash, uint64_t size)
+{
+    lru_.push_front(hex);
+    entries_[hex] = Entry{hash, size, lru_.begin()};
+    bytes_ += size;
+    while (bytes_ > capacity_ && lru_.size() > 1)
+        dropLocked(lru_.back());
+}
+
+// Caller holds mtx_.
+void ImageDiskCache::dropLocked(std::string hex)
+{
+    auto it = entries_.find(hex);
+    if (it == entries_.end())
+        return;
+    bytes_ -= it->second.size;
+    lru_.erase(it->second.lruPos);
+    entries_.erase(it);
+    std::error_code ec;
+    fs::remove(pathFor(hex), ec);
+}
@@ -0,0 +1,187 @@
+#include "ImageSpool.h"
+#include <string>
+#include <utility>
+#include "Logger.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <WinSock2.h> // must be BEFORE windows.h
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    void logFailure(const char* what)
+    {
+#ifdef _WIN32
+        const auto err = static_cast<long long>(GetLastError());
+#else
+        const auto err = static_cast<long long>(errno);
+#endif
+        Logger::instance().log("localtunnel", Logger::Level::Error,
+                               std::string("ImageSpool: ") + what + " failed err=" + std::to_string(err));
+    }
+} // namespace
+
+ImageSpool& ImageSpool::operator=(ImageSpool&& o) noexcept
+{
+    if (this == &o)
+        return *this;
+    reset();
+    mem_ = std::move(o.mem_);
+    file_ = std::exchange(o.file_, -1);
+    mapping_ = std::exchange(o.mapping_, nullptr);
+    view_ = std::exchange(o.view_, nullptr);
+    size_ = std::exchange(o.size_, 0);
+    onDisk_ = std::exchange(o.onDisk_, false);
+    return *this;
+}
+
+bool ImageSpool::allocateInMemory(size_t total)
+{
+    reset();
+    try
+    {
+        mem_.resize(total);
+    }
+    catch (const std::bad_alloc&)
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Error,
+                               "ImageSpool: heap alloc failed size=" + std::to_string(total));
+        mem_.clear();
+        return false;
+    }
+    size_ = total;
+    return true;
+}
+
+bool ImageSpool::allocateOnDisk(size_t total)
+{
+    reset();
+    if (total == 0)
+        return false;
+    if (spilled_.fetch_add(total) + total > kSpillBudget)
+    {
+        spilled_.fetch_sub(total);
+        Logger::instance().log("localtunnel", Logger::Level::Warn,
+                               "ImageSpool: spill budget spent, size=" + std::to_string(total));
+        return false;
+    }
+    size_ = total;
+    onDisk_ = true; // reset() gives the budget back from here on
+
+#ifdef _WIN32
+    wchar_t dir[MAX_PATH + 1] = {};
+    wchar_t path[MAX_PATH + 1] = {};
+    if (!GetTempPathW(MAX_PATH, dir) || !GetTempFileNameW(dir, L"rvt", 0, path))
+    {
+        logFailure("GetTempFileName");
+        reset();
+        return false;
+    }
+
+    HANDLE file = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        logFailure("CreateFile");
+        DeleteFileW(path);
+        reset();
+        return false;
+    }
+    file_ = reinterpret_cast<intptr_t>(file);
+
+    const uint64_t t = static_cast<uint64_t>(total);
+    mapping_ = CreateFileMappingW(file, nullptr, PAGE_READWRITE,
+                                  static_cast<DWORD>(t >> 32), static_cast<DWORD>(t & 0xFFFFFFFFull), nullptr);
+    if (!mapping_)
+    {
+        logFailure("CreateFileMapping");
+        reset();
+        return false;
+    }
+
+    view_ = static_cast<uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, total));
+#else
+    std::error_code ec;
+    std::string path = (std::filesystem::temp_directory_path(ec) / "rvtXXXXXX").string();
+    const int fd = mkstemp(path.data());
+    if (fd < 0)
+    {
+        logFailure("mkstemp");
+        reset();
+        return false;
+    }
+    unlink(path.c_str()); // gone from the folder, lives until the fd closes
+    file_ = fd;
+    if (ftruncate(fd, static_cast<off_t>(total)) != 0)
+    {
+        logFailure("ftruncate");
+        reset();
+        return false;
+    }
+    void* v = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    view_ = v == MAP_FAILED ? nullptr : static_cast<uint8_t*>(v);
+#endif
+    if (!view_)
+    {
+        logFailure("map view");
+        reset();
+        return false;
+    }
+    return true;
+}
+
+std::vector<uint8_t> ImageSpool::takeBytes()
+{
+    std::vector<uint8_t> out;
+    if (!isSpilled())
+        out = std::move(mem_);
+    reset();
+    return out;
+}
+
+std::shared_ptr<const uint8_t> ImageSpool::shareMapped()
+{
+    if (!isSpilled())
+        return {};
+    auto owner = std::make_shared<ImageSpool>(std::move(*this));
+    return std::shared_ptr<const uint8_t>(owner, owner->data());
+}
+
+void ImageSpool::reset()
+{
+#ifdef _WIN32
+    if (view_)
+        UnmapViewOfFile(view_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    if (file_ != -1)
+        CloseHandle(reinterpret_cast<HANDLE>(file_)); // FILE_FLAG_DELETE_ON_CLOSE removes it
+#else
+    if (view_)
+        munmap(view_, size_);
+    if (file_ != -1)
+        close(static_cast<int>(file_));
+#endif
+    if (onDisk_)
+        spilled_.fetch_sub(size_);
+    onDisk_ = false;
+    view_ = nullptr;
+    mapping_ = nullptr;
+    file_ = -1;
+    mem_.clear();
+    mem_.shrink_to_fit();
+    size_ = 0;
+}
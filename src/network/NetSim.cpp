@@ -0,0 +1,336 @@
+#include "NetSim.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "Logger.h"
+
+namespace
+{
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    std::chrono::steady_clock::duration toDuration(double ms)
+    {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(Ms(ms));
+    }
+
+    bool parseNumber(std::string_view s, double& out)
+    {
+        const std::string copy(s);
+        char* end = nullptr;
+        out = std::strtod(copy.c_str(), &end);
+        return !copy.empty() && end == copy.c_str() + copy.size() && out >= 0.0;
+    }
+} // namespace
+
+NetSim::~NetSim()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+void NetSim::configure(const Config& cfg)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        cfg_ = cfg;
+        rngs_.clear();
+        refreshEngaged();
+    }
+    Logger::instance().log("localtunnel", Logger::Level::Info, "NetSim: " + describe(cfg));
+}
+
+NetSim::Config NetSim::config() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return cfg_;
+}
+
+void NetSim::setEnabled(bool on)
+{
+    Config cfg = config();
+    cfg.enabled = on;
+    configure(cfg);
+}
+
+// Caller holds mtx_.
+void NetSim::refreshEngaged()
+{
+    engaged_.store(cfg_.enabled || !queue_.empty(), std::memory_order_release);
+}
+
+double NetSim::uniform(std::mt19937_64& rng, double lo, double hi)
+{
+    if (hi <= lo)
+        return lo;
+    return std::uniform_real_distribution<double>(lo, hi)(rng);
+}
+
+// Caller holds mtx_.
+std::mt19937_64& NetSim::rngFor(uint64_t lane)
+{
+    auto it = rngs_.find(lane);
+    if (it == rngs_.end())
+    {
+        std::seed_seq seq{uint32_t(cfg_.seed), uint32_t(cfg_.seed >> 32), uint32_t(lane), uint32_t(lane >> 32)};
+        it = rngs_.emplace(lane, std::mt19937_64(seq)).first;
+    }
+    return it->second;
+}
+
+bool NetSim::submit(msg::PeerHandle peer, msg::dc::Channel channel, Direction dir, size_t bytes, Deliver deliver)
+{
+    if (!engaged() || channel == msg::dc::Channel::Unknown)
+        return false;
+
+    const auto now = Clock::now();
+    const bool isReliable = reliable(channel);
+    const uint64_t key = laneKey(peer, channel, dir);
+
+    std::unique_lock<std::mutex> lk(mtx_);
+    const bool applies = cfg_.enabled && (dir == Direction::Out ? cfg_.outbound : cfg_.inbound);
+    auto lane = lanes_.find(key);
+    Clock::time_point due;
+
+    if (!applies)
+    {
+        // turned off with messages still held: a reliable lane queues behind them, the rest go now
+        if (!isReliable || lane == lanes_.end() || lane->second.pending == 0)
+            return false;
+        due = std::max(now, lane->second.lastDue);
+    }
+    else
+    {
+        const Profile& p = cfg_.channels[static_cast<size_t>(channel)];
+        auto& rng = rngFor(key);
+        if (!isReliable && p.lossPct > 0.0f && uniform(rng, 0.0, 100.0) < p.lossPct)
+        {
+            ++stats_.lost;
+            return true;
+        }
+        if (lane == lanes_.end())
+            lane = lanes_.emplace(key, Lane{}).first;
+        Lane& l = lane->second;
+
+        // a capped link serialises: each message waits for the ones before it to leave the wire
+        Clock::time_point sent = now;
+        if (p.kbps > 0)
+        {
+            const auto start = std::max(now, l.wireFree);
+            l.wireFree = start + toDuration(double(bytes) * 8.0 / double(p.kbps));
+            sent = l.wireFree;
+        }
+        const double jitter = p.jitterMs > 0 ? uniform(rng, -double(p.jitterMs), double(p.jitterMs)) : 0.0;
+        due = sent + toDuration(std::max(0.0, double(p.latencyMs) + jitter));
+
+        if (isReliable)
+        {
+            due = std::max(due, l.lastDue);
+        }
+        else
+        {
+            if (p.reorderPct > 0.0f && uniform(rng, 0.0, 100.0) < p.reorderPct)
+            {
+                // held back long enough for the next few to overtake it
+                due += toDuration(uniform(rng, 1.0, std::max(20.0, 2.0 * double(p.jitterMs))));
+                ++stats_.reordered;
+            }
+            if (due - now > kMarkerMoveLifetime)
+            {
+                ++stats_.expired;
+                return true;
+            }
+        }
+    }
+
+    Lane& l = lane->second;
+    l.lastDue = std::max(l.lastDue, due);
+    ++l.pending;
+    l.pendingBytes += bytes;
+    ++stats_.delayed;
+    ++stats_.pending;
+    stats_.pendingBytes += bytes;
+    queue_.push(Pending{due, ++seq_, key, bytes, std::move(deliver)});
+    refreshEngaged();
+
+    if (!worker_.joinable())
+        worker_ = std::thread([this]()
+                              { run(); });
+    lk.unlock();
+    cv_.notify_one();
+    return true;
+}
+
+void NetSim::run()
+{
+    std::unique_lock<std::mutex> lk(mtx_);
+    for (;;)
+    {
+        cv_.wait(lk, [&]()
+                 { return stop_ || !queue_.empty(); });
+        if (stop_)
+            return;
+        const auto due = queue_.top().due;
+        if (Clock::now() < due)
+        {
+            cv_.wait_until(lk, due); // woken early by a sooner message or stop
+            continue;
+        }
+
+        // top() is const; the entry is popped right after, so moving its handler out is fine
+        Pending job = std::move(const_cast<Pending&>(queue_.top()));
+        queue_.pop();
+        --stats_.pending;
+        stats_.pendingBytes -= job.bytes;
+        if (auto it = lanes_.find(job.lane); it != lanes_.end())
+        {
+            Lane& l = it->second;
+            --l.pending;
+            l.pendingBytes -= job.bytes;
+            if (l.pending == 0 && l.wireFree <= Clock::now())
+                lanes_.erase(it);
+        }
+        refreshEngaged();
+
+        lk.unlock();
+        try
+        {
+            job.deliver();
+        }
+        catch (const std::exception& e)
+        {
+            Logger::instance().log("localtunnel", Logger::Level::Debug, std::string("NetSim: delivery failed: ") + e.what());
+        }
+        job.deliver = nullptr; // drop captured buffers outside the lock too
+        lk.lock();
+    }
+}
+
+size_t NetSim::queuedBytes(msg::PeerHandle peer, msg::dc::Channel channel) const
+{
+    if (!engaged())
+        return 0;
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto it = lanes_.find(laneKey(peer, channel, Direction::Out));
+    return it == lanes_.end() ? 0 : it->second.pendingBytes;
+}
+
+NetSim::Stats NetSim::stats() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return stats_;
+}
+
+const char* NetSim::channelName(size_t channel)
+{
+    static const char* names[kChannels] = {"game", "chat", "notes", "marker_move", "chat_media"};
+    return channel < kChannels ? names[channel] : "?";
+}
+
+bool NetSim::parseSpec(std::string_view spec, Config& inout, std::string* error)
+{
+    auto fail = [error](const std::string& why)
+    {
+        if (error)
+            *error = why;
+        return false;
+    };
+
+    Config cfg = inout;
+    cfg.enabled = true;
+    size_t pos = 0;
+    while (pos < spec.size())
+    {
+        const size_t end = std::min(spec.find_first_of(", ", pos), spec.size());
+        const std::string_view tok = spec.substr(pos, end - pos);
+        pos = end + 1;
+        if (tok.empty())
+            continue;
+        if (tok == "off" || tok == "on")
+        {
+            cfg.enabled = tok == "on";
+            continue;
+        }
+
+        const size_t eq = tok.find('=');
+        if (eq == std::string_view::npos)
+            return fail("expected key=value: " + std::string(tok));
+        std::string_view key = tok.substr(0, eq);
+        const std::string_view value = tok.substr(eq + 1);
+
+        if (key == "dir")
+        {
+            cfg.outbound = value == "out" || value == "both";
+            cfg.inbound = value == "in" || value == "both";
+            if (!cfg.outbound && !cfg.inbound)
+                return fail("dir must be out, in or both");
+            continue;
+        }
+
+        double v = 0.0;
+        if (!parseNumber(value, v))
+            return fail("bad value for " + std::string(key) + ": " + std::string(value));
+        if (key == "seed")
+        {
+            cfg.seed = static_cast<uint64_t>(v);
+            continue;
+        }
+
+        size_t first = 0, last = kChannels;
+        if (const size_t dot = key.find('.'); dot != std::string_view::npos)
+        {
+            const auto ch = msg::dc::channelFromLabel(key.substr(0, dot));
+            if (ch == msg::dc::Channel::Unknown)
+                return fail("unknown channel: " + std::string(key.substr(0, dot)));
+            first = static_cast<size_t>(ch);
+            last = first + 1;
+            key = key.substr(dot + 1);
+        }
+
+        for (size_t c = first; c < last; ++c)
+        {
+            Profile& p = cfg.channels[c];
+            if (key == "latency")
+                p.latencyMs = static_cast<uint32_t>(v);
+            else if (key == "jitter")
+                p.jitterMs = static_cast<uint32_t>(v);
+            else if (key == "kbps")
+                p.kbps = static_cast<uint32_t>(v);
+            else if (key == "loss")
+                p.lossPct = static_cast<float>(std::min(v, 100.0));
+            else if (key == "reorder")
+                p.reorderPct = static_cast<float>(std::min(v, 100.0));
+            else
+                return fail("unknown key: " + std::string(key));
+        }
+    }
+    inout = cfg;
+    return true;
+}
+
+std::string NetSim::describe(const Config& cfg)
+{
+    if (!cfg.enabled)
+        return "off";
+    std::string out = "seed " + std::to_string(cfg.seed) + ", " +
+                      (cfg.outbound && cfg.inbound ? "out+in" : cfg.outbound ? "out"
+                                                                             : "in");
+    for (size_t c = 0; c < kChannels; ++c)
+    {
+        const Profile& p = cfg.channels[c];
+        out += std::string(" | ") + channelName(c) + " " + std::to_string(p.latencyMs) + "+/-" + std::to_string(p.jitterMs) + " ms";
+        if (p.kbps > 0)
+            out += " " + std::to_string(p.kbps) + " kbps";
+        if (!reliable(static_cast<msg::dc::Channel>(c)))
+        {
+            char buf[48];
+            snprintf(buf, sizeof(buf), " loss %.1f%% reorder %.1f%%", p.lossPct, p.reorderPct);
+            out += buf;
+        }
+    }
+    return out;
+}
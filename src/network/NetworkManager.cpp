@@ -9,15 +9,30 @@
 #include "Serializer.h"
 #include "DebugConsole.h"
 #include "Logger.h"
+#include "BufferPool.h"
+#include "HeadlessMode.h"
+#include "HostDiscovery.h"
+#include "ImageThumbnail.h"
 #include <unordered_set>
+#include <algorithm>
 
-NetworkManager::NetworkManager(flecs::world ecs, std::shared_ptr<IdentityManager> identity_manager) :
-    ecs(ecs), identity_manager(identity_manager), peer_role(Role::NONE)
+thread_local msg::PeerHandle NetworkManager::decodingFrom_ = msg::kNoPeer;
+
+NetworkManager::NetworkManager(flecs::world ecs, std::shared_ptr<IdentityManager> identity_manager, bool replaySandbox) :
+    ecs(ecs), identity_manager(identity_manager), peer_role(Role::NONE), replaySandbox_(replaySandbox)
 {
-    getLocalIPAddress();
-    getExternalIPAddress();
+    changeFeed_ = std::make_unique<BoardChangeFeed>(ecs);
+    deltaTracker_ = std::make_unique<EntityDeltaTracker>(ecs, *changeFeed_);
+    boardVersions_ = std::make_unique<BoardVersions>(ecs, *changeFeed_);
+    stateHash_ = std::make_unique<BoardStateHash>(ecs, *changeFeed_);
+    // addresses and the UPnP gateway are looked up in the background; the UI only reads the cache
+    discovery_ = std::make_shared<HostDiscovery>(igd::Options{}, []()
+                                                 { return NetworkUtilities::httpGet(L"loca.lt", L"/mytunnelpassword"); });
+    if (!replaySandbox_)
+        discovery_->start();
     rtc::InitLogger(rtc::LogLevel::Verbose);
     NetworkUtilities::setupTLS();
+    startDecodeShards();
 }
 
 void NetworkManager::setup(std::weak_ptr<BoardManager> board_manager, std::weak_ptr<GameTableManager> gametable_manager)
@@ -27,6 +42,8 @@ void NetworkManager::setup(std::weak_ptr<BoardManager> board_manager, std::weak_
 
     signalingClient = std::make_shared<SignalingClient>(weak_from_this());
     signalingServer = std::make_shared<SignalingServer>(weak_from_this());
+    if (replaySandbox_)
+        return; // the debug console keeps talking to the live session
 
     DebugConsole::setLocalTunnelHandlers(
         [this]() -> std::string
@@ -46,6 +63,13 @@ void NetworkManager::setup(std::weak_ptr<BoardManager> board_manager, std::weak_
 
 NetworkManager::~NetworkManager()
 {
+    stopReplay();
+    stopCapture();
+    stopPrefetchWorker();
+    stopChatMediaWorker();
+    stopSwarmWorker();
+    diskCache_.reset(); // joins its thread: no load callback runs past here
+    stopDecodeShards();
     closeServer();
     disconnectAllPeers();
 }
@@ -134,6 +158,8 @@ void NetworkManager::startServer(ConnectionType mode, unsigned short port, bool
     setPort(port);
 
     const std::string localIp = getLocalIPAddress();
+    // the address in the LOCAL connection string is the one players will reach
+    setLanMode(mode == ConnectionType::LOCAL, localIp);
 
     // Mode-specific side effects (no client connect here)
     switch (mode)
@@ -153,14 +179,18 @@ void NetworkManager::startServer(ConnectionType mode, unsigned short port, bool
         {
             if (tryUpnp)
             {
-                try
-                {
-                    (void)UPnPManager::addPortMapping(localIp, port, port, "TCP", "RunicVTT");
-                }
-                catch (...)
-                {
-                    pushStatusToast("UPnP port mapping failed — check router config.", ImGuiToaster::Level::Error, 4);
-                }
+                // the gateway may still be answering discovery; the result comes back as a toast
+                upnpMappedPort_ = port;
+                std::weak_ptr<NetworkManager> weak = weak_from_this();
+                discovery_->addPortMappingAsync(port, "TCP", "RunicVTT", [weak](bool ok, const std::string& detail)
+                                                {
+                    auto self = weak.lock();
+                    if (!self)
+                        return;
+                    if (ok)
+                        self->pushStatusToast("UPnP port mapping added.", ImGuiToaster::Level::Good, 4);
+                    else
+                        self->pushStatusToast("UPnP port mapping failed (" + detail + ") - check router config.", ImGuiToaster::Level::Error, 6); });
             }
             // Players will connect via public IP:port; GM still connects locally below
             break;
@@ -313,11 +343,16 @@ void NetworkManager::closeServer()
     }
     //stopRawDrainWorker();
     NetworkUtilities::stopLocalTunnel();
+    if (upnpMappedPort_ != 0)
+    {
+        discovery_->removePortMappingAsync(upnpMappedPort_, "TCP");
+        upnpMappedPort_ = 0;
+    }
 }
 
 bool NetworkManager::isConnected()
 {
-    for (auto& [peerId, link] : peers)
+    for (auto& [peerId, link] : peers.snapshot())
     {
         if (link && link->isConnected())
             return true;
@@ -335,7 +370,7 @@ bool NetworkManager::hasAnyPeer() const
 int NetworkManager::connectedPeerCount() const
 {
     int n = 0;
-    for (auto& [id, link] : peers)
+    for (auto& [id, link] : peers.snapshot())
         if (link && link->isConnected())
             ++n;
     return n;
@@ -351,6 +386,27 @@ bool NetworkManager::connectToPeer(const std::string& connectionString)
     if (!password.empty())
         setNetworkPassword(password.c_str());
     peer_role = Role::PLAYER;
+    if (!diskCache_ && !replaySandbox_)
+        diskCache_ = std::make_unique<ImageDiskCache>(PathManager::getImageCachePath()); // before any link can use it
+
+    if (!hasUrlScheme(server) && NetworkUtilities::isPrivateIPv4(server))
+    {
+        std::string bind;
+        try
+        {
+            bind = NetworkUtilities::getLocalIPv4Address(server.c_str());
+        }
+        catch (...)
+        {
+            // no route yet: gather on every interface
+        }
+        setLanMode(true, bind);
+        Logger::instance().log("localtunnel", Logger::Level::Info, "LAN mode: host candidates only, bind " + (bind.empty() ? std::string("any") : bind));
+    }
+    else
+    {
+        setLanMode(false);
+    }
 
     if (hasUrlScheme(server))
     {
@@ -359,28 +415,47 @@ bool NetworkManager::connectToPeer(const std::string& connectionString)
     return signalingClient->connect(server, port); // your old method
 }
 
+uint64_t NetworkManager::signalingAuthMs() const
+{
+    return signalingClient ? signalingClient->authMs() : 0;
+}
+
+void NetworkManager::logConnectPhases(const std::string& peerId, const PeerLink& link)
+{
+    Logger::instance().log("localtunnel", Logger::Level::Info,
+                           "Connect " + peerId + ": auth " + std::to_string(signalingAuthMs()) + " ms | " + link.phaseSummary());
+}
+
+void NetworkManager::markPeerBootstrapped(msg::PeerHandle from)
+{
+    const std::string peerId = peerRegistry_.peerId(from);
+    auto link = peers.find(peerId);
+    if (!link || link->phaseMs(PeerLink::Phase::Bootstrap))
+        return;
+    link->markPhase(PeerLink::Phase::Bootstrap);
+    logConnectPhases(peerId, *link);
+}
+
 //INFORMATION AND PARSE OPERATIONS
 std::string NetworkManager::getLocalIPAddress()
 {
-    if (local_ip_address == "")
+    if (auto ip = discovery_->localIPv4(); !ip.empty())
+        return ip;
+    // discovery still running: the route lookup is a local syscall, cheap enough to do inline
+    try
     {
-        auto local_ip = NetworkUtilities::getLocalIPv4Address();
-        local_ip_address = local_ip;
-        return local_ip;
+        return NetworkUtilities::getLocalIPv4Address();
+    }
+    catch (...)
+    {
+        return {};
     }
-    return local_ip_address;
 }
 
+// Never blocks; "" until discovery has an answer.
 std::string NetworkManager::getExternalIPAddress()
 {
-    if (external_ip_address == "")
-    {
-        //auto external_ip = UPnPManager::getExternalIPv4Address();
-        std::string external_ip = NetworkUtilities::httpGet(L"loca.lt", L"/mytunnelpassword");
-        external_ip_address = external_ip;
-        return external_ip;
-    }
-    return external_ip_address;
+    return discovery_->externalIPv4();
 }
 
 std::string NetworkManager::getNetworkInfo(ConnectionType type)
@@ -391,11 +466,15 @@ std::string NetworkManager::getNetworkInfo(ConnectionType type)
     if (type == ConnectionType::LOCAL)
     { // LAN (192.168.x.y)
         const auto ip = getLocalIPAddress();
+        if (ip.empty())
+            return {};
         return "runic:" + ip + ":" + std::to_string(port) + "?" + pwd;
     }
     else if (type == ConnectionType::EXTERNAL)
-    { // public IP
+    { // public IP, "" while discovery is still looking it up
         const auto ip = getExternalIPAddress();
+        if (ip.empty())
+            return {};
         return "runic:" + ip + ":" + std::to_string(port) + "?" + pwd;
     }
     else if (type == ConnectionType::LOCALTUNNEL)
@@ -550,30 +629,15 @@ void NetworkManager::ShowPortForwardingHelpPopup(bool* p_open)
 // Optional: remove peers that are no longer usable (Closed/Failed or nullptr)
 std::size_t NetworkManager::removeDisconnectedPeers()
 {
-    std::vector<std::string> toErase;
-    std::vector<std::shared_ptr<PeerLink>> toClose;
-    toErase.reserve(peers.size());
-    toClose.reserve(peers.size());
-
-    // 1) Decide who to remove; DO NOT mutate the map yet.
-    for (auto const& [pid, link] : peers)
-    {
-        const bool shouldRemove = (!link) || link->isClosedOrFailed();
-        if (shouldRemove)
-        {
-            toErase.push_back(pid);
-            if (link)
-                toClose.emplace_back(link);
-        }
-    }
-
-    // 2) Erase all selected entries from the map (no destructors called yet for links we retained).
-    for (auto const& pid : toErase)
-        peers.erase(pid);
+    // 1) Publish a table without the dead links (we keep them alive in `removed`).
+    auto removed = peers.eraseIf([](const std::string&, const std::shared_ptr<PeerLink>& link)
+                                 { return (!link) || link->isClosedOrFailed(); });
 
-    // 3) Close outside the map to avoid re-entrancy/races.
-    for (auto& link : toClose)
+    // 2) Close outside the table to avoid re-entrancy/races.
+    for (auto& [pid, link] : removed)
     {
+        if (!link)
+            continue;
         try
         {
             link->close(); // should be idempotent and NOT call back into NM
@@ -590,22 +654,15 @@ std::size_t NetworkManager::removeDisconnectedPeers()
         }
     }
 
-    return toErase.size();
+    return removed.size();
 }
 
 bool NetworkManager::removePeer(std::string peerId)
 {
     // 1) Find, move the link out, erase entry first.
     std::shared_ptr<PeerLink> link;
-    if (auto it = peers.find(peerId); it != peers.end())
-    {
-        link = std::move(it->second);
-        peers.erase(it);
-    }
-    else
-    {
+    if (!peers.erase(peerId, link))
         return false;
-    }
 
     // 2) Close outside the map.
     if (link)
@@ -631,11 +688,8 @@ bool NetworkManager::removePeer(std::string peerId)
 // PEER INSERT METHOD AND LOCAL CALLBACKS --------------------------------------------------------------------
 std::shared_ptr<PeerLink> NetworkManager::ensurePeerLink(const std::string& peerId)
 {
-    if (auto it = peers.find(peerId); it != peers.end())
-        return it->second;
-    auto link = std::make_shared<PeerLink>(peerId, weak_from_this());
-    peers.emplace(peerId, link);
-    return link;
+    return peers.findOrInsert(peerId, [&]()
+                              { return std::make_shared<PeerLink>(peerId, weak_from_this()); });
 }
 
 // NetworkManager.cpp (relevant part)
@@ -684,40 +738,28 @@ void NetworkManager::housekeepPeers()
     static std::unordered_map<std::string, uint64_t> firstDiscWsAt;
 
     // ---- PeerLink cleanup ----
-    for (auto it = peers.begin(); it != peers.end();)
+    auto expired = peers.eraseIf([&](const std::string& pid, const std::shared_ptr<PeerLink>& link)
+                                 {
+                                     if (link && link->isConnected())
+                                     {
+                                         firstDiscPeerAt.erase(pid);
+                                         return false;
+                                     }
+                                     uint64_t& t0 = firstDiscPeerAt[pid];
+                                     if (t0 == 0)
+                                         t0 = now;
+                                     return now - t0 >= kGraceMs; });
+    for (auto& [pid, link] : expired)
     {
-        const std::string& pid = it->first;
-        auto& link = it->second;
-
-        const bool connected = (link && link->isConnected());
-        if (connected)
-        {
-            firstDiscPeerAt.erase(pid);
-            ++it;
-            continue;
-        }
-
-        uint64_t& t0 = firstDiscPeerAt[pid];
-        if (t0 == 0)
-            t0 = now;
-
-        if (now - t0 >= kGraceMs)
+        try
         {
-            try
-            {
-                if (link)
-                    link->close();
-            }
-            catch (...)
-            {
-            }
-            it = peers.erase(it);
-            firstDiscPeerAt.erase(pid);
+            if (link)
+                link->close();
         }
-        else
+        catch (...)
         {
-            ++it;
         }
+        firstDiscPeerAt.erase(pid);
     }
 
     // ---- WebSocket cleanup (server side) ----
@@ -765,9 +807,10 @@ void NetworkManager::upsertPeerIdentityWithUnique(const std::string& peerId,
     identity_manager->bindPeer(/*peerId=*/peerId,
                                /*uniqueId=*/uniqueId,
                                /*username=*/username);
+    peerRegistry_.setUniqueId(peerRegistry_.intern(peerId), uniqueId);
 
-    if (auto it = peers.find(peerId); it != peers.end() && it->second)
-        it->second->setDisplayName(username);
+    if (auto link = peers.find(peerId))
+        link->setDisplayName(username);
 }
 
 std::string NetworkManager::displayNameForPeer(const std::string& peerId) const
@@ -781,8 +824,7 @@ std::string NetworkManager::displayNameForPeer(const std::string& peerId) const
 bool NetworkManager::disconectFromPeers()
 {
     // Move out to avoid mutation during destruction
-    std::unordered_map<std::string, std::shared_ptr<PeerLink>> moved = std::move(peers);
-    peers.clear();
+    auto moved = peers.takeAll();
 
     for (auto& [pid, link] : moved)
     {
@@ -821,8 +863,7 @@ bool NetworkManager::disconnectAllPeers()
         signalingServer->broadcastShutdown();
     }
 
-    std::unordered_map<std::string, std::shared_ptr<PeerLink>> moved = std::move(peers);
-    peers.clear();
+    auto moved = peers.takeAll();
 
     for (auto& [pid, link] : moved)
     {
@@ -877,8 +918,9 @@ void NetworkManager::broadcastPeerDisconnect(const std::string& targetId)
 std::vector<std::string> NetworkManager::getConnectedPeerIds() const
 {
     std::vector<std::string> ids;
-    ids.reserve(peers.size());
-    for (auto& [pid, link] : peers)
+    auto snap = peers.snapshot();
+    ids.reserve(snap.size());
+    for (auto& [pid, link] : snap)
     {
         if (link && link->isConnected())
         {
@@ -891,8 +933,9 @@ std::vector<std::string> NetworkManager::getConnectedPeerIds() const
 std::vector<std::string> NetworkManager::getConnectedUsernames() const
 {
     std::vector<std::string> user_names;
-    user_names.reserve(peers.size());
-    for (auto& [pid, link] : peers)
+    auto snap = peers.snapshot();
+    user_names.reserve(snap.size());
+    for (auto& [pid, link] : snap)
     {
         if (link && link->isConnected())
         {
@@ -922,7 +965,7 @@ std::string NetworkManager::debugIdentitySnapshot() const
     }
 
     os << "\n[Peers]\n";
-    for (const auto& [peerId, link] : peers)
+    for (const auto& [peerId, link] : peers.snapshot())
     {
         os << "- peerId=" << peerId;
 
@@ -979,15 +1022,22 @@ void NetworkManager::broadcastGameTable(const flecs::entity& gameTable)
 void NetworkManager::broadcastBoard(const flecs::entity& board)
 { //{check}--USE THIS METHOD
     auto ids = getConnectedPeerIds();
-    if (!ids.empty())
+    if (ids.empty())
+        return;
+    // players still holding this board just switch back and catch up
+    std::vector<std::string> whole;
+    for (auto& pid : ids)
     {
-        sendBoard(board, ids);
+        if (!switchToHeldBoard(board, pid))
+            whole.push_back(pid);
     }
+    if (!whole.empty())
+        sendBoard(board, whole);
 }
 
 void NetworkManager::broadcastMarker(uint64_t boardId, const flecs::entity& marker)
 { //{check}--USE THIS METHOD
-    auto ids = getConnectedPeerIds();
+    auto ids = getPeerIdsViewing(boardId);
     if (!ids.empty())
     {
         sendMarker(boardId, marker, ids);
@@ -996,7 +1046,7 @@ void NetworkManager::broadcastMarker(uint64_t boardId, const flecs::entity& mark
 
 void NetworkManager::broadcastFog(uint64_t boardId, const flecs::entity& fog)
 { //{check}--USE THIS METHOD
-    auto ids = getConnectedPeerIds();
+    auto ids = getPeerIdsViewing(boardId);
     if (!ids.empty())
     {
         sendFog(boardId, fog, ids);
@@ -1009,21 +1059,16 @@ void NetworkManager::broadcastFog(uint64_t boardId, const flecs::entity& fog)
 
 void NetworkManager::broadcastMarkerDelete(uint64_t boardId, const flecs::entity& marker)
 {
-    auto ids = getConnectedPeerIds();
+    if (marker.is_valid() && marker.has<Identifier>())
+        forgetWithheldMarkers({marker.get<Identifier>()->id});
+    auto ids = getPeerIdsViewing(boardId);
     if (!ids.empty())
         sendMarkerDelete(boardId, marker, ids);
 }
 
-void NetworkManager::broadcastFogUpdate(uint64_t boardId, const flecs::entity& fog)
-{
-    auto ids = getConnectedPeerIds();
-    if (!ids.empty())
-        sendFogUpdate(boardId, fog, ids);
-}
-
 void NetworkManager::broadcastFogDelete(uint64_t boardId, const flecs::entity& fog)
 {
-    auto ids = getConnectedPeerIds();
+    auto ids = getPeerIdsViewing(boardId);
     if (!ids.empty())
         sendFogDelete(boardId, fog, ids);
 }
@@ -1047,7 +1092,7 @@ void NetworkManager::buildUserNameUpdate(std::vector<uint8_t>& out,
 
 void NetworkManager::broadcastUserNameUpdate(const std::vector<uint8_t>& payload)
 {
-    for (auto& [pid, link] : peers)
+    for (auto& [pid, link] : peers.snapshot())
     {
         if (!link)
             continue;
@@ -1058,8 +1103,8 @@ void NetworkManager::broadcastUserNameUpdate(const std::vector<uint8_t>& payload
 void NetworkManager::sendUserNameUpdateTo(const std::string& peerId,
                                           const std::vector<uint8_t>& payload)
 {
-    auto it = peers.find(peerId);
-    if (it == peers.end() || !it->second)
+    auto link = peers.find(peerId);
+    if (!link)
         return;
 
     std::vector<uint8_t> frame;
@@ -1067,7 +1112,7 @@ void NetworkManager::sendUserNameUpdateTo(const std::string& peerId,
     frame.push_back((uint8_t)msg::DCType::UserNameUpdate);
     frame.insert(frame.end(), payload.begin(), payload.end());
 
-    it->second->sendOn(msg::dc::name::Game, frame);
+    link->sendOn(msg::dc::name::Game, frame);
 }
 
 // NetworkManager.cpp
@@ -1075,20 +1120,17 @@ bool NetworkManager::broadcastChatJson(const msg::Json& j)
 {
     const std::string text = j.dump(); // UTF-8 JSON
     bool any = false;
-    for (auto& [pid, link] : peers)
+    for (auto& [pid, link] : peers.snapshot())
     {
-        if (link->sendOn(msg::dc::name::Chat, std::string_view(text)))
+        if (link && link->sendOn(msg::dc::name::Chat, std::string_view(text)))
             any = true;
     }
     return any;
 }
 bool NetworkManager::sendChatJsonTo(const std::string& peerId, const msg::Json& j)
 {
-    auto it = peers.find(peerId);
-    if (it == peers.end() || !it->second)
-        return false;
-    auto& link = it->second;
-    if (!link->isConnected())
+    auto link = peers.find(peerId);
+    if (!link || !link->isConnected())
         return false;
     return link->sendOn(msg::dc::name::Chat, std::string_view(j.dump()));
 }
@@ -1098,11 +1140,8 @@ bool NetworkManager::sendChatJsonTo(const std::set<std::string>& targets, const
     bool any = false;
     for (auto& pid : targets)
     {
-        auto it = peers.find(pid);
-        if (it == peers.end() || !it->second)
-            continue;
-        auto& link = it->second;
-        if (!link->isConnected())
+        auto link = peers.find(pid);
+        if (!link || !link->isConnected())
             continue;
         if (link->sendOn(msg::dc::name::Chat, std::string_view(text)))
             any = true;
@@ -1110,9 +1149,9 @@ bool NetworkManager::sendChatJsonTo(const std::set<std::string>& targets, const
     return any;
 }
 
-void NetworkManager::decodeRawGameBuffer(const std::string& fromPeer, const std::vector<uint8_t>& b)
+void NetworkManager::decodeRawGameBuffer(msg::PeerHandle fromPeer, const std::vector<uint8_t>& b)
 {
-    decodingFromPeer_ = fromPeer;
+    decodingFrom_ = fromPeer;
     size_t off = 0;
     while (off < b.size())
     {
@@ -1160,6 +1199,62 @@ void NetworkManager::decodeRawGameBuffer(const std::string& fromPeer, const std:
                 Logger::instance().log("localtunnel", Logger::Level::Info, "CommitMarker Handled!!");
                 break;
 
+            case msg::DCType::ImagePrefetchChunk:
+                handleImagePrefetchChunk(b, off);
+                break;
+
+            case msg::DCType::ImageCached:
+                handleImageCached(b, off);
+                break;
+
+            case msg::DCType::ImageRequest:
+                handleImageRequest(b, off);
+                break;
+
+            case msg::DCType::EntityDelta:
+                handleEntityDelta(b, off);
+                break;
+
+            case msg::DCType::ImageManifest:
+                handleImageManifest(b, off);
+                break;
+
+            case msg::DCType::ImagePiece:
+                handleImagePiece(b, off);
+                break;
+
+            case msg::DCType::PieceRequest:
+                handlePieceRequest(b, off);
+                break;
+
+            case msg::DCType::CacheInventory:
+                handleCacheInventory(b, off);
+                break;
+
+            case msg::DCType::ImageCachedByHash:
+                handleImageCachedByHash(b, off);
+                break;
+
+            case msg::DCType::StateVersion:
+                handleStateVersion(b, off);
+                break;
+
+            case msg::DCType::ResyncRequest:
+                handleResyncRequest(b, off);
+                break;
+
+            case msg::DCType::StateHash:
+                handleStateHash(b, off);
+                break;
+
+            case msg::DCType::StateHashLeaves:
+                handleStateHashLeaves(b, off);
+                break;
+            case msg::DCType::BoardView:
+            case msg::DCType::BoardSwitch:
+                handleBoardView(type, b, off);
+                break;
+
             case msg::DCType::MarkerUpdate:
                 handleMarkerUpdate(b, off);
                 Logger::instance().log("localtunnel", Logger::Level::Info, "MarkerUpdate Handled!!");
@@ -1170,6 +1265,14 @@ void NetworkManager::decodeRawGameBuffer(const std::string& fromPeer, const std:
                 Logger::instance().log("localtunnel", Logger::Level::Info, "MarkerUpdate Handled!!");
                 break;
 
+            case msg::DCType::MarkerMoveAck:
+                handleMarkerMoveAck(b, off);
+                break;
+
+            case msg::DCType::MarkerGroupOp:
+                handleMarkerGroupOp(b, off);
+                break;
+
             case msg::DCType::FogUpdate:
                 handleFogUpdate(b, off);
                 Logger::instance().log("localtunnel", Logger::Level::Info, "FogUpdate Handled!!");
@@ -1200,13 +1303,13 @@ void NetworkManager::decodeRawGameBuffer(const std::string& fromPeer, const std:
                 break;
         }
     }
-    decodingFromPeer_.clear();
+    decodingFrom_ = msg::kNoPeer;
 }
 
 // MARKER MOVE OPERATIONS -----------------------------------------------------------------------------------------------------------------------------------------
-void NetworkManager::decodeRawMarkerMoveBuffer(const std::string& fromPeer, const std::vector<uint8_t>& b)
+void NetworkManager::decodeRawMarkerMoveBuffer(msg::PeerHandle fromPeer, const std::vector<uint8_t>& b)
 {
-    decodingFromPeer_ = fromPeer;
+    decodingFrom_ = fromPeer;
     size_t off = 0;
     while (off < b.size())
     {
@@ -1215,17 +1318,25 @@ void NetworkManager::decodeRawMarkerMoveBuffer(const std::string& fromPeer, cons
 
         auto type = static_cast<msg::DCType>(b[off]);
         off += 1;
-        Logger::instance().log("localtunnel", Logger::Level::Info, msg::DCtypeString(type) + " Received!! MarkerMove");
+        if (type == msg::DCType::MarkerMoveAck)
+        {
+            handleMarkerMoveAck(b, off); // GM acks for streamed moves ride the same channel
+            continue;
+        }
+        if (type == msg::DCType::MarkerGroupOp)
+        {
+            handleMarkerGroupOp(b, off); // streamed group moves
+            continue;
+        }
         if (type != msg::DCType::MarkerMove)
         {
             // If the sender packed something else on this DC, bail
-            return;
+            break;
         }
 
         handleMarkerMove(b, off); // parses one frame and updates coalescer
-        Logger::instance().log("localtunnel", Logger::Level::Info, "MarkerMove Handled!!");
     }
-    decodingFromPeer_.clear();
+    decodingFrom_ = msg::kNoPeer;
 }
 
 void NetworkManager::handleMarkerMove(const std::vector<uint8_t>& raw, size_t& off)
@@ -1246,7 +1357,7 @@ void NetworkManager::handleMarkerMove(const std::vector<uint8_t>& raw, size_t& o
     m.pos = p;
     m.mov = Moving{true};
 
-    m.fromPeerId = decodingFromPeer_;
+    m.fromPeer = decodingFrom_;
 
     inboundGame_.push(std::move(m));
 }
@@ -1263,7 +1374,7 @@ void NetworkManager::handleMarkerUpdate(const std::vector<uint8_t>& b, size_t& o
     m.vis = Serializer::deserializeVisibility(b, off);
     m.markerComp = Serializer::deserializeMarkerComponent(b, off);
 
-    m.fromPeerId = decodingFromPeer_;
+    m.fromPeer = decodingFrom_;
     inboundGame_.push(std::move(m));
 }
 void NetworkManager::handleMarkerMoveState(const std::vector<uint8_t>& raw, size_t& off)
@@ -1292,13 +1403,139 @@ void NetworkManager::handleMarkerMoveState(const std::vector<uint8_t>& raw, size
         Position p = Serializer::deserializePosition(b, off);
         m.pos = p;
     }
-    m.fromPeerId = decodingFromPeer_;
+    m.fromPeer = decodingFrom_;
+    inboundGame_.push(std::move(m));
+}
+
+void NetworkManager::handleMarkerMoveAck(const std::vector<uint8_t>& raw, size_t& off)
+{
+    // [boardId:u64][markerId:u64][epoch:u32][seq:u32][accepted:u8][Position]
+    if (!ensureRemaining(raw, off, 8 + 8 + 4 + 4 + 1 + 8))
+        return;
+
+    const auto& b = reinterpret_cast<const std::vector<unsigned char>&>(raw);
+
+    msg::ReadyMessage m;
+    m.kind = msg::DCType::MarkerMoveAck;
+    m.boardId = Serializer::deserializeUInt64(b, off);
+    m.markerId = Serializer::deserializeUInt64(b, off);
+    m.dragEpoch = Serializer::deserializeUInt32(b, off);
+    m.seq = Serializer::deserializeUInt32(b, off);
+    m.accepted = Serializer::deserializeUInt8(b, off) != 0;
+    m.pos = Serializer::deserializePosition(b, off);
+    m.fromPeer = decodingFrom_;
+    inboundGame_.push(std::move(m));
+}
+
+void NetworkManager::handleMarkerGroupOp(const std::vector<uint8_t>& raw, size_t& off)
+{
+    // [boardId:u64][op:u8][groupId:u64][epoch:u32][seq:u32][count:u32][ids:u64 x count][payload by op]
+    if (!ensureRemaining(raw, off, 8 + 1 + 8 + 4 + 4 + 4))
+    {
+        off = raw.size();
+        return;
+    }
+
+    const auto& b = reinterpret_cast<const std::vector<unsigned char>&>(raw);
+
+    msg::ReadyMessage m;
+    m.kind = msg::DCType::MarkerGroupOp;
+    m.boardId = Serializer::deserializeUInt64(b, off);
+    const auto op = static_cast<msg::GroupOp>(Serializer::deserializeUInt8(b, off));
+    m.groupOp = op;
+    m.groupId = Serializer::deserializeUInt64(b, off);
+    m.dragEpoch = Serializer::deserializeUInt32(b, off);
+    m.seq = Serializer::deserializeUInt32(b, off);
+    const uint32_t count = Serializer::deserializeUInt32(b, off);
+    if (count > msg::kMaxGroupMarkers || !ensureRemaining(raw, off, size_t(count) * 8))
+    {
+        off = raw.size();
+        return;
+    }
+
+    std::vector<uint64_t> ids(count);
+    for (auto& id : ids)
+        id = Serializer::deserializeUInt64(b, off);
+    m.ids = std::move(ids);
+
+    switch (op)
+    {
+        case msg::GroupOp::Move:
+            if (!ensureRemaining(raw, off, 8))
+            {
+                off = raw.size();
+                return;
+            }
+            m.pos = Serializer::deserializePosition(b, off);
+            break;
+        case msg::GroupOp::MoveEnd:
+        {
+            if (!ensureRemaining(raw, off, size_t(count) * 8))
+            {
+                off = raw.size();
+                return;
+            }
+            std::vector<Position> positions(count);
+            for (auto& p : positions)
+                p = Serializer::deserializePosition(b, off);
+            m.positions = std::move(positions);
+            break;
+        }
+        case msg::GroupOp::Visibility:
+            if (!ensureRemaining(raw, off, 1))
+            {
+                off = raw.size();
+                return;
+            }
+            m.vis = Serializer::deserializeVisibility(b, off);
+            break;
+        case msg::GroupOp::Delete:
+            break;
+        default:
+            off = raw.size(); // unknown op: the payload size is unknown too
+            return;
+    }
+
+    m.fromPeer = decodingFrom_;
+    // anyone may drag a selection, only the GM hides or deletes one
+    if ((op == msg::GroupOp::Visibility || op == msg::GroupOp::Delete) && !isGmPeer(m.fromPeer))
+        return;
     inboundGame_.push(std::move(m));
 }
 
+std::vector<unsigned char> NetworkManager::buildMarkerGroupFrame(uint64_t boardId, msg::GroupOp op, uint64_t groupId, uint32_t epoch,
+                                                                 uint32_t seq, const std::vector<uint64_t>& markerIds)
+{
+    auto out = BufferPool::instance().acquire();
+    Serializer::serializeUInt8(out, static_cast<uint8_t>(msg::DCType::MarkerGroupOp));
+    Serializer::serializeUInt64(out, boardId);
+    Serializer::serializeUInt8(out, static_cast<uint8_t>(op));
+    Serializer::serializeUInt64(out, groupId);
+    Serializer::serializeUInt32(out, epoch);
+    Serializer::serializeUInt32(out, seq);
+    Serializer::serializeUInt32(out, static_cast<uint32_t>(markerIds.size()));
+    for (auto id : markerIds)
+        Serializer::serializeUInt64(out, id);
+    return out; // caller appends the payload
+}
+
+std::vector<unsigned char> NetworkManager::buildMarkerMoveAckFrame(uint64_t boardId, uint64_t markerId, uint32_t epoch,
+                                                                   uint32_t seq, bool accepted, const Position& pos)
+{
+    auto out = BufferPool::instance().acquire();
+    Serializer::serializeUInt8(out, static_cast<uint8_t>(msg::DCType::MarkerMoveAck));
+    Serializer::serializeUInt64(out, boardId);
+    Serializer::serializeUInt64(out, markerId);
+    Serializer::serializeUInt32(out, epoch);
+    Serializer::serializeUInt32(out, seq);
+    Serializer::serializeUInt8(out, accepted ? 1 : 0);
+    Serializer::serializePosition(out, &pos);
+    return out;
+}
+
 std::vector<unsigned char> NetworkManager::buildMarkerMoveFrame(uint64_t boardId, const flecs::entity& marker, uint32_t seq)
 {
-    std::vector<unsigned char> out;
+    auto out = BufferPool::instance().acquire();
     const auto* id = marker.get<Identifier>();
     const auto* pos = marker.get<Position>();
     if (!id || !pos)
@@ -1325,7 +1562,7 @@ std::vector<unsigned char> NetworkManager::buildMarkerMoveFrame(uint64_t boardId
 }
 std::vector<unsigned char> NetworkManager::buildMarkerMoveStateFrame(uint64_t boardId, const flecs::entity& marker)
 {
-    std::vector<unsigned char> out;
+    auto out = BufferPool::instance().acquire();
     const auto* id = marker.get<Identifier>();
     const auto* mv = marker.get<Moving>();
     if (!id || !mv)
@@ -1341,6 +1578,7 @@ std::vector<unsigned char> NetworkManager::buildMarkerMoveStateFrame(uint64_t bo
     const uint32_t seq = ++s.localSeq;
     const uint64_t ts = nowMs();
     s.lastTxMs = ts;
+    recordPredictedMove(s, seq, marker);
 
     Serializer::serializeUInt8(out, static_cast<uint8_t>(msg::DCType::MarkerMoveState));
     Serializer::serializeUInt64(out, boardId);
@@ -1358,35 +1596,9 @@ std::vector<unsigned char> NetworkManager::buildMarkerMoveStateFrame(uint64_t bo
     return out;
 }
 
-// ---- MARKER UPDATE/DELETE ----
-std::vector<unsigned char> NetworkManager::buildMarkerUpdateFrame(uint64_t boardId, const flecs::entity& marker)
-{
-    std::vector<unsigned char> b;
-    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::MarkerUpdate));
-    Serializer::serializeUInt64(b, boardId);
-
-    const auto id = marker.get<Identifier>()->id;
-    const auto siz = *marker.get<Size>();
-    const auto vis = *marker.get<Visibility>();
-    const auto mc = *marker.get<MarkerComponent>();
-
-    Serializer::serializeUInt64(b, id);
-    Serializer::serializeSize(b, &siz);
-    Serializer::serializeVisibility(b, &vis);
-    Serializer::serializeMarkerComponent(b, &mc);
-    return b;
-}
-
-void NetworkManager::broadcastMarkerUpdate(uint64_t boardId, const flecs::entity& marker)
-{
-    auto ids = getConnectedPeerIds();
-    if (!ids.empty())
-        sendMarkerUpdate(boardId, marker, ids);
-}
-
 void NetworkManager::broadcastMarkerMove(uint64_t boardId, const flecs::entity& marker)
 {
-    auto ids = getConnectedPeerIds();
+    auto ids = getPeerIdsViewing(boardId);
     if (!ids.empty())
         sendMarkerMove(boardId, marker, ids);
 }
@@ -1406,21 +1618,24 @@ void NetworkManager::sendMarkerMove(uint64_t boardId, const flecs::entity& marke
     }
     const uint32_t seq = ++s.localSeq;
     s.lastTxMs = nowMs();
+    recordPredictedMove(s, seq, marker);
 
     auto frame = buildMarkerMoveFrame(boardId, marker, seq);
     if (frame.empty())
         return;
 
+    auto snap = peers.snapshot();
     for (auto& pid : toPeerIds)
     {
-        if (auto it = peers.find(pid); it != peers.end() && it->second)
+        if (auto it = snap.find(pid); it != snap.end() && it->second)
             it->second->sendMarkerMove(frame);
     }
+    BufferPool::instance().release(std::move(frame));
 }
 
 void NetworkManager::broadcastMarkerMoveState(uint64_t boardId, const flecs::entity& marker)
 {
-    auto ids = getConnectedPeerIds();
+    auto ids = getPeerIdsViewing(boardId);
     if (!ids.empty())
         sendMarkerMoveState(boardId, marker, ids);
 }
@@ -1436,6 +1651,7 @@ void NetworkManager::sendMarkerMoveState(uint64_t boardId, const flecs::entity&
 
     // Reliable: use your game channel
     broadcastGameFrame(frame, toPeerIds);
+    BufferPool::instance().release(std::move(frame));
 }
 
 //bool NetworkManager::amIDragging(uint64_t markerId) const
@@ -1459,7 +1675,22 @@ bool NetworkManager::amIDragging(uint64_t markerId) const
         return true;
 
     // Otherwise fall back to peer-id ownership (remote handoff cases).
-    return !s.closed && s.ownerPeerId == getMyPeerId();
+    return !s.closed && s.ownerPeer == msg::kSelfPeer;
+}
+
+// UI thread. Drags a peer held open won't get their final state once its link is gone.
+void NetworkManager::releaseDragsOf(msg::PeerHandle peer)
+{
+    if (peer == msg::kNoPeer)
+        return;
+    for (auto& [mid, s] : drag_)
+    {
+        if (!s.closed && !s.locallyDragging && s.ownerPeer == peer)
+            s.closed = true;
+    }
+    for (auto it = groupDrag_.begin(); it != groupDrag_.end();)
+        it = it->second.ownerPeer == peer ? groupDrag_.erase(it) : std::next(it);
+    groupEpochEnded_.erase(peer);
 }
 
 // markDraggingLocal — called by BoardManager on start/end
@@ -1471,9 +1702,12 @@ void NetworkManager::markDraggingLocal(uint64_t markerId, bool dragging)
         s.locallyDragging = true;
         s.locallyProposedEpoch = (s.closed ? (s.epoch + 1) : s.epoch);
         s.localSeq = 0;
-        s.ownerPeerId = getMyPeerId();
+        s.ownerPeer = msg::kSelfPeer;
         s.epochOpenedMs = nowMs();
         s.closed = false;
+        s.unacked.clear();
+        s.ackedSeq = 0;
+        s.yielded = false;
         if (s.locallyProposedEpoch > s.epoch)
             s.epoch = s.locallyProposedEpoch;
     }
@@ -1500,21 +1734,12 @@ void NetworkManager::forceCloseDrag(uint64_t markerId)
     s.localSeq = 0;
 }
 
-void NetworkManager::sendMarkerUpdate(uint64_t boardId, const flecs::entity& marker,
-                                      const std::vector<std::string>& toPeerIds)
-{
-    if (!marker.is_valid() || !marker.has<Identifier>())
-        return;
-
-    auto frame = buildMarkerUpdateFrame(boardId, marker);
-    broadcastGameFrame(frame, toPeerIds);
-}
-
 bool NetworkManager::shouldApplyMarkerMove(const msg::ReadyMessage& m)
 {
     if (!m.markerId || !m.dragEpoch)
         return false;
     auto& s = drag_[*m.markerId];
+    s.lastRxMs = nowMs();
 
     // Epoch
     if (*m.dragEpoch < s.epoch)
@@ -1524,26 +1749,23 @@ bool NetworkManager::shouldApplyMarkerMove(const msg::ReadyMessage& m)
         s.epoch = *m.dragEpoch;
         s.closed = false;
         s.lastSeq = 0;
-        s.ownerPeerId = m.fromPeerId;
+        s.ownerPeer = m.fromPeer;
+        s.yielded = false;
     }
     else
     {
-        if (s.closed)
+        if (s.closed && !s.yielded)
             return false;
-        if (!s.ownerPeerId.empty() && s.ownerPeerId != m.fromPeerId)
+        if (s.ownerPeer != msg::kNoPeer && s.ownerPeer != m.fromPeer)
         {
-            if (!tieBreakWins(m.fromPeerId, s.ownerPeerId))
+            // a local drag only ends on the GM's word (MarkerMoveAck), never on another peer's claim
+            if (s.locallyDragging || !tieBreakWins(m.fromPeer, s.ownerPeer))
                 return false;
-            s.ownerPeerId = m.fromPeerId;
-            if (s.locallyDragging)
-            {
-                s.locallyDragging = false;
-                s.localSeq = 0;
-            }
+            s.ownerPeer = m.fromPeer;
         }
         else
         {
-            s.ownerPeerId = m.fromPeerId; // first owner for this epoch
+            s.ownerPeer = m.fromPeer; // first owner for this epoch
         }
     }
 
@@ -1565,6 +1787,7 @@ bool NetworkManager::shouldApplyMarkerMoveStateStart(const msg::ReadyMessage& m)
     if (!m.markerId || !m.dragEpoch || !m.mov || !m.mov->isDragging)
         return false;
     auto& s = drag_[*m.markerId];
+    s.lastRxMs = nowMs();
 
     if (*m.dragEpoch < s.epoch)
         return false;
@@ -1573,26 +1796,23 @@ bool NetworkManager::shouldApplyMarkerMoveStateStart(const msg::ReadyMessage& m)
         s.epoch = *m.dragEpoch;
         s.closed = false;
         s.lastSeq = 0;
-        s.ownerPeerId = m.fromPeerId;
+        s.ownerPeer = m.fromPeer;
+        s.yielded = false;
     }
     else
     {
-        if (s.closed)
+        if (s.closed && !s.yielded)
             return false;
-        if (!s.ownerPeerId.empty() && s.ownerPeerId != m.fromPeerId)
+        if (s.ownerPeer != msg::kNoPeer && s.ownerPeer != m.fromPeer)
         {
-            if (!tieBreakWins(m.fromPeerId, s.ownerPeerId))
+            // a local drag only ends on the GM's word (MarkerMoveAck), never on another peer's claim
+            if (s.locallyDragging || !tieBreakWins(m.fromPeer, s.ownerPeer))
                 return false;
-            s.ownerPeerId = m.fromPeerId;
-            if (s.locallyDragging)
-            {
-                s.locallyDragging = false;
-                s.localSeq = 0;
-            }
+            s.ownerPeer = m.fromPeer;
         }
         else
         {
-            s.ownerPeerId = m.fromPeerId;
+            s.ownerPeer = m.fromPeer;
         }
     }
 
@@ -1609,6 +1829,7 @@ bool NetworkManager::shouldApplyMarkerMoveStateFinal(const msg::ReadyMessage& m)
     if (!m.markerId || !m.dragEpoch || !m.mov || m.mov->isDragging)
         return false;
     auto& s = drag_[*m.markerId];
+    s.lastRxMs = nowMs();
 
     if (*m.dragEpoch < s.epoch)
         return false;
@@ -1617,26 +1838,23 @@ bool NetworkManager::shouldApplyMarkerMoveStateFinal(const msg::ReadyMessage& m)
         s.epoch = *m.dragEpoch;
         s.closed = false;
         s.lastSeq = 0;
-        s.ownerPeerId = m.fromPeerId;
+        s.ownerPeer = m.fromPeer;
+        s.yielded = false;
     }
     else
     {
-        if (s.closed)
+        if (s.closed && !s.yielded)
             return false;
-        if (!s.ownerPeerId.empty() && s.ownerPeerId != m.fromPeerId)
+        if (s.ownerPeer != msg::kNoPeer && s.ownerPeer != m.fromPeer)
         {
-            if (!tieBreakWins(m.fromPeerId, s.ownerPeerId))
+            // a local drag only ends on the GM's word (MarkerMoveAck), never on another peer's claim
+            if (s.locallyDragging || !tieBreakWins(m.fromPeer, s.ownerPeer))
                 return false;
-            s.ownerPeerId = m.fromPeerId;
-            if (s.locallyDragging)
-            {
-                s.locallyDragging = false;
-                s.localSeq = 0;
-            }
+            s.ownerPeer = m.fromPeer;
         }
         else
         {
-            s.ownerPeerId = m.fromPeerId;
+            s.ownerPeer = m.fromPeer;
         }
         if (m.seq && *m.seq < s.lastSeq)
             return false;
@@ -1648,41 +1866,358 @@ bool NetworkManager::shouldApplyMarkerMoveStateFinal(const msg::ReadyMessage& m)
     s.closed = true;
     s.locallyDragging = false;
     s.localSeq = 0;
+    s.yielded = false;
 
     return true;
 }
-// END MARKER OPERATIONS -----------------------------------------------------------------------------------------------------------------------------------------
+// ---- group ops --------------------------------------------------------------------------------------------------
 
-void NetworkManager::sendMarkerDelete(uint64_t boardId, const flecs::entity& marker,
-                                      const std::vector<std::string>& toPeerIds)
+// Same selection, same group id on every peer.
+uint64_t NetworkManager::groupIdOf(std::vector<uint64_t> markerIds)
 {
-    if (!marker.is_valid() || !marker.has<Identifier>())
-        return;
-
-    const uint64_t mid = marker.get<Identifier>()->id;
-    auto frame = buildMarkerDeleteFrame(boardId, mid);
-    broadcastGameFrame(frame, toPeerIds);
+    std::sort(markerIds.begin(), markerIds.end());
+    uint64_t groupId = 0xcbf29ce484222325ull;
+    for (auto id : markerIds)
+    {
+        groupId ^= id;
+        groupId *= 0x100000001b3ull;
+    }
+    return groupId;
 }
 
-void NetworkManager::sendFogUpdate(uint64_t boardId, const flecs::entity& fog,
-                                   const std::vector<std::string>& toPeerIds)
+uint64_t NetworkManager::beginGroupDrag(const std::vector<uint64_t>& markerIds)
 {
-    if (!fog.is_valid() || !fog.has<Identifier>())
-        return;
+    const uint64_t groupId = groupIdOf(markerIds);
+    auto& s = groupDrag_[groupId];
+    // past anything seen for this group too, so a drag taken over from someone else wins on epoch
+    groupEpoch_ = std::max(groupEpoch_, s.epoch) + 1;
+    s.epoch = groupEpoch_;
+    s.closed = false;
+    s.lastSeq = 0;
+    s.localSeq = 0;
+    s.ownerPeer = msg::kSelfPeer;
+    s.base.clear();
 
-    auto frame = buildFogUpdateFrame(boardId, fog);
-    broadcastGameFrame(frame, toPeerIds);
+    // hold the members like local drags, so single moves from others bounce off them
+    for (auto id : markerIds)
+    {
+        auto& d = drag_[id];
+        d.locallyDragging = true;
+        d.closed = false;
+        d.ownerPeer = msg::kSelfPeer;
+    }
+    return groupId;
 }
 
-void NetworkManager::sendFogDelete(uint64_t boardId, const flecs::entity& fog,
-                                   const std::vector<std::string>& toPeerIds)
+void NetworkManager::broadcastGroupMove(uint64_t boardId, uint64_t groupId, const std::vector<uint64_t>& markerIds, const Position& offset)
 {
-    if (!fog.is_valid() || !fog.has<Identifier>())
+    auto it = groupDrag_.find(groupId);
+    if (it == groupDrag_.end() || it->second.closed || markerIds.empty())
         return;
+    auto& s = it->second;
 
-    const uint64_t fid = fog.get<Identifier>()->id;
-    auto frame = buildFogDeleteFrame(boardId, fid);
-    broadcastGameFrame(frame, toPeerIds);
+    auto frame = buildMarkerGroupFrame(boardId, msg::GroupOp::Move, groupId, s.epoch, ++s.localSeq, markerIds);
+    Serializer::serializePosition(frame, &offset);
+
+    auto snap = peers.snapshot();
+    for (auto& pid : getPeerIdsViewing(boardId))
+    {
+        if (auto p = snap.find(pid); p != snap.end() && p->second)
+            p->second->sendMarkerMove(frame);
+    }
+    BufferPool::instance().release(std::move(frame));
+}
+
+void NetworkManager::broadcastGroupMoveEnd(uint64_t boardId, uint64_t groupId, const std::vector<flecs::entity>& markers)
+{
+    auto it = groupDrag_.find(groupId);
+    const bool open = it != groupDrag_.end() && !it->second.closed;
+
+    std::vector<uint64_t> ids;
+    std::vector<Position> positions;
+    ids.reserve(markers.size());
+    positions.reserve(markers.size());
+    for (const auto& e : markers)
+    {
+        if (!e.is_alive() || !e.has<Identifier>() || !e.has<Position>())
+            continue;
+        const uint64_t id = e.get<Identifier>()->id;
+        ids.push_back(id);
+        positions.push_back(*e.get<Position>());
+        forceCloseDrag(id);
+    }
+    if (!open || ids.empty())
+        return;
+    auto& s = it->second;
+    s.closed = true;
+
+    auto frame = buildMarkerGroupFrame(boardId, msg::GroupOp::MoveEnd, groupId, s.epoch, ++s.localSeq, ids);
+    groupDrag_.erase(it);
+    for (const auto& p : positions)
+        Serializer::serializePosition(frame, &p);
+    broadcastGameFrame(frame, getPeerIdsViewing(boardId));
+    BufferPool::instance().release(std::move(frame));
+}
+
+void NetworkManager::broadcastGroupVisibility(uint64_t boardId, const std::vector<flecs::entity>& markers, bool visible)
+{
+    auto peerIds = getPeerIdsViewing(boardId);
+    std::vector<uint64_t> ids;
+    ids.reserve(markers.size());
+    for (const auto& e : markers)
+    {
+        if (!e.is_alive() || !e.has<Identifier>())
+            continue;
+        ids.push_back(e.get<Identifier>()->id);
+        if (visible)
+            sendRevealedMarker(boardId, e, peerIds);
+    }
+    if (ids.empty() || peerIds.empty())
+        return;
+
+    const Visibility vis{visible};
+    auto frame = buildMarkerGroupFrame(boardId, msg::GroupOp::Visibility, 0, 0, 0, ids);
+    Serializer::serializeVisibility(frame, &vis);
+    broadcastGameFrame(frame, peerIds);
+    BufferPool::instance().release(std::move(frame));
+}
+
+void NetworkManager::broadcastGroupDelete(uint64_t boardId, const std::vector<flecs::entity>& markers)
+{
+    std::vector<uint64_t> ids;
+    ids.reserve(markers.size());
+    for (const auto& e : markers)
+    {
+        if (e.is_alive() && e.has<Identifier>())
+            ids.push_back(e.get<Identifier>()->id);
+    }
+    forgetWithheldMarkers(ids);
+    forgetMarkerDrags(ids);
+    auto peerIds = getPeerIdsViewing(boardId);
+    if (ids.empty() || peerIds.empty())
+        return;
+
+    auto frame = buildMarkerGroupFrame(boardId, msg::GroupOp::Delete, 0, 0, 0, ids);
+    broadcastGameFrame(frame, peerIds);
+    BufferPool::instance().release(std::move(frame));
+}
+
+bool NetworkManager::shouldApplyGroupMove(const msg::ReadyMessage& m)
+{
+    if (!m.groupId || !m.dragEpoch || !m.ids || !m.groupOp)
+        return false;
+    const bool final = *m.groupOp == msg::GroupOp::MoveEnd;
+    // the group's entry went with its MoveEnd; a move that was overtaken by it lands here
+    if (auto e = groupEpochEnded_.find(m.fromPeer); e != groupEpochEnded_.end() && *m.dragEpoch <= e->second)
+        return false;
+    auto& s = groupDrag_[*m.groupId];
+
+    if (*m.dragEpoch < s.epoch)
+        return false;
+    if (*m.dragEpoch > s.epoch)
+    {
+        s.epoch = *m.dragEpoch;
+        s.closed = false;
+        s.lastSeq = 0;
+        s.ownerPeer = m.fromPeer;
+        s.base.clear();
+        // members count as dragged by the sender, so nobody here grabs one halfway
+        for (auto id : *m.ids)
+        {
+            auto& d = drag_[id];
+            if (d.closed)
+            {
+                d.closed = false;
+                d.ownerPeer = m.fromPeer;
+            }
+        }
+    }
+    else
+    {
+        if (s.closed)
+            return false;
+        if (s.ownerPeer != msg::kNoPeer && s.ownerPeer != m.fromPeer && !tieBreakWins(m.fromPeer, s.ownerPeer))
+            return false;
+        s.ownerPeer = m.fromPeer;
+    }
+
+    if (m.seq && (final ? *m.seq < s.lastSeq : *m.seq <= s.lastSeq))
+        return false;
+    if (m.seq)
+        s.lastSeq = *m.seq;
+
+    if (final)
+    {
+        for (auto id : *m.ids)
+        {
+            auto it = drag_.find(id);
+            if (it != drag_.end() && !it->second.locallyDragging && it->second.ownerPeer == m.fromPeer)
+                it->second.closed = true;
+        }
+        auto& ended = groupEpochEnded_[m.fromPeer];
+        ended = std::max(ended, *m.dragEpoch);
+        groupDrag_.erase(*m.groupId);
+    }
+    return true;
+}
+
+void NetworkManager::forgetMarkerDrags(const std::vector<uint64_t>& markerIds)
+{
+    if (markerIds.empty())
+        return;
+    std::unordered_set<uint64_t> gone(markerIds.begin(), markerIds.end());
+    for (auto id : markerIds)
+        drag_.erase(id);
+    groupDrag_.erase(groupIdOf(markerIds));
+    // a drag of a wider selection that took some of them along
+    for (auto it = groupDrag_.begin(); it != groupDrag_.end();)
+    {
+        const bool touched = std::any_of(it->second.base.begin(), it->second.base.end(),
+                                         [&](const auto& kv)
+                                         { return gone.count(kv.first) > 0; });
+        it = touched ? groupDrag_.erase(it) : std::next(it);
+    }
+}
+
+bool NetworkManager::groupMayMove(const msg::ReadyMessage& m, uint64_t markerId) const
+{
+    auto it = drag_.find(markerId);
+    if (it == drag_.end())
+        return true;
+    const auto& d = it->second;
+    return !d.locallyDragging && (d.closed || d.ownerPeer == m.fromPeer);
+}
+
+Position NetworkManager::groupMoveTarget(const msg::ReadyMessage& m, uint64_t markerId, const Position& current)
+{
+    if (!m.groupId || !m.pos)
+        return current;
+    auto& s = groupDrag_[*m.groupId];
+    const auto& base = s.base.try_emplace(markerId, current).first->second;
+    return Position{base.x + m.pos->x, base.y + m.pos->y};
+}
+
+bool NetworkManager::isGmPeer(msg::PeerHandle h) const
+{
+    if (h == msg::kSelfPeer)
+        return getPeerRole() == Role::GAMEMASTER;
+    return !gmPeerId_.empty() && peerRegistry_.uniqueId(h) == gmPeerId_;
+}
+
+bool NetworkManager::tieBreakWins(msg::PeerHandle challenger, msg::PeerHandle currentOwner) const
+{
+    // the GM is the authority: its drag always stands, between players the lower peer id wins
+    if (isGmPeer(currentOwner))
+        return false;
+    if (isGmPeer(challenger))
+        return true;
+    return peerRegistry_.peerId(challenger) < peerRegistry_.peerId(currentOwner);
+}
+
+void NetworkManager::recordPredictedMove(DragState& s, uint32_t seq, const flecs::entity& marker)
+{
+    if (getPeerRole() != Role::PLAYER || !marker.has<Position>())
+        return;
+    s.unacked.emplace_back(seq, *marker.get<Position>());
+    if (s.unacked.size() > kMaxUnackedMoves)
+        s.unacked.pop_front();
+}
+
+void NetworkManager::ackMarkerMove(const msg::ReadyMessage& m, const flecs::entity& marker, bool applied)
+{
+    if (getPeerRole() != Role::GAMEMASTER || m.fromPeer == msg::kNoPeer || m.fromPeer == msg::kSelfPeer)
+        return;
+    if (!m.boardId || !m.markerId || !m.dragEpoch || !m.seq || !marker.is_valid() || !marker.has<Position>())
+        return;
+    auto it = drag_.find(*m.markerId);
+    if (it == drag_.end())
+        return;
+
+    const auto& s = it->second;
+    const bool accepted = (*m.dragEpoch == s.epoch && s.ownerPeer == m.fromPeer);
+    if (accepted && !applied)
+        return; // reordered op from the owner; the ack for its newer op already covers it
+
+    const std::string peerId = peerRegistry_.peerId(m.fromPeer);
+    auto link = peers.find(peerId);
+    if (!link)
+        return;
+
+    auto frame = buildMarkerMoveAckFrame(*m.boardId, *m.markerId, *m.dragEpoch, *m.seq, accepted, *marker.get<Position>());
+    // streamed moves are acked on the move channel (a lost one is covered by the next);
+    // refusals and drag start/end go on the reliable game channel
+    if (accepted && m.kind == msg::DCType::MarkerMove)
+        link->sendMarkerMove(frame);
+    else
+        link->sendGame(frame);
+    BufferPool::instance().release(std::move(frame));
+}
+
+std::optional<Position> NetworkManager::reconcileMarkerMove(const msg::ReadyMessage& m, const Position& current)
+{
+    if (!m.markerId || !m.dragEpoch || !m.seq || !m.pos || !m.accepted || !isGmPeer(m.fromPeer))
+        return std::nullopt;
+    auto it = drag_.find(*m.markerId);
+    if (it == drag_.end())
+        return std::nullopt;
+
+    auto& s = it->second;
+    if (*m.dragEpoch != s.locallyProposedEpoch || *m.seq <= s.ackedSeq)
+        return std::nullopt; // older drag, or overtaken by a newer ack
+    s.ackedSeq = *m.seq;
+
+    if (!*m.accepted)
+    {
+        // the GM gave this drag to someone else (or refused it): stop predicting, take its position
+        // and let the owner it picked claim the epoch with its next op
+        s.unacked.clear();
+        s.locallyDragging = false;
+        s.localSeq = 0;
+        s.ownerPeer = msg::kNoPeer;
+        s.yielded = true;
+        return *m.pos;
+    }
+
+    std::optional<Position> sent;
+    while (!s.unacked.empty() && s.unacked.front().first <= *m.seq)
+    {
+        if (s.unacked.front().first == *m.seq)
+            sent = s.unacked.front().second;
+        s.unacked.pop_front();
+    }
+    if (!sent)
+        return std::nullopt;
+
+    // replay what we did since that op on top of the GM's position; equal when it took ours as is
+    const Position out{m.pos->x + (current.x - sent->x), m.pos->y + (current.y - sent->y)};
+    if (out.x == current.x && out.y == current.y)
+        return std::nullopt;
+    return out;
+}
+// END MARKER OPERATIONS -----------------------------------------------------------------------------------------------------------------------------------------
+
+void NetworkManager::sendMarkerDelete(uint64_t boardId, const flecs::entity& marker,
+                                      const std::vector<std::string>& toPeerIds)
+{
+    if (!marker.is_valid() || !marker.has<Identifier>())
+        return;
+
+    const uint64_t mid = marker.get<Identifier>()->id;
+    auto frame = buildMarkerDeleteFrame(boardId, mid);
+    broadcastGameFrame(frame, toPeerIds);
+    BufferPool::instance().release(std::move(frame));
+}
+
+void NetworkManager::sendFogDelete(uint64_t boardId, const flecs::entity& fog,
+                                   const std::vector<std::string>& toPeerIds)
+{
+    if (!fog.is_valid() || !fog.has<Identifier>())
+        return;
+
+    const uint64_t fid = fog.get<Identifier>()->id;
+    auto frame = buildFogDeleteFrame(boardId, fid);
+    broadcastGameFrame(frame, toPeerIds);
+    BufferPool::instance().release(std::move(frame));
 }
 
 // ---------- MESSAGE SENDERS --------------------------------------------------------------------------------
@@ -1692,37 +2227,38 @@ void NetworkManager::sendGameTable(const flecs::entity& gameTable, const std::ve
     auto gt = *gameTable.get<GameTable>();
     auto frame = buildSnapshotGameTableFrame(gtId, gt.gameTableName);
     broadcastGameFrame(frame, toPeerIds);
+    BufferPool::instance().release(std::move(frame));
 }
 
 void NetworkManager::sendBoard(const flecs::entity& board, const std::vector<std::string>& toPeerIds)
 {
     // read board image (from TextureComponent.image_path)
     auto tex = board.get<TextureComponent>();
-    auto image_path = tex->image_path;
+    const auto image_path = tex ? resolveImagePath(msg::ImageOwnerKind::Board, tex->image_path) : std::string{};
     Logger::instance().log("localtunnel", Logger::Level::Info, "Board Texture Path: " + image_path);
-    auto is_file_only = PathManager::isFilenameOnly(tex->image_path);
-    auto is_path_like = PathManager::isPathLike(tex->image_path);
-    if (is_file_only || !is_path_like)
-    {
-        Logger::instance().log("localtunnel", Logger::Level::Info, "Board Texture Path is FILE ONLY");
-        auto map_folder = PathManager::getMapsPath();
-        auto image_path_ = map_folder / tex->image_path;
-        image_path = image_path_.string();
-    }
-    Logger::instance().log("localtunnel", Logger::Level::Info, "Board Texture Path AGAIN: " + image_path);
-    std::vector<unsigned char> img = tex ? readFileBytes(image_path) : std::vector<unsigned char>{};
+    auto img = std::make_shared<const std::vector<unsigned char>>(tex ? readFileBytes(image_path) : std::vector<unsigned char>{});
 
     // 1) meta
-    auto meta = buildSnapshotBoardFrame(board, static_cast<uint64_t>(img.size()));
+    auto meta = buildSnapshotBoardFrame(board, static_cast<uint64_t>(img->size()));
     broadcastGameFrame(meta, toPeerIds);
+    BufferPool::instance().release(std::move(meta));
 
-    //// 2) image chunks (ownerKind=0 for board)
+    //// 2) image chunks (ownerKind=0 for board), or ImageCached to players that hold it
     uint64_t bid = board.get<Identifier>()->id;
-    sendImageChunks(msg::ImageOwnerKind::Board, bid, img, toPeerIds);
+    sendImageOrCached(msg::ImageOwnerKind::Board, bid, bid, img, image_path, toPeerIds);
 
     // 3) commit
     auto commit = buildCommitBoardFrame(bid);
     broadcastGameFrame(commit, toPeerIds);
+    BufferPool::instance().release(std::move(commit));
+    if (peer_role == Role::GAMEMASTER && boardVersions_)
+    {
+        // it isn't looking at the board until the image lands: what changes meanwhile is filtered
+        // out and caught up once its BoardView says so
+        const uint64_t v = boardVersions_->version(bid);
+        for (auto& pid : toPeerIds)
+            peerViews_[pid].held[bid] = HeldBoard{board.id(), v};
+    }
 
     board.children([&](flecs::entity child)
                    {
@@ -1741,27 +2277,52 @@ void NetworkManager::sendBoard(const flecs::entity& board, const std::vector<std
 void NetworkManager::sendMarker(uint64_t boardId, const flecs::entity& marker, const std::vector<std::string>& toPeerIds)
 {
     const TextureComponent* tex = marker.get<TextureComponent>();
-    auto image_path = tex->image_path;
+    const auto image_path = tex ? resolveImagePath(msg::ImageOwnerKind::Marker, tex->image_path) : std::string{};
+    uint64_t mid = marker.get<Identifier>()->id;
+
+    // Hidden GM markers go out as stubs (no image, total 0); sendMarkerUpdate ships the art on reveal.
+    const auto* vis = marker.get<Visibility>();
+    if (peer_role == Role::GAMEMASTER && vis && !vis->isVisible)
+    {
+        auto meta = buildCreateMarkerFrame(boardId, marker, 0);
+        broadcastGameFrame(meta, toPeerIds);
+        BufferPool::instance().release(std::move(meta));
+        auto commit = buildCommitMarkerFrame(boardId, mid);
+        broadcastGameFrame(commit, toPeerIds);
+        BufferPool::instance().release(std::move(commit));
+
+        std::lock_guard<std::mutex> lk(prefetchMtx_);
+        for (auto& pid : toPeerIds)
+        {
+            withheldMarkers_[pid].insert(mid);
+            if (prefetchHiddenArt_.load() && !image_path.empty())
+            {
+                PrefetchJob job;
+                job.peerId = pid;
+                job.kind = msg::ImageOwnerKind::Marker;
+                job.id = mid;
+                job.imagePath = image_path;
+                prefetchJobs_.push_back(std::move(job));
+            }
+        }
+        if (prefetchHiddenArt_.load())
+        {
+            ensurePrefetchWorker();
+            prefetchCv_.notify_all();
+        }
+        return;
+    }
+
     Logger::instance().log("localtunnel", Logger::Level::Info, "Marker Path: " + image_path);
-    auto is_file_only = PathManager::isFilenameOnly(tex->image_path);
-    auto is_path_like = PathManager::isPathLike(tex->image_path);
-    if (is_file_only || !is_path_like)
-    {
-        Logger::instance().log("localtunnel", Logger::Level::Info, "Marker Path is FILE ONLY");
-        auto marker_folder = PathManager::getMarkersPath();
-        auto image_path_ = marker_folder / tex->image_path;
-        image_path = image_path_.string();
-    }
-    Logger::instance().log("localtunnel", Logger::Level::Info, "Marker Path Again: " + image_path);
-    std::vector<unsigned char> img = tex ? readFileBytes(image_path) : std::vector<unsigned char>{};
-    Logger::instance().log("localtunnel", Logger::Level::Info, "Marker Texture Byte Size: " + std::to_string(img.size()));
+    auto img = std::make_shared<const std::vector<unsigned char>>(tex ? readFileBytes(image_path) : std::vector<unsigned char>{});
+    Logger::instance().log("localtunnel", Logger::Level::Info, "Marker Texture Byte Size: " + std::to_string(img->size()));
     // 1) meta
-    auto meta = buildCreateMarkerFrame(boardId, marker, static_cast<uint64_t>(img.size()));
+    auto meta = buildCreateMarkerFrame(boardId, marker, static_cast<uint64_t>(img->size()));
     broadcastGameFrame(meta, toPeerIds);
+    BufferPool::instance().release(std::move(meta));
 
     // 2) image chunks (ownerKind=1 for marker)
-    uint64_t mid = marker.get<Identifier>()->id;
-    sendImageChunks(msg::ImageOwnerKind::Marker, mid, img, toPeerIds);
+    sendImageOrCached(msg::ImageOwnerKind::Marker, mid, boardId, img, image_path, toPeerIds);
     //uint64_t off = 0;
     //while (off < img.size())
     //{
@@ -1775,12 +2336,14 @@ void NetworkManager::sendMarker(uint64_t boardId, const flecs::entity& marker, c
     // 3) commit
     auto commit = buildCommitMarkerFrame(boardId, mid);
     broadcastGameFrame(commit, toPeerIds);
+    BufferPool::instance().release(std::move(commit));
 }
 
 void NetworkManager::sendFog(uint64_t boardId, const flecs::entity& fog, const std::vector<std::string>& toPeerIds)
 {
     auto frame = buildFogCreateFrame(boardId, fog);
     broadcastGameFrame(frame, toPeerIds);
+    BufferPool::instance().release(std::move(frame));
 }
 
 // --- tuning ---
@@ -1795,12 +2358,13 @@ bool NetworkManager::sendImageChunks(msg::ImageOwnerKind kind, uint64_t id, cons
                            std::string("sendImageChunks: kind=") + (kind == msg::ImageOwnerKind::Board ? "Board" : "Marker") +
                                " id=" + std::to_string(id) + " bytes=" + std::to_string(img.size()));
 
+    foregroundImageSends_.fetch_add(1); // holds the prefetch worker back
     size_t sent = 0;
     int paced = 0;
     while (sent < img.size())
     {
         const size_t chunk = std::min(kChunk, img.size() - sent);
-        const auto frame = buildImageChunkFrame(static_cast<uint8_t>(kind), id, sent, img.data() + sent, chunk);
+        auto frame = buildImageChunkFrame(static_cast<uint8_t>(kind), id, sent, img.data() + sent, chunk);
 
         // If you have per-peer send that returns bool, check and log
         bool allOk = true;
@@ -1808,6 +2372,7 @@ bool NetworkManager::sendImageChunks(msg::ImageOwnerKind kind, uint64_t id, cons
         {
             sendGameTo(pid, frame); // if your API is void, keep it; otherwise log ok
         }
+        BufferPool::instance().release(std::move(frame));
 
         // Fallback pacing (keeps buffers happy)
         if ((++paced % kPaceEveryN) == 0)
@@ -1815,6 +2380,7 @@ bool NetworkManager::sendImageChunks(msg::ImageOwnerKind kind, uint64_t id, cons
 
         sent += chunk;
     }
+    foregroundImageSends_.fetch_sub(1);
 
     Logger::instance().log("localtunnel", Logger::Level::Info,
                            "sendImageChunks: done kind=" + std::string(kind == msg::ImageOwnerKind::Board ? "Board" : "Marker") +
@@ -1822,112 +2388,2637 @@ bool NetworkManager::sendImageChunks(msg::ImageOwnerKind kind, uint64_t id, cons
     return true;
 }
 
-//ON PEER RECEIVING MESSAGE-----------------------------------------------------------
-//void NetworkManager::onDcGameBinary(const std::string& fromPeer, const std::vector<uint8_t>& b)
-//{
-//    size_t off = 0;
-//    while (off < b.size())
-//    {
-//        // Need at least one byte for the type
-//        if (!ensureRemaining(b, off, 1))
-//        {
-//            break;
-//        }
-//
-//        auto type = static_cast<msg::DCType>(b[off]);
-//        off += 1;
-//
-//        switch (type)
-//        {
-//                // -------- SNAPSHOT / BOARD ----------
-//            case msg::DCType::Snapshot_Board:
-//                handleBoardMeta(b, off);
-//                break;
-//
-//                // -------- CREATE MARKER (META) ----------
-//            case msg::DCType::MarkerCreate:
-//                handleMarkerMeta(b, off);
-//                break;
-//
-//                // -------- FOG CREATE (NO IMAGE) ----------
-//            case msg::DCType::FogCreate:
-//                handleFogCreate(b, off);
-//                break;
-//
-//                // -------- IMAGE CHUNK (BOARD or MARKER) ----------
-//            case msg::DCType::ImageChunk:
-//                handleImageChunk(b, off);
-//                break;
-//
-//                // -------- COMMIT BOARD ----------
-//            case msg::DCType::CommitBoard:
-//                handleCommitBoard(b, off);
-//                break;
-//
-//                // -------- COMMIT MARKER ----------
-//            case msg::DCType::CommitMarker:
-//                handleCommitMarker(b, off);
-//                break;
-//
-//                // -------- BOARD OPERATONS - AFTER ENTITIY CREATION ----------
-//            case msg::DCType::MarkerUpdate:
-//                //handlemarkermove(b, off);
-//                break;
-//
-//            case msg::DCType::GridUpdate:
-//                //handlegridupdate(b, off);
-//                break;
-//
-//            case msg::DCType::FogUpdate:
-//                //handleFogUpdate(b, off);
-//                break;
-//            default:
-//                return;
-//        }
-//    }
-//}
+// ---------- BOARD PREFETCH --------------------------------------------------------------------------------
 
-//---Message Received Handlers--------------------------------------------------------------------------------
-//
+// Bare file names live in the Maps/Markers folders (same rule the loaders use).
+std::string NetworkManager::resolveImagePath(msg::ImageOwnerKind kind, const std::string& image_path)
+{
+    if (!PathManager::isFilenameOnly(image_path) && PathManager::isPathLike(image_path))
+        return image_path;
+    const auto folder = kind == msg::ImageOwnerKind::Board ? PathManager::getMapsPath() : PathManager::getMarkersPath();
+    return (folder / image_path).string();
+}
+
+// Players that already hold this exact image get ImageCached instead of the chunks; the rest
+// get the full transfer and are remembered as holding it (the player keeps what it receives).
+// Players with a disk cache need the content hash; until it is memoized they go to the prefetch
+// worker, which hashes and then sends ImageCachedByHash, or the chunks and the commit again.
+void NetworkManager::sendImageOrCached(msg::ImageOwnerKind kind, uint64_t id, uint64_t boardId,
+                                       std::shared_ptr<const std::vector<unsigned char>> bytes,
+                                       const std::string& path, const std::vector<std::string>& toPeerIds)
+{
+    const auto& img = *bytes;
+    std::vector<std::string> full;
+    std::optional<Sha256::Digest> hash;
+    bool hashLooked = false;
+    for (auto& pid : toPeerIds)
+    {
+        if (!img.empty() && heldByPeer(pid, id, img.size(), path))
+        {
+            auto frame = buildImageCachedFrame(kind, id);
+            sendGameTo(pid, frame);
+            BufferPool::instance().release(std::move(frame));
+            continue;
+        }
+
+        bool onDisk = false;
+        if (!img.empty())
+        {
+            bool hasInventory = false;
+            {
+                std::lock_guard<std::mutex> lk(prefetchMtx_);
+                auto it = diskHeld_.find(pid);
+                hasInventory = it != diskHeld_.end() && !it->second.empty();
+            }
+            if (hasInventory && !hashLooked)
+            {
+                hash = memoizedContentHash(path, img.size());
+                hashLooked = true;
+            }
+            if (hasInventory && !hash)
+            {
+                PrefetchJob job;
+                job.peerId = pid;
+                job.kind = kind;
+                job.id = id;
+                job.boardId = boardId;
+                job.bytes = bytes;
+                job.checkDisk = true;
+                std::lock_guard<std::mutex> lk(prefetchMtx_);
+                prefetchSent_[pid][id] = PrefetchSent{kind, img.size(), path};
+                ensurePrefetchWorker();
+                resendJobs_.push_back(std::move(job));
+                prefetchCv_.notify_all();
+                continue;
+            }
+            if (hasInventory)
+            {
+                const std::string key(hash->begin(), hash->end());
+                std::lock_guard<std::mutex> lk(prefetchMtx_);
+                auto it = diskHeld_.find(pid);
+                onDisk = it != diskHeld_.end() && it->second.count(key) > 0;
+                if (onDisk)
+                    prefetchSent_[pid][id] = PrefetchSent{kind, img.size(), path}; // a miss comes back as ImageRequest
+            }
+        }
+        if (onDisk)
+        {
+            auto frame = buildImageCachedByHashFrame(kind, id, *hash);
+            sendGameTo(pid, frame);
+            BufferPool::instance().release(std::move(frame));
+        }
+        else
+        {
+            full.push_back(pid);
+        }
+    }
+    if (full.empty())
+        return;
+    if (shouldSwarm(img.size(), full))
+        sendImageSwarm(kind, id, bytes, path, full);
+    else
+        sendImageChunks(kind, id, img, full);
+    if (!img.empty())
+        rememberHeld(full, kind, id, img.size(), path);
+}
+
+bool NetworkManager::heldByPeer(const std::string& peerId, uint64_t id, uint64_t size, const std::string& path)
+{
+    std::lock_guard<std::mutex> lk(prefetchMtx_);
+    auto peer = prefetchSent_.find(peerId);
+    if (peer == prefetchSent_.end())
+        return false;
+    auto it = peer->second.find(id);
+    return it != peer->second.end() && it->second.size == size && it->second.path == path;
+}
+
+void NetworkManager::rememberHeld(const std::vector<std::string>& peerIds, msg::ImageOwnerKind kind, uint64_t id,
+                                  uint64_t size, const std::string& path)
+{
+    if (size > ImagePrefetchCache::kDefaultCapacity / 2)
+        return; // the player won't keep it
+    std::lock_guard<std::mutex> lk(prefetchMtx_);
+    for (auto& pid : peerIds)
+        prefetchSent_[pid][id] = PrefetchSent{kind, size, path};
+}
+
+void NetworkManager::setBoardUpcoming(const std::string& boardFile, bool upcoming)
+{
+    {
+        std::lock_guard<std::mutex> lk(prefetchMtx_);
+        if (upcoming)
+            upcomingBoards_.insert(boardFile);
+        else
+            upcomingBoards_.erase(boardFile);
+    }
+    if (!upcoming || peer_role != Role::GAMEMASTER)
+        return;
+    for (auto& pid : getConnectedPeerIds())
+    {
+        auto link = peers.find(pid);
+        if (link && link->bootstrapSent())
+            schedulePrefetch(pid, {boardFile}, /*front=*/true);
+    }
+}
+
+bool NetworkManager::isBoardUpcoming(const std::string& boardFile) const
+{
+    std::lock_guard<std::mutex> lk(prefetchMtx_);
+    return upcomingBoards_.count(boardFile) > 0;
+}
+
+// UI thread.
+std::vector<std::string> NetworkManager::prefetchBoardOrder()
+{
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    auto gm = gametable_manager.lock();
+    if (!gm || gm->game_table_name.empty())
+        return files;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(PathManager::getBoardsPath(gm->game_table_name), ec))
+    {
+        if (entry.is_regular_file())
+            files.push_back(entry.path().filename().string());
+    }
+    std::lock_guard<std::mutex> lk(prefetchMtx_);
+    std::stable_partition(files.begin(), files.end(), [&](const std::string& f)
+                          { return upcomingBoards_.count(f) > 0; });
+    return files;
+}
+
+// UI thread (bootstrap, upcoming toggle). The active board is skipped: the player has it.
+void NetworkManager::schedulePrefetch(const std::string& peerId, const std::vector<std::string>& boardFiles, bool front)
+{
+    auto gm = gametable_manager.lock();
+    auto bm = board_manager.lock();
+    if (!gm || boardFiles.empty())
+        return;
+    uint64_t skipBoardId = 0;
+    if (bm && bm->isBoardActive())
+    {
+        auto active = bm->getActiveBoard();
+        if (active.is_valid() && active.has<Identifier>())
+            skipBoardId = active.get<Identifier>()->id;
+    }
+    const auto dir = PathManager::getBoardsPath(gm->game_table_name);
+
+    std::lock_guard<std::mutex> lk(prefetchMtx_);
+    ensurePrefetchWorker();
+    std::deque<PrefetchJob> jobs;
+    for (const auto& file : boardFiles)
+        jobs.push_back(PrefetchJob{peerId, dir / file, skipBoardId});
+    prefetchJobs_.insert(front ? prefetchJobs_.begin() : prefetchJobs_.end(),
+                         std::make_move_iterator(jobs.begin()), std::make_move_iterator(jobs.end()));
+    prefetchCv_.notify_all();
+}
+
+// Caller holds prefetchMtx_. Never restarts once stopped (shutdown).
+void NetworkManager::ensurePrefetchWorker()
+{
+    if (prefetchWorker_.joinable() || prefetchStop_.load())
+        return;
+    prefetchWorker_ = std::thread([this]()
+                                  { prefetchLoop(); });
+}
+
+void NetworkManager::stopPrefetchWorker()
+{
+    {
+        std::lock_guard<std::mutex> lk(prefetchMtx_);
+        prefetchStop_.store(true);
+        prefetchJobs_.clear();
+        resendJobs_.clear();
+    }
+    prefetchCv_.notify_all();
+    if (prefetchWorker_.joinable())
+        prefetchWorker_.join();
+}
+
+void NetworkManager::prefetchLoop()
+{
+    for (;;)
+    {
+        PrefetchJob job;
+        {
+            std::unique_lock<std::mutex> lk(prefetchMtx_);
+            prefetchCv_.wait(lk, [&]()
+                             { return prefetchStop_.load() || !resendJobs_.empty() || !prefetchJobs_.empty(); });
+            if (prefetchStop_.load())
+                return;
+            if (!resendJobs_.empty())
+            {
+                lk.unlock();
+                serviceResends();
+                continue;
+            }
+            job = std::move(prefetchJobs_.front());
+            prefetchJobs_.pop_front();
+        }
+        try
+        {
+            if (!job.imagePath.empty())
+                prefetchImage(job.peerId, job.kind, job.id, job.imagePath);
+            else
+                prefetchBoardFile(job);
+        }
+        catch (const std::exception& e)
+        {
+            Logger::instance().log("localtunnel", Logger::Level::Warn, "Prefetch " + job.boardFile.string() + ": " + e.what());
+        }
+    }
+}
+
+void NetworkManager::prefetchBoardFile(const PrefetchJob& job)
+{
+    auto buffer = readFileBytes(job.boardFile.string());
+    if (buffer.empty())
+        return;
+    size_t offset = 0;
+    const auto refs = Serializer::scanBoardImages(buffer, offset);
+    if (refs.boardId == 0 || refs.boardId == job.skipBoardId)
+        return;
+
+    if (!prefetchImage(job.peerId, msg::ImageOwnerKind::Board, refs.boardId, resolveImagePath(msg::ImageOwnerKind::Board, refs.boardImage)))
+        return;
+    for (const auto& marker : refs.markerImages)
+    {
+        if (!marker.visible && !prefetchHiddenArt_.load())
+            continue; // same rule as the live board: hidden art waits for the reveal
+        if (!prefetchImage(job.peerId, msg::ImageOwnerKind::Marker, marker.markerId, resolveImagePath(msg::ImageOwnerKind::Marker, marker.imagePath)))
+            return;
+    }
+    Logger::instance().log("localtunnel", Logger::Level::Info,
+                           "Prefetched board " + job.boardFile.filename().string() + " to " + job.peerId);
+}
+
+// False when the peer went away (or we're stopping); a missing image file is skipped.
+bool NetworkManager::prefetchImage(const std::string& peerId, msg::ImageOwnerKind kind, uint64_t id, const std::string& path)
+{
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec || size == 0 || size > ImagePrefetchCache::kDefaultCapacity / 2)
+        return true;
+    if (heldByPeer(peerId, id, size, path))
+        return true;
+
+    const auto img = readFileBytes(path);
+    if (img.size() != size)
+        return true;
+    for (size_t sent = 0; sent < img.size();)
+    {
+        if (!waitPrefetchIdle(peerId))
+            return false;
+        const size_t chunk = std::min(kChunk, img.size() - sent);
+        auto frame = buildImagePrefetchChunkFrame(kind, id, img.size(), sent, img.data() + sent, chunk);
+        sendGameTo(peerId, frame);
+        BufferPool::instance().release(std::move(frame));
+        sent += chunk;
+    }
+    rememberHeld({peerId}, kind, id, size, path);
+    return true;
+}
+
+// Lowest priority: wait until no foreground image is going out and the peer's game channel
+// is nearly drained. Resend requests jump the queue meanwhile.
+bool NetworkManager::waitPrefetchIdle(const std::string& peerId)
+{
+    for (;;)
+    {
+        serviceResends();
+        if (prefetchStop_.load())
+            return false;
+        auto link = peers.find(peerId);
+        if (!link || !link->isConnected())
+            return false;
+        if (foregroundImageSends_.load() == 0 && link->bufferedAmount(std::string(msg::dc::name::Game)) < kPrefetchMaxBuffered)
+            return true;
+
+        std::unique_lock<std::mutex> lk(prefetchMtx_);
+        prefetchCv_.wait_for(lk, std::chrono::milliseconds(20), [&]()
+                             { return prefetchStop_.load() || !resendJobs_.empty(); });
+    }
+}
+
+void NetworkManager::serviceResends()
+{
+    for (;;)
+    {
+        PrefetchJob job;
+        {
+            std::lock_guard<std::mutex> lk(prefetchMtx_);
+            if (resendJobs_.empty() || prefetchStop_.load())
+                return;
+            job = std::move(resendJobs_.front());
+            resendJobs_.pop_front();
+        }
+        try
+        {
+            resendImage(job);
+        }
+        catch (const std::exception& e)
+        {
+            Logger::instance().log("localtunnel", Logger::Level::Warn, std::string("Image resend failed: ") + e.what());
+        }
+    }
+}
+
+// The player lost a prefetched copy: full transfer, then the commit again to finalize it.
+// checkDisk jobs (sendImageOrCached) hash first and answer with ImageCachedByHash when they can.
+void NetworkManager::resendImage(const PrefetchJob& job)
+{
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lk(prefetchMtx_);
+        auto peer = prefetchSent_.find(job.peerId);
+        if (peer == prefetchSent_.end())
+            return;
+        auto it = peer->second.find(job.id);
+        if (it == peer->second.end())
+            return;
+        path = it->second.path;
+        if (!job.checkDisk)
+            peer->second.erase(it);
+    }
+    const auto img = job.bytes ? job.bytes : std::make_shared<const std::vector<unsigned char>>(readFileBytes(path));
+    if (job.checkDisk)
+    {
+        const auto hash = contentHashOf(path, *img);
+        const std::string key(hash.begin(), hash.end());
+        bool onDisk = false;
+        {
+            std::lock_guard<std::mutex> lk(prefetchMtx_);
+            auto held = diskHeld_.find(job.peerId);
+            onDisk = held != diskHeld_.end() && held->second.count(key) > 0;
+            if (!onDisk)
+                if (auto peer = prefetchSent_.find(job.peerId); peer != prefetchSent_.end())
+                    peer->second.erase(job.id);
+        }
+        if (onDisk)
+        {
+            // the entry stays: a miss comes back as ImageRequest
+            auto frame = buildImageCachedByHashFrame(job.kind, job.id, hash);
+            sendGameTo(job.peerId, frame);
+            BufferPool::instance().release(std::move(frame));
+            return;
+        }
+    }
+    Logger::instance().log("localtunnel", Logger::Level::Info,
+                           "Resending image id=" + std::to_string(job.id) + " to " + job.peerId);
+    sendImageChunks(job.kind, job.id, *img, {job.peerId});
+    auto commit = job.kind == msg::ImageOwnerKind::Board ? buildCommitBoardFrame(job.id) : buildCommitMarkerFrame(job.boardId, job.id);
+    sendGameTo(job.peerId, commit);
+    BufferPool::instance().release(std::move(commit));
+    if (!img->empty())
+        rememberHeld({job.peerId}, job.kind, job.id, img->size(), path);
+}
+
+std::vector<uint8_t> NetworkManager::buildImagePrefetchChunkFrame(msg::ImageOwnerKind kind, uint64_t id, uint64_t total,
+                                                                  uint64_t offset, const uint8_t* data, size_t len)
+{
+    auto b = BufferPool::instance().acquire(1 + 1 + 8 + 8 + 8 + 4 + len);
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::ImagePrefetchChunk));
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(kind));
+    Serializer::serializeUInt64(b, id);
+    Serializer::serializeUInt64(b, total);
+    Serializer::serializeUInt64(b, offset);
+    Serializer::serializeInt(b, static_cast<int>(len));
+    b.insert(b.end(), data, data + len);
+    return b;
+}
+
+std::vector<uint8_t> NetworkManager::buildImageCachedFrame(msg::ImageOwnerKind kind, uint64_t id)
+{
+    auto b = BufferPool::instance().acquire();
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::ImageCached));
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(kind));
+    Serializer::serializeUInt64(b, id);
+    return b;
+}
+
+std::vector<uint8_t> NetworkManager::buildImageRequestFrame(msg::ImageOwnerKind kind, uint64_t boardId, uint64_t id)
+{
+    auto b = BufferPool::instance().acquire();
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::ImageRequest));
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(kind));
+    Serializer::serializeUInt64(b, boardId);
+    Serializer::serializeUInt64(b, id);
+    return b;
+}
+
+void NetworkManager::handleImagePrefetchChunk(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (off + 1 + 8 + 8 + 8 + 4 > b.size())
+    {
+        off = b.size();
+        return;
+    }
+    auto kind = static_cast<msg::ImageOwnerKind>(Serializer::deserializeUInt8(b, off));
+    uint64_t id = Serializer::deserializeUInt64(b, off);
+    uint64_t total = Serializer::deserializeUInt64(b, off);
+    uint64_t offset = Serializer::deserializeUInt64(b, off);
+    int len = Serializer::deserializeInt(b, off);
+    if (len < 0 || off + static_cast<size_t>(len) > b.size())
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Error, "ImagePrefetchChunk: invalid len id=" + std::to_string(id));
+        off = b.size();
+        return;
+    }
+    // only the GM prefetches; a player's bytes would later be served for the GM's ImageCached
+    if (!isGmPeer(decodingFrom_))
+    {
+        off += static_cast<size_t>(len);
+        return;
+    }
+    prefetchCache_.addChunk(kind, id, total, offset, b.data() + off, static_cast<size_t>(len));
+    off += static_cast<size_t>(len);
+}
+
+// Between the meta and the commit, in place of the ImageChunk frames.
+void NetworkManager::handleImageCached(const std::vector<uint8_t>& b, size_t& off)
+{
+    auto kind = static_cast<msg::ImageOwnerKind>(Serializer::deserializeUInt8(b, off));
+    uint64_t id = Serializer::deserializeUInt64(b, off);
+
+    uint64_t boardId = 0;
+    {
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        if (imagesRefused_.count(id))
+            return;
+        auto it = imagesRx_.find(id);
+        if (it == imagesRx_.end() || it->second.total == 0)
+            return; // no meta: nothing to fill
+        auto& p = it->second;
+        if (auto bytes = prefetchCache_.find(kind, id, p.total))
+        {
+            p.buf.write(0, bytes->data(), bytes->size());
+            p.received = p.total;
+            p.contiguous = p.total;
+            p.lastByteMs = nowMs();
+            feedStreamingDecode(p);
+            return;
+        }
+        p.prefetched = true;
+        boardId = p.boardId;
+    }
+
+    const auto sender = peerRegistry_.peerId(decodingFrom_);
+    Logger::instance().log("localtunnel", Logger::Level::Info, "ImageCached miss id=" + std::to_string(id) + ", requesting it");
+    auto frame = buildImageRequestFrame(kind, boardId, id);
+    sendGameTo(sender, frame);
+    BufferPool::instance().release(std::move(frame));
+}
+
+void NetworkManager::handleImageRequest(const std::vector<uint8_t>& b, size_t& off)
+{
+    PrefetchJob job;
+    job.kind = static_cast<msg::ImageOwnerKind>(Serializer::deserializeUInt8(b, off));
+    job.boardId = Serializer::deserializeUInt64(b, off);
+    job.id = Serializer::deserializeUInt64(b, off);
+    job.peerId = peerRegistry_.peerId(decodingFrom_);
+    if (job.peerId.empty())
+        return;
+
+    // served by the prefetch worker, never on a decode shard
+    std::lock_guard<std::mutex> lk(prefetchMtx_);
+    ensurePrefetchWorker();
+    resendJobs_.push_back(std::move(job));
+    prefetchCv_.notify_all();
+}
+
+// ---------- DISK IMAGE CACHE ----------------------------------------------------------------------------
+
+// Memo only, so the UI thread can ask without hashing; keyed on the path, size and write time.
+std::optional<Sha256::Digest> NetworkManager::memoizedContentHash(const std::string& path, uint64_t size)
+{
+    if (path.empty())
+        return std::nullopt;
+    std::error_code ec;
+    const auto mtime = static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+    if (ec)
+        return std::nullopt;
+    std::lock_guard<std::mutex> lk(hashMemoMtx_);
+    auto it = hashMemo_.find(path);
+    if (it != hashMemo_.end() && it->second.size == size && it->second.mtime == mtime)
+        return it->second.hash;
+    return std::nullopt;
+}
+
+// Prefetch worker.
+Sha256::Digest NetworkManager::contentHashOf(const std::string& path, const std::vector<unsigned char>& img)
+{
+    if (auto memo = memoizedContentHash(path, img.size()))
+        return *memo;
+    const auto hash = Sha256::of(img.data(), img.size());
+    std::error_code ec;
+    const auto mtime = path.empty() ? 0 : static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+    if (!path.empty() && !ec)
+    {
+        std::lock_guard<std::mutex> lk(hashMemoMtx_);
+        hashMemo_[path] = HashMemo{img.size(), mtime, hash};
+    }
+    return hash;
+}
+
+// UI thread. Players that never send an inventory (older builds) only cost the wait.
+bool NetworkManager::cacheInventoryReady(const std::string& peerId)
+{
+    std::lock_guard<std::mutex> lk(prefetchMtx_);
+    if (diskHeld_.count(peerId))
+        return true;
+    const auto now = nowMs();
+    auto [it, fresh] = inventoryWaitSince_.try_emplace(peerId, now);
+    return now - it->second >= kCacheInventoryWaitMs;
+}
+
+// [count:u32][hash 32 x count]; sent to every link, only the GM reads it
+void NetworkManager::sendCacheInventory(const std::string& peerId)
+{
+    const auto hashes = diskCache_ ? diskCache_->inventory(kCacheInventoryMax) : std::vector<Sha256::Digest>{};
+    auto b = BufferPool::instance().acquire(1 + 4 + hashes.size() * 32);
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::CacheInventory));
+    Serializer::serializeUInt32(b, static_cast<uint32_t>(hashes.size()));
+    for (auto& h : hashes)
+        b.insert(b.end(), h.begin(), h.end());
+    sendGameTo(peerId, b);
+    BufferPool::instance().release(std::move(b));
+}
+
+std::vector<uint8_t> NetworkManager::buildImageCachedByHashFrame(msg::ImageOwnerKind kind, uint64_t id, const Sha256::Digest& hash)
+{
+    auto b = BufferPool::instance().acquire(1 + 1 + 8 + 32);
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::ImageCachedByHash));
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(kind));
+    Serializer::serializeUInt64(b, id);
+    b.insert(b.end(), hash.begin(), hash.end());
+    return b;
+}
+
+void NetworkManager::handleCacheInventory(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 4))
+    {
+        off = b.size();
+        return;
+    }
+    const uint32_t count = Serializer::deserializeUInt32(b, off);
+    if (count > kCacheInventoryMax || !ensureRemaining(b, off, size_t(count) * 32))
+    {
+        off = b.size();
+        return;
+    }
+    std::unordered_set<std::string> held;
+    held.reserve(count);
+    for (uint32_t i = 0; i < count; ++i, off += 32)
+        held.emplace(reinterpret_cast<const char*>(b.data() + off), 32);
+
+    const auto peerId = peerRegistry_.peerId(decodingFrom_);
+    if (peer_role != Role::GAMEMASTER || peerId.empty())
+        return;
+    Logger::instance().log("localtunnel", Logger::Level::Info,
+                           "Cache inventory from " + peerId + ": " + std::to_string(count) + " images");
+    std::lock_guard<std::mutex> lk(prefetchMtx_);
+    diskHeld_[peerId] = std::move(held);
+}
+
+void NetworkManager::handleImageCachedByHash(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 1 + 8 + 32))
+    {
+        off = b.size();
+        return;
+    }
+    auto kind = static_cast<msg::ImageOwnerKind>(Serializer::deserializeUInt8(b, off));
+    const uint64_t id = Serializer::deserializeUInt64(b, off);
+    Sha256::Digest hash;
+    std::memcpy(hash.data(), b.data() + off, hash.size());
+    off += hash.size();
+
+    uint64_t total = 0, boardId = 0;
+    {
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        if (imagesRefused_.count(id))
+            return;
+        auto it = imagesRx_.find(id);
+        if (it == imagesRx_.end() || it->second.total == 0)
+            return; // no meta: nothing to fill
+        total = it->second.total;
+        boardId = it->second.boardId;
+    }
+
+    // file read and hash check happen on the cache's thread, which posts the result back
+    const auto sender = peerRegistry_.peerId(decodingFrom_);
+    if (!diskCache_)
+    {
+        fillFromDiskCache(kind, id, boardId, sender, {});
+        return;
+    }
+    diskCache_->loadAsync(hash, total, [this, kind, id, boardId, sender](std::vector<uint8_t> bytes)
+                          { fillFromDiskCache(kind, id, boardId, sender, std::move(bytes)); });
+}
+
+// Disk cache thread (or the decode shard when there is no cache). A miss asks the GM for the image.
+void NetworkManager::fillFromDiskCache(msg::ImageOwnerKind kind, uint64_t id, uint64_t boardId, const std::string& sender,
+                                       std::vector<uint8_t> bytes)
+{
+    if (!bytes.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lk(imagesMtx_);
+            auto it = imagesRx_.find(id);
+            if (it == imagesRx_.end() || it->second.total != bytes.size() || it->second.isComplete())
+                return;
+            auto& p = it->second;
+            p.buf.write(0, bytes.data(), bytes.size());
+            p.received = p.total;
+            p.contiguous = p.total;
+            p.lastByteMs = nowMs();
+            p.fromDiskCache = true;
+            feedStreamingDecode(p);
+            if (p.commitRequested)
+                tryFinalizeImage(kind, id); // the commit beat the file read
+        }
+        keepFinishedImages();
+        return;
+    }
+
+    Logger::instance().log("localtunnel", Logger::Level::Info, "Disk cache miss id=" + std::to_string(id) + ", requesting it");
+    auto frame = buildImageRequestFrame(kind, boardId, id);
+    sendGameTo(sender, frame);
+    BufferPool::instance().release(std::move(frame));
+}
+
+// ---------- VERSIONED RESYNC ------------------------------------------------------------------------------
+
+// [historyId:u64][boardId:u64][version:u64], same layout both ways
+std::vector<uint8_t> NetworkManager::buildStateVersionFrame(msg::DCType type, const SeenState& s)
+{
+    auto b = BufferPool::instance().acquire(1 + 8 + 8 + 8);
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(type));
+    Serializer::serializeUInt64(b, s.historyId);
+    Serializer::serializeUInt64(b, s.boardId);
+    Serializer::serializeUInt64(b, s.version);
+    return b;
+}
+
+// UI thread.
+void NetworkManager::publishStateVersion()
+{
+    if (peer_role != Role::GAMEMASTER || !boardVersions_)
+        return;
+    auto bm = board_manager.lock();
+    if (!bm || !bm->isBoardActive())
+        return;
+    auto board = bm->getActiveBoard();
+    if (!board.is_valid() || !board.has<Identifier>())
+        return;
+
+    const uint64_t bid = board.get<Identifier>()->id;
+    const SeenState now{boardVersions_->historyId(), bid, boardVersions_->version(bid)};
+    if (now.boardId == lastVersionSent_.boardId && now.version == lastVersionSent_.version)
+        return;
+    const uint64_t t = nowMs();
+    if (now.boardId == lastVersionSent_.boardId && t - lastVersionSentMs_ < kStateVersionPeriodMs)
+        return;
+
+    // only players that got their bootstrap and look at this board: the version vouches for
+    // everything before it
+    std::vector<std::string> ids;
+    for (auto& pid : getPeerIdsViewing(bid))
+    {
+        auto link = peers.find(pid);
+        if (link && link->bootstrapSent())
+            ids.push_back(pid);
+    }
+    lastVersionSent_ = now;
+    lastVersionSentMs_ = t;
+    if (ids.empty())
+        return;
+    auto frame = buildStateVersionFrame(msg::DCType::StateVersion, now);
+    broadcastGameFrame(frame, ids);
+    BufferPool::instance().release(std::move(frame));
+}
+
+// UI thread, on the game channel opening. Sent to every link, only the GM reads it.
+void NetworkManager::sendResyncRequest(const std::string& peerId)
+{
+    SeenState s;
+    {
+        std::lock_guard<std::mutex> lk(seenStateMtx_);
+        s = seenState_;
+    }
+    if (s.version == 0)
+        return;
+    auto bm = board_manager.lock();
+    if (!bm || !bm->findBoardById(s.boardId).is_valid())
+        return; // nothing left to patch: take the full bootstrap
+    auto frame = buildStateVersionFrame(msg::DCType::ResyncRequest, s);
+    sendGameTo(peerId, frame);
+    BufferPool::instance().release(std::move(frame));
+}
+
+void NetworkManager::handleStateVersion(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 8 + 8 + 8))
+    {
+        off = b.size();
+        return;
+    }
+    SeenState s;
+    s.historyId = Serializer::deserializeUInt64(b, off);
+    s.boardId = Serializer::deserializeUInt64(b, off);
+    s.version = Serializer::deserializeUInt64(b, off);
+    if (peer_role == Role::GAMEMASTER)
+        return;
+    {
+        std::lock_guard<std::mutex> lk(seenStateMtx_);
+        seenState_ = s;
+    }
+    markPeerBootstrapped(decodingFrom_); // closes a resync bootstrap, which has no CommitBoard
+}
+
+void NetworkManager::handleResyncRequest(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 8 + 8 + 8))
+    {
+        off = b.size();
+        return;
+    }
+    SeenState s;
+    s.historyId = Serializer::deserializeUInt64(b, off);
+    s.boardId = Serializer::deserializeUInt64(b, off);
+    s.version = Serializer::deserializeUInt64(b, off);
+    const auto peerId = peerRegistry_.peerId(decodingFrom_);
+    if (peer_role != Role::GAMEMASTER || peerId.empty())
+        return;
+    std::lock_guard<std::mutex> lk(prefetchMtx_);
+    resyncFrom_[peerId] = s;
+}
+
+// UI thread (bootstrap). Deletes and field deltas first, then whole markers/fog the player
+// never saw (or only saw as a stub). False: out of history, the caller sends the full board.
+bool NetworkManager::sendBoardResync(const flecs::entity& board, const std::string& peerId, const SeenState& from)
+{
+    BoardVersions::Changes ch;
+    const uint64_t bid = board.get<Identifier>()->id;
+    if (!boardVersions_ || !boardVersions_->since(bid, from.historyId, from.version, ch))
+        return false;
+
+    const std::vector<std::string> to{peerId};
+    std::unordered_map<uint64_t, flecs::entity> byId;
+    {
+        // hidden markers were sent as stubs: remember them, so a reveal still ships the art
+        std::lock_guard<std::mutex> lk(prefetchMtx_);
+        auto& withheld = withheldMarkers_[peerId];
+        board.children([&](flecs::entity child)
+                       {
+            if (!child.has<Identifier>())
+                return;
+            const uint64_t id = child.get<Identifier>()->id;
+            byId[id] = child;
+            const auto* vis = child.get<Visibility>();
+            if (child.has<MarkerComponent>() && vis && !vis->isVisible)
+                withheld.insert(id); });
+    }
+
+    auto frame = BufferPool::instance().acquire();
+    auto flushIfFull = [&]()
+    {
+        if (frame.size() >= kDeltaFrameMax)
+        {
+            broadcastGameFrame(frame, to);
+            frame.clear();
+        }
+    };
+    for (auto& [id, fog] : ch.deleted)
+    {
+        auto del = fog ? buildFogDeleteFrame(bid, id) : buildMarkerDeleteFrame(bid, id);
+        frame.insert(frame.end(), del.begin(), del.end());
+        BufferPool::instance().release(std::move(del));
+        flushIfFull();
+    }
+    if (ch.boardChanged)
+        appendEntityDelta(frame, board, msg::DeltaGrid, to);
+
+    std::vector<flecs::entity> whole;
+    for (auto id : ch.created)
+    {
+        if (auto it = byId.find(id); it != byId.end())
+            whole.push_back(it->second);
+    }
+    for (auto id : ch.revealed)
+    {
+        auto it = byId.find(id);
+        if (it == byId.end())
+            continue;
+        const auto* vis = it->second.get<Visibility>();
+        if (vis && vis->isVisible)
+            whole.push_back(it->second);
+        else
+            ch.changed.push_back(id); // hidden again: just the fields
+    }
+    for (auto id : ch.changed)
+    {
+        if (auto it = byId.find(id); it != byId.end())
+        {
+            appendEntityDelta(frame, it->second, 0xFF, to);
+            flushIfFull();
+        }
+    }
+    if (!frame.empty())
+        broadcastGameFrame(frame, to);
+    BufferPool::instance().release(std::move(frame));
+
+    for (auto& e : whole)
+    {
+        if (e.has<MarkerComponent>())
+            sendMarker(bid, e, to);
+        else if (e.has<FogOfWar>())
+            sendFog(bid, e, to);
+    }
+
+    Logger::instance().log("localtunnel", Logger::Level::Info,
+                           "Resync " + peerId + " from v" + std::to_string(from.version) + ": " +
+                               std::to_string(ch.changed.size()) + " changed, " + std::to_string(whole.size()) + " whole, " +
+                               std::to_string(ch.deleted.size()) + " deleted");
+    return true;
+}
+
+// ---------- INTEREST MANAGEMENT ---------------------------------------------------------------------------
+
+std::vector<unsigned char> NetworkManager::buildBoardViewFrame(msg::DCType type, uint64_t boardId)
+{
+    auto out = BufferPool::instance().acquire();
+    Serializer::serializeUInt8(out, static_cast<uint8_t>(type));
+    Serializer::serializeUInt64(out, boardId);
+    return out;
+}
+
+void NetworkManager::announceBoardView()
+{
+    auto ids = getConnectedPeerIds();
+    if (ids.empty())
+        return;
+    auto bm = board_manager.lock();
+    const auto board = bm ? bm->getActiveBoard() : flecs::entity();
+    const uint64_t bid = board.is_valid() && board.has<Identifier>() ? board.get<Identifier>()->id : 0;
+    auto frame = buildBoardViewFrame(msg::DCType::BoardView, bid);
+    broadcastGameFrame(frame, ids);
+    BufferPool::instance().release(std::move(frame));
+}
+
+// UI thread, on the game channel opening
+void NetworkManager::sendBoardView(const std::string& peerId)
+{
+    auto bm = board_manager.lock();
+    const auto board = bm ? bm->getActiveBoard() : flecs::entity();
+    const uint64_t bid = board.is_valid() && board.has<Identifier>() ? board.get<Identifier>()->id : 0;
+    auto frame = buildBoardViewFrame(msg::DCType::BoardView, bid);
+    sendGameTo(peerId, frame);
+    BufferPool::instance().release(std::move(frame));
+}
+
+void NetworkManager::handleBoardView(msg::DCType type, const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 8))
+    {
+        off = b.size();
+        return;
+    }
+    msg::ReadyMessage m;
+    m.kind = type;
+    m.boardId = Serializer::deserializeUInt64(b, off);
+    // Anyone may report what they are viewing, but only the GM moves a player to another board.
+    if (type == msg::DCType::BoardSwitch && !isGmPeer(decodingFrom_))
+        return;
+    m.fromPeer = decodingFrom_;
+    inboundGame_.push(std::move(m));
+}
+
+std::vector<std::string> NetworkManager::getPeerIdsViewing(uint64_t boardId) const
+{
+    auto all = getConnectedPeerIds();
+    std::vector<std::string> ids;
+    ids.reserve(all.size());
+    for (auto& pid : all)
+    {
+        auto it = peerViews_.find(pid);
+        // A player always keeps the GM in the loop, whatever board the GM has open.
+        if (it == peerViews_.end() || !it->second.known || it->second.boardId == boardId ||
+            (peer_role == Role::PLAYER && isGmPeer(peerRegistry_.find(pid))))
+            ids.push_back(std::move(pid));
+    }
+    interestStats_.skippedSends += all.size() - ids.size();
+    return ids;
+}
+
+// GM: a player that still holds this very board entity is told to show it again; the catch-up
+// goes out when its BoardView comes back (onPeerBoardView).
+bool NetworkManager::switchToHeldBoard(const flecs::entity& board, const std::string& peerId)
+{
+    if (peer_role != Role::GAMEMASTER || !board.has<Identifier>())
+        return false;
+    auto it = peerViews_.find(peerId);
+    if (it == peerViews_.end() || !it->second.known)
+        return false;
+    auto& view = it->second;
+    const uint64_t bid = board.get<Identifier>()->id;
+    auto held = view.held.find(bid);
+    if (held == view.held.end() || held->second.entity != board.id())
+        return false;
+    if (view.boardId == bid)
+        return true; // already there and up to date
+
+    auto frame = buildBoardViewFrame(msg::DCType::BoardSwitch, bid);
+    sendGameTo(peerId, frame);
+    BufferPool::instance().release(std::move(frame));
+    view.pendingSwitch = bid;
+    ++interestStats_.switches;
+    return true;
+}
+
+void NetworkManager::onPeerBoardView(const msg::ReadyMessage& m)
+{
+    if (!m.boardId)
+        return;
+    const auto peerId = peerRegistry_.peerId(m.fromPeer);
+    if (peerId.empty())
+        return;
+
+    auto& view = peerViews_[peerId];
+    const uint64_t prev = view.known ? view.boardId : 0;
+    view.known = true;
+    view.boardId = *m.boardId;
+    if (peer_role != Role::GAMEMASTER || !boardVersions_)
+        return;
+
+    auto bm = board_manager.lock();
+    if (!bm)
+        return;
+
+    if (prev != view.boardId && prev != 0)
+    {
+        if (auto h = view.held.find(prev); h != view.held.end())
+            h->second.leftAt = boardVersions_->version(prev);
+    }
+
+    // told to switch but it doesn't hold the board after all: send it whole
+    if (view.pendingSwitch != 0)
+    {
+        const uint64_t wanted = view.pendingSwitch;
+        view.pendingSwitch = 0;
+        if (view.boardId != wanted)
+        {
+            view.held.erase(wanted);
+            if (auto board = bm->findBoardById(wanted); board.is_valid())
+                sendBoard(board, {peerId});
+            return;
+        }
+    }
+
+    auto h = view.held.find(view.boardId);
+    if (h == view.held.end() || h->second.leftAt == 0)
+        return;
+    const uint64_t from = h->second.leftAt;
+    h->second.leftAt = 0;
+
+    auto board = bm->findBoardById(view.boardId);
+    if (!board.is_valid() || board.id() != h->second.entity)
+        return;
+    const SeenState since{boardVersions_->historyId(), view.boardId, from};
+    if (!sendBoardResync(board, peerId, since))
+    {
+        sendBoard(board, {peerId});
+        return;
+    }
+    ++interestStats_.catchUps;
+    auto frame = buildStateVersionFrame(msg::DCType::StateVersion,
+                                        SeenState{boardVersions_->historyId(), view.boardId, boardVersions_->version(view.boardId)});
+    sendGameTo(peerId, frame);
+    BufferPool::instance().release(std::move(frame));
+}
+
+// ---------- BOARD HASH CHECKS -----------------------------------------------------------------------------
+
+// UI thread, every frame. The hash itself only costs the entities that changed.
+void NetworkManager::pollStateHash()
+{
+    if (!stateHash_)
+        return;
+    auto bm = board_manager.lock();
+    if (!bm || !bm->isBoardActive())
+    {
+        stateHash_->clear();
+        return;
+    }
+    auto board = bm->getActiveBoard();
+    const auto t0 = std::chrono::steady_clock::now();
+    stateHash_->refresh(board);
+    stateHashStats_.lastRefreshUs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count());
+    stateHashStats_.maxRefreshUs = std::max(stateHashStats_.maxRefreshUs, stateHashStats_.lastRefreshUs);
+    if (peer_role != Role::GAMEMASTER || stateHash_->boardId() == 0)
+        return;
+
+    const uint64_t t = nowMs();
+    if (t - lastStateHashMs_ < kStateHashPeriodMs)
+        return;
+    lastStateHashMs_ = t;
+
+    std::vector<std::string> ids;
+    for (auto& pid : getPeerIdsViewing(stateHash_->boardId()))
+    {
+        auto link = peers.find(pid);
+        if (link && link->bootstrapSent())
+            ids.push_back(pid);
+    }
+    if (ids.empty())
+        return;
+
+    // [boardId:u64][root:u64][bucket:u64 x kBuckets]
+    auto b = BufferPool::instance().acquire(1 + 8 + 8 + 8 * BoardStateHash::kBuckets);
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::StateHash));
+    Serializer::serializeUInt64(b, stateHash_->boardId());
+    Serializer::serializeUInt64(b, stateHash_->root());
+    for (auto h : stateHash_->buckets())
+        Serializer::serializeUInt64(b, h);
+    broadcastGameFrame(b, ids);
+    BufferPool::instance().release(std::move(b));
+}
+
+void NetworkManager::handleStateHash(const std::vector<uint8_t>& b, size_t& off)
+{
+    const size_t n = 8 * (1 + BoardStateHash::kBuckets);
+    if (!ensureRemaining(b, off, 8 + n))
+    {
+        off = b.size();
+        return;
+    }
+    msg::ReadyMessage m;
+    m.kind = msg::DCType::StateHash;
+    m.boardId = Serializer::deserializeUInt64(b, off);
+    m.bytes = std::vector<uint8_t>(b.begin() + off, b.begin() + off + n);
+    off += n;
+    m.fromPeer = decodingFrom_;
+    inboundGame_.push(std::move(m));
+}
+
+// [boardId:u64][bucketCount:u8][bucket:u8...][leafCount:u32][(id:u64, kind:u8, hash:u64)...]
+void NetworkManager::handleStateHashLeaves(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 8 + 1))
+    {
+        off = b.size();
+        return;
+    }
+    msg::ReadyMessage m;
+    m.kind = msg::DCType::StateHashLeaves;
+    m.boardId = Serializer::deserializeUInt64(b, off);
+
+    const size_t start = off;
+    const uint8_t nb = Serializer::deserializeUInt8(b, off);
+    if (!ensureRemaining(b, off, size_t(nb) + 4))
+    {
+        off = b.size();
+        return;
+    }
+    off += nb;
+    const uint32_t nl = Serializer::deserializeUInt32(b, off);
+    if (!ensureRemaining(b, off, size_t(nl) * 17))
+    {
+        off = b.size();
+        return;
+    }
+    off += size_t(nl) * 17;
+    m.bytes = std::vector<uint8_t>(b.begin() + start, b.begin() + off);
+    m.fromPeer = decodingFrom_;
+    inboundGame_.push(std::move(m));
+}
+
+// UI thread. A bucket has to differ on two checks in a row before we ask: deltas still in
+// flight make single mismatches normal.
+void NetworkManager::checkStateHash(const msg::ReadyMessage& m)
+{
+    constexpr size_t kBuckets = BoardStateHash::kBuckets;
+    if (peer_role != Role::PLAYER || !stateHash_ || !m.boardId || !m.bytes || m.bytes->size() != 8 * (1 + kBuckets))
+        return;
+    auto bm = board_manager.lock();
+    if (!bm || !bm->isBoardActive())
+        return;
+    auto board = bm->getActiveBoard();
+    stateHash_->refresh(board);
+    if (stateHash_->boardId() != *m.boardId)
+        return;
+    ++stateHashStats_.checks;
+
+    const auto& raw = *m.bytes;
+    size_t off = 0;
+    const uint64_t root = Serializer::deserializeUInt64(raw, off);
+    if (suspectBoard_ != *m.boardId)
+    {
+        suspectBoard_ = *m.boardId;
+        suspectBuckets_ = 0;
+    }
+    if (root == stateHash_->root())
+    {
+        suspectBuckets_ = 0;
+        return;
+    }
+    const uint64_t now = nowMs();
+    for (auto& [mid, s] : drag_)
+    {
+        // a drag in progress differs by design; a remote one that went quiet lost its end
+        if (!s.closed && (s.locallyDragging || now - std::max(s.lastRxMs, s.epochOpenedMs) < kDragQuietMs))
+            return;
+    }
+
+    uint64_t differ = 0;
+    const auto& mine = stateHash_->buckets();
+    for (size_t i = 0; i < kBuckets; ++i)
+    {
+        if (Serializer::deserializeUInt64(raw, off) != mine[i])
+            differ |= uint64_t(1) << i;
+    }
+    const uint64_t confirmed = differ & suspectBuckets_;
+    suspectBuckets_ = differ;
+    if (!confirmed)
+        return;
+
+    std::vector<uint8_t> buckets;
+    for (size_t i = 0; i < kBuckets && buckets.size() < kMaxRepairBuckets; ++i)
+    {
+        if (confirmed & (uint64_t(1) << i))
+            buckets.push_back(static_cast<uint8_t>(i));
+    }
+    std::vector<BoardStateHash::Leaf> leaves;
+    for (auto i : buckets)
+    {
+        auto l = stateHash_->leaves(i);
+        leaves.insert(leaves.end(), l.begin(), l.end());
+    }
+
+    auto b = BufferPool::instance().acquire(1 + 8 + 1 + buckets.size() + 4 + leaves.size() * 17);
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::StateHashLeaves));
+    Serializer::serializeUInt64(b, *m.boardId);
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(buckets.size()));
+    b.insert(b.end(), buckets.begin(), buckets.end());
+    Serializer::serializeUInt32(b, static_cast<uint32_t>(leaves.size()));
+    for (const auto& l : leaves)
+    {
+        Serializer::serializeUInt64(b, l.id);
+        Serializer::serializeUInt8(b, static_cast<uint8_t>(l.kind));
+        Serializer::serializeUInt64(b, l.hash);
+    }
+    sendGameTo(peerRegistry_.peerId(m.fromPeer), b);
+    BufferPool::instance().release(std::move(b));
+
+    ++stateHashStats_.mismatches;
+    suspectBuckets_ &= ~confirmed; // give the repair a round to land
+    Logger::instance().log("localtunnel", Logger::Level::Warn,
+                           "Board hash mismatch in " + std::to_string(buckets.size()) + " buckets, " +
+                               std::to_string(leaves.size()) + " leaves sent to GM");
+}
+
+// UI thread. Same order as sendBoardResync: deletes and field deltas, then whole entities.
+void NetworkManager::repairStateHash(const msg::ReadyMessage& m)
+{
+    if (peer_role != Role::GAMEMASTER || !stateHash_ || !m.boardId || !m.bytes)
+        return;
+    const auto peerId = peerRegistry_.peerId(m.fromPeer);
+    auto bm = board_manager.lock();
+    if (peerId.empty() || !bm || !bm->isBoardActive())
+        return;
+    auto board = bm->getActiveBoard();
+    stateHash_->refresh(board);
+    if (stateHash_->boardId() != *m.boardId)
+        return;
+
+    // handleStateHashLeaves checked the layout
+    const auto& raw = *m.bytes;
+    size_t off = 0;
+    const uint8_t nb = Serializer::deserializeUInt8(raw, off);
+    std::vector<uint8_t> buckets(raw.begin() + off, raw.begin() + off + nb);
+    off += nb;
+    const uint32_t nl = Serializer::deserializeUInt32(raw, off);
+    std::unordered_map<uint64_t, BoardStateHash::Leaf> theirs;
+    theirs.reserve(nl);
+    for (uint32_t i = 0; i < nl; ++i)
+    {
+        BoardStateHash::Leaf l;
+        l.id = Serializer::deserializeUInt64(raw, off);
+        l.kind = static_cast<BoardStateHash::Kind>(Serializer::deserializeUInt8(raw, off));
+        l.hash = Serializer::deserializeUInt64(raw, off);
+        theirs[l.id] = l;
+    }
+    ++stateHashStats_.mismatches;
+
+    const uint64_t bid = *m.boardId;
+    const std::vector<std::string> to{peerId};
+    std::vector<flecs::entity> whole;
+    size_t changed = 0, deleted = 0;
+    auto frame = BufferPool::instance().acquire();
+    auto flushIfFull = [&]()
+    {
+        if (frame.size() >= kDeltaFrameMax)
+        {
+            broadcastGameFrame(frame, to);
+            frame.clear();
+        }
+    };
+
+    for (auto i : buckets)
+    {
+        if (i >= BoardStateHash::kBuckets)
+            continue;
+        for (const auto& mine : stateHash_->leaves(i))
+        {
+            auto it = theirs.find(mine.id);
+            auto e = stateHash_->entityOf(mine.id);
+            if (it == theirs.end())
+            {
+                if (e.is_valid() && mine.kind != BoardStateHash::Kind::Board)
+                    whole.push_back(e);
+                continue;
+            }
+            if (it->second.hash != mine.hash && e.is_valid())
+            {
+                appendEntityDelta(frame, e, mine.kind == BoardStateHash::Kind::Board ? msg::DeltaGrid : 0xFF, to);
+                ++changed;
+                flushIfFull();
+            }
+            theirs.erase(it);
+        }
+    }
+    // what is left only exists on the player
+    for (auto& [id, l] : theirs)
+    {
+        if (l.kind == BoardStateHash::Kind::Board ||
+            std::find(buckets.begin(), buckets.end(), BoardStateHash::bucketOf(id)) == buckets.end())
+            continue;
+        auto del = l.kind == BoardStateHash::Kind::Fog ? buildFogDeleteFrame(bid, id) : buildMarkerDeleteFrame(bid, id);
+        frame.insert(frame.end(), del.begin(), del.end());
+        BufferPool::instance().release(std::move(del));
+        ++deleted;
+        flushIfFull();
+    }
+    if (!frame.empty())
+        broadcastGameFrame(frame, to);
+    BufferPool::instance().release(std::move(frame));
+
+    for (auto& e : whole)
+    {
+        if (e.has<MarkerComponent>())
+            sendMarker(bid, e, to);
+        else if (e.has<FogOfWar>())
+            sendFog(bid, e, to);
+    }
+    stateHashStats_.repaired += changed + deleted + whole.size();
+
+    Logger::instance().log("localtunnel", Logger::Level::Info,
+                           "Board hash repair " + peerId + ": " + std::to_string(changed) + " changed, " +
+                               std::to_string(whole.size()) + " whole, " + std::to_string(deleted) + " deleted");
+}
+
+// ---------- CHAT IMAGES -----------------------------------------------------------------------------------
+
+void NetworkManager::postChatImage(uint64_t tableId, uint64_t groupId, const std::set<std::string>& toPeerIds, bool broadcast,
+                                   const std::string& username, const std::string& caption, uint64_t ts, std::vector<uint8_t> bytes)
+{
+    if (bytes.empty() || bytes.size() > msg::kChatImageMaxBytes)
+    {
+        pushStatusToast("Image too large for chat (max " + std::to_string(msg::kChatImageMaxBytes / (1024 * 1024)) + " MB)",
+                        ImGuiToaster::Level::Warning);
+        return;
+    }
+    ChatMediaJob job;
+    job.kind = ChatMediaJob::Kind::Post;
+    job.tableId = tableId;
+    job.groupId = groupId;
+    job.ts = ts;
+    job.toPeerIds = toPeerIds;
+    job.broadcast = broadcast;
+    job.username = username;
+    job.caption = caption;
+    job.bytes = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+    queueChatMediaJob(std::move(job));
+}
+
+void NetworkManager::requestChatImage(const msg::ChatImageRef& ref, const std::string& fromPeerId)
+{
+    ChatMediaJob job;
+    job.kind = ChatMediaJob::Kind::Fetch;
+    job.ref = ref;
+    job.peerId = fromPeerId;
+    queueChatMediaJob(std::move(job));
+}
+
+void NetworkManager::queueChatMediaJob(ChatMediaJob job)
+{
+    std::lock_guard<std::mutex> lk(chatMediaMtx_);
+    if (chatMediaStop_)
+        return;
+    if (!chatMediaWorker_.joinable())
+        chatMediaWorker_ = std::thread([this]()
+                                       { chatMediaLoop(); });
+    chatMediaJobs_.push_back(std::move(job));
+    chatMediaCv_.notify_all();
+}
+
+void NetworkManager::stopChatMediaWorker()
+{
+    {
+        std::lock_guard<std::mutex> lk(chatMediaMtx_);
+        chatMediaStop_ = true;
+        chatMediaJobs_.clear();
+    }
+    chatMediaCv_.notify_all();
+    if (chatMediaWorker_.joinable())
+        chatMediaWorker_.join();
+}
+
+// Outgoing full images are served round-robin, each link only topped up to kChatMediaMaxBuffered,
+// so a big picture for one reader neither floods the channel nor holds up the others.
+void NetworkManager::chatMediaLoop()
+{
+    struct Send
+    {
+        std::string peerId;
+        msg::ChatImageRef ref;
+        std::shared_ptr<const std::vector<uint8_t>> bytes;
+        uint64_t offset = 0;
+    };
+    std::deque<Send> sends;
+    const std::string label(msg::dc::name::ChatMedia);
+
+    for (;;)
+    {
+        std::deque<ChatMediaJob> jobs;
+        {
+            std::unique_lock<std::mutex> lk(chatMediaMtx_);
+            auto ready = [&]()
+            { return chatMediaStop_ || !chatMediaJobs_.empty(); };
+            if (sends.empty())
+                chatMediaCv_.wait(lk, ready);
+            else
+                chatMediaCv_.wait_for(lk, std::chrono::milliseconds(5), ready);
+            if (chatMediaStop_)
+                return;
+            jobs.swap(chatMediaJobs_);
+        }
+
+        for (auto& job : jobs)
+        {
+            try
+            {
+                switch (job.kind)
+                {
+                    case ChatMediaJob::Kind::Post:
+                        runChatMediaPost(job);
+                        break;
+                    case ChatMediaJob::Kind::Fetch:
+                        runChatMediaFetch(job);
+                        break;
+                    case ChatMediaJob::Kind::Serve:
+                    {
+                        auto bytes = chatMediaBytes(job.ref);
+                        if (!bytes || job.offset >= bytes->size())
+                        {
+                            Logger::instance().log("chat", Logger::Level::Info, "Chat image asked by " + job.peerId + " not held here");
+                            break;
+                        }
+                        sends.push_back(Send{job.peerId, job.ref, std::move(bytes), job.offset});
+                        break;
+                    }
+                }
+            }
+            catch (const std::exception& e)
+            {
+                Logger::instance().log("chat", Logger::Level::Warn, std::string("Chat image job failed: ") + e.what());
+            }
+        }
+
+        for (auto it = sends.begin(); it != sends.end();)
+        {
+            auto link = peers.find(it->peerId);
+            if (!link || !link->isConnected())
+            {
+                it = sends.erase(it);
+                continue;
+            }
+            const auto& img = *it->bytes;
+            while (it->offset < img.size() && link->bufferedAmount(label) < kChatMediaMaxBuffered)
+            {
+                const size_t n = std::min<size_t>(kChatMediaChunk, img.size() - it->offset);
+                // [hash:32][total:u64][offset:u64][len:u32][bytes]
+                auto b = BufferPool::instance().acquire(1 + 32 + 8 + 8 + 4 + n);
+                Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::ChatImageChunk));
+                b.insert(b.end(), it->ref.hash.begin(), it->ref.hash.end());
+                Serializer::serializeUInt64(b, img.size());
+                Serializer::serializeUInt64(b, it->offset);
+                Serializer::serializeUInt32(b, static_cast<uint32_t>(n));
+                b.insert(b.end(), img.begin() + it->offset, img.begin() + it->offset + n);
+                const bool ok = link->sendChatMedia(b);
+                BufferPool::instance().release(std::move(b));
+                if (!ok)
+                    break;
+                it->offset += n;
+            }
+            if (it->offset >= img.size())
+                it = sends.erase(it);
+            else
+                ++it;
+        }
+    }
+}
+
+// Worker. Thumbnail and hash first, then the message (chat channel) and the thumbnail (chat_media).
+void NetworkManager::runChatMediaPost(const ChatMediaJob& job)
+{
+    const auto& img = *job.bytes;
+    ImageThumbnail::Result thumb;
+    if (!ImageThumbnail::make(img.data(), img.size(), kChatThumbSide, thumb))
+    {
+        pushStatusToast("That file is not an image chat can show", ImGuiToaster::Level::Warning);
+        return;
+    }
+    if (thumb.width > int(msg::kChatImageMaxSide) || thumb.height > int(msg::kChatImageMaxSide))
+    {
+        pushStatusToast("Image too large for chat (max " + std::to_string(msg::kChatImageMaxSide) + " px a side)",
+                        ImGuiToaster::Level::Warning);
+        return;
+    }
+    msg::ChatImageRef ref;
+    ref.hash = Sha256::of(img.data(), img.size());
+    ref.size = img.size();
+    ref.width = static_cast<uint16_t>(std::min(thumb.width, 65535));
+    ref.height = static_cast<uint16_t>(std::min(thumb.height, 65535));
+    holdChatMedia(ref, job.bytes);
+    if (diskCache_)
+        diskCache_->store(img.data(), img.size()); // still servable after a restart
+
+    const auto j = msg::makeChatImageMessage(job.tableId, job.groupId, job.ts, job.username, job.caption, ref);
+    std::vector<std::string> targets;
+    if (job.broadcast)
+    {
+        broadcastChatJson(j);
+        for (auto& [pid, link] : peers.snapshot())
+            targets.push_back(pid);
+    }
+    else if (!job.toPeerIds.empty())
+    {
+        sendChatJsonTo(job.toPeerIds, j);
+        targets.assign(job.toPeerIds.begin(), job.toPeerIds.end());
+    }
+
+    // [hash:32][size:u64][w:u32][h:u32][len:u32][jpeg]
+    auto b = BufferPool::instance().acquire(1 + 32 + 8 + 4 + 4 + 4 + thumb.jpeg.size());
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::ChatImageThumb));
+    b.insert(b.end(), ref.hash.begin(), ref.hash.end());
+    Serializer::serializeUInt64(b, ref.size);
+    Serializer::serializeUInt32(b, ref.width);
+    Serializer::serializeUInt32(b, ref.height);
+    Serializer::serializeUInt32(b, static_cast<uint32_t>(thumb.jpeg.size()));
+    b.insert(b.end(), thumb.jpeg.begin(), thumb.jpeg.end());
+    for (auto& pid : targets)
+    {
+        if (auto link = peers.find(pid); link && link->isConnected())
+            link->sendChatMedia(b);
+    }
+    BufferPool::instance().release(std::move(b));
+
+    msg::ReadyMessage echo;
+    echo.kind = msg::DCType::ChatMessage;
+    echo.fromPeer = msg::kSelfPeer;
+    echo.tableId = job.tableId;
+    echo.threadId = job.groupId;
+    echo.ts = job.ts;
+    echo.name = job.username;
+    echo.text = job.caption;
+    echo.chatImage = ref;
+    inboundGame_.push(std::move(echo));
+
+    msg::ReadyMessage preview;
+    preview.kind = msg::DCType::ChatImageThumb;
+    preview.fromPeer = msg::kSelfPeer;
+    preview.chatImage = ref;
+    preview.bytes = std::move(thumb.jpeg);
+    inboundGame_.push(std::move(preview));
+}
+
+// Worker. Local copies first; the wire only for what we really don't have.
+void NetworkManager::runChatMediaFetch(const ChatMediaJob& job)
+{
+    if (auto bytes = chatMediaBytes(job.ref))
+    {
+        msg::ReadyMessage m;
+        m.kind = msg::DCType::ChatImageChunk;
+        m.fromPeer = msg::kSelfPeer;
+        m.chatImage = job.ref;
+        m.bytes = *bytes;
+        inboundGame_.push(std::move(m));
+        return;
+    }
+
+    std::string from = job.peerId;
+    auto link = from.empty() ? nullptr : peers.find(from);
+    if ((!link || !link->isConnected()) && identity_manager)
+    {
+        from = identity_manager->peerForUnique(getGMId()).value_or(std::string{});
+        link = from.empty() ? nullptr : peers.find(from);
+    }
+    if (!link || !link->isConnected())
+    {
+        Logger::instance().log("chat", Logger::Level::Info, "Chat image: nobody connected to ask");
+        return;
+    }
+
+    const std::string key(job.ref.hash.begin(), job.ref.hash.end());
+    uint64_t offset = 0;
+    {
+        std::lock_guard<std::mutex> lk(chatMediaMtx_);
+        auto& rx = chatMediaRx_[key];
+        if (rx.total != job.ref.size)
+        {
+            rx = ChatMediaRx{};
+            rx.total = job.ref.size;
+            rx.buf.resize(static_cast<size_t>(job.ref.size));
+        }
+        offset = rx.received; // a second click after a drop picks up where it stopped
+    }
+
+    // [hash:32][size:u64][offset:u64]
+    auto b = BufferPool::instance().acquire(1 + 32 + 8 + 8);
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::ChatImageRequest));
+    b.insert(b.end(), job.ref.hash.begin(), job.ref.hash.end());
+    Serializer::serializeUInt64(b, job.ref.size);
+    Serializer::serializeUInt64(b, offset);
+    link->sendChatMedia(b);
+    BufferPool::instance().release(std::move(b));
+}
+
+// Worker.
+std::shared_ptr<const std::vector<uint8_t>> NetworkManager::chatMediaBytes(const msg::ChatImageRef& ref)
+{
+    const std::string key(ref.hash.begin(), ref.hash.end());
+    for (auto& [k, bytes] : chatMediaHeld_)
+    {
+        if (k == key)
+            return bytes;
+    }
+    if (!diskCache_)
+        return nullptr;
+    auto bytes = diskCache_->load(ref.hash, ref.size);
+    if (bytes.empty())
+        return nullptr;
+    auto shared = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+    holdChatMedia(ref, shared);
+    return shared;
+}
+
+// Worker.
+void NetworkManager::holdChatMedia(const msg::ChatImageRef& ref, std::shared_ptr<const std::vector<uint8_t>> bytes)
+{
+    std::string key(ref.hash.begin(), ref.hash.end());
+    for (auto it = chatMediaHeld_.begin(); it != chatMediaHeld_.end(); ++it)
+    {
+        if (it->first == key)
+        {
+            chatMediaHeld_.erase(it);
+            break;
+        }
+    }
+    chatMediaHeld_.emplace_back(std::move(key), std::move(bytes));
+    while (chatMediaHeld_.size() > kChatMediaHeldMax)
+        chatMediaHeld_.pop_front();
+}
+
+void NetworkManager::decodeRawChatMediaBuffer(msg::PeerHandle fromPeer, const std::vector<uint8_t>& b)
+{
+    decodingFrom_ = fromPeer;
+    size_t off = 0;
+    while (off < b.size())
+    {
+        auto type = static_cast<msg::DCType>(b[off]);
+        off += 1;
+        switch (type)
+        {
+            case msg::DCType::ChatImageThumb:
+                handleChatImageThumb(b, off);
+                break;
+            case msg::DCType::ChatImageRequest:
+                handleChatImageRequest(b, off);
+                break;
+            case msg::DCType::ChatImageChunk:
+                handleChatImageChunk(b, off);
+                break;
+            default:
+                Logger::instance().log("chat", Logger::Level::Warn, "Unknown chat_media type " + std::to_string(static_cast<int>(type)));
+                return;
+        }
+    }
+}
+
+void NetworkManager::handleChatImageThumb(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 32 + 8 + 4 + 4 + 4))
+    {
+        off = b.size();
+        return;
+    }
+    msg::ChatImageRef ref;
+    std::copy(b.begin() + off, b.begin() + off + 32, ref.hash.begin());
+    off += 32;
+    ref.size = Serializer::deserializeUInt64(b, off);
+    ref.width = static_cast<uint16_t>(Serializer::deserializeUInt32(b, off));
+    ref.height = static_cast<uint16_t>(Serializer::deserializeUInt32(b, off));
+    const uint32_t len = Serializer::deserializeUInt32(b, off);
+    if (!ensureRemaining(b, off, len))
+    {
+        off = b.size();
+        return;
+    }
+    if (ref.width > msg::kChatImageMaxSide || ref.height > msg::kChatImageMaxSide)
+    {
+        off += len;
+        return;
+    }
+    msg::ReadyMessage m;
+    m.kind = msg::DCType::ChatImageThumb;
+    m.fromPeer = decodingFrom_;
+    m.chatImage = ref;
+    m.bytes = std::vector<uint8_t>(b.begin() + off, b.begin() + off + len);
+    off += len;
+    inboundGame_.push(std::move(m));
+}
+
+void NetworkManager::handleChatImageRequest(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 32 + 8 + 8))
+    {
+        off = b.size();
+        return;
+    }
+    ChatMediaJob job;
+    job.kind = ChatMediaJob::Kind::Serve;
+    std::copy(b.begin() + off, b.begin() + off + 32, job.ref.hash.begin());
+    off += 32;
+    job.ref.size = Serializer::deserializeUInt64(b, off);
+    job.offset = Serializer::deserializeUInt64(b, off);
+    job.peerId = peerRegistry_.peerId(decodingFrom_);
+    if (job.peerId.empty() || job.ref.size == 0 || job.ref.size > msg::kChatImageMaxBytes)
+        return;
+    queueChatMediaJob(std::move(job));
+}
+
+void NetworkManager::handleChatImageChunk(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 32 + 8 + 8 + 4))
+    {
+        off = b.size();
+        return;
+    }
+    msg::ChatImageRef ref;
+    std::copy(b.begin() + off, b.begin() + off + 32, ref.hash.begin());
+    off += 32;
+    const uint64_t total = Serializer::deserializeUInt64(b, off);
+    const uint64_t offset = Serializer::deserializeUInt64(b, off);
+    const uint32_t len = Serializer::deserializeUInt32(b, off);
+    if (!ensureRemaining(b, off, len))
+    {
+        off = b.size();
+        return;
+    }
+    const uint8_t* data = b.data() + off;
+    off += len;
+
+    const std::string key(ref.hash.begin(), ref.hash.end());
+    std::vector<uint8_t> done;
+    {
+        std::lock_guard<std::mutex> lk(chatMediaMtx_);
+        auto it = chatMediaRx_.find(key);
+        if (it == chatMediaRx_.end() || it->second.total != total || offset != it->second.received ||
+            offset + len > total)
+            return; // not asked for, or a duplicate from a second request
+        auto& rx = it->second;
+        std::copy(data, data + len, rx.buf.begin() + offset);
+        rx.received += len;
+        if (rx.received < rx.total)
+            return;
+        done = std::move(rx.buf);
+        chatMediaRx_.erase(it);
+    }
+
+    if (Sha256::of(done.data(), done.size()) != ref.hash)
+    {
+        Logger::instance().log("chat", Logger::Level::Warn, "Chat image failed its hash check, dropped");
+        return;
+    }
+    if (diskCache_)
+        diskCache_->store(done.data(), done.size());
+    ref.size = total;
+    msg::ReadyMessage m;
+    m.kind = msg::DCType::ChatImageChunk;
+    m.fromPeer = decodingFrom_;
+    m.chatImage = ref;
+    m.bytes = std::move(done);
+    inboundGame_.push(std::move(m));
+}
+
+// ---------- SWARM IMAGES ----------------------------------------------------------------------------------
+
+bool NetworkManager::shouldSwarm(uint64_t size, const std::vector<std::string>& toPeerIds) const
+{
+    return swarmImages_.load() && peer_role == Role::GAMEMASTER && toPeerIds.size() >= 2 &&
+           size >= kSwarmMinBytes && size <= kSwarmMaxBytes;
+}
+
+// Manifest to everyone, then each piece once to its seeder; the players trade the rest. The seed
+// is registered right away so fallbacks are answered while the worker is still hashing.
+void NetworkManager::sendImageSwarm(msg::ImageOwnerKind kind, uint64_t id, std::shared_ptr<const std::vector<unsigned char>> img,
+                                    const std::string& path, const std::vector<std::string>& toPeerIds)
+{
+    std::lock_guard<std::mutex> lk(swarmMtx_);
+    if (swarmStop_.load())
+        return;
+    auto& seed = swarmSeeds_[id];
+    if (seed.kind != kind || seed.total != img->size())
+        seed.recipients.clear(); // another image under that id
+    seed.recipients.insert(toPeerIds.begin(), toPeerIds.end());
+    seed.kind = kind;
+    seed.total = img->size();
+    seed.path = path;
+    seed.bytes = img;
+    seed.lastUseMs = nowMs();
+
+    swarmSends_.push_back(SwarmSend{kind, id, std::move(img), toPeerIds});
+    if (!swarmWorker_.joinable())
+        swarmWorker_ = std::thread([this]()
+                                   { swarmLoop(); });
+    swarmCv_.notify_all();
+}
+
+void NetworkManager::stopSwarmWorker()
+{
+    {
+        std::lock_guard<std::mutex> lk(swarmMtx_);
+        swarmStop_.store(true);
+        swarmSends_.clear();
+    }
+    swarmCv_.notify_all();
+    if (swarmWorker_.joinable())
+        swarmWorker_.join();
+}
+
+void NetworkManager::swarmLoop()
+{
+    for (;;)
+    {
+        SwarmSend job;
+        {
+            std::unique_lock<std::mutex> lk(swarmMtx_);
+            swarmCv_.wait(lk, [&]()
+                          { return swarmStop_.load() || !swarmSends_.empty(); });
+            if (swarmStop_.load())
+                return;
+            job = std::move(swarmSends_.front());
+            swarmSends_.pop_front();
+        }
+        runSwarmSend(job);
+    }
+}
+
+void NetworkManager::runSwarmSend(const SwarmSend& job)
+{
+    const auto& img = *job.bytes;
+    const auto manifest = ImageManifest::build(img.data(), img.size(), job.toPeerIds);
+
+    auto mf = buildImageManifestFrame(job.kind, job.id, manifest);
+    broadcastGameFrame(mf, job.toPeerIds);
+    BufferPool::instance().release(std::move(mf));
+
+    foregroundImageSends_.fetch_add(1); // holds the prefetch worker back
+    int paced = 0;
+    uint32_t sent = 0;
+    for (; sent < manifest.pieceCount() && !swarmStop_.load(); ++sent)
+    {
+        auto frame = buildImagePieceFrame(job.kind, job.id, sent, img.data() + manifest.pieceOffset(sent), manifest.pieceLen(sent));
+        sendGameTo(manifest.seederOf(sent), frame);
+        BufferPool::instance().release(std::move(frame));
+        if ((++paced % (kPaceEveryN / 8)) == 0) // pieces are 8x a chunk
+            std::this_thread::sleep_for(std::chrono::milliseconds(kPaceMillis));
+    }
+    foregroundImageSends_.fetch_sub(1);
+    {
+        std::lock_guard<std::mutex> lk(swarmMtx_);
+        swarmStats_.piecesSeeded += sent;
+    }
+
+    Logger::instance().log("localtunnel", Logger::Level::Info,
+                           "sendImageSwarm: id=" + std::to_string(job.id) + " bytes=" + std::to_string(img.size()) +
+                               " pieces=" + std::to_string(manifest.pieceCount()) + " seeders=" + std::to_string(job.toPeerIds.size()));
+}
+
+// GM copy of a swarmed image, re-read from disk once the hold expired. Null if it's unknown or changed.
+std::shared_ptr<const std::vector<unsigned char>> NetworkManager::swarmSeedBytes(msg::ImageOwnerKind kind, uint64_t id, uint64_t total)
+{
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lk(swarmMtx_);
+        auto it = swarmSeeds_.find(id);
+        if (it == swarmSeeds_.end() || it->second.kind != kind || it->second.total != total)
+            return nullptr;
+        it->second.lastUseMs = nowMs();
+        if (it->second.bytes)
+            return it->second.bytes;
+        path = it->second.path;
+    }
+    auto bytes = std::make_shared<const std::vector<unsigned char>>(readFileBytes(path));
+    if (bytes->size() != total)
+        return nullptr;
+    std::lock_guard<std::mutex> lk(swarmMtx_);
+    if (auto it = swarmSeeds_.find(id); it != swarmSeeds_.end())
+        it->second.bytes = bytes;
+    return bytes;
+}
+
+void NetworkManager::pollSwarmTransfers()
+{
+    const uint64_t now = nowMs();
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> asks;
+    {
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        for (auto& [id, p] : imagesRx_)
+        {
+            if (!p.swarm || p.swarm->complete())
+                continue;
+            auto& sw = *p.swarm;
+            if (now - std::max(sw.lastProgressMs, sw.lastFallbackMs) < kSwarmStallMs)
+                continue;
+
+            std::vector<uint32_t> missing;
+            for (uint32_t i = 0; i < sw.manifest.pieceCount(); ++i)
+                if (!sw.have[i])
+                    missing.push_back(i);
+            sw.lastFallbackMs = now;
+            asks.emplace_back(sw.gmPeerId, buildPieceRequestFrame(p.kind, id, p.total, missing));
+            Logger::instance().log("localtunnel", Logger::Level::Warn,
+                                   "Swarm: id=" + std::to_string(id) + " stalled, asking the GM for " +
+                                       std::to_string(missing.size()) + " pieces");
+        }
+    }
+    for (auto& [pid, frame] : asks)
+    {
+        sendGameTo(pid, frame);
+        BufferPool::instance().release(std::move(frame));
+    }
+
+    std::lock_guard<std::mutex> lk(swarmMtx_);
+    swarmStats_.fallbacks += asks.size();
+    for (auto& [id, seed] : swarmSeeds_)
+    {
+        if (seed.bytes && now - seed.lastUseMs > kSwarmSeedHoldMs)
+            seed.bytes.reset(); // path stays: a late fallback re-reads it
+    }
+}
+
+// [kind][id][total][pieceSize][contentHash 32][pieceCount][pieceHash 16 x n][seederCount][seeder ids]
+std::vector<uint8_t> NetworkManager::buildImageManifestFrame(msg::ImageOwnerKind kind, uint64_t id, const ImageManifest& m)
+{
+    auto b = BufferPool::instance().acquire();
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::ImageManifest));
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(kind));
+    Serializer::serializeUInt64(b, id);
+    Serializer::serializeUInt64(b, m.total);
+    Serializer::serializeUInt32(b, m.pieceSize);
+    b.insert(b.end(), m.contentHash.begin(), m.contentHash.end());
+    Serializer::serializeUInt32(b, m.pieceCount());
+    for (auto& h : m.pieceHashes)
+        b.insert(b.end(), h.begin(), h.end());
+    Serializer::serializeUInt32(b, static_cast<uint32_t>(m.seeders.size()));
+    for (auto& s : m.seeders)
+        Serializer::serializeString(b, s);
+    return b;
+}
+
+std::vector<uint8_t> NetworkManager::buildImagePieceFrame(msg::ImageOwnerKind kind, uint64_t id, uint32_t index, const uint8_t* data, size_t len)
+{
+    auto b = BufferPool::instance().acquire(1 + 1 + 8 + 4 + 4 + len);
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::ImagePiece));
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(kind));
+    Serializer::serializeUInt64(b, id);
+    Serializer::serializeUInt32(b, index);
+    Serializer::serializeUInt32(b, static_cast<uint32_t>(len));
+    b.insert(b.end(), data, data + len);
+    return b;
+}
+
+std::vector<uint8_t> NetworkManager::buildPieceRequestFrame(msg::ImageOwnerKind kind, uint64_t id, uint64_t total,
+                                                            const std::vector<uint32_t>& indices)
+{
+    auto b = BufferPool::instance().acquire(1 + 1 + 8 + 8 + 4 + indices.size() * 4);
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::PieceRequest));
+    Serializer::serializeUInt8(b, static_cast<uint8_t>(kind));
+    Serializer::serializeUInt64(b, id);
+    Serializer::serializeUInt64(b, total);
+    Serializer::serializeUInt32(b, static_cast<uint32_t>(indices.size()));
+    for (auto i : indices)
+        Serializer::serializeUInt32(b, i);
+    return b;
+}
+
+// Between the meta and the commit, in place of the ImageChunk frames. Pieces seeded to us come
+// from the GM on its own; the rest are asked from their seeders right away (they answer as soon
+// as they hold the piece), or from the GM when there's no open link to that seeder.
+void NetworkManager::handleImageManifest(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 1 + 8 + 8 + 4 + 32 + 4))
+    {
+        off = b.size();
+        return;
+    }
+    auto kind = static_cast<msg::ImageOwnerKind>(Serializer::deserializeUInt8(b, off));
+    const uint64_t id = Serializer::deserializeUInt64(b, off);
+    if (!isGmPeer(decodingFrom_))
+    {
+        // only the GM hands out pieces and seeders; a player's manifest could point us at anything
+        Logger::instance().log("localtunnel", Logger::Level::Warn,
+                               "ImageManifest: id=" + std::to_string(id) + " not from the GM, ignored");
+        off = b.size();
+        return;
+    }
+
+    auto sw = std::make_unique<SwarmRx>();
+    auto& m = sw->manifest;
+    m.total = Serializer::deserializeUInt64(b, off);
+    m.pieceSize = Serializer::deserializeUInt32(b, off);
+    std::memcpy(m.contentHash.data(), b.data() + off, m.contentHash.size());
+    off += m.contentHash.size();
+    const uint32_t count = Serializer::deserializeUInt32(b, off);
+    if (m.pieceSize == 0 || count != (m.total + m.pieceSize - 1) / m.pieceSize ||
+        !ensureRemaining(b, off, size_t(count) * sizeof(ImageManifest::PieceHash) + 4))
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Error, "ImageManifest: malformed id=" + std::to_string(id));
+        off = b.size();
+        return;
+    }
+    m.pieceHashes.resize(count);
+    for (auto& h : m.pieceHashes)
+    {
+        std::memcpy(h.data(), b.data() + off, h.size());
+        off += h.size();
+    }
+    // the GM names only peers it's linked to, and so are we, give or take one joining
+    const uint32_t seeders = Serializer::deserializeUInt32(b, off);
+    if (seeders > peers.snapshot().size() + 8)
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Error, "ImageManifest: too many seeders id=" + std::to_string(id));
+        off = b.size();
+        return;
+    }
+    for (uint32_t i = 0; i < seeders; ++i)
+    {
+        const int len = ensureRemaining(b, off, 4) ? Serializer::deserializeInt(b, off) : -1;
+        if (len < 0 || !ensureRemaining(b, off, static_cast<size_t>(len)))
+        {
+            Logger::instance().log("localtunnel", Logger::Level::Error, "ImageManifest: malformed seeders id=" + std::to_string(id));
+            off = b.size();
+            return;
+        }
+        m.seeders.emplace_back(b.begin() + off, b.begin() + off + len);
+        off += static_cast<size_t>(len);
+    }
+    if (m.seeders.empty())
+        return;
+
+    sw->gmPeerId = peerRegistry_.peerId(decodingFrom_);
+    sw->have.assign(count, false);
+    sw->lastProgressMs = nowMs();
+
+    std::unordered_map<std::string, std::vector<uint32_t>> asks; // peer -> pieces
+    {
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        if (imagesRefused_.count(id))
+            return;
+        auto it = imagesRx_.find(id);
+        if (it == imagesRx_.end() || it->second.kind != kind || it->second.total != m.total || m.total == 0)
+        {
+            Logger::instance().log("localtunnel", Logger::Level::Warn, "ImageManifest: no matching meta id=" + std::to_string(id));
+            return;
+        }
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const auto& seeder = m.seederOf(i);
+            if (seeder == myPeerId_)
+                continue;
+            auto link = peers.find(seeder);
+            asks[(link && link->isConnected()) ? seeder : sw->gmPeerId].push_back(i);
+        }
+        if (swarmPeers_.size() >= kMaxSwarmPeers)
+            swarmPeers_.clear();
+        const auto& allowed = swarmPeers_[id] = std::unordered_set<std::string>(m.seeders.begin(), m.seeders.end());
+        // other players' requests that beat our manifest here
+        if (auto early = earlyPieceRequests_.find(id); early != earlyPieceRequests_.end())
+        {
+            for (auto& [pid, indices] : early->second)
+            {
+                if (!allowed.count(pid))
+                    continue;
+                for (auto i : indices)
+                    if (i < count)
+                        sw->waiters[i].push_back(pid);
+            }
+            earlyPieceRequests_.erase(early);
+        }
+        it->second.swarm = std::move(sw);
+    }
+
+    for (auto& [pid, indices] : asks)
+    {
+        auto frame = buildPieceRequestFrame(kind, id, m.total, indices);
+        sendGameTo(pid, frame);
+        BufferPool::instance().release(std::move(frame));
+    }
+}
+
+void NetworkManager::handleImagePiece(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 1 + 8 + 4 + 4))
+    {
+        off = b.size();
+        return;
+    }
+    auto kind = static_cast<msg::ImageOwnerKind>(Serializer::deserializeUInt8(b, off));
+    const uint64_t id = Serializer::deserializeUInt64(b, off);
+    const uint32_t index = Serializer::deserializeUInt32(b, off);
+    const uint32_t len = Serializer::deserializeUInt32(b, off);
+    if (!ensureRemaining(b, off, len))
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Error, "ImagePiece: underrun id=" + std::to_string(id));
+        off = b.size();
+        return;
+    }
+    const uint8_t* data = b.data() + off;
+    off += len;
+
+    const auto sender = peerRegistry_.peerId(decodingFrom_);
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> out; // relays to waiters, or a re-ask
+    bool fromPeer = false;
+    size_t relayed = 0;
+
+    // Hashing runs outside imagesMtx_: look up what the piece should be, check it, then lock again
+    // to store it. The same goes for the content hash once the last piece is in.
+    const SwarmRx* swarmRx = nullptr;
+    ImageManifest::PieceHash expected{};
+    size_t expectedLen = 0;
+    std::string gmPeerId;
+    uint64_t total = 0;
+    {
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        auto it = imagesRx_.find(id);
+        if (it == imagesRx_.end() || !it->second.swarm || it->second.kind != kind)
+            return;
+        const auto& sw = *it->second.swarm;
+        if (index >= sw.manifest.pieceCount() || sw.have[index])
+            return;
+        swarmRx = it->second.swarm.get();
+        expected = sw.manifest.pieceHashes[index];
+        expectedLen = sw.manifest.pieceLen(index);
+        gmPeerId = sw.gmPeerId;
+        total = it->second.total;
+    }
+
+    if (len != expectedLen || ImageManifest::hashPiece(data, len) != expected)
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Warn,
+                               "ImagePiece: hash mismatch id=" + std::to_string(id) + " piece=" + std::to_string(index) +
+                                   " from " + sender + ", asking the GM");
+        auto frame = buildPieceRequestFrame(kind, id, total, {index});
+        sendGameTo(gmPeerId, frame);
+        BufferPool::instance().release(std::move(frame));
+        std::lock_guard<std::mutex> lk(swarmMtx_);
+        swarmStats_.badPieces++;
+        return;
+    }
+
+    std::vector<uint8_t> whole; // copy of the finished image, hashed unlocked
+    Sha256::Digest contentHash{};
+    {
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        auto it = imagesRx_.find(id);
+        if (it == imagesRx_.end() || it->second.swarm.get() != swarmRx || it->second.kind != kind)
+            return; // replaced while we hashed
+        auto& p = it->second;
+        auto& sw = *p.swarm;
+        if (sw.have[index])
+            return;
+
+        p.buf.write(sw.manifest.pieceOffset(index), data, len);
+        sw.have[index] = true;
+        sw.haveCount++;
+        sw.lastProgressMs = nowMs();
+        p.received += len;
+        fromPeer = sender != sw.gmPeerId;
+        while (p.contiguous < p.total)
+        {
+            const auto next = static_cast<uint32_t>(p.contiguous / sw.manifest.pieceSize);
+            if (!sw.have[next])
+                break;
+            p.contiguous += sw.manifest.pieceLen(next);
+        }
+
+        // whoever asked before it landed
+        if (auto w = sw.waiters.find(index); w != sw.waiters.end())
+        {
+            for (auto& pid : w->second)
+                out.emplace_back(pid, buildImagePieceFrame(kind, id, index, data, len));
+            relayed = w->second.size();
+            sw.waiters.erase(w);
+        }
+
+        if (sw.complete())
+        {
+            // not complete for the commit until sw.verified
+            whole.assign(p.buf.data(), p.buf.data() + p.buf.size());
+            contentHash = sw.manifest.contentHash;
+        }
+        feedStreamingDecode(p);
+    }
+
+    if (!whole.empty())
+    {
+        const bool match = Sha256::of(whole.data(), whole.size()) == contentHash;
+        whole = {};
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        auto it = imagesRx_.find(id);
+        if (it != imagesRx_.end() && it->second.swarm.get() == swarmRx && it->second.swarm->complete())
+        {
+            auto& p = it->second;
+            auto& sw = *p.swarm;
+            if (!match)
+            {
+                // every piece matched, so the manifest itself is off: asking for the pieces again
+                // would fail the same way. Drop the swarm and take the plain chunked transfer.
+                Logger::instance().log("localtunnel", Logger::Level::Error,
+                                       "ImagePiece: content hash mismatch id=" + std::to_string(id) + ", falling back to chunks");
+                out.emplace_back(sw.gmPeerId, buildImageRequestFrame(kind, p.boardId, id));
+                swarmPeers_.erase(id);
+                p.swarm.reset();
+                p.received = 0;
+                p.contiguous = 0;
+                p.decoder.reset();
+            }
+            else
+            {
+                sw.verified = true;
+                p.lastByteMs = nowMs();
+                if (p.isComplete() && p.commitRequested)
+                    tryFinalizeImage(kind, id); // the commit came first
+            }
+        }
+    }
+    keepFinishedImages();
+
+    for (auto& [pid, frame] : out)
+    {
+        sendGameTo(pid, frame);
+        BufferPool::instance().release(std::move(frame));
+    }
+    std::lock_guard<std::mutex> lk(swarmMtx_);
+    if (fromPeer)
+        swarmStats_.piecesFromPeers++;
+    swarmStats_.piecesServed += relayed;
+}
+
+// Served from the transfer in progress (pieces we don't hold yet wait for it), from the
+// finished image in the prefetch cache, or on the GM from its seed copy. Only to peers the GM
+// sent the manifest to.
+void NetworkManager::handlePieceRequest(const std::vector<uint8_t>& b, size_t& off)
+{
+    if (!ensureRemaining(b, off, 1 + 8 + 8 + 4))
+    {
+        off = b.size();
+        return;
+    }
+    auto kind = static_cast<msg::ImageOwnerKind>(Serializer::deserializeUInt8(b, off));
+    const uint64_t id = Serializer::deserializeUInt64(b, off);
+    const uint64_t total = Serializer::deserializeUInt64(b, off);
+    const uint32_t count = Serializer::deserializeUInt32(b, off);
+    if (!ensureRemaining(b, off, size_t(count) * 4))
+    {
+        off = b.size();
+        return;
+    }
+    std::vector<uint32_t> indices(count);
+    for (auto& i : indices)
+        i = Serializer::deserializeUInt32(b, off);
+
+    const auto requester = peerRegistry_.peerId(decodingFrom_);
+    if (requester.empty())
+        return;
+    if (peer_role == Role::GAMEMASTER)
+    {
+        // only the peers the manifest went to; anyone else could pull art of hidden markers
+        std::lock_guard<std::mutex> lk(swarmMtx_);
+        auto seed = swarmSeeds_.find(id);
+        if (seed == swarmSeeds_.end() || !seed->second.recipients.count(requester))
+        {
+            Logger::instance().log("localtunnel", Logger::Level::Warn,
+                                   "PieceRequest: id=" + std::to_string(id) + " from " + requester + ", not a recipient");
+            return;
+        }
+    }
+
+    uint64_t served = 0;
+    auto send = [&](std::vector<uint8_t> frame)
+    {
+        sendGameTo(requester, frame);
+        BufferPool::instance().release(std::move(frame));
+        ++served;
+    };
+
+    std::vector<std::vector<uint8_t>> ready;
+    bool inFlight = false;
+    {
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        auto it = imagesRx_.find(id);
+        if (it != imagesRx_.end() && it->second.swarm && it->second.kind == kind && it->second.total == total)
+        {
+            inFlight = true;
+            auto& p = it->second;
+            auto& sw = *p.swarm;
+            if (std::find(sw.manifest.seeders.begin(), sw.manifest.seeders.end(), requester) == sw.manifest.seeders.end())
+                return; // not in the GM's manifest
+            for (auto i : indices)
+            {
+                if (i >= sw.manifest.pieceCount())
+                    continue;
+                if (sw.have[i])
+                    ready.push_back(buildImagePieceFrame(kind, id, i, p.buf.data() + sw.manifest.pieceOffset(i), sw.manifest.pieceLen(i)));
+                else
+                    sw.waiters[i].push_back(requester);
+            }
+        }
+    }
+    for (auto& frame : ready)
+        send(std::move(frame));
+
+    if (!inFlight)
+    {
+        std::shared_ptr<const std::vector<unsigned char>> bytes;
+        if (peer_role == Role::GAMEMASTER)
+        {
+            bytes = swarmSeedBytes(kind, id, total);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lk(imagesMtx_);
+            auto known = swarmPeers_.find(id);
+            if (known != swarmPeers_.end() && !known->second.count(requester))
+                return; // not in the GM's manifest
+            if (known != swarmPeers_.end())
+                bytes = prefetchCache_.find(kind, id, total);
+            if (!bytes)
+            {
+                // our manifest may still be on its way: answer once it lands, if it names them
+                if (earlyPieceRequests_.size() >= kMaxEarlyPieceRequests)
+                    earlyPieceRequests_.clear();
+                earlyPieceRequests_[id].emplace_back(requester, std::move(indices));
+                return;
+            }
+        }
+        if (!bytes)
+        {
+            Logger::instance().log("localtunnel", Logger::Level::Warn,
+                                   "PieceRequest: id=" + std::to_string(id) + " not held, " + requester + " will fall back");
+            return;
+        }
+        const uint32_t pieceSize = ImageManifest::kPieceSize;
+        for (auto i : indices)
+        {
+            const uint64_t pieceOff = uint64_t(i) * pieceSize;
+            if (pieceOff >= bytes->size())
+                continue;
+            const size_t len = static_cast<size_t>(std::min<uint64_t>(pieceSize, bytes->size() - pieceOff));
+            send(buildImagePieceFrame(kind, id, i, bytes->data() + pieceOff, len));
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(swarmMtx_);
+    swarmStats_.piecesServed += served;
+}
+
+//ON PEER RECEIVING MESSAGE-----------------------------------------------------------
+//void NetworkManager::onDcGameBinary(const std::string& fromPeer, const std::vector<uint8_t>& b)
+//{
+//    size_t off = 0;
+//    while (off < b.size())
+//    {
+//        // Need at least one byte for the type
+//        if (!ensureRemaining(b, off, 1))
+//        {
+//            break;
+//        }
+//
+//        auto type = static_cast<msg::DCType>(b[off]);
+//        off += 1;
+//
+//        switch (type)
+//        {
+//                // -------- SNAPSHOT / BOARD ----------
+//            case msg::DCType::Snapshot_Board:
+//                handleBoardMeta(b, off);
+//                break;
+//
+//                // -------- CREATE MARKER (META) ----------
+//            case msg::DCType::MarkerCreate:
+//                handleMarkerMeta(b, off);
+//                break;
+//
+//                // -------- FOG CREATE (NO IMAGE) ----------
+//            case msg::DCType::FogCreate:
+//                handleFogCreate(b, off);
+//                break;
+//
+//                // -------- IMAGE CHUNK (BOARD or MARKER) ----------
+//            case msg::DCType::ImageChunk:
+//                handleImageChunk(b, off);
+//                break;
+//
+//                // -------- COMMIT BOARD ----------
+//            case msg::DCType::CommitBoard:
+//                handleCommitBoard(b, off);
+//                break;
+//
+//                // -------- COMMIT MARKER ----------
+//            case msg::DCType::CommitMarker:
+//                handleCommitMarker(b, off);
+//                break;
+//
+//                // -------- BOARD OPERATONS - AFTER ENTITIY CREATION ----------
+//            case msg::DCType::MarkerUpdate:
+//                //handlemarkermove(b, off);
+//                break;
+//
+//            case msg::DCType::GridUpdate:
+//                //handlegridupdate(b, off);
+//                break;
+//
+//            case msg::DCType::FogUpdate:
+//                //handleFogUpdate(b, off);
+//                break;
+//            default:
+//                return;
+//        }
+//    }
+//}
+
+//---Message Received Handlers--------------------------------------------------------------------------------
+//
+
+void NetworkManager::handleGridUpdate(const std::vector<uint8_t>& b, size_t& off)
+{
+    // type byte already consumed by the caller switch
+    if (!ensureRemaining(b, off, 8))
+        return;
+
+    msg::ReadyMessage m;
+    m.kind = msg::DCType::GridUpdate;
+    m.boardId = Serializer::deserializeUInt64(b, off);
+    Grid g = Serializer::deserializeGrid(b, off);
+    m.grid = g;
+    inboundGame_.push(std::move(m));
+}
+
+// Called once per frame before inbound messages are applied: everything edited since the last
+// call goes out as one game message of concatenated EntityDelta records.
+void NetworkManager::flushEntityDeltas()
+{
+    auto dirty = deltaTracker_->take();
+    if (dirty.empty())
+        return;
+    if (getConnectedPeerIds().empty())
+        return;
+
+    // one frame per board, each to the peers looking at it
+    struct BoardFrame
+    {
+        std::vector<std::string> ids;
+        std::vector<unsigned char> frame;
+    };
+    std::unordered_map<uint64_t, BoardFrame> byBoard;
+    for (auto& d : dirty)
+    {
+        flecs::entity board = d.entity.has<Board>() ? d.entity : d.entity.parent();
+        if (!board.is_valid() || !board.has<Identifier>())
+            continue;
+        const uint64_t bid = board.get<Identifier>()->id;
+        auto [it, fresh] = byBoard.try_emplace(bid);
+        auto& bf = it->second;
+        if (fresh)
+        {
+            bf.ids = getPeerIdsViewing(bid);
+            bf.frame = BufferPool::instance().acquire();
+        }
+        if (bf.ids.empty())
+            continue; // BoardVersions has it for the catch-up
+        appendEntityDelta(bf.frame, d.entity, d.mask, bf.ids);
+        if (bf.frame.size() >= kDeltaFrameMax)
+        {
+            broadcastGameFrame(bf.frame, bf.ids);
+            bf.frame.clear();
+        }
+    }
+    for (auto& [bid, bf] : byBoard)
+    {
+        if (!bf.frame.empty() && !bf.ids.empty())
+            broadcastGameFrame(bf.frame, bf.ids);
+        BufferPool::instance().release(std::move(bf.frame));
+    }
+}
 
-void NetworkManager::broadcastGridUpdate(uint64_t boardId, const flecs::entity& board)
+bool NetworkManager::appendEntityDelta(std::vector<unsigned char>& out, const flecs::entity& e, uint8_t mask,
+                                       const std::vector<std::string>& toPeerIds)
 {
-    auto ids = getConnectedPeerIds();
-    if (!ids.empty())
-        sendGridUpdate(boardId, board, ids);
+    if (!e.has<Identifier>())
+        return false;
+
+    msg::DeltaEntity kind;
+    flecs::entity board;
+    if (e.has<Board>())
+    {
+        kind = msg::DeltaEntity::Board;
+        board = e;
+        mask &= msg::DeltaGrid;
+    }
+    else if (e.has<MarkerComponent>())
+    {
+        kind = msg::DeltaEntity::Marker;
+        board = e.parent();
+        mask &= msg::DeltaPosition | msg::DeltaSize | msg::DeltaVisibility | msg::DeltaMarkerComponent;
+        // a drag owns the position (MarkerMove/MarkerMoveState)
+        if (const auto* mv = e.get<Moving>(); mv && mv->isDragging)
+            mask &= ~msg::DeltaPosition;
+    }
+    else if (e.has<FogOfWar>())
+    {
+        kind = msg::DeltaEntity::Fog;
+        board = e.parent();
+        mask &= msg::DeltaPosition | msg::DeltaSize | msg::DeltaVisibility;
+    }
+    else
+    {
+        return false;
+    }
+    if (mask == 0 || !board.is_valid() || !board.has<Identifier>())
+        return false;
+
+    const uint64_t boardId = board.get<Identifier>()->id;
+    const uint64_t id = e.get<Identifier>()->id;
+
+    const auto* vis = e.get<Visibility>();
+    if (kind == msg::DeltaEntity::Marker && (mask & msg::DeltaVisibility) && vis && vis->isVisible)
+        sendRevealedMarker(boardId, e, toPeerIds);
+
+    const auto* pos = e.get<Position>();
+    const auto* siz = e.get<Size>();
+    const auto* grid = e.get<Grid>();
+    const auto* mc = e.get<MarkerComponent>();
+    if (!pos)
+        mask &= ~msg::DeltaPosition;
+    if (!siz)
+        mask &= ~msg::DeltaSize;
+    if (!vis)
+        mask &= ~msg::DeltaVisibility;
+    if (!grid)
+        mask &= ~msg::DeltaGrid;
+    if (!mc)
+        mask &= ~msg::DeltaMarkerComponent;
+    if (mask == 0)
+        return false;
+
+    Serializer::serializeUInt8(out, static_cast<uint8_t>(msg::DCType::EntityDelta));
+    Serializer::serializeUInt64(out, boardId);
+    Serializer::serializeUInt64(out, id);
+    Serializer::serializeUInt8(out, static_cast<uint8_t>(kind));
+    Serializer::serializeUInt8(out, mask);
+    if (mask & msg::DeltaPosition)
+        Serializer::serializePosition(out, pos);
+    if (mask & msg::DeltaSize)
+        Serializer::serializeSize(out, siz);
+    if (mask & msg::DeltaVisibility)
+        Serializer::serializeVisibility(out, vis);
+    if (mask & msg::DeltaGrid)
+        Serializer::serializeGrid(out, grid);
+    if (mask & msg::DeltaMarkerComponent)
+        Serializer::serializeMarkerComponent(out, mc);
+    return true;
 }
 
-void NetworkManager::sendGridUpdate(uint64_t boardId, const flecs::entity& board,
-                                    const std::vector<std::string>& toPeerIds)
+// revealed: players that only got a stub need the full marker (art first, at foreground priority)
+void NetworkManager::sendRevealedMarker(uint64_t boardId, const flecs::entity& marker, const std::vector<std::string>& toPeerIds)
 {
-    if (!board.is_valid() || !board.has<Grid>())
+    if (peer_role != Role::GAMEMASTER || !marker.has<Identifier>())
         return;
+    const uint64_t id = marker.get<Identifier>()->id;
 
-    const auto* g = board.get<Grid>();
-    auto frame = buildGridUpdateFrame(boardId, *g);
-    broadcastGameFrame(frame, toPeerIds);
+    std::vector<std::string> stubbed;
+    {
+        std::lock_guard<std::mutex> lk(prefetchMtx_);
+        for (auto& pid : toPeerIds)
+        {
+            auto it = withheldMarkers_.find(pid);
+            if (it != withheldMarkers_.end() && it->second.erase(id))
+                stubbed.push_back(pid);
+        }
+    }
+    if (!stubbed.empty())
+        sendMarker(boardId, marker, stubbed);
 }
 
-std::vector<unsigned char> NetworkManager::buildGridUpdateFrame(uint64_t boardId, const Grid& grid)
+// deleted markers: a stub the player held is gone, there is nothing left to reveal
+void NetworkManager::forgetWithheldMarkers(const std::vector<uint64_t>& ids)
 {
-    std::vector<unsigned char> b;
-    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::GridUpdate));
-    Serializer::serializeUInt64(b, boardId);
-    Serializer::serializeGrid(b, &grid);
-    return b;
+    if (ids.empty())
+        return;
+    std::lock_guard<std::mutex> lk(prefetchMtx_);
+    for (auto it = withheldMarkers_.begin(); it != withheldMarkers_.end();)
+    {
+        for (auto id : ids)
+            it->second.erase(id);
+        if (it->second.empty())
+            it = withheldMarkers_.erase(it);
+        else
+            ++it;
+    }
 }
 
-void NetworkManager::handleGridUpdate(const std::vector<uint8_t>& b, size_t& off)
+// DCType::EntityDelta (109), one record
+void NetworkManager::handleEntityDelta(const std::vector<uint8_t>& b, size_t& off)
 {
-    // type byte already consumed by the caller switch
-    if (!ensureRemaining(b, off, 8))
+    if (!ensureRemaining(b, off, 8 + 8 + 1 + 1))
+    {
+        off = b.size();
         return;
+    }
 
     msg::ReadyMessage m;
-    m.kind = msg::DCType::GridUpdate;
+    m.kind = msg::DCType::EntityDelta;
+    m.fromPeer = decodingFrom_;
     m.boardId = Serializer::deserializeUInt64(b, off);
-    Grid g = Serializer::deserializeGrid(b, off);
-    m.grid = g;
+    const uint64_t id = Serializer::deserializeUInt64(b, off);
+    const auto kind = static_cast<msg::DeltaEntity>(Serializer::deserializeUInt8(b, off));
+    const uint8_t mask = Serializer::deserializeUInt8(b, off);
+    if (kind == msg::DeltaEntity::Marker)
+        m.markerId = id;
+    else if (kind == msg::DeltaEntity::Fog)
+        m.fogId = id;
+
+    // fixed-size fields in mask order, then the MarkerComponent with its two strings
+    size_t need = 0;
+    if (mask & msg::DeltaPosition)
+        need += 4 + 4;
+    if (mask & msg::DeltaSize)
+        need += 4 + 4;
+    if (mask & msg::DeltaVisibility)
+        need += 1;
+    if (mask & msg::DeltaGrid)
+        need += 8 + 4 + 1 + 1 + 1 + 4;
+    if (mask & msg::DeltaMarkerComponent)
+    {
+        size_t at = off + need;
+        for (int i = 0; i < 2; ++i)
+        {
+            if (!ensureRemaining(b, at, 4))
+            {
+                off = b.size();
+                return;
+            }
+            const int len = Serializer::deserializeInt(b, at);
+            if (len < 0 || !ensureRemaining(b, at, static_cast<size_t>(len)))
+            {
+                off = b.size();
+                return;
+            }
+            at += static_cast<size_t>(len);
+        }
+        need = at - off + 1 + 1;
+    }
+    if (!ensureRemaining(b, off, need))
+    {
+        off = b.size();
+        return;
+    }
+
+    if (mask & msg::DeltaPosition)
+        m.pos = Serializer::deserializePosition(b, off);
+    if (mask & msg::DeltaSize)
+        m.size = Serializer::deserializeSize(b, off);
+    if (mask & msg::DeltaVisibility)
+        m.vis = Serializer::deserializeVisibility(b, off);
+    if (mask & msg::DeltaGrid)
+        m.grid = Serializer::deserializeGrid(b, off);
+    if (mask & msg::DeltaMarkerComponent)
+        m.markerComp = Serializer::deserializeMarkerComponent(b, off);
     inboundGame_.push(std::move(m));
 }
 
@@ -1952,16 +5043,22 @@ void NetworkManager::handleBoardMeta(const std::vector<uint8_t>& b, size_t& off)
     bm.size = Serializer::deserializeSize(b, off);
     uint64_t total = Serializer::deserializeUInt64(b, off); // 0 if no image
 
+    std::lock_guard<std::mutex> lk(imagesMtx_);
     auto& p = imagesRx_[bm.boardId];
+    releaseImageRx(p); // re-sent meta for the same id
     p.kind = msg::ImageOwnerKind::Board;
     p.id = bm.boardId;
     p.boardId = bm.boardId;
     p.boardMeta = bm;
     p.total = total;
     p.received = 0;
-    p.buf.clear();
-    if (total)
-        p.buf.resize(static_cast<size_t>(total));
+    if (total && !reserveImageRx(p, total))
+    {
+        imagesRx_.erase(bm.boardId);
+        imagesRefused_.insert(bm.boardId);
+        return;
+    }
+    imagesRefused_.erase(bm.boardId);
 }
 
 // DCType::CreateEntity (4)
@@ -1977,16 +5074,79 @@ void NetworkManager::handleMarkerMeta(const std::vector<uint8_t>& b, size_t& off
     mm.mov = Serializer::deserializeMoving(b, off);
     uint64_t total = Serializer::deserializeUInt64(b, off); // 0 if no image
 
+    std::lock_guard<std::mutex> lk(imagesMtx_);
     auto& p = imagesRx_[mm.markerId];
+    releaseImageRx(p);
     p.kind = msg::ImageOwnerKind::Marker;
     p.id = mm.markerId;
     p.boardId = mm.boardId;
     p.markerMeta = mm;
     p.total = total;
     p.received = 0;
-    p.buf.clear();
-    if (total)
-        p.buf.resize(static_cast<size_t>(total));
+    if (total && !reserveImageRx(p, total))
+    {
+        imagesRx_.erase(mm.markerId);
+        imagesRefused_.insert(mm.markerId);
+        return;
+    }
+    imagesRefused_.erase(mm.markerId);
+}
+
+// Picks the backing for an incoming image: heap while under budget, mmapped temp file above
+// the spill threshold (or when the heap budget is used up), refused past the hard limit.
+bool NetworkManager::reserveImageRx(PendingImage& p, uint64_t total)
+{
+    if (total > kRxHardLimit)
+    {
+        rxStats_.refusedCount++;
+        Logger::instance().log("localtunnel", Logger::Level::Warn,
+                               "ImageRx: refused id=" + std::to_string(p.id) + " total=" + std::to_string(total) +
+                                   " (hard limit " + std::to_string(kRxHardLimit) + ")");
+        pushStatusToast("Refused oversized image transfer (" + std::to_string(total >> 20) + " MB)",
+                        ImGuiToaster::Level::Warning, 5.0f);
+        return false;
+    }
+
+    const size_t n = static_cast<size_t>(total);
+    const bool fitsInMemory = rxStats_.memBytes + total <= kRxMemBudget;
+    if (total > kRxSpillThreshold || !fitsInMemory)
+    {
+        if (p.buf.allocateOnDisk(n))
+        {
+            rxStats_.spillBytes += total;
+            rxStats_.spilledCount++;
+            Logger::instance().log("localtunnel", Logger::Level::Info,
+                                   "ImageRx: spilling id=" + std::to_string(p.id) + " total=" + std::to_string(total) + " to temp file");
+            return true;
+        }
+        // disk failed, heap is still fine if there's room
+    }
+
+    if (fitsInMemory && p.buf.allocateInMemory(n))
+    {
+        rxStats_.memBytes += total;
+        rxStats_.peakMemBytes = std::max(rxStats_.peakMemBytes, rxStats_.memBytes);
+        return true;
+    }
+
+    rxStats_.refusedCount++;
+    Logger::instance().log("localtunnel", Logger::Level::Error,
+                           "ImageRx: no backing for id=" + std::to_string(p.id) + " total=" + std::to_string(total));
+    return false;
+}
+
+void NetworkManager::releaseImageRx(PendingImage& p)
+{
+    p.decoder.reset(); // stop reading the spool before it goes away
+    p.contiguous = 0;
+    p.swarm.reset();
+    if (p.buf.empty())
+        return;
+    if (p.buf.isSpilled())
+        rxStats_.spillBytes -= p.buf.size();
+    else
+        rxStats_.memBytes -= p.buf.size();
+    p.buf.reset();
 }
 
 // DCType::FogCreate (7)
@@ -2005,6 +5165,9 @@ void NetworkManager::handleFogCreate(const std::vector<uint8_t>& b, size_t& off)
 void NetworkManager::handleCommitBoard(const std::vector<uint8_t>& b, size_t& off)
 {
     uint64_t boardId = Serializer::deserializeUInt64(b, off);
+    std::unique_lock<std::mutex> lk(imagesMtx_);
+    if (imagesRefused_.erase(boardId))
+        return;
 
     auto it = imagesRx_.find(boardId);
     if (it == imagesRx_.end())
@@ -2019,6 +5182,8 @@ void NetworkManager::handleCommitBoard(const std::vector<uint8_t>& b, size_t& of
 
     it->second.commitRequested = true;
     tryFinalizeImage(msg::ImageOwnerKind::Board, boardId);
+    lk.unlock();
+    keepFinishedImages();
 }
 
 void NetworkManager::handleImageChunk(const std::vector<uint8_t>& b, size_t& off)
@@ -2047,6 +5212,13 @@ void NetworkManager::handleImageChunk(const std::vector<uint8_t>& b, size_t& off
         return;
     }
 
+    std::lock_guard<std::mutex> lk(imagesMtx_);
+    if (imagesRefused_.count(id))
+    {
+        off += static_cast<size_t>(len);
+        return;
+    }
+
     auto it = imagesRx_.find(id);
     if (it == imagesRx_.end())
     {
@@ -2075,9 +5247,17 @@ void NetworkManager::handleImageChunk(const std::vector<uint8_t>& b, size_t& off
         return;
     }
 
-    std::memcpy(p.buf.data() + off64, b.data() + off, static_cast<size_t>(len));
+    p.buf.write(off64, b.data() + off, static_cast<size_t>(len));
     off += static_cast<size_t>(len);
     p.received += static_cast<uint64_t>(len);
+    if (off64 == p.contiguous)
+        p.contiguous += static_cast<uint64_t>(len);
+    if (p.isComplete())
+    {
+        p.lastByteMs = nowMs();
+        p.contiguous = p.total; // out-of-order chunks are all in now
+    }
+    feedStreamingDecode(p);
 
     // Occasional progress log (e.g., every ~1MB)
     if ((p.received % (1u << 20)) < static_cast<uint64_t>(len))
@@ -2088,10 +5268,56 @@ void NetworkManager::handleImageChunk(const std::vector<uint8_t>& b, size_t& off
     }
 }
 
+// Caller holds imagesMtx_.
+// Starts (or feeds) a worker-side decode for big JPEG/PNG transfers so the RGBA is
+// ready right after the last chunk instead of decoding on the UI thread at commit.
+void NetworkManager::feedStreamingDecode(PendingImage& p)
+{
+    if (!p.decoder)
+    {
+        if (HeadlessMode::enabled())
+            return; // the host keeps images as raw bytes
+        if (p.total < kStreamDecodeMinBytes || p.contiguous < 8 || p.buf.empty())
+            return;
+        if (!StreamingImageDecoder::canStream(p.buf.data(), static_cast<size_t>(p.contiguous)))
+            return;
+
+        size_t active = 0;
+        for (auto& [id, other] : imagesRx_)
+            if (other.decoder && !other.decoder->done())
+                ++active;
+        if (active >= kMaxStreamDecoders)
+            return; // falls back to decode on commit
+
+        p.decoder = std::make_unique<StreamingImageDecoder>(p.buf.data(), p.buf.size());
+    }
+    p.decoder->feed(static_cast<size_t>(p.contiguous));
+}
+
+// Commits that arrived before their streaming decode finished get finalized here.
+void NetworkManager::pollStreamingDecodes()
+{
+    {
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        std::vector<std::pair<msg::ImageOwnerKind, uint64_t>> ready;
+        for (auto& [id, p] : imagesRx_)
+        {
+            if (p.decoder && p.decoder->done() && p.commitRequested && p.isComplete())
+                ready.emplace_back(p.kind, id);
+        }
+        for (auto& [kind, id] : ready)
+            tryFinalizeImage(kind, id);
+    }
+    keepFinishedImages();
+}
+
 void NetworkManager::handleCommitMarker(const std::vector<uint8_t>& b, size_t& off)
 {
     uint64_t boardId = Serializer::deserializeUInt64(b, off);
     uint64_t markerId = Serializer::deserializeUInt64(b, off);
+    std::unique_lock<std::mutex> lk(imagesMtx_);
+    if (imagesRefused_.erase(markerId))
+        return;
 
     auto it = imagesRx_.find(markerId);
     if (it == imagesRx_.end())
@@ -2110,13 +5336,16 @@ void NetworkManager::handleCommitMarker(const std::vector<uint8_t>& b, size_t& o
 
     it->second.commitRequested = true;
     tryFinalizeImage(msg::ImageOwnerKind::Marker, markerId);
+    lk.unlock();
+    keepFinishedImages();
 }
 
 void NetworkManager::handleUserNameUpdate(const std::vector<uint8_t>& b, size_t& off)
 {
     msg::ReadyMessage r;
     r.kind = msg::DCType::UserNameUpdate;
-    r.fromPeerId = decodingFromPeer_;
+    r.fromPeer = decodingFrom_;
+    r.fromPeerId = peerRegistry_.peerId(decodingFrom_);
     r.tableId = Serializer::deserializeUInt64(b, off);
 
     // This is UNIQUE ID now:
@@ -2177,26 +5406,37 @@ void NetworkManager::drainEvents()
     {
         if (ev.type == msg::NetEvent::Type::DcOpen)
         {
-            auto it = peers.find(ev.peerId);
-            if (it != peers.end() && it->second)
+            if (auto link = peers.find(ev.peerId))
+            {
+                link->setOpen(ev.label, true);
+            }
+            // first thing on the game channel, so the GM can skip what we already have
+            if (peer_role == Role::PLAYER && ev.label == msg::dc::name::Game)
             {
-                it->second->setOpen(ev.label, true);
+                sendResyncRequest(ev.peerId); // ahead of the inventory the GM waits for
+                sendCacheInventory(ev.peerId);
             }
+            if (ev.label == msg::dc::name::Game)
+                sendBoardView(ev.peerId);
         }
         else if (ev.type == msg::NetEvent::Type::DcClosed)
         {
-            auto it = peers.find(ev.peerId);
-            if (it != peers.end() && it->second)
+            if (auto link = peers.find(ev.peerId))
             {
-                it->second->setOpen(ev.label, false);
-                it->second->markBootstrapReset();
+                link->setOpen(ev.label, false);
+                link->markBootstrapReset();
+                peerViews_.erase(ev.peerId); // unknown again until the next link says
+                releaseDragsOf(peerRegistry_.find(ev.peerId));
+                std::lock_guard<std::mutex> lk(prefetchMtx_);
+                diskHeld_.erase(ev.peerId); // the next link brings a fresh inventory
+                inventoryWaitSince_.erase(ev.peerId);
+                resyncFrom_.erase(ev.peerId);
                 //reconnectPeer(ev.peerId);
             }
         }
         else if (ev.type == msg::NetEvent::Type::PcClosed)
         {
-            auto it = peers.find(ev.peerId);
-            if (it != peers.end() && it->second)
+            if (auto link = peers.find(ev.peerId))
             {
                 //reconnectPeer(ev.peerId);
             }
@@ -2210,9 +5450,9 @@ void NetworkManager::drainEvents()
     // If GM: check if any peer is now fully open → bootstrap once
     if (peer_role == Role::GAMEMASTER)
     {
-        for (auto& [pid, link] : peers)
+        for (auto& [pid, link] : peers.snapshot())
         {
-            if (link && link->allRequiredOpen() && !link->bootstrapSent())
+            if (link && link->allRequiredOpen() && !link->bootstrapSent() && cacheInventoryReady(pid))
             {
                 try
                 {
@@ -2235,39 +5475,150 @@ void NetworkManager::drainEvents()
     }
 }
 
-void NetworkManager::drainInboundRaw(int maxPerTick)
+void NetworkManager::enqueueInbound(msg::InboundRaw&& r)
 {
-    using clock = std::chrono::steady_clock;
-    int processed = 0;
+    recorder_.record(r, peerRegistry_);
+    routeInbound(std::move(r));
+}
 
-    msg::InboundRaw r;
-    while (processed < maxPerTick && inboundRaw_.try_pop(r))
+void NetworkManager::routeInbound(msg::InboundRaw&& r)
+{
+    if (shards_.empty() || shardsStop_.load(std::memory_order_acquire))
     {
-        try
+        BufferPool::instance().release(std::move(r.bytes));
+        return;
+    }
+    auto& shard = *shards_[r.fromPeer % shards_.size()];
+    {
+        std::lock_guard<std::mutex> lk(shard.mtx);
+        shard.q.push_back(std::move(r));
+    }
+    shard.cv.notify_one();
+}
+
+void NetworkManager::decodeInbound(const msg::InboundRaw& r)
+{
+    try
+    {
+        switch (r.channel)
         {
-            if (r.label == msg::dc::name::Game)
-            {
+            case msg::dc::Channel::Game:
                 decodeRawGameBuffer(r.fromPeer, r.bytes);
-            }
-            else if (r.label == msg::dc::name::Chat)
-            {
+                break;
+            case msg::dc::Channel::Chat:
                 decodeRawChatBuffer(r.fromPeer, r.bytes);
-            }
-            else if (r.label == msg::dc::name::Notes)
-            {
+                break;
+            case msg::dc::Channel::Notes:
                 decodeRawNotesBuffer(r.fromPeer, r.bytes);
-            }
-            else if (r.label == msg::dc::name::MarkerMove)
-            {
-                decodeRawMarkerMoveBuffer(r.fromPeer, r.bytes); // coalesce into moveLatest_
-            }
+                break;
+            case msg::dc::Channel::MarkerMove:
+                decodeRawMarkerMoveBuffer(r.fromPeer, r.bytes);
+                break;
+            case msg::dc::Channel::ChatMedia:
+                decodeRawChatMediaBuffer(r.fromPeer, r.bytes);
+                break;
+            default:
+                break;
         }
-        catch (...)
+    }
+    catch (const std::exception& e)
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Error, std::string("decodeInbound: ") + e.what());
+    }
+    catch (...)
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Error, "decodeInbound: unknown exception");
+    }
+}
+
+void NetworkManager::decodeShardLoop(DecodeShard& shard)
+{
+    for (;;)
+    {
+        msg::InboundRaw r;
         {
-            // swallow/log
+            std::unique_lock<std::mutex> lk(shard.mtx);
+            shard.cv.wait(lk, [&]
+                          { return shardsStop_.load(std::memory_order_acquire) || !shard.q.empty(); });
+            if (shardsStop_.load(std::memory_order_acquire))
+                return;
+            r = std::move(shard.q.front());
+            shard.q.pop_front();
         }
-        ++processed;
+        const auto t0 = std::chrono::steady_clock::now();
+        decodeInbound(r);
+        BufferPool::instance().release(std::move(r.bytes));
+        shard.busyUs.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count()),
+                               std::memory_order_relaxed);
+        shard.decoded.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+size_t NetworkManager::inboundRawDepth() const
+{
+    size_t n = 0;
+    for (auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lk(shard->mtx);
+        n += shard->q.size();
+    }
+    return n;
+}
+
+std::vector<uint64_t> NetworkManager::decodeShardCounts() const
+{
+    std::vector<uint64_t> out;
+    out.reserve(shards_.size());
+    for (auto& shard : shards_)
+        out.push_back(shard->decoded.load(std::memory_order_relaxed));
+    return out;
+}
+
+std::vector<double> NetworkManager::decodeShardBusyMs() const
+{
+    std::vector<double> out;
+    out.reserve(shards_.size());
+    for (auto& shard : shards_)
+        out.push_back(static_cast<double>(shard->busyUs.load(std::memory_order_relaxed)) / 1000.0);
+    return out;
+}
+
+bool NetworkManager::startCapture(const std::filesystem::path& file)
+{
+    return recorder_.start(file);
+}
+
+void NetworkManager::stopCapture()
+{
+    recorder_.stop();
+}
+
+bool NetworkManager::startReplay(const std::filesystem::path& file, bool realtime)
+{
+    stopReplay();
+    if (!replaySandbox_)
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Error, "Replay: refused on a live session, use a ReplaySandbox");
+        return false;
     }
+    if (!std::filesystem::exists(file))
+        return false;
+    replayer_ = std::make_unique<SessionReplayer>(
+        file, realtime,
+        [this](const std::string& peerId, msg::dc::Channel channel, std::vector<uint8_t>&& bytes)
+        {
+            while (inboundRawDepth() > kReplayMaxQueued && !shardsStop_.load())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            // straight in: the capture already holds the timing the link had, and the sim is
+            // process-wide, so a live session's settings must not bend the replay
+            routeInbound(msg::InboundRaw{peerRegistry_.intern(peerId), channel, std::move(bytes)});
+        });
+    return true;
+}
+
+void NetworkManager::stopReplay()
+{
+    replayer_.reset();
 }
 
 //void NetworkManager::drainInboundRaw(int maxPerTick)
@@ -2304,7 +5655,7 @@ void NetworkManager::drainInboundRaw(int maxPerTick)
 //}
 
 // NetworkManager.cpp
-//void NetworkManager::decodeRawChatBuffer(const std::string& fromPeer,
+//void NetworkManager::decodeRawChatBuffer(msg::PeerHandle fromPeer,
 //                                         const std::vector<uint8_t>& b)
 //{
 //    size_t off = 0;
@@ -2401,7 +5752,8 @@ void NetworkManager::decodeRawChatBuffer(const std::string& fromPeer,
             msg::Json j = msg::Json::parse(s);
 
             msg::ReadyMessage r;
-            r.fromPeerId = fromPeer;
+            r.fromPeer = fromPeer;
+            r.fromPeerId = peerRegistry_.peerId(fromPeer);
 
             // type
             msg::DCType t;
@@ -2447,6 +5799,12 @@ void NetworkManager::decodeRawChatBuffer(const std::string& fromPeer,
                         r.name = j["username"].get<std::string>();
                     if (j.contains("text"))
                         r.text = j["text"].get<std::string>();
+                    if (j.contains("image"))
+                    {
+                        msg::ChatImageRef ref;
+                        if (msg::chatImageFromJson(j["image"], ref) && ref.size <= msg::kChatImageMaxBytes)
+                            r.chatImage = ref;
+                    }
                     break;
                 }
                 default:
@@ -2464,7 +5822,7 @@ void NetworkManager::decodeRawChatBuffer(const std::string& fromPeer,
     }
 }
 
-void NetworkManager::decodeRawNotesBuffer(const std::string& fromPeer, const std::vector<uint8_t>& b)
+void NetworkManager::decodeRawNotesBuffer(msg::PeerHandle fromPeer, const std::vector<uint8_t>& b)
 {
     size_t off = 0;
     while (off < b.size())
@@ -2499,52 +5857,42 @@ void NetworkManager::decodeRawNotesBuffer(const std::string& fromPeer, const std
         }
     }
 }
-void NetworkManager::startRawDrainWorker()
+void NetworkManager::startDecodeShards()
 {
-    bool expected = false;
-    if (!rawWorkerRunning_.compare_exchange_strong(expected, true))
-        return; // already running
-
-    rawWorkerStop_.store(false);
-    rawWorker_ = std::thread([this]()
-                             {
-        using clock = std::chrono::steady_clock;
-        auto lastFlush = clock::now();
-        for (;;) {
-            if (rawWorkerStop_.load())
-                break;
-
-            bool didWork = false;
-
-            msg::InboundRaw r;
-            if (inboundRaw_.try_pop(r)) {
-                try {
-                    if (r.label == msg::dc::name::Game) {
-                        decodeRawGameBuffer(r.fromPeer, r.bytes);
-                    } else if (r.label == msg::dc::name::Chat) {
-                        decodeRawChatBuffer(r.fromPeer, r.bytes);
-                    } else if (r.label == msg::dc::name::Notes) {
-                        decodeRawNotesBuffer(r.fromPeer, r.bytes);
-                    } else if (r.label == msg::dc::name::MarkerMove) {
-                        decodeRawMarkerMoveBuffer(r.fromPeer, r.bytes);
-                    }
-                } catch (...) {
-                    // swallow
-                }
-                didWork = true;
-            }
-            
-        } });
+    if (!shards_.empty())
+        return;
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned count = std::clamp(hw / 2, 1u, kMaxDecodeShards);
+
+    shardsStop_.store(false);
+    shards_.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+        shards_.push_back(std::make_unique<DecodeShard>());
+    for (auto& shard : shards_)
+    {
+        DecodeShard* sp = shard.get();
+        sp->worker = std::thread([this, sp]()
+                                 { decodeShardLoop(*sp); });
+    }
 }
 
-void NetworkManager::stopRawDrainWorker()
+// Joins the workers; the shard objects stay so late enqueueInbound calls find them (and drop).
+void NetworkManager::stopDecodeShards()
 {
-    if (!rawWorkerRunning_.load())
-        return;
-    rawWorkerStop_.store(true);
-    if (rawWorker_.joinable())
-        rawWorker_.join();
-    rawWorkerRunning_.store(false);
+    shardsStop_.store(true, std::memory_order_release);
+    for (auto& shard : shards_)
+    {
+        {
+            std::lock_guard<std::mutex> lk(shard->mtx);
+            for (auto& r : shard->q)
+                BufferPool::instance().release(std::move(r.bytes));
+            shard->q.clear();
+        }
+        shard->cv.notify_all();
+    }
+    for (auto& shard : shards_)
+        if (shard->worker.joinable())
+            shard->worker.join();
 }
 
 void NetworkManager::bootstrapPeerIfReady(const std::string& peerId)
@@ -2561,12 +5909,29 @@ void NetworkManager::bootstrapPeerIfReady(const std::string& peerId)
         throw std::exception("[NetworkManager] BoardManager Expired!!");
     }
 
-    auto it = peers.find(peerId);
-    if (it == peers.end() || !it->second)
+    auto link = peers.find(peerId);
+    if (!link)
         return;
-    auto& link = it->second;
     if (link->bootstrapSent())
         return; // one-shot per connection
+    // fresh link: whatever the old one knew the player held may be gone
+    std::optional<SeenState> resync;
+    {
+        std::lock_guard<std::mutex> lk(prefetchMtx_);
+        prefetchSent_.erase(peerId);
+        withheldMarkers_.erase(peerId);
+        inventoryWaitSince_.erase(peerId);
+        if (auto it = resyncFrom_.find(peerId); it != resyncFrom_.end())
+        {
+            resync = it->second;
+            resyncFrom_.erase(it);
+        }
+    }
+    {
+        auto& view = peerViews_[peerId];
+        view.held.clear();
+        view.pendingSwitch = 0;
+    }
     if (gm->active_game_table.is_valid() && gm->active_game_table.has<GameTable>())
     {
         sendGameTable(gm->active_game_table, {peerId});
@@ -2578,22 +5943,40 @@ void NetworkManager::bootstrapPeerIfReady(const std::string& peerId)
         auto boardEnt = bm->getActiveBoard();
         if (boardEnt.is_valid() && boardEnt.has<Board>())
         {
-            sendBoard(boardEnt, {peerId}); // this sends meta + image chunks + commit
-            Logger::instance().log("localtunnel", Logger::Level::Info, "SentBoard");
+            // a reconnecting player that still has this board only gets what changed meanwhile
+            if (resync && resync->boardId == boardEnt.get<Identifier>()->id && sendBoardResync(boardEnt, peerId, *resync))
+            {
+                peerViews_[peerId].held[resync->boardId] = HeldBoard{boardEnt.id(), 0};
+                Logger::instance().log("localtunnel", Logger::Level::Info, "ResyncedBoard");
+            }
+            else
+            {
+                sendBoard(boardEnt, {peerId}); // this sends meta + image chunks + commit
+                Logger::instance().log("localtunnel", Logger::Level::Info, "SentBoard");
+            }
+            const uint64_t bid = boardEnt.get<Identifier>()->id;
+            auto frame = buildStateVersionFrame(msg::DCType::StateVersion, SeenState{boardVersions_->historyId(), bid, boardVersions_->version(bid)});
+            sendGameTo(peerId, frame);
+            BufferPool::instance().release(std::move(frame));
         }
     }
 
     link->markBootstrapSent();
+    link->markPhase(PeerLink::Phase::Bootstrap);
+    logConnectPhases(peerId, *link);
+
+    schedulePrefetch(peerId, prefetchBoardOrder(), /*front=*/false);
 }
 
+// Caller holds imagesMtx_.
 void NetworkManager::tryFinalizeImage(msg::ImageOwnerKind kind, uint64_t id)
 {
     auto it = imagesRx_.find(id);
     if (it == imagesRx_.end())
         return;
     auto& p = it->second;
-    if (!p.commitRequested || !p.isComplete())
-        return;
+    if (!p.commitRequested || (p.total > 0 && !p.isComplete()))
+        return; // total 0 with meta: image-less stub (hidden marker)
 
     msg::ReadyMessage m;
     if (kind == msg::ImageOwnerKind::Board)
@@ -2612,7 +5995,62 @@ void NetworkManager::tryFinalizeImage(msg::ImageOwnerKind kind, uint64_t id)
         m.boardId = p.boardId; // for markers we also stored the boardId
         m.markerMeta = p.markerMeta;
     }
-    m.bytes = std::move(p.buf);
+    if (p.decoder)
+    {
+        if (!p.decoder->done())
+            return; // pollStreamingDecodes picks it up
+        if (p.decoder->succeeded())
+            m.decoded = p.decoder->take();
+    }
+    m.lastByteMs = p.lastByteMs;
+
+    KeptImage kept;
+    const bool toDisk = peer_role != Role::GAMEMASTER && diskCache_ && !p.fromDiskCache && !p.buf.empty();
+    // only images others may still ask this player for: a missed prefetch, or a swarm image it keeps seeding
+    const bool toPrefetch = peer_role != Role::GAMEMASTER && (p.prefetched || p.swarm) && !p.buf.empty() && !p.buf.isSpilled();
+    if (!m.decoded || toDisk || toPrefetch)
+    {
+        // one buffer shared by the texture upload and the caches, nothing is copied under imagesMtx_
+        p.decoder.reset();
+        std::shared_ptr<const uint8_t> view;
+        const size_t size = p.buf.size();
+        if (p.buf.isSpilled())
+        {
+            // the decoder reads the mapped file itself, no heap copy of a spilled image
+            rxStats_.spillBytes -= size;
+            view = p.buf.shareMapped();
+        }
+        else if (toDisk || toPrefetch)
+        {
+            rxStats_.memBytes -= size;
+            auto bytes = std::make_shared<const std::vector<uint8_t>>(p.buf.takeBytes());
+            view = std::shared_ptr<const uint8_t>(bytes, bytes->data());
+            if (toPrefetch)
+                kept.prefetch = std::move(bytes);
+        }
+        else
+        {
+            rxStats_.memBytes -= size;
+            m.bytes = p.buf.takeBytes();
+        }
+        if (view && !m.decoded)
+        {
+            m.mappedSize = size;
+            m.mapped = view;
+        }
+        if (toDisk)
+        {
+            kept.data = std::move(view);
+            kept.size = size;
+        }
+    }
+    if (kept.prefetch || kept.data)
+    {
+        kept.kind = kind;
+        kept.id = id;
+        keptImages_.push_back(std::move(kept));
+    }
+    releaseImageRx(p);
     inboundGame_.push(std::move(m));
 
     Logger::instance().log("localtunnel", Logger::Level::Info,
@@ -2623,39 +6061,38 @@ void NetworkManager::tryFinalizeImage(msg::ImageOwnerKind kind, uint64_t id)
     imagesRx_.erase(it);
 }
 
+// Called by whoever ran tryFinalizeImage, after letting go of imagesMtx_.
+void NetworkManager::keepFinishedImages()
+{
+    std::vector<KeptImage> kept;
+    {
+        std::lock_guard<std::mutex> lk(imagesMtx_);
+        kept.swap(keptImages_);
+    }
+    for (auto& k : kept)
+    {
+        if (k.prefetch)
+            prefetchCache_.put(k.kind, k.id, std::move(k.prefetch)); // the next switch to it is free again
+        if (k.data && diskCache_)
+            diskCache_->store(std::move(k.data), k.size); // and the next session skips it
+    }
+}
+
 // ---------- GAME FRAME BUILDERS ----------
 
 std::vector<unsigned char> NetworkManager::buildMarkerDeleteFrame(uint64_t boardId, uint64_t markerId)
 {
-    std::vector<unsigned char> b;
+    auto b = BufferPool::instance().acquire();
     Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::MarkerDelete));
     Serializer::serializeUInt64(b, boardId);
     Serializer::serializeUInt64(b, markerId);
     return b;
 }
 
-// ---- FOG UPDATE/DELETE ----
-std::vector<unsigned char> NetworkManager::buildFogUpdateFrame(uint64_t boardId, const flecs::entity& fog)
-{
-    std::vector<unsigned char> b;
-    Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::FogUpdate));
-    Serializer::serializeUInt64(b, boardId);
-
-    const auto id = fog.get<Identifier>()->id;
-    const auto pos = *fog.get<Position>();
-    const auto siz = *fog.get<Size>();
-    const auto vis = *fog.get<Visibility>();
-
-    Serializer::serializeUInt64(b, id);
-    Serializer::serializePosition(b, &pos);
-    Serializer::serializeSize(b, &siz);
-    Serializer::serializeVisibility(b, &vis);
-    return b;
-}
-
+// ---- FOG DELETE ----
 std::vector<unsigned char> NetworkManager::buildFogDeleteFrame(uint64_t boardId, uint64_t fogId)
 {
-    std::vector<unsigned char> b;
+    auto b = BufferPool::instance().acquire();
     Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::FogDelete));
     Serializer::serializeUInt64(b, boardId);
     Serializer::serializeUInt64(b, fogId);
@@ -2664,7 +6101,7 @@ std::vector<unsigned char> NetworkManager::buildFogDeleteFrame(uint64_t boardId,
 
 std::vector<unsigned char> NetworkManager::buildSnapshotGameTableFrame(uint64_t gameTableId, const std::string& name)
 {
-    std::vector<unsigned char> b;
+    auto b = BufferPool::instance().acquire();
     Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::Snapshot_GameTable));
     Serializer::serializeUInt64(b, gameTableId);
     Serializer::serializeString(b, name);
@@ -2673,7 +6110,7 @@ std::vector<unsigned char> NetworkManager::buildSnapshotGameTableFrame(uint64_t
 
 std::vector<unsigned char> NetworkManager::buildSnapshotBoardFrame(const flecs::entity& board, uint64_t imageBytesTotal)
 {
-    std::vector<unsigned char> b;
+    auto b = BufferPool::instance().acquire();
     Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::Snapshot_Board));
 
     // Required components
@@ -2708,7 +6145,7 @@ std::vector<unsigned char> NetworkManager::buildSnapshotBoardFrame(const flecs::
 
 std::vector<unsigned char> NetworkManager::buildCreateMarkerFrame(uint64_t boardId, const flecs::entity& marker, uint64_t imageBytesTotal)
 {
-    std::vector<unsigned char> b;
+    auto b = BufferPool::instance().acquire();
     Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::MarkerCreate));
 
     auto mid = marker.get<Identifier>()->id;
@@ -2734,7 +6171,7 @@ std::vector<unsigned char> NetworkManager::buildCreateMarkerFrame(uint64_t board
 
 std::vector<unsigned char> NetworkManager::buildFogCreateFrame(uint64_t boardId, const flecs::entity& fog)
 {
-    std::vector<unsigned char> b;
+    auto b = BufferPool::instance().acquire();
     Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::FogCreate));
 
     auto fid = fog.get<Identifier>()->id;
@@ -2752,7 +6189,7 @@ std::vector<unsigned char> NetworkManager::buildFogCreateFrame(uint64_t boardId,
 
 std::vector<unsigned char> NetworkManager::buildImageChunkFrame(uint8_t ownerKind, uint64_t id, uint64_t offset, const unsigned char* data, size_t len)
 {
-    std::vector<unsigned char> b;
+    auto b = BufferPool::instance().acquire(1 + 1 + 8 + 8 + 4 + len);
     Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::ImageChunk));
     Serializer::serializeUInt8(b, ownerKind);
     Serializer::serializeUInt64(b, id);
@@ -2765,7 +6202,7 @@ std::vector<unsigned char> NetworkManager::buildImageChunkFrame(uint8_t ownerKin
 
 std::vector<unsigned char> NetworkManager::buildCommitBoardFrame(uint64_t boardId)
 {
-    std::vector<unsigned char> b;
+    auto b = BufferPool::instance().acquire();
     Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::CommitBoard));
     Serializer::serializeUInt64(b, boardId);
     return b;
@@ -2773,7 +6210,7 @@ std::vector<unsigned char> NetworkManager::buildCommitBoardFrame(uint64_t boardI
 
 std::vector<unsigned char> NetworkManager::buildCommitMarkerFrame(uint64_t boardId, uint64_t markerId)
 {
-    std::vector<unsigned char> b;
+    auto b = BufferPool::instance().acquire();
     Serializer::serializeUInt8(b, static_cast<uint8_t>(msg::DCType::CommitMarker));
     Serializer::serializeUInt64(b, boardId);
     Serializer::serializeUInt64(b, markerId);
@@ -2782,16 +6219,16 @@ std::vector<unsigned char> NetworkManager::buildCommitMarkerFrame(uint64_t board
 
 void NetworkManager::sendGameTo(const std::string& peerId, const std::vector<unsigned char>& bytes)
 {
-    auto it = peers.find(peerId);
-    if (it == peers.end() || !it->second)
-        return;
-    it->second->sendGame(bytes);
+    if (auto link = peers.find(peerId))
+        link->sendGame(bytes);
 }
 
 void NetworkManager::broadcastGameFrame(const std::vector<unsigned char>& frame, const std::vector<std::string>& toPeerIds)
 {
+    auto snap = peers.snapshot(); // one version for the whole fan-out
     for (auto& pid : toPeerIds)
     {
-        sendGameTo(pid, frame);
+        if (auto it = snap.find(pid); it != snap.end() && it->second)
+            it->second->sendGame(frame);
     }
 }
@@ -3,16 +3,31 @@
 #include "Message.h"
 #include "Logger.h"
 #include "NetworkUtilities.h"
+#include "BufferPool.h"
+#include "NetSim.h"
+#include <algorithm>
 
 PeerLink::PeerLink(const std::string& id, std::weak_ptr<NetworkManager> parent) :
     peerId(id), network_manager(parent)
 {
     if (auto nm = network_manager.lock())
     {
+        handle_ = nm->peerRegistry().intern(peerId);
         auto config = nm->getRTCConfig();
-        config.iceServers.push_back({"stun:stun.l.google.com:19302"});    // Google
-        config.iceServers.push_back({"stun:stun1.l.google.com:19302"});   // Google alt
-        config.iceServers.push_back({"stun:stun.stunprotocol.org:3478"}); // Community server
+        lanMode_ = nm->isLanMode();
+        if (lanMode_)
+        {
+            // LAN: host candidates only, so gathering never waits on STUN/DNS lookups that
+            // time out on offline networks; bind to the interface that routes to the table
+            if (const auto bind = nm->getLanBindAddress(); !bind.empty())
+                config.bindAddress = bind;
+        }
+        else
+        {
+            config.iceServers.push_back({"stun:stun.l.google.com:19302"});    // Google
+            config.iceServers.push_back({"stun:stun1.l.google.com:19302"});   // Google alt
+            config.iceServers.push_back({"stun:stun.stunprotocol.org:3478"}); // Community server
+        }
         pc = std::make_shared<rtc::PeerConnection>(config);
         setupCallbacks();
     }
@@ -22,6 +37,50 @@ PeerLink::PeerLink(const std::string& id, std::weak_ptr<NetworkManager> parent)
     }
 }
 
+const char* PeerLink::phaseName(Phase p)
+{
+    switch (p)
+    {
+        case Phase::LocalSdp:
+            return "sdp";
+        case Phase::Gathered:
+            return "gather";
+        case Phase::RemoteSdp:
+            return "remote sdp";
+        case Phase::IceConnected:
+            return "ice";
+        case Phase::DcOpen:
+            return "dc";
+        case Phase::Bootstrap:
+            return "bootstrap";
+        default:
+            return "?";
+    }
+}
+
+// first call wins; 0 is reserved for "not reached"
+void PeerLink::markPhase(Phase p)
+{
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - createdAt_).count();
+    uint64_t expected = 0;
+    phaseMs_[static_cast<size_t>(p)].compare_exchange_strong(expected, std::max<uint64_t>(1, static_cast<uint64_t>(ms)),
+                                                             std::memory_order_relaxed);
+}
+
+std::string PeerLink::phaseSummary() const
+{
+    std::string out;
+    for (size_t i = 0; i < static_cast<size_t>(Phase::Count); ++i)
+    {
+        const auto p = static_cast<Phase>(i);
+        const auto ms = phaseMs(p);
+        if (!out.empty())
+            out += " | ";
+        out += std::string(phaseName(p)) + " " + (ms ? std::to_string(ms) : std::string("-"));
+    }
+    return out + " ms" + (lanMode_ ? " (LAN)" : "");
+}
+
 // PeerLink.cpp
 void PeerLink::setDisplayName(std::string n)
 {
@@ -62,19 +121,23 @@ void PeerLink::createChannels()
 
     // Offerer creates channels; answerer gets them in pc->onDataChannel
     auto dcGame = pc->createDataChannel(std::string(msg::dc::name::Game), init);
-    dcs_[std::string(msg::dc::name::Game)] = dcGame;
+    setChannel(std::string(msg::dc::name::Game), dcGame);
     attachChannelHandlers(dcGame, std::string(msg::dc::name::Game));
 
     auto dcChat = pc->createDataChannel(std::string(msg::dc::name::Chat), init);
-    dcs_[std::string(msg::dc::name::Chat)] = dcChat;
+    setChannel(std::string(msg::dc::name::Chat), dcChat);
     attachChannelHandlers(dcChat, std::string(msg::dc::name::Chat));
 
     auto dcNotes = pc->createDataChannel(std::string(msg::dc::name::Notes), init);
-    dcs_[std::string(msg::dc::name::Notes)] = dcNotes;
+    setChannel(std::string(msg::dc::name::Notes), dcNotes);
     attachChannelHandlers(dcNotes, std::string(msg::dc::name::Notes));
 
+    auto dcChatMedia = pc->createDataChannel(std::string(msg::dc::name::ChatMedia), init);
+    setChannel(std::string(msg::dc::name::ChatMedia), dcChatMedia);
+    attachChannelHandlers(dcChatMedia, std::string(msg::dc::name::ChatMedia));
+
     auto dcMarkerMove = pc->createDataChannel(std::string(msg::dc::name::MarkerMove), markerMoveInit);
-    dcs_[std::string(msg::dc::name::MarkerMove)] = dcMarkerMove;
+    setChannel(std::string(msg::dc::name::MarkerMove), dcMarkerMove);
     attachChannelHandlers(dcMarkerMove, std::string(msg::dc::name::MarkerMove));
 }
 
@@ -85,6 +148,7 @@ rtc::Description PeerLink::createOffer()
     init.icePwd = offer.icePwd();     // string
     init.iceUfrag = offer.iceUfrag(); // string
     pc->setLocalDescription(offer.type(), init);
+    markPhase(Phase::LocalSdp);
     return offer;
 }
 
@@ -95,12 +159,14 @@ rtc::Description PeerLink::createAnswer()
     init.icePwd = answer.icePwd();
     init.iceUfrag = answer.iceUfrag();
     pc->setLocalDescription(answer.type(), init);
+    markPhase(Phase::LocalSdp);
     return answer; // Send this via signaling
 }
 
 void PeerLink::setRemoteDescription(const rtc::Description& desc)
 {
     pc->setRemoteDescription(desc);
+    markPhase(Phase::RemoteSdp);
     {
         std::lock_guard<std::mutex> lk(candMx_);
         remoteDescSet_.store(true, std::memory_order_release);
@@ -140,12 +206,18 @@ void PeerLink::setupCallbacks()
             } 
         }
         if (s == rtc::PeerConnection::State::Connected) {
+            markPhase(Phase::IceConnected);
             if (auto nm = network_manager.lock()) {
                 msg::NetEvent ev{msg::NetEvent::Type::PcOpen, peerId, "PC"};
                 nm->events_.push(std::move(ev));
             } 
         } });
 
+    pc->onGatheringStateChange([this](rtc::PeerConnection::GatheringState g)
+                               {
+        if (g == rtc::PeerConnection::GatheringState::Complete)
+            markPhase(Phase::Gathered); });
+
     pc->onLocalDescription([wk = network_manager, id = peerId](rtc::Description desc)
                            {
         if (auto nm = wk.lock()) nm->onPeerLocalDescription(id, desc); });
@@ -157,7 +229,7 @@ void PeerLink::setupCallbacks()
     pc->onDataChannel([this](std::shared_ptr<rtc::DataChannel> ch)
                       {
         const std::string label = ch->label();
-        dcs_[label] = ch;
+        setChannel(label, ch);
         attachChannelHandlers(ch, label);
         std::cout << "[PeerLink] Received DC \"" << label << "\" from " << peerId << "\n"; });
 }
@@ -168,29 +240,47 @@ void PeerLink::setupCallbacks()
 //    it->second->send(&bytes.front(), bytes.size());
 //}
 
-bool PeerLink::sendOn(const std::string& label, std::string_view text)
+void PeerLink::setChannel(const std::string& label, std::shared_ptr<rtc::DataChannel> ch)
 {
+    std::lock_guard<std::mutex> lk(dcsMtx_);
+    dcs_[label] = std::move(ch);
+}
+
+// Sends come from the UI thread and the decode shards while libdatachannel threads add
+// channels, so lookups copy the channel out under the lock and send outside it.
+std::shared_ptr<rtc::DataChannel> PeerLink::channel(const std::string& label) const
+{
+    std::lock_guard<std::mutex> lk(dcsMtx_);
     auto it = dcs_.find(label);
-    if (it == dcs_.end() || !it->second)
-        return false;
-    auto& ch = it->second;
-    if (!ch->isOpen())
+    return it == dcs_.end() ? nullptr : it->second;
+}
+
+bool PeerLink::sendOn(const std::string& label, std::string_view text)
+{
+    auto ch = channel(label);
+    if (!ch || !ch->isOpen())
         return false;
 
     // optional backpressure guard
     // if (ch->bufferedAmount() > kMaxBufferedBytes) return false;
 
+    if (NetSim::instance().engaged() &&
+        NetSim::instance().submit(handle_, msg::dc::channelFromLabel(label), NetSim::Direction::Out, text.size(),
+                                  [weak = std::weak_ptr<rtc::DataChannel>(ch), copy = std::string(text)]()
+                                  {
+                                      if (auto c = weak.lock(); c && c->isOpen())
+                                          c->send(copy);
+                                  }))
+        return true;
+
     ch->send(std::string(text)); // TEXT frame over DC
     return true;
 }
 
 bool PeerLink::sendOn(const std::string& label, const std::vector<uint8_t>& bytes)
 {
-    auto it = dcs_.find(label);
-    if (it == dcs_.end() || !it->second)
-        return false;
-    auto& ch = it->second;
-    if (!ch->isOpen())
+    auto ch = channel(label);
+    if (!ch || !ch->isOpen())
         return false;
 
     //// Optional backpressure guard (avoid unbounded memory use)
@@ -199,13 +289,18 @@ bool PeerLink::sendOn(const std::string& label, const std::vector<uint8_t>& byte
     //    // You can queue locally instead of dropping, if you want
     //    return false;
     //}
-    rtc::binary b;
-    b.resize(bytes.size());
-    if (!bytes.empty())
-    {
-        std::memcpy(b.data(), bytes.data(), bytes.size()); // std::byte is trivially copyable
-    }
-    ch->send(b); // libdatachannel handles SCTP fragmentation
+    // simulated link: the caller recycles its frame, so the held message needs its own copy
+    if (NetSim::instance().engaged() &&
+        NetSim::instance().submit(handle_, msg::dc::channelFromLabel(label), NetSim::Direction::Out, bytes.size(),
+                                  [weak = std::weak_ptr<rtc::DataChannel>(ch), copy = bytes]()
+                                  {
+                                      if (auto c = weak.lock(); c && c->isOpen())
+                                          c->send(reinterpret_cast<const std::byte*>(copy.data()), copy.size());
+                                  }))
+        return true;
+
+    // straight from our buffer, no intermediate rtc::binary copy
+    ch->send(reinterpret_cast<const std::byte*>(bytes.data()), bytes.size()); // libdatachannel handles SCTP fragmentation
     return true;
 }
 bool PeerLink::sendGame(const std::vector<uint8_t>& bytes)
@@ -227,6 +322,11 @@ bool PeerLink::sendMarkerMove(const std::vector<uint8_t>& bytes)
 {
     return sendOn(std::string(msg::dc::name::MarkerMove), bytes);
 }
+
+bool PeerLink::sendChatMedia(const std::vector<uint8_t>& bytes)
+{
+    return sendOn(std::string(msg::dc::name::ChatMedia), bytes);
+}
 void PeerLink::sendChatJson(const std::string& jsonText)
 {
     sendOn(msg::dc::name::Chat, jsonText);
@@ -235,6 +335,7 @@ void PeerLink::sendChatJson(const std::string& jsonText)
 bool PeerLink::allRequiredOpen() const
 {
     // minimal: only require the channel used for snapshots
+    std::lock_guard<std::mutex> lk(dcsMtx_);
     auto it = dcOpen_.find(msg::dc::name::Game);
     return it != dcOpen_.end() && it->second;
 }
@@ -247,53 +348,71 @@ void PeerLink::attachChannelHandlers(const std::shared_ptr<rtc::DataChannel>& dc
     dc->onOpen([this, id = peerId, label]()
                {
                    std::cout << "[PeerLink] DC open \"" << label << "\" to " << id << "\n";
+                   if (label == msg::dc::name::Game)
+                       markPhase(Phase::DcOpen);
                    if (auto nm = network_manager.lock())
                    {
                        msg::NetEvent ev{msg::NetEvent::Type::DcOpen, id, label};
                        nm->events_.push(std::move(ev)); // or nm->notifyDcOpen(id, label);
                    }
-                   dcOpen_[label] = true; });
+                   setOpen(label, true); });
 
     dc->onClosed([this, id = peerId, label]()
                  {
         std::cout << "[PeerLink] DC closed \"" << label << "\" to " << id << "\n";
-        dcOpen_[label] = false;
+        setOpen(label, false);
         bootstrapSent_ = false;
         if (auto nm = network_manager.lock()) {
             msg::NetEvent ev{msg::NetEvent::Type::DcClosed, id, label};
             nm->events_.push(std::move(ev));
         } });
 
-    dc->onMessage([this, id = peerId, label](rtc::message_variant m)
+    dc->onMessage([this, from = handle_, channel = msg::dc::channelFromLabel(label)](rtc::message_variant m)
                   {
-                      Logger::instance().log("localtunnel", Logger::Level::Info, "MESSAGE RECEIVED!! FROM: "+label);
                       if (auto nm = network_manager.lock())
                       {
+                          std::vector<uint8_t> bytes;
                           if (std::holds_alternative<std::string>(m))
                           {
                               const auto& s = std::get<std::string>(m);
-                              std::vector<uint8_t> bytes(s.begin(), s.end());
-                              nm->inboundRaw_.push(msg::InboundRaw{peerId, label, std::move(bytes)});
+                              bytes = BufferPool::instance().acquire(s.size());
+                              bytes.assign(s.begin(), s.end());
                           }
                           else
                           {
                               const auto& bin = std::get<rtc::binary>(m);
-                              std::vector<uint8_t> bytes(bin.size());
-                              std::memcpy(bytes.data(), bin.data(), bin.size());
-                              nm->inboundRaw_.push(msg::InboundRaw{peerId, label, std::move(bytes)});
+                              bytes = BufferPool::instance().acquire(bin.size());
+                              const auto* p = reinterpret_cast<const uint8_t*>(bin.data());
+                              bytes.assign(p, p + bin.size());
                           }
+
+                          if (NetSim::instance().engaged())
+                          {
+                              const size_t size = bytes.size();
+                              auto held = std::make_shared<msg::InboundRaw>(msg::InboundRaw{from, channel, std::move(bytes)});
+                              if (NetSim::instance().submit(from, channel, NetSim::Direction::In, size,
+                                                            [weak = network_manager, held]()
+                                                            {
+                                                                if (auto later = weak.lock())
+                                                                    later->enqueueInbound(std::move(*held));
+                                                            }))
+                                  return;
+                              bytes = std::move(held->bytes);
+                          }
+                          nm->enqueueInbound(msg::InboundRaw{from, channel, std::move(bytes)});
                       } });
 }
 
 bool PeerLink::isConnected() const
 {
     // â€œusableâ€ = PC connected AND at least Game channel open
-    auto it = dcs_.find(std::string(msg::dc::name::Game));
-    return isPcConnectedOnly() && it != dcs_.end() && it->second && it->second->isOpen();
+    auto ch = channel(std::string(msg::dc::name::Game));
+    return isPcConnectedOnly() && ch && ch->isOpen();
 }
 
 bool PeerLink::isDataChannelOpen() const
 {
+    std::lock_guard<std::mutex> lk(dcsMtx_);
     for (auto& [label, ch] : dcs_)
     {
         if (ch && ch->isOpen())
@@ -302,6 +421,14 @@ bool PeerLink::isDataChannelOpen() const
     return false;
 }
 
+size_t PeerLink::bufferedAmount(const std::string& label) const
+{
+    auto ch = channel(label);
+    if (!ch)
+        return 0;
+    return ch->bufferedAmount() + NetSim::instance().queuedBytes(handle_, msg::dc::channelFromLabel(label));
+}
+
 bool PeerLink::isPcConnectedOnly() const
 {
     return pc && pc->state() == rtc::PeerConnection::State::Connected;
@@ -352,9 +479,15 @@ void PeerLink::close()
 
     Logger::instance().log("main", Logger::Level::Debug, "PeerLink::close() begin #" + std::to_string(seq));
 
+    std::unordered_map<std::string, std::shared_ptr<rtc::DataChannel>> movedDcs;
+    {
+        std::lock_guard<std::mutex> lk(dcsMtx_);
+        movedDcs.swap(dcs_);
+    }
+
     try
     {
-        for (auto& [label, ch] : dcs_)
+        for (auto& [label, ch] : movedDcs)
         {
             if (!ch)
                 continue;
@@ -378,9 +511,6 @@ void PeerLink::close()
         // ignore
     }
 
-    std::unordered_map<std::string, std::shared_ptr<rtc::DataChannel>> movedDcs;
-    movedDcs.swap(dcs_);
-
     for (auto& kv : movedDcs)
     {
         NetworkUtilities::safeCloseDataChannel(kv.second);
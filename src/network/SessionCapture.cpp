@@ -0,0 +1,210 @@
+#include "SessionCapture.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    template <class T>
+    void writePod(std::ofstream& out, T v)
+    {
+        out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    template <class T>
+    bool readPod(std::ifstream& in, T& v)
+    {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+    }
+} // namespace
+
+// ---- SessionRecorder ----
+
+bool SessionRecorder::start(const std::filesystem::path& file)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (recording_.load())
+        return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+    out_.open(file, std::ios::binary | std::ios::trunc);
+    if (!out_)
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Error, "SessionRecorder: cannot open " + file.string());
+        return false;
+    }
+    out_.write(capture::kMagic, sizeof(capture::kMagic));
+
+    path_ = file;
+    t0_ = std::chrono::steady_clock::now();
+    introduced_.clear();
+    messages_ = 0;
+    bytes_ = 0;
+    recording_.store(true, std::memory_order_release);
+    Logger::instance().log("localtunnel", Logger::Level::Info, "SessionRecorder: capturing to " + file.string());
+    return true;
+}
+
+void SessionRecorder::stop()
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (!recording_.exchange(false))
+        return;
+    out_.flush();
+    out_.close();
+    Logger::instance().log("localtunnel", Logger::Level::Info,
+                           "SessionRecorder: stopped, " + std::to_string(messages_.load()) + " messages, " +
+                               std::to_string(bytes_.load()) + " bytes");
+}
+
+void SessionRecorder::record(const msg::InboundRaw& r, const PeerRegistry& peers)
+{
+    if (!isRecording())
+        return;
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (!recording_.load())
+        return;
+
+    if (introduced_.insert(r.fromPeer).second)
+    {
+        const std::string peerId = peers.peerId(r.fromPeer);
+        const auto len = static_cast<uint16_t>(std::min<size_t>(peerId.size(), UINT16_MAX));
+        writePod(out_, capture::RecordKind::Peer);
+        writePod(out_, r.fromPeer);
+        writePod(out_, len);
+        out_.write(peerId.data(), len);
+    }
+
+    const auto tUs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0_).count());
+    writePod(out_, capture::RecordKind::Message);
+    writePod(out_, tUs);
+    writePod(out_, r.fromPeer);
+    writePod(out_, r.channel);
+    writePod(out_, static_cast<uint32_t>(r.bytes.size()));
+    out_.write(reinterpret_cast<const char*>(r.bytes.data()), static_cast<std::streamsize>(r.bytes.size()));
+
+    messages_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(r.bytes.size(), std::memory_order_relaxed);
+}
+
+// ---- SessionReplayer ----
+
+SessionReplayer::SessionReplayer(std::filesystem::path file, bool realtime, Sink sink) :
+    file_(std::move(file)), realtime_(realtime), sink_(std::move(sink))
+{
+    std::error_code ec;
+    fileBytes_ = std::filesystem::file_size(file_, ec);
+    if (ec)
+        fileBytes_ = 0;
+    started_ = std::chrono::steady_clock::now();
+    worker_ = std::thread([this]()
+                          { run(); });
+}
+
+SessionReplayer::~SessionReplayer()
+{
+    stop_.store(true);
+    if (worker_.joinable())
+        worker_.join();
+}
+
+double SessionReplayer::progress() const
+{
+    return fileBytes_ ? static_cast<double>(readBytes_.load()) / static_cast<double>(fileBytes_) : 0.0;
+}
+
+double SessionReplayer::elapsedMs() const
+{
+    if (done())
+        return elapsedMs_.load();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started_).count();
+}
+
+void SessionReplayer::run()
+{
+    auto finish = [this](bool ok)
+    {
+        elapsedMs_.store(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started_).count());
+        failed_.store(!ok);
+        done_.store(true, std::memory_order_release);
+    };
+
+    std::ifstream in(file_, std::ios::binary);
+    char magic[sizeof(capture::kMagic)] = {};
+    if (!in || !in.read(magic, sizeof(magic)) || std::memcmp(magic, capture::kMagic, sizeof(magic)) != 0)
+    {
+        Logger::instance().log("localtunnel", Logger::Level::Error, "SessionReplayer: not a capture file " + file_.string());
+        finish(false);
+        return;
+    }
+
+    std::unordered_map<msg::PeerHandle, std::string> peerIds; // capture handle -> peer id
+    while (!stop_.load())
+    {
+        capture::RecordKind kind;
+        if (!readPod(in, kind))
+            break; // clean end of file
+
+        if (kind == capture::RecordKind::Peer)
+        {
+            msg::PeerHandle h = 0;
+            uint16_t len = 0;
+            if (!readPod(in, h) || !readPod(in, len))
+                break;
+            std::string id(len, '\0');
+            if (!in.read(id.data(), len))
+                break;
+            peerIds[h] = std::move(id);
+        }
+        else if (kind == capture::RecordKind::Message)
+        {
+            uint64_t tUs = 0;
+            msg::PeerHandle h = 0;
+            msg::dc::Channel channel{};
+            uint32_t len = 0;
+            if (!readPod(in, tUs) || !readPod(in, h) || !readPod(in, channel) || !readPod(in, len))
+                break;
+            if (len > capture::kMaxMessageBytes)
+            {
+                Logger::instance().log("localtunnel", Logger::Level::Error, "SessionReplayer: oversized record, stopping");
+                finish(false);
+                return;
+            }
+            std::vector<uint8_t> bytes(len);
+            if (!in.read(reinterpret_cast<char*>(bytes.data()), len))
+                break;
+
+            if (realtime_)
+            {
+                const auto due = started_ + std::chrono::microseconds(tUs);
+                while (!stop_.load() && std::chrono::steady_clock::now() < due)
+                    std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                        due - std::chrono::steady_clock::now(), std::chrono::milliseconds(5)));
+            }
+            auto peer = peerIds.find(h);
+            if (peer == peerIds.end())
+            {
+                Logger::instance().log("localtunnel", Logger::Level::Error, "SessionReplayer: message from an unintroduced sender, stopping");
+                finish(false);
+                return;
+            }
+            sink_(peer->second, channel, std::move(bytes));
+            fed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            Logger::instance().log("localtunnel", Logger::Level::Error, "SessionReplayer: corrupt record, stopping");
+            finish(false);
+            return;
+        }
+        readBytes_.store(static_cast<uint64_t>(in.tellg()), std::memory_order_relaxed);
+    }
+
+    Logger::instance().log("localtunnel", Logger::Level::Info,
+                           "SessionReplayer: fed " + std::to_string(fed_.load()) + " messages from " + file_.string());
+    finish(true);
+}
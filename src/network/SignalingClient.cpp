@@ -1,5 +1,6 @@
 #include "SignalingClient.h"
 #include <rtc/rtc.hpp>
+#include <algorithm>
 #include <iostream>
 #include <nlohmann/json.hpp>
 #include "NetworkManager.h"
@@ -21,6 +22,8 @@ bool SignalingClient::connectUrl(const std::string& url)
     cfg.pingInterval = std::chrono::milliseconds(1000);
     cfg.connectionTimeout = std::chrono::milliseconds(0);
     ws = std::make_shared<rtc::WebSocket>(cfg);
+    connectStartedAt_ = Clock::now();
+    authMs_.store(0);
 
     ws->onOpen([=]()
                {
@@ -62,6 +65,8 @@ bool SignalingClient::connect(const std::string& ip, unsigned short port)
     cfg.pingInterval = std::chrono::milliseconds(1000);
     cfg.connectionTimeout = std::chrono::milliseconds(0);
     ws = std::make_shared<rtc::WebSocket>(cfg);
+    connectStartedAt_ = Clock::now();
+    authMs_.store(0);
 
     ws->onOpen([=]()
                {
@@ -143,6 +148,9 @@ void SignalingClient::onMessage(const std::string& msg)
     {
         if (j.value(msg::key::AuthOk, msg::value::False) == msg::value::True)
         {
+            const auto authMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - connectStartedAt_).count();
+            authMs_.store(std::max<uint64_t>(1, static_cast<uint64_t>(authMs)));
+
             // Routing id assigned by the server
             const std::string newPeerId = j.value(std::string(msg::key::ClientId), "");
             // --- bind *self* now that peerId is known ---
@@ -0,0 +1,107 @@
+#include "StreamingImageDecoder.h"
+#include "Logger.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <cstring>
+
+StreamingImageDecoder::StreamingImageDecoder(const uint8_t* data, size_t total) :
+    data_(data), total_(total)
+{
+    worker_ = std::thread([this]()
+                          { run(); });
+}
+
+StreamingImageDecoder::~StreamingImageDecoder()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        abort_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+bool StreamingImageDecoder::canStream(const uint8_t* head, size_t n)
+{
+    static const uint8_t kPng[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    if (n >= 8 && std::memcmp(head, kPng, 8) == 0)
+        return true;
+    if (n >= 3 && head[0] == 0xFF && head[1] == 0xD8 && head[2] == 0xFF) // JPEG SOI
+        return true;
+    return false;
+}
+
+void StreamingImageDecoder::feed(size_t available)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        available_ = std::min(std::max(available_, available), total_);
+    }
+    cv_.notify_one();
+}
+
+int StreamingImageDecoder::readCb(void* user, char* out, int size)
+{
+    auto* self = static_cast<StreamingImageDecoder*>(user);
+    if (size <= 0 || self->pos_ >= self->total_)
+        return 0;
+
+    std::unique_lock<std::mutex> lk(self->mtx_);
+    self->cv_.wait(lk, [self]
+                   { return self->abort_ || self->available_ > self->pos_; });
+    if (self->abort_)
+        return 0; // stb sees EOF and fails out
+
+    const size_t n = std::min(static_cast<size_t>(size), self->available_ - self->pos_);
+    lk.unlock();
+
+    std::memcpy(out, self->data_ + self->pos_, n);
+    self->pos_ += n;
+    return static_cast<int>(n);
+}
+
+void StreamingImageDecoder::skipCb(void* user, int n)
+{
+    auto* self = static_cast<StreamingImageDecoder*>(user);
+    if (n < 0)
+        self->pos_ -= std::min(self->pos_, static_cast<size_t>(-n));
+    else
+        self->pos_ = std::min(self->total_, self->pos_ + static_cast<size_t>(n));
+}
+
+int StreamingImageDecoder::eofCb(void* user)
+{
+    auto* self = static_cast<StreamingImageDecoder*>(user);
+    return self->pos_ >= self->total_ ? 1 : 0;
+}
+
+void StreamingImageDecoder::run()
+{
+    stbi_io_callbacks cb{&StreamingImageDecoder::readCb, &StreamingImageDecoder::skipCb, &StreamingImageDecoder::eofCb};
+
+    // flip flag is global by default; the thread-local one keeps Texture.cpp loads from racing us
+    stbi_set_flip_vertically_on_load_thread(0);
+
+    int w = 0, h = 0, comp = 0;
+    uint8_t* px = stbi_load_from_callbacks(&cb, this, &w, &h, &comp, 4);
+    if (px)
+    {
+        decoded_.width = w;
+        decoded_.height = h;
+        decoded_.rgba = std::shared_ptr<uint8_t>(px, [](uint8_t* p)
+                                                 { stbi_image_free(p); });
+    }
+    else
+    {
+        bool aborted = false;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            aborted = abort_;
+        }
+        if (!aborted)
+            Logger::instance().log("localtunnel", Logger::Level::Warn,
+                                   std::string("StreamingImageDecoder: decode failed, falling back (") + stbi_failure_reason() + ")");
+    }
+    done_.store(true, std::memory_order_release);
+}
@@ -0,0 +1,73 @@
+#include "ImageThumbnail.h"
+#include <algorithm>
+#include <memory>
+// stb lives in RunicCore so the host gets the decoders without the GL renderer files
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+namespace
+{
+    void appendBytes(void* ctx, void* data, int size)
+    {
+        auto* out = static_cast<std::vector<uint8_t>*>(ctx);
+        const auto* p = static_cast<const uint8_t*>(data);
+        out->insert(out->end(), p, p + size);
+    }
+} // namespace
+
+bool ImageThumbnail::make(const uint8_t* data, size_t len, int maxSide, Result& out)
+{
+    stbi_set_flip_vertically_on_load_thread(0);
+    int w = 0, h = 0, comp = 0;
+    std::unique_ptr<uint8_t, void (*)(void*)> src(
+        stbi_load_from_memory(data, static_cast<int>(len), &w, &h, &comp, 4), stbi_image_free);
+    if (!src || w <= 0 || h <= 0)
+        return false;
+    out.width = w;
+    out.height = h;
+
+    // box filter: every thumbnail pixel averages the source block it covers
+    const float scale = std::min(1.0f, float(maxSide) / float(std::max(w, h)));
+    const int tw = std::max(1, int(w * scale));
+    const int th = std::max(1, int(h * scale));
+    std::vector<uint8_t> thumb(size_t(tw) * th * 3);
+    for (int y = 0; y < th; ++y)
+    {
+        const int y0 = y * h / th, y1 = std::max(y0 + 1, (y + 1) * h / th);
+        for (int x = 0; x < tw; ++x)
+        {
+            const int x0 = x * w / tw, x1 = std::max(x0 + 1, (x + 1) * w / tw);
+            uint32_t acc[4] = {0, 0, 0, 0};
+            for (int sy = y0; sy < y1; ++sy)
+            {
+                const uint8_t* row = src.get() + (size_t(sy) * w + x0) * 4;
+                for (int sx = x0; sx < x1; ++sx, row += 4)
+                {
+                    acc[0] += row[0];
+                    acc[1] += row[1];
+                    acc[2] += row[2];
+                    acc[3] += row[3];
+                }
+            }
+            const uint32_t n = uint32_t(y1 - y0) * uint32_t(x1 - x0);
+            const uint32_t a = acc[3] / n;
+            uint8_t* px = &thumb[(size_t(y) * tw + x) * 3];
+            // JPEG has no alpha: flatten onto the chat's dark background
+            for (int c = 0; c < 3; ++c)
+                px[c] = static_cast<uint8_t>((acc[c] / n * a + 32 * (255 - a)) / 255);
+        }
+    }
+
+    out.jpeg.clear();
+    return stbi_write_jpg_to_func(appendBytes, &out.jpeg, tw, th, 3, thumb.data(), 80) != 0;
+}
+
+std::vector<uint8_t> ImageThumbnail::encodePng(const uint8_t* rgba, int width, int height)
+{
+    std::vector<uint8_t> out;
+    if (!stbi_write_png_to_func(appendBytes, &out, width, height, 4, rgba, width * 4))
+        out.clear();
+    return out;
+}
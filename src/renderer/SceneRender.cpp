@@ -0,0 +1,167 @@
+#include "GameTableManager.h"
+#include "BoardManager.h"
+#include "Renderer.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+// The GL draw paths of the managers. Only the desktop build links this file; everything else in
+// them is shared with RunicVTTHost through RunicCore.
+
+void GameTableManager::render(VertexArray& va, IndexBuffer& ib, Shader& shader, Shader& grid_shader, Renderer& renderer)
+{
+    if (isGameTableActive())
+    {
+        chat_manager->render();
+    }
+    if (board_manager->isBoardActive())
+    {
+        if (board_manager->isEditWindowOpen())
+        {
+            board_manager->renderEditWindow();
+        }
+        else
+        {
+            board_manager->setShowEditWindow(false);
+        }
+        board_manager->renderSelectionWindow();
+
+        if (network_manager->getPeerRole() == Role::GAMEMASTER)
+        {
+            board_manager->marker_directory->renderDirectory();
+        }
+        board_manager->renderBoard(va, ib, shader, grid_shader, renderer);
+    }
+}
+
+void BoardManager::renderBoard(VertexArray& va, IndexBuffer& ib, Shader& shader, Shader& grid_shader, Renderer& renderer)
+{
+    auto nm = network_manager.lock();
+    if (!nm)
+        throw std::exception("[BoardManager] Network Manager expired!!");
+
+    const TextureComponent* texture = active_board.get<TextureComponent>();
+    if (texture->textureID != 0)
+    {
+        const Board* board = active_board.get<Board>();
+        const Grid* grid = active_board.get<Grid>();
+        const Size* size = active_board.get<Size>();
+
+        glm::mat4 viewMatrix = camera.getViewMatrix(); // ObtÃ©m a matriz de visualizaÃ§Ã£o da cÃ¢mera (pan/zoom)
+        glm::mat4 projection = camera.getProjectionMatrix();
+        glm::mat4 board_model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f));
+        board_model = glm::scale(board_model, glm::vec3(size->width, size->height, 1.0f));
+
+        shader.Bind();
+        shader.SetUniformMat4f("projection", projection);
+        shader.SetUniformMat4f("view", viewMatrix);
+        shader.SetUniformMat4f("model", board_model);
+        shader.SetUniform1f("u_Alpha", 1.0f);
+        shader.SetUniform1i("u_UseTexture", 1);
+        shader.SetUniform1i("u_Texture", 0);
+        shader.Unbind();
+
+        GLCall(glActiveTexture(GL_TEXTURE0));
+        GLCall(glBindTexture(GL_TEXTURE_2D, texture->textureID));
+
+        renderer.Draw(va, ib, shader);
+
+        if (grid)
+        {
+            if (grid->visible)
+            {
+                grid_shader.Bind();
+                grid_shader.SetUniformMat4f("projection", projection);
+                grid_shader.SetUniformMat4f("view", viewMatrix);
+                grid_shader.SetUniformMat4f("model", board_model); // Grid model is the same as the board
+                grid_shader.SetUniform1i("grid_type", grid->is_hex ? 1 : 0);
+                grid_shader.SetUniform1f("cell_size", grid->cell_size);
+                grid_shader.SetUniform2f("grid_offset", grid->offset.x, grid->offset.y);
+                grid_shader.SetUniform1f("opacity", grid->opacity);
+                grid_shader.Unbind();
+
+                renderer.Draw(va, ib, grid_shader);
+            }
+        }
+
+        ecs.defer_begin(); // Start deferring modifications
+        active_board.children([&](flecs::entity child)
+                              {
+            if (child.has<MarkerComponent>()) {
+                const TextureComponent* texture_marker = child.get<TextureComponent>();
+                if (texture_marker->textureID != 0) {
+                    const Position* position_marker = child.get<Position>();
+                    const Visibility* visibility_marker = child.get<Visibility>();
+                    const Size* size_marker = child.get<Size>();
+
+                    glm::mat4 marker_model = glm::translate(glm::mat4(1.0f), glm::vec3(position_marker->x, position_marker->y, 0.0f));
+                    marker_model = glm::scale(marker_model, glm::vec3(size_marker->width, size_marker->height, 1.0f));
+
+                    //glm::mat4 mvp = projection * viewMatrix * marker_model; //Calculate Screen Position(Can use method to standize it, but alter to return the MVP
+                    float alpha = 1.0f;
+                    if (!visibility_marker->isVisible) {
+                        if (nm->getPeerRole() == Role::GAMEMASTER)
+                        {
+                            alpha = 0.5f;
+                        }
+                        else {
+                            alpha = 0.0f;
+                        }
+                    }
+
+                    shader.Bind();
+                    shader.SetUniformMat4f("projection", projection);
+                    shader.SetUniformMat4f("view", viewMatrix);
+                    shader.SetUniformMat4f("model", marker_model);
+                    shader.SetUniform1f("u_Alpha", alpha);
+                    shader.SetUniform1i("u_Texture", 0);
+                    shader.SetUniform1i("u_UseTexture", 1);
+                    shader.Unbind();
+
+                    GLCall(glActiveTexture(GL_TEXTURE0));
+                    GLCall(glBindTexture(GL_TEXTURE_2D, texture_marker->textureID));
+
+                    renderer.Draw(va, ib, shader);
+                }
+            }
+
+            if (child.has<FogOfWar>()) {
+                const Position* position_marker = child.get<Position>();
+                const Visibility* visibility_marker = child.get<Visibility>();
+                const TextureComponent* texture_marker = child.get<TextureComponent>();
+                const Size* size_marker = child.get<Size>();
+
+                glm::mat4 fog_model = glm::translate(glm::mat4(1.0f), glm::vec3(position_marker->x, position_marker->y, 0.0f));
+                fog_model = glm::scale(fog_model, glm::vec3(size_marker->width, size_marker->height, 1.0f));
+
+                float alpha = 1.0f;
+              
+                if (!visibility_marker->isVisible) {
+                    if (nm->getPeerRole() == Role::GAMEMASTER) {
+                        alpha = 0.3f;
+                    }
+                    else
+                    {
+                        alpha = 0.0f;
+                    }
+                }
+                else
+                {
+                    if (nm->getPeerRole() == Role::GAMEMASTER)
+                    {
+                        alpha = 0.6f;
+                    }
+                }
+
+                shader.Bind();
+                shader.SetUniformMat4f("projection", projection);
+                shader.SetUniformMat4f("view", viewMatrix);
+                shader.SetUniformMat4f("model", fog_model);
+                shader.SetUniform1f("u_Alpha", alpha);
+                shader.SetUniform1i("u_UseTexture", 0);
+                shader.Unbind();
+
+                renderer.Draw(va, ib, shader);
+
+            } });
+        ecs.defer_end();
+    }
+}
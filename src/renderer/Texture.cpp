@@ -1,5 +1,4 @@
 #include "Texture.h"
-#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 Texture::Texture(const std::string& path) :
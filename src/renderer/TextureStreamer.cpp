@@ -0,0 +1,202 @@
+#include "TextureStreamer.h"
+#include "GpuTextures.h"
+#include "Logger.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    double nowMsF()
+    {
+        using namespace std::chrono;
+        return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+    }
+} // namespace
+
+TextureStreamer::TextureStreamer(size_t workers)
+{
+    workers = std::max<size_t>(1, workers);
+    for (size_t i = 0; i < workers; ++i)
+        workers_.emplace_back([this]()
+                              { workerLoop(); });
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_)
+        if (t.joinable())
+            t.join();
+}
+
+GLuint TextureStreamer::createPlaceholder(uint64_t& gen)
+{
+    static const uint8_t kGray[4] = {96, 96, 96, 255};
+    const GLuint tex = GpuTextures::create(1, 1, kGray);
+    gen = ++nextGen_;
+    live_[tex] = gen;
+    return tex;
+}
+
+bool TextureStreamer::current(const UploadJob& job) const
+{
+    auto it = live_.find(job.tex);
+    return it != live_.end() && it->second == job.gen;
+}
+
+void TextureStreamer::release(GLuint tex)
+{
+    if (tex == 0)
+        return;
+    live_.erase(tex); // decode/upload still queued for it is dropped when it comes up
+    GpuTextures::destroy(tex);
+}
+
+GLuint TextureStreamer::requestFromBytes(std::vector<uint8_t> bytes, ReadyFn onReady)
+{
+    auto owner = std::make_shared<std::vector<uint8_t>>(std::move(bytes));
+    const size_t size = owner->size();
+    return requestFromView(std::shared_ptr<const uint8_t>(owner, owner->data()), size, std::move(onReady));
+}
+
+GLuint TextureStreamer::requestFromView(std::shared_ptr<const uint8_t> data, size_t size, ReadyFn onReady)
+{
+    uint64_t gen = 0;
+    GLuint tex = createPlaceholder(gen);
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        decodeQ_.push_back(DecodeJob{tex, gen, std::move(data), size, std::move(onReady)});
+    }
+    cv_.notify_one();
+    return tex;
+}
+
+GLuint TextureStreamer::requestFromPixels(std::shared_ptr<uint8_t> rgba, int width, int height, ReadyFn onReady)
+{
+    uint64_t gen = 0;
+    GLuint tex = createPlaceholder(gen);
+    UploadJob job;
+    job.tex = tex;
+    job.gen = gen;
+    job.width = width;
+    job.height = height;
+    job.rgba = std::move(rgba);
+    job.onReady = std::move(onReady);
+    uploads_.push_back(std::move(job));
+    return tex;
+}
+
+size_t TextureStreamer::pendingDecodes() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return decodeQ_.size() + decoding_ + decoded_.size();
+}
+
+void TextureStreamer::workerLoop()
+{
+    stbi_set_flip_vertically_on_load_thread(0);
+    for (;;)
+    {
+        DecodeJob job;
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            cv_.wait(lk, [this]
+                     { return stop_ || !decodeQ_.empty(); });
+            if (stop_)
+                return;
+            job = std::move(decodeQ_.front());
+            decodeQ_.pop_front();
+            ++decoding_;
+        }
+
+        int w = 0, h = 0, comp = 0;
+        uint8_t* px = stbi_load_from_memory(job.data.get(), static_cast<int>(job.size), &w, &h, &comp, 4);
+        job.data.reset(); // unmaps a spilled file right after its decode
+
+        UploadJob up;
+        up.tex = job.tex;
+        up.gen = job.gen;
+        up.onReady = std::move(job.onReady);
+        if (px)
+        {
+            up.width = w;
+            up.height = h;
+            up.rgba = std::shared_ptr<uint8_t>(px, [](uint8_t* p)
+                                               { stbi_image_free(p); });
+        }
+        else
+        {
+            Logger::instance().log("localtunnel", Logger::Level::Error,
+                                   std::string("TextureStreamer: decode failed (") + stbi_failure_reason() + ")");
+            up.failed = true;
+        }
+
+        std::lock_guard<std::mutex> lk(mtx_);
+        --decoding_;
+        decoded_.push_back(std::move(up));
+    }
+}
+
+// Uploads row bands until the job is done or the deadline passed. True when finished.
+bool TextureStreamer::uploadSome(UploadJob& job, double deadlineMs)
+{
+    if (!job.storageAllocated)
+    {
+        GpuTextures::allocate(job.tex, job.width, job.height);
+        job.storageAllocated = true;
+    }
+
+    const size_t rowBytes = static_cast<size_t>(job.width) * 4;
+    const int bandRows = std::max(1, static_cast<int>(kBandBytes / rowBytes));
+    while (job.nextRow < job.height)
+    {
+        const int rows = std::min(bandRows, job.height - job.nextRow);
+        GpuTextures::uploadRows(job.tex, job.nextRow, job.width, rows,
+                                job.rgba.get() + rowBytes * static_cast<size_t>(job.nextRow));
+        job.nextRow += rows;
+        if (nowMsF() >= deadlineMs)
+            break;
+    }
+    return job.nextRow >= job.height;
+}
+
+void TextureStreamer::pump(double budgetMs)
+{
+    const double start = nowMsF();
+    const double deadline = start + budgetMs;
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        while (!decoded_.empty())
+        {
+            uploads_.push_back(std::move(decoded_.front()));
+            decoded_.pop_front();
+        }
+    }
+
+    while (!uploads_.empty() && nowMsF() < deadline)
+    {
+        auto& job = uploads_.front();
+        if (!current(job))
+        {
+            uploads_.pop_front(); // released meanwhile
+            continue;
+        }
+        if (!job.failed && !uploadSome(job, deadline))
+            break; // budget spent, continue next frame
+
+        UploadJob done = std::move(job);
+        uploads_.pop_front();
+        live_.erase(done.tex);
+        if (done.onReady)
+            done.onReady(done.tex, glm::vec2(done.width, done.height), !done.failed);
+    }
+
+    lastPumpMs_ = nowMsF() - start;
+    maxPumpMs_ = std::max(maxPumpMs_, lastPumpMs_);
+}
@@ -0,0 +1,137 @@
+// EntityBulk against the .set() chain it replaced, for 1k and 10k markers on one board: both
+// must leave the same entities behind, parented and readable when the ChildOf observer fires
+// (what BoardVersions and BoardStateHash rely on). Prints the timings; only correctness fails
+// the test, a loaded CI box makes any speed threshold flaky.
+#include "EntityBulk.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+    int failures = 0;
+
+    void fail(const char* what, int n)
+    {
+        if (++failures <= 10)
+            std::fprintf(stderr, "FAIL (%d markers): %s\n", n, what);
+    }
+
+    std::string texturePath(int i)
+    {
+        return "markers/goblin_" + std::to_string(i) + ".png";
+    }
+
+    MarkerComponent owner()
+    {
+        return MarkerComponent{"owner-uuid-123456789", "Player", false, false};
+    }
+
+    struct Run
+    {
+        double ms = 0.0;
+        uint64_t parentAdds = 0;
+        uint64_t unreadable = 0; // ChildOf arrived before the Identifier/MarkerComponent
+    };
+
+    Run spawnMarkers(int n, bool bulk)
+    {
+        flecs::world ecs;
+        Run run;
+        auto observer = ecs.observer()
+                            .with(flecs::ChildOf, flecs::Wildcard)
+                            .event(flecs::OnAdd)
+                            .each([&run](flecs::entity e)
+                                  {
+                                      ++run.parentAdds;
+                                      if (!e.has<MarkerComponent>() || !e.has<Identifier>() || e.get<Identifier>()->id == 0)
+                                          ++run.unreadable; });
+        auto board = ecs.entity().set(Identifier{1});
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<flecs::entity> markers;
+        if (bulk)
+        {
+            MarkerRows rows;
+            rows.reserve(n);
+            for (int i = 0; i < n; ++i)
+                rows.push(Identifier{uint64_t(i + 2)}, Position{float(i), 2.0f}, Size{3.0f, 4.0f},
+                          TextureComponent{0, texturePath(i), glm::vec2{3.0f, 4.0f}}, Visibility{true}, owner(), Moving{false});
+            markers = EntityBulk::spawnMarkers(ecs, rows, board);
+            if (rows.size() != 0)
+                fail("rows were not emptied", n);
+        }
+        else
+        {
+            markers.reserve(n);
+            for (int i = 0; i < n; ++i)
+            {
+                auto e = ecs.entity()
+                             .set(Identifier{uint64_t(i + 2)})
+                             .set(Position{float(i), 2.0f})
+                             .set(Size{3.0f, 4.0f})
+                             .set(TextureComponent{0, texturePath(i), glm::vec2{3.0f, 4.0f}})
+                             .set(Visibility{true})
+                             .set(owner())
+                             .set(Moving{false});
+                e.add(flecs::ChildOf, board);
+                markers.push_back(e);
+            }
+        }
+        run.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (markers.size() != size_t(n))
+            fail("wrong number of entities", n);
+        for (int i = 0; i < int(markers.size()); ++i)
+        {
+            const auto& e = markers[i];
+            if (!e.has(flecs::ChildOf, board))
+                fail("marker not parented to the board", n);
+            if (e.get<Identifier>()->id != uint64_t(i + 2) || e.get<Position>()->x != float(i))
+                fail("rows out of order", n);
+            if (e.get<TextureComponent>()->image_path != texturePath(i) || e.get<MarkerComponent>()->ownerUniqueId != owner().ownerUniqueId)
+                fail("strings not moved in", n);
+        }
+        int children = 0;
+        board.children([&](flecs::entity)
+                       { ++children; });
+        if (children != n)
+            fail("board child count", n);
+        if (run.parentAdds != uint64_t(n) || run.unreadable != 0)
+            fail("ChildOf observer saw an unreadable marker", n);
+        observer.destruct();
+        return run;
+    }
+
+    void checkFog()
+    {
+        flecs::world ecs;
+        auto board = ecs.entity().set(Identifier{1});
+        FogRows rows;
+        for (int i = 0; i < 64; ++i)
+            rows.push(Identifier{uint64_t(i + 2)}, Position{0.0f, float(i)}, Size{8.0f, 8.0f}, Visibility{false});
+        auto fog = EntityBulk::spawnFog(ecs, rows, board);
+        if (fog.size() != 64 || !fog[10].has<FogOfWar>() || !fog[10].has(flecs::ChildOf, board) || fog[10].get<Identifier>()->id != 12)
+            fail("fog rows", 64);
+    }
+} // namespace
+
+int main()
+{
+    for (int n : {1000, 10000})
+    {
+        const Run chain = spawnMarkers(n, false);
+        const Run bulk = spawnMarkers(n, true);
+        std::printf("%5d markers: set() chain %.2f ms, bulk %.2f ms\n", n, chain.ms, bulk.ms);
+    }
+    checkFog();
+
+    if (failures != 0)
+    {
+        std::fprintf(stderr, "EntityBulkTest: %d failures\n", failures);
+        return 1;
+    }
+    std::printf("EntityBulkTest: ok\n");
+    return 0;
+}
@@ -0,0 +1,315 @@
+// igd::discover, the SOAP calls and HostDiscovery against a local SSDP + HTTP responder: a UDP
+// socket answering M-SEARCH with a LOCATION on loopback and a TCP server playing the gateway
+// (device description, GetExternalIPAddress, AddPortMapping, DeletePortMapping).
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "HostDiscovery.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+#ifdef _WIN32
+    using socket_t = SOCKET;
+    constexpr socket_t kBadSocket = INVALID_SOCKET;
+    void closeSocket(socket_t s)
+    {
+        closesocket(s);
+    }
+#else
+    using socket_t = int;
+    constexpr socket_t kBadSocket = -1;
+    void closeSocket(socket_t s)
+    {
+        ::close(s);
+    }
+#endif
+
+    constexpr const char* kExternalIp = "203.0.113.7";
+    constexpr const char* kServiceType = "urn:schemas-upnp-org:service:WANIPConnection:1";
+
+    int failures = 0;
+
+    void check(bool ok, const char* what)
+    {
+        if (!ok)
+        {
+            ++failures;
+            std::fprintf(stderr, "FAIL: %s\n", what);
+        }
+    }
+
+    socket_t bindLoopback(int type, unsigned short& port)
+    {
+        socket_t s = ::socket(AF_INET, type, type == SOCK_DGRAM ? IPPROTO_UDP : IPPROTO_TCP);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        if (s == kBadSocket || ::bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+            return kBadSocket;
+        socklen_t len = sizeof(addr);
+        getsockname(s, reinterpret_cast<sockaddr*>(&addr), &len);
+        port = ntohs(addr.sin_port);
+        return s;
+    }
+
+    // One fake gateway: SSDP on a UDP port, description + control on a TCP port.
+    class FakeGateway
+    {
+    public:
+        FakeGateway()
+        {
+            udp_ = bindLoopback(SOCK_DGRAM, ssdpPort);
+            tcp_ = bindLoopback(SOCK_STREAM, httpPort_);
+            if (udp_ == kBadSocket || tcp_ == kBadSocket || ::listen(tcp_, 8) != 0)
+                return;
+            ssdp_ = std::thread([this]()
+                                { serveSsdp(); });
+            http_ = std::thread([this]()
+                                { serveHttp(); });
+        }
+
+        ~FakeGateway()
+        {
+            stop_ = true;
+            // unblock both loops with a last datagram and a last connection
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socket_t poke = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            addr.sin_port = htons(ssdpPort);
+            ::sendto(poke, "x", 1, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            closeSocket(poke);
+            poke = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            addr.sin_port = htons(httpPort_);
+            ::connect(poke, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            closeSocket(poke);
+            if (ssdp_.joinable())
+                ssdp_.join();
+            if (http_.joinable())
+                http_.join();
+            closeSocket(udp_);
+            closeSocket(tcp_);
+        }
+
+        bool ok() const
+        {
+            return ssdp_.joinable() && http_.joinable();
+        }
+
+        std::vector<std::string> soapActions()
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            return actions_;
+        }
+
+        std::string lastSoapBody()
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            return lastBody_;
+        }
+
+        unsigned short ssdpPort = 0;
+
+    private:
+        void serveSsdp()
+        {
+            char buf[2048];
+            while (!stop_)
+            {
+                sockaddr_in from{};
+                socklen_t len = sizeof(from);
+                const int n = ::recvfrom(udp_, buf, sizeof(buf), 0, reinterpret_cast<sockaddr*>(&from), &len);
+                if (n <= 0 || stop_ || std::string(buf, n).rfind("M-SEARCH", 0) != 0)
+                    continue;
+                const std::string reply = "HTTP/1.1 200 OK\r\n"
+                                          "CACHE-CONTROL: max-age=120\r\n"
+                                          "ST: urn:schemas-upnp-org:device:InternetGatewayDevice:1\r\n"
+                                          "Location: http://127.0.0.1:" +
+                                          std::to_string(httpPort_) + "/rootDesc.xml\r\n\r\n";
+                ::sendto(udp_, reply.data(), static_cast<int>(reply.size()), 0, reinterpret_cast<sockaddr*>(&from), len);
+            }
+        }
+
+        void serveHttp()
+        {
+            while (!stop_)
+            {
+                socket_t c = ::accept(tcp_, nullptr, nullptr);
+                if (c == kBadSocket)
+                    continue;
+                if (!stop_)
+                    serveOne(c);
+                closeSocket(c);
+            }
+        }
+
+        void serveOne(socket_t c)
+        {
+            std::string raw;
+            char buf[4096];
+            size_t need = std::string::npos;
+            while (need == std::string::npos || raw.size() < need)
+            {
+                const int n = ::recv(c, buf, sizeof(buf), 0);
+                if (n <= 0)
+                    return;
+                raw.append(buf, n);
+                const auto split = raw.find("\r\n\r\n");
+                if (split != std::string::npos && need == std::string::npos)
+                {
+                    size_t bodyLen = 0;
+                    if (auto cl = raw.find("Content-Length: "); cl != std::string::npos && cl < split)
+                        bodyLen = std::strtoul(raw.c_str() + cl + 16, nullptr, 10);
+                    need = split + 4 + bodyLen;
+                }
+            }
+            const std::string body = raw.substr(raw.find("\r\n\r\n") + 4);
+
+            std::string status = "200 OK", out;
+            if (raw.rfind("GET /rootDesc.xml ", 0) == 0)
+            {
+                // chunked, with the control URL relative: both paths the parser has to handle
+                const std::string xml = std::string("<?xml version=\"1.0\"?><root><device><deviceList><device>"
+                                                    "<serviceList><service><serviceType>urn:schemas-upnp-org:service:Layer3Forwarding:1</serviceType>"
+                                                    "<controlURL>/l3f</controlURL></service>"
+                                                    "<service><serviceType>") +
+                                        kServiceType + "</serviceType><controlURL>ctl/IPConn</controlURL></service>"
+                                                       "</serviceList></device></deviceList></device></root>";
+                char size[16];
+                std::snprintf(size, sizeof(size), "%zx", xml.size());
+                sendAll(c, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nContent-Type: text/xml\r\n\r\n" +
+                               std::string(size) + "\r\n" + xml + "\r\n0\r\n\r\n");
+                return;
+            }
+            if (raw.rfind("POST /ctl/IPConn ", 0) == 0)
+            {
+                const auto at = raw.find("SOAPAction: \"");
+                const auto hash = raw.find('#', at);
+                const std::string action = raw.substr(hash + 1, raw.find('"', hash) - hash - 1);
+                {
+                    std::lock_guard<std::mutex> lk(mtx_);
+                    actions_.push_back(action);
+                    lastBody_ = body;
+                }
+                if (action == "GetExternalIPAddress")
+                    out = std::string("<s:Envelope><s:Body><u:GetExternalIPAddressResponse><NewExternalIPAddress>") +
+                          kExternalIp + "</NewExternalIPAddress></u:GetExternalIPAddressResponse></s:Body></s:Envelope>";
+                else if (action != "AddPortMapping" && action != "DeletePortMapping")
+                    status = "500 Internal Server Error";
+            }
+            else
+            {
+                status = "404 Not Found";
+            }
+            sendAll(c, "HTTP/1.1 " + status + "\r\nContent-Length: " + std::to_string(out.size()) + "\r\n\r\n" + out);
+        }
+
+        static void sendAll(socket_t c, const std::string& s)
+        {
+            ::send(c, s.data(), static_cast<int>(s.size()), 0);
+        }
+
+        socket_t udp_ = kBadSocket;
+        socket_t tcp_ = kBadSocket;
+        unsigned short httpPort_ = 0;
+        std::atomic<bool> stop_{false};
+        std::thread ssdp_, http_;
+        std::mutex mtx_;
+        std::vector<std::string> actions_;
+        std::string lastBody_;
+    };
+
+    bool contains(const std::string& s, const std::string& part)
+    {
+        return s.find(part) != std::string::npos;
+    }
+} // namespace
+
+int main()
+{
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+    FakeGateway fake;
+    if (!fake.ok())
+    {
+        std::fprintf(stderr, "FAIL: could not start the fake gateway\n");
+        return 1;
+    }
+
+    igd::Options opts;
+    opts.ssdpAddress = "127.0.0.1";
+    opts.ssdpPort = fake.ssdpPort;
+    opts.timeoutMs = 1000;
+
+    // blocking API
+    const auto gw = igd::discover(opts);
+    check(gw.valid(), "discover finds the fake gateway");
+    check(gw.host == "127.0.0.1", "gateway host comes from LOCATION");
+    check(gw.controlPath == "/ctl/IPConn", "relative controlURL resolved against LOCATION");
+    check(gw.serviceType == kServiceType, "WANIPConnection picked over Layer3Forwarding");
+    check(gw.localIp == "127.0.0.1", "local address routes toward the gateway");
+    check(igd::externalIPAddress(gw) == kExternalIp, "GetExternalIPAddress parsed");
+
+    std::string err;
+    check(igd::addPortMapping(gw, "127.0.0.1", 7777, 7777, "TCP", "RunicVTT", 0, &err), "AddPortMapping accepted");
+    const std::string addBody = fake.lastSoapBody();
+    check(contains(addBody, "<NewExternalPort>7777</NewExternalPort>") && contains(addBody, "<NewProtocol>TCP</NewProtocol>") &&
+              contains(addBody, "<NewInternalClient>127.0.0.1</NewInternalClient>"),
+          "AddPortMapping arguments");
+    check(igd::deletePortMapping(gw, 7777, "TCP"), "DeletePortMapping accepted");
+
+    // async wrapper: answers show up without the caller blocking on them
+    HostDiscovery hd(opts);
+    hd.start();
+    std::promise<bool> mapped;
+    hd.addPortMappingAsync(7778, "UDP", "RunicVTT", [&](bool ok, const std::string&)
+                           { mapped.set_value(ok); });
+    auto done = mapped.get_future();
+    check(done.wait_for(std::chrono::seconds(10)) == std::future_status::ready && done.get(), "addPortMappingAsync maps through the discovered gateway");
+    check(hd.gatewayState() == HostDiscovery::State::Ready, "gateway state ready");
+    for (int i = 0; i < 100 && hd.externalIPv4().empty(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    check(hd.externalIPv4() == kExternalIp, "HostDiscovery caches the gateway's public address");
+    check(hd.localIPv4() == "127.0.0.1", "HostDiscovery local address is the one facing the gateway");
+
+    // nobody answering: invalid gateway, no mapping, within the timeout
+    igd::Options silent = opts;
+    unsigned short unusedPort = 0;
+    const socket_t hold = bindLoopback(SOCK_DGRAM, unusedPort); // bound, never read
+    silent.ssdpPort = unusedPort;
+    silent.timeoutMs = 300;
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto none = igd::discover(silent);
+    check(!none.valid(), "no responder, no gateway");
+    check(std::chrono::steady_clock::now() - t0 < std::chrono::seconds(3), "discover gives up after its timeout");
+    check(!igd::addPortMapping(none, "127.0.0.1", 1, 1, "TCP", "", 0, &err) && err == "no gateway", "mapping without a gateway fails");
+    closeSocket(hold);
+
+    const auto actions = fake.soapActions();
+    check(actions.size() >= 4, "every SOAP call reached the gateway");
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    if (failures == 0)
+        std::printf("HostDiscovery: ok\n");
+    return failures == 0 ? 0 : 1;
+}
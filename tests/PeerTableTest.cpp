@@ -0,0 +1,135 @@
+// Stress test for PeerTable: writers connect and disconnect peers while readers iterate
+// snapshots and look peers up. Every snapshot must stay internally consistent for as long as
+// it is held, and the final table must match what the writers left behind.
+#include "PeerTable.h"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// PeerTable only holds shared_ptr<PeerLink>; the real one needs libdatachannel
+class PeerLink
+{
+public:
+    explicit PeerLink(std::string id) :
+        id(std::move(id)) {}
+    std::string id;
+};
+
+namespace
+{
+    constexpr int kWriters = 4;
+    constexpr int kReaders = 4;
+    constexpr int kPeersPerWriter = 16;
+    constexpr int kRounds = 2000;
+
+    std::atomic<int> failures{0};
+
+    void fail(const char* what)
+    {
+        if (failures.fetch_add(1) < 10)
+            std::fprintf(stderr, "FAIL: %s\n", what);
+    }
+
+    std::string peerName(int writer, int i)
+    {
+        return "w" + std::to_string(writer) + "-p" + std::to_string(i);
+    }
+} // namespace
+
+int main()
+{
+    PeerTable table;
+    std::atomic<bool> stop{false};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; ++r)
+    {
+        readers.emplace_back([&]()
+                             {
+                                 uint64_t lastVersion = 0;
+                                 while (!stop.load())
+                                 {
+                                     auto snap = table.snapshot();
+                                     const size_t size = snap.size();
+                                     size_t seen = 0;
+                                     for (const auto& [pid, link] : snap)
+                                     {
+                                         if (!link || link->id != pid)
+                                             fail("snapshot entry does not match its key");
+                                         if (snap.find(pid) == snap.end())
+                                             fail("snapshot lost an entry while held");
+                                         ++seen;
+                                     }
+                                     if (seen != size)
+                                         fail("snapshot size changed while iterating");
+                                     if (auto link = table.find(peerName(0, 0)); link && link->id != peerName(0, 0))
+                                         fail("find returned the wrong link");
+                                     const uint64_t v = table.version();
+                                     if (v < lastVersion)
+                                         fail("version went backwards");
+                                     lastVersion = v;
+                                 } });
+    }
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w)
+    {
+        writers.emplace_back([&, w]()
+                             {
+                                 for (int round = 0; round < kRounds; ++round)
+                                 {
+                                     const int i = round % kPeersPerWriter;
+                                     const std::string pid = peerName(w, i);
+                                     int made = 0;
+                                     auto link = table.findOrInsert(pid, [&]()
+                                                                    {
+                                                                        ++made;
+                                                                        return std::make_shared<PeerLink>(pid); });
+                                     if (!link || link->id != pid)
+                                         fail("findOrInsert returned the wrong link");
+                                     auto again = table.findOrInsert(pid, [&]()
+                                                                     {
+                                                                         ++made;
+                                                                         return std::make_shared<PeerLink>(pid); });
+                                     if (again != link || made > 1)
+                                         fail("findOrInsert made a second link for a present peer");
+
+                                     // every other round the peer leaves again
+                                     if (round % 2 == 1)
+                                     {
+                                         std::shared_ptr<PeerLink> removed;
+                                         if (!table.erase(pid, removed) || removed != link)
+                                             fail("erase did not return the inserted link");
+                                         if (table.erase(pid, removed))
+                                             fail("erase succeeded twice");
+                                     }
+                                 } });
+    }
+
+    for (auto& t : writers)
+        t.join();
+    stop = true;
+    for (auto& t : readers)
+        t.join();
+
+    // kRounds is even: the peers of the last round left, the ones of the round before stayed
+    const size_t expected = static_cast<size_t>(kWriters) * (kPeersPerWriter / 2);
+    if (table.size() != expected)
+        fail("final table size is wrong");
+    auto removed = table.eraseIf([](const std::string& pid, const std::shared_ptr<PeerLink>&)
+                                 { return pid.rfind("w0-", 0) == 0; });
+    if (removed.size() != kPeersPerWriter / 2 || table.size() != expected - removed.size())
+        fail("eraseIf removed the wrong entries");
+    if (table.takeAll().size() != expected - removed.size() || !table.empty())
+        fail("takeAll left entries behind");
+
+    if (failures.load() != 0)
+    {
+        std::fprintf(stderr, "PeerTableTest: %d failures\n", failures.load());
+        return 1;
+    }
+    std::printf("PeerTableTest: ok\n");
+    return 0;
+}